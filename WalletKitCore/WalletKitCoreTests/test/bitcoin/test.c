@@ -58,6 +58,8 @@
 #include <errno.h>
 #include <time.h>
 #include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
 #include <arpa/inet.h>
 #include <pthread.h>
 
@@ -2674,7 +2676,22 @@ int BRWalletTests()
     
     if (BRWalletFeeForTxAmount(w, SATOSHIS) != 0)
         r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletFeeForTxAmount() test 2\n", __func__);
-    
+
+    uint32_t chain = UINT32_MAX, index = UINT32_MAX;
+    BRAddress changeAddrs[2];
+
+    if (! BRWalletAddressChainIndex(w, recvAddr.s, &chain, &index) || chain != SEQUENCE_EXTERNAL_CHAIN || index != 0)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletAddressChainIndex() test 1\n", __func__);
+
+    BRWalletUnusedAddrs(w, changeAddrs, 2, SEQUENCE_INTERNAL_CHAIN);
+
+    if (! BRWalletAddressChainIndex(w, changeAddrs[1].s, &chain, &index) || chain != SEQUENCE_INTERNAL_CHAIN ||
+        index != 1)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletAddressChainIndex() test 2\n", __func__);
+
+    if (BRWalletAddressChainIndex(w, addr.s, &chain, &index))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletAddressChainIndex() test 3\n", __func__);
+
     printf("                                    ");
     BRWalletFree(w);
 
@@ -2707,7 +2724,140 @@ int BRWalletTests()
 
     BRTransactionFree(tx);
     BRWalletFree(w);
-    
+
+    // registering transactions one at a time must agree with a wallet built from all of them at once
+    BRTransaction *txs[4], *txsCopy[4];
+    BRUTXO utxos[8], utxosCopy[8];
+    BRWallet *wCopy;
+    size_t utxosCount;
+
+    txs[0] = BRTransactionNew();
+    BRTransactionAddInput(txs[0], inHash, 0, 1, inScript, inScriptLen, NULL, 0, NULL, 0, TXIN_SEQUENCE);
+    BRTransactionAddOutput(txs[0], SATOSHIS, outScript, outScriptLen);
+    BRTransactionSign(txs[0], 0, &k, 1);
+    txs[0]->blockHeight = 1, txs[0]->timestamp = 1;
+    w = BRWalletNew(BRMainNetParams->addrParams, txs, 1, mpk);
+
+    for (size_t i = 1; i < 4; i++) {
+        txs[i] = BRWalletCreateTransaction(w, SATOSHIS/10, addr.s);
+        if (txs[i]) BRWalletSignTransaction(w, txs[i], 0x00, &seed, sizeof(seed));
+        if (! txs[i] || ! BRWalletRegisterTransaction(w, txs[i]))
+            r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletRegisterTransaction() test 6\n", __func__);
+        if (! txs[i]) break;
+    }
+
+    for (size_t i = 0; r && i < 4; i++) txsCopy[i] = BRTransactionCopy(txs[i]);
+    wCopy = (r ? BRWalletNew(BRMainNetParams->addrParams, txsCopy, 4, mpk) : NULL);
+
+    if (wCopy) {
+        if (BRWalletBalance(w) != BRWalletBalance(wCopy) ||
+            BRWalletTotalSent(w) != BRWalletTotalSent(wCopy) ||
+            BRWalletTotalReceived(w) != BRWalletTotalReceived(wCopy))
+            r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletRegisterTransaction() balance test\n", __func__);
+
+        utxosCount = BRWalletUTXOs(w, utxos, 8);
+        if (utxosCount != BRWalletUTXOs(wCopy, utxosCopy, 8) ||
+            0 != memcmp(utxos, utxosCopy, utxosCount * sizeof(BRUTXO)))
+            r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletRegisterTransaction() UTXO test\n", __func__);
+
+        for (size_t i = 0; i < 4; i++) {
+            if (BRWalletBalanceAfterTx(w, txs[i]) != BRWalletBalanceAfterTx(wCopy, txsCopy[i]))
+                r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletBalanceAfterTx() test %zu\n", __func__, i);
+        }
+
+        BRWalletFree(wCopy);
+    }
+
+    // registering all of them together, in reverse order, must agree as well
+    for (size_t i = 0; r && i < 4; i++) txsCopy[3 - i] = BRTransactionCopy(txs[i]);
+    wCopy = (r ? BRWalletNew(BRMainNetParams->addrParams, NULL, 0, mpk) : NULL);
+
+    if (wCopy) {
+        BRTransaction *batch[6];
+
+        // along with an in-batch duplicate of txs[0] and a confirmed non-wallet tx, which the wallet doesn't take
+        for (size_t i = 0; i < 4; i++) batch[i] = txsCopy[i];
+        batch[4] = BRTransactionCopy(txs[0]);
+        batch[5] = BRTransactionNew();
+        BRTransactionAddInput(batch[5], inHash, 2, 1, inScript, inScriptLen, NULL, 0, NULL, 0, TXIN_SEQUENCE);
+        BRTransactionAddOutput(batch[5], SATOSHIS, inScript, inScriptLen);
+        BRTransactionSign(batch[5], 0, &k, 1);
+        batch[5]->blockHeight = 1, batch[5]->timestamp = 1;
+
+        if (4 != BRWalletRegisterTransactions(wCopy, batch, 6))
+            r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletRegisterTransactions() test\n", __func__);
+
+        if (batch[0] || batch[1] || batch[2] || 1 != (! batch[3]) + (! batch[4]) || ! batch[5])
+            r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletRegisterTransactions() ownership test\n", __func__);
+
+        for (size_t i = 0; i < 6; i++) {
+            if (batch[i]) BRTransactionFree(batch[i]);
+        }
+
+        if (BRWalletBalance(w) != BRWalletBalance(wCopy) || 4 != BRWalletTransactions(wCopy, NULL, 0))
+            r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletRegisterTransactions() balance test\n", __func__);
+
+        utxosCount = BRWalletUTXOs(w, utxos, 8);
+        if (utxosCount != BRWalletUTXOs(wCopy, utxosCopy, 8) ||
+            0 != memcmp(utxos, utxosCopy, utxosCount * sizeof(BRUTXO)))
+            r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletRegisterTransactions() UTXO test\n", __func__);
+
+        BRWalletFree(wCopy);
+    }
+
+    // registering them one at a time, children first, must still order each after those it spends from
+    for (size_t i = 0; r && i < 4; i++) txsCopy[i] = BRTransactionCopy(txs[i]);
+    wCopy = (r ? BRWalletNew(BRMainNetParams->addrParams, NULL, 0, mpk) : NULL);
+
+    if (wCopy) {
+        BRTransaction *ordered[4];
+
+        for (size_t i = 4; i > 0; i--) BRWalletRegisterTransaction(wCopy, txsCopy[i - 1]);
+
+        if (4 != BRWalletTransactions(wCopy, ordered, 4) || 0 != memcmp(ordered, txsCopy, sizeof(ordered)))
+            r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletTransactions() order test\n", __func__);
+
+        BRWalletFree(wCopy);
+    }
+
+    BRWalletFree(w);
+
+    // knapsack spends the smallest output that covers the amount plus change, branch and bound one that needs no change
+    txs[0] = BRTransactionNew();
+    BRTransactionAddInput(txs[0], inHash, 0, 1, inScript, inScriptLen, NULL, 0, NULL, 0, TXIN_SEQUENCE);
+    BRTransactionAddOutput(txs[0], SATOSHIS, outScript, outScriptLen);
+    BRTransactionSign(txs[0], 0, &k, 1);
+    txs[0]->blockHeight = 1, txs[0]->timestamp = 1;
+    txs[1] = BRTransactionNew();
+    BRTransactionAddInput(txs[1], inHash, 1, 1, inScript, inScriptLen, NULL, 0, NULL, 0, TXIN_SEQUENCE);
+    BRTransactionAddOutput(txs[1], SATOSHIS/2, outScript, outScriptLen);
+    BRTransactionSign(txs[1], 0, &k, 1);
+    txs[1]->blockHeight = 2, txs[1]->timestamp = 2;
+    w = BRWalletNew(BRMainNetParams->addrParams, txs, 2, mpk);
+
+    if (BRWalletGetCoinSelection(w) != BRWalletCoinSelectionInOrder)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletGetCoinSelection() test\n", __func__);
+
+    BRWalletSetCoinSelection(w, BRWalletCoinSelectionKnapsack);
+    tx = BRWalletCreateTransaction(w, SATOSHIS/4 + 37, addr.s);
+    fee = (tx) ? BRWalletFeeForTx(w, tx) : 0;
+
+    if (! tx || tx->inCount != 1 || ! UInt256Eq(tx->inputs[0].txHash, txs[1]->txHash) || tx->outCount != 2)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletCoinSelectionKnapsack test\n", __func__);
+
+    if (tx && (BRWalletBalance(w) - (SATOSHIS/4 + 37 + fee)) % 100 != 0)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletCoinSelectionKnapsack fee round off test\n", __func__);
+
+    if (tx) BRTransactionFree(tx);
+    BRWalletSetCoinSelection(w, BRWalletCoinSelectionBranchAndBound);
+    tx = BRWalletCreateTransaction(w, SATOSHIS/2 - fee - 1000, addr.s);
+
+    if (! tx || tx->inCount != 1 || ! UInt256Eq(tx->inputs[0].txHash, txs[1]->txHash) || tx->outCount != 1)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletCoinSelectionBranchAndBound test\n", __func__);
+
+    if (tx) BRTransactionFree(tx);
+    BRWalletFree(w);
+
     amt = BRBitcoinAmount(50000, 50000);
     if (amt != SATOSHIS) r = 0, fprintf(stderr, "***FAILED*** %s: BRBitcoinAmount() test 1\n", __func__);
 
@@ -3341,6 +3491,113 @@ int BRPaymentProtocolEncryptionTests()
 
 void BRPeerAcceptMessageTest(BRPeer *peer, const uint8_t *msg, size_t len, const char *type);
 
+static pthread_mutex_t _reactorTestLock = PTHREAD_MUTEX_INITIALIZER;
+static int _reactorTestError = 0, _reactorTestCleanups = 0;
+
+static void _reactorTestDisconnected(void *info, int error)
+{
+    pthread_mutex_lock(&_reactorTestLock);
+    _reactorTestError = error;
+    pthread_mutex_unlock(&_reactorTestLock);
+}
+
+static void _reactorTestThreadCleanup(void *info)
+{
+    pthread_mutex_lock(&_reactorTestLock);
+    _reactorTestCleanups++;
+    pthread_mutex_unlock(&_reactorTestLock);
+}
+
+// waits for the reactor to finish with the peer, returning the disconnect error
+static int _reactorTestWait(int cleanups)
+{
+    int error = -1;
+
+    for (int i = 0; i < 500 && error < 0; i++) {
+        pthread_mutex_lock(&_reactorTestLock);
+        if (_reactorTestCleanups == cleanups) error = _reactorTestError;
+        pthread_mutex_unlock(&_reactorTestLock);
+        if (error < 0) usleep(10000);
+    }
+
+    return error;
+}
+
+// accepts peer's connection on listener and reads its first message header, which must be version
+static int _reactorTestAccept(int listener)
+{
+    uint8_t header[24];
+    size_t len = 0;
+    ssize_t n = 1;
+    int conn = accept(listener, NULL, NULL);
+
+    while (conn >= 0 && n > 0 && len < sizeof(header)) {
+        n = read(conn, &header[len], sizeof(header) - len);
+        if (n > 0) len += (size_t)n;
+    }
+
+    if (len != sizeof(header) || UInt32GetLE(header) != BRMainNetParams->magicNumber ||
+        strncmp((const char *)&header[4], MSG_VERSION, 12) != 0) {
+        if (conn >= 0) close(conn);
+        conn = -1;
+    }
+
+    return conn;
+}
+
+int BRPeerReactorTests()
+{
+    int r = 1, listener, conn;
+    BRPeerReactor *reactor = BRPeerReactorNew(2);
+    struct sockaddr_in addr;
+    socklen_t addrLen = sizeof(addr);
+    BRPeer *p;
+
+    if (! reactor) return r; // not supported on this platform
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (listener < 0 || bind(listener, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(listener, 1) < 0 ||
+        getsockname(listener, (struct sockaddr *)&addr, &addrLen) < 0) {
+        if (listener >= 0) close(listener);
+        BRPeerReactorFree(reactor);
+        return r; // no loopback networking
+    }
+
+    p = BRPeerNew(BRMainNetParams->magicNumber);
+    p->address = ((UInt128) { .u8 = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff, 127, 0, 0, 1 } });
+    p->port = ntohs(addr.sin_port);
+    BRPeerSetReactor(p, reactor);
+    BRPeerSetCallbacks(p, NULL, NULL, _reactorTestDisconnected, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                       _reactorTestThreadCleanup);
+
+    // the remote peer closes the connection
+    BRPeerConnect(p);
+    conn = _reactorTestAccept(listener);
+    if (conn < 0) r = 0, fprintf(stderr, "***FAILED*** %s: BRPeerConnect() test 1\n", __func__);
+    if (conn >= 0) close(conn);
+
+    if (_reactorTestWait(1) != ECONNRESET || BRPeerConnectStatus(p) != BRPeerStatusDisconnected)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRPeerConnect() test 2\n", __func__);
+
+    // the reactor is freed with the peer connected
+    BRPeerConnect(p);
+    conn = _reactorTestAccept(listener);
+    if (conn < 0) r = 0, fprintf(stderr, "***FAILED*** %s: BRPeerReactorFree() test 1\n", __func__);
+    BRPeerReactorFree(reactor);
+
+    if (_reactorTestWait(2) != ECANCELED || BRPeerConnectStatus(p) != BRPeerStatusDisconnected)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRPeerReactorFree() test 2\n", __func__);
+
+    if (conn >= 0) close(conn);
+    close(listener);
+    BRPeerFree(p);
+    return r;
+}
+
 int BRPeerTests()
 {
     int r = 1;
@@ -3348,6 +3605,7 @@ int BRPeerTests()
     const char msg[] = "my message";
     
     BRPeerAcceptMessageTest(p, (const uint8_t *)msg, sizeof(msg) - 1, "inv");
+    if (! BRPeerReactorTests()) r = 0;
     return r;
 }
 
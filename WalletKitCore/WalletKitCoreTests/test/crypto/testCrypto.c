@@ -15,19 +15,24 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <sys/stat.h>
 
 #include "BRCryptoAmount.h"
 #include "BRCryptoWallet.h"
+#include "crypto/BRCryptoListenerP.h"
 #include "crypto/BRCryptoNetworkP.h"
 #include "crypto/BRCryptoTransferP.h"
 #include "crypto/BRCryptoWalletP.h"
 #include "crypto/BRCryptoWalletManagerP.h"
 #include "crypto/BRCryptoSystemP.h"
+#include "crypto/BRCryptoFileService.h"
 
+#include "support/BRCrypto.h"
 #include "support/BRBIP32Sequence.h"
 #include "support/BRBIP39Mnemonic.h"
 #include "support/util/BRHex.h"
 #include "bitcoin/BRChainParams.h"
+#include "bitcoin/BRMerkleBlock.h"
 #include "bitcoin/BRWallet.h"
 
 #include "crypto/handlers/btc/BRCryptoBTC.h"
@@ -309,6 +314,253 @@ runCryptoTransferTests (void) {
     transferTestsAddress();
 }
 
+///
+/// Mark: BRCryptoListener Tests
+///
+
+// Records the transfer events delivered in batches.  A batch callback can be held, on the
+// listener's thread, until released by the test.
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    size_t batchesCount;
+    BRArrayOf(BRCryptoTransferEvent) events;
+    bool hold;
+    bool held;
+} ListenerTestRecorder;
+
+static void
+listenerTestRecorderBatchCallback (BRCryptoListenerContext context,
+                                   BRCryptoListenerEvent *events,
+                                   size_t eventsCount) {
+    ListenerTestRecorder *recorder = (ListenerTestRecorder *) context;
+
+    pthread_mutex_lock (&recorder->lock);
+    recorder->batchesCount += 1;
+    for (size_t index = 0; index < eventsCount; index++) {
+        assert (CRYPTO_LISTENER_EVENT_TRANSFER == events[index].type);
+        array_add (recorder->events, events[index].u.transfer);
+
+        // The recorder keeps the state pointers for comparison; the test holds references.
+        if (CRYPTO_TRANSFER_EVENT_CHANGED == events[index].u.transfer.type) {
+            cryptoTransferStateGive (events[index].u.transfer.u.state.old);
+            cryptoTransferStateGive (events[index].u.transfer.u.state.new);
+        }
+    }
+
+    recorder->held = recorder->hold;
+    pthread_cond_broadcast (&recorder->cond);
+    while (recorder->hold) pthread_cond_wait (&recorder->cond, &recorder->lock);
+    recorder->held = false;
+    pthread_mutex_unlock (&recorder->lock);
+}
+
+// Wait, for at most a few seconds, until `eventsCount` events have been recorded.
+static size_t
+listenerTestRecorderWait (ListenerTestRecorder *recorder,
+                          size_t eventsCount) {
+    for (size_t tries = 0; tries < 5000; tries++) {
+        pthread_mutex_lock (&recorder->lock);
+        size_t count = array_count (recorder->events);
+        pthread_mutex_unlock (&recorder->lock);
+
+        if (count >= eventsCount) return count;
+        usleep (1000);
+    }
+
+    pthread_mutex_lock (&recorder->lock);
+    size_t count = array_count (recorder->events);
+    pthread_mutex_unlock (&recorder->lock);
+    return count;
+}
+
+static BRCryptoListener
+listenerTestCreate (ListenerTestRecorder *recorder,
+                    BRCryptoBoolean coalesce) {
+    pthread_mutex_init (&recorder->lock, NULL);
+    pthread_cond_init  (&recorder->cond, NULL);
+    recorder->batchesCount = 0;
+    array_new (recorder->events, 100);
+    recorder->hold = false;
+    recorder->held = false;
+
+    BRCryptoListener listener = cryptoListenerCreate (recorder, NULL, NULL, NULL, NULL, NULL);
+    cryptoListenerSetBatchCallback (listener, listenerTestRecorderBatchCallback);
+    cryptoListenerSetCoalescing (listener, coalesce);
+    return listener;
+}
+
+static void
+listenerTestRelease (BRCryptoListener listener,
+                     ListenerTestRecorder *recorder) {
+    cryptoListenerStop (listener);
+    cryptoListenerGive (listener);
+
+    array_free (recorder->events);
+    pthread_cond_destroy  (&recorder->cond);
+    pthread_mutex_destroy (&recorder->lock);
+}
+
+// Generate a CHANGED event, from `old` to `new`, for the (NULL) transfer of `listener`.
+static void
+listenerTestGenerateChanged (BRCryptoTransferListener *listener,
+                             BRCryptoTransferState old,
+                             BRCryptoTransferState new) {
+    cryptoListenerGenerateTransferEvent (listener, NULL, (BRCryptoTransferEvent) {
+        CRYPTO_TRANSFER_EVENT_CHANGED,
+        { .state = { cryptoTransferStateTake (old), cryptoTransferStateTake (new) } }
+    });
+}
+
+static void
+listenerTestGenerateCreated (BRCryptoTransferListener *listener) {
+    cryptoListenerGenerateTransferEvent (listener, NULL, (BRCryptoTransferEvent) {
+        CRYPTO_TRANSFER_EVENT_CREATED
+    });
+}
+
+#define LISTENER_TEST_STATES_COUNT      (100)
+
+static void
+runCryptoListenerBatchOrderTest (BRCryptoTransferState *states) {
+    ListenerTestRecorder recorder;
+    BRCryptoListener listener = listenerTestCreate (&recorder, CRYPTO_FALSE);
+    BRCryptoTransferListener transferListener = { listener };
+
+    // Generated before the start, all events are delivered in one batch, in order.
+    for (size_t index = 1; index < LISTENER_TEST_STATES_COUNT; index++)
+        listenerTestGenerateChanged (&transferListener, states[index - 1], states[index]);
+
+    cryptoListenerStart (listener);
+    assert (LISTENER_TEST_STATES_COUNT - 1 == listenerTestRecorderWait (&recorder, LISTENER_TEST_STATES_COUNT - 1));
+    assert (1 == recorder.batchesCount);
+
+    for (size_t index = 1; index < LISTENER_TEST_STATES_COUNT; index++) {
+        assert (states[index - 1] == recorder.events[index - 1].u.state.old);
+        assert (states[index]     == recorder.events[index - 1].u.state.new);
+    }
+
+    listenerTestRelease (listener, &recorder);
+}
+
+// Generate two changes of a transfer and, after `separation` other events, a third change.
+static void
+runCryptoListenerCoalesceTest (BRCryptoTransferState *states,
+                               size_t separation) {
+    ListenerTestRecorder recorder;
+    BRCryptoListener listener = listenerTestCreate (&recorder, CRYPTO_TRUE);
+    BRCryptoTransferListener transferListener = { listener };
+
+    listenerTestGenerateChanged (&transferListener, states[0], states[1]);
+    listenerTestGenerateChanged (&transferListener, states[1], states[2]);
+    for (size_t index = 0; index < separation; index++)
+        listenerTestGenerateCreated (&transferListener);
+    listenerTestGenerateChanged (&transferListener, states[2], states[3]);
+
+    // Only a change within the window of pending events is coalesced
+    bool   coalesced   = separation < CRYPTO_LISTENER_COALESCE_WINDOW;
+    size_t eventsCount = separation + (coalesced ? 1 : 2);
+
+    cryptoListenerStart (listener);
+    assert (eventsCount == listenerTestRecorderWait (&recorder, eventsCount));
+
+    // A coalesced change spans from the first `old` to the last `new` state, in the position
+    // of the last change.
+    BRCryptoTransferEvent *first = &recorder.events[0];
+    BRCryptoTransferEvent *last  = &recorder.events[eventsCount - 1];
+
+    if (!coalesced) {
+        assert (CRYPTO_TRANSFER_EVENT_CHANGED == first->type);
+        assert (states[0] == first->u.state.old);
+        assert (states[2] == first->u.state.new);
+        first += 1;
+    }
+
+    for (; first < last; first++)
+        assert (CRYPTO_TRANSFER_EVENT_CREATED == first->type);
+
+    assert (CRYPTO_TRANSFER_EVENT_CHANGED == last->type);
+    assert ((coalesced ? states[0] : states[2]) == last->u.state.old);
+    assert (states[3] == last->u.state.new);
+
+    listenerTestRelease (listener, &recorder);
+}
+
+static void *
+listenerTestStopThread (BRCryptoListener listener) {
+    cryptoListenerStop (listener);
+    return NULL;
+}
+
+static void
+runCryptoListenerRestartTest (BRCryptoTransferState *states) {
+    ListenerTestRecorder recorder;
+    BRCryptoListener listener = listenerTestCreate (&recorder, CRYPTO_FALSE);
+    BRCryptoTransferListener transferListener = { listener };
+
+    cryptoListenerStart (listener);
+
+    // Hold the listener's thread in the first batch ...
+    pthread_mutex_lock (&recorder.lock);
+    recorder.hold = true;
+    pthread_mutex_unlock (&recorder.lock);
+
+    listenerTestGenerateChanged (&transferListener, states[0], states[1]);
+
+    pthread_mutex_lock (&recorder.lock);
+    while (!recorder.held) pthread_cond_wait (&recorder.cond, &recorder.lock);
+    pthread_mutex_unlock (&recorder.lock);
+
+    // ... while a second batch is signalled and then, when stopped, cleared.
+    listenerTestGenerateChanged (&transferListener, states[1], states[2]);
+
+    pthread_t thread;
+    pthread_create (&thread, NULL, (void* (*) (void*)) listenerTestStopThread, listener);
+    usleep (100000);
+
+    pthread_mutex_lock (&recorder.lock);
+    recorder.hold = false;
+    pthread_cond_broadcast (&recorder.cond);
+    pthread_mutex_unlock (&recorder.lock);
+
+    pthread_join (thread, NULL);
+
+    // Restarting signals the pending event.
+    cryptoListenerStart (listener);
+    assert (2 == listenerTestRecorderWait (&recorder, 2));
+    assert (states[1] == recorder.events[1].u.state.old);
+    assert (states[2] == recorder.events[1].u.state.new);
+
+    // Stopped and restarted w/o anything pending, a new event is delivered just once.
+    cryptoListenerStop  (listener);
+    cryptoListenerStart (listener);
+    listenerTestGenerateChanged (&transferListener, states[2], states[3]);
+    assert (3 == listenerTestRecorderWait (&recorder, 3));
+    usleep (10000);
+    assert (3 == array_count (recorder.events));
+
+    listenerTestRelease (listener, &recorder);
+}
+
+static void
+runCryptoListenerTests (void) {
+    BRCryptoTransferState states[LISTENER_TEST_STATES_COUNT];
+    for (size_t index = 0; index < LISTENER_TEST_STATES_COUNT; index++)
+        states[index] = cryptoTransferStateInit (CRYPTO_TRANSFER_STATE_CREATED);
+
+    runCryptoListenerBatchOrderTest (states);
+    runCryptoListenerCoalesceTest   (states, 0);
+    runCryptoListenerCoalesceTest   (states, CRYPTO_LISTENER_COALESCE_WINDOW - 1);
+    runCryptoListenerCoalesceTest   (states, CRYPTO_LISTENER_COALESCE_WINDOW);
+    runCryptoListenerRestartTest    (states);
+
+    // Every event's references to states were released exactly once; only the test's remain.
+    for (size_t index = 0; index < LISTENER_TEST_STATES_COUNT; index++) {
+        assert (1 == states[index]->ref.count);
+        cryptoTransferStateGive (states[index]);
+    }
+}
+
 ///
 /// Mark: BRCryptoWalletManager Tests
 ///
@@ -1504,6 +1756,533 @@ runCryptoWalletManagerLifecycleWithSetModeTest (BRCryptoAccount account,
     return success;
 }
 
+///
+/// Mark: Client Request Tests
+///
+
+// Records the block number and submit requests made of the client, until announced by the test.
+typedef struct {
+    pthread_mutex_t lock;
+    BRArrayOf(BRCryptoClientCallbackState) blockNumberStates;
+    BRArrayOf(BRCryptoClientCallbackState) submitStates;
+} CWMClientRequestRecordingState;
+
+static void
+_CWMRecordingGetBlockNumberCallback (BRCryptoClientContext context,
+                                     OwnershipGiven BRCryptoWalletManager manager,
+                                     OwnershipGiven BRCryptoClientCallbackState callbackState) {
+    CWMClientRequestRecordingState *state = context;
+    pthread_mutex_lock (&state->lock);
+    array_add (state->blockNumberStates, callbackState);
+    pthread_mutex_unlock (&state->lock);
+    cryptoWalletManagerGive (manager);
+}
+
+static void
+_CWMRecordingSubmitTransactionCallback (BRCryptoClientContext context,
+                                        OwnershipGiven BRCryptoWalletManager manager,
+                                        OwnershipGiven BRCryptoClientCallbackState callbackState,
+                                        OwnershipKept const char    *identifier,
+                                        OwnershipKept const uint8_t *transaction,
+                                        size_t transactionLength) {
+    CWMClientRequestRecordingState *state = context;
+    pthread_mutex_lock (&state->lock);
+    array_add (state->submitStates, callbackState);
+    pthread_mutex_unlock (&state->lock);
+    cryptoWalletManagerGive (manager);
+}
+
+// Returns the most recent of `callbackStates`, or NULL if none.
+static BRCryptoClientCallbackState
+CWMClientRequestRecordingStateTake (CWMClientRequestRecordingState *state,
+                                    BRArrayOf(BRCryptoClientCallbackState) callbackStates) {
+    BRCryptoClientCallbackState callbackState = NULL;
+    pthread_mutex_lock (&state->lock);
+    size_t count = array_count (callbackStates);
+    if (count > 0) {
+        callbackState = callbackStates[count - 1];
+        array_rm (callbackStates, count - 1);
+    }
+    pthread_mutex_unlock (&state->lock);
+    return callbackState;
+}
+
+// Returns the most recent block number request, or NULL if none.
+static BRCryptoClientCallbackState
+CWMClientRequestRecordingStateTakeBlockNumber (CWMClientRequestRecordingState *state) {
+    return CWMClientRequestRecordingStateTake (state, state->blockNumberStates);
+}
+
+// Returns the most recent submit request, or NULL if none.
+static BRCryptoClientCallbackState
+CWMClientRequestRecordingStateTakeSubmit (CWMClientRequestRecordingState *state) {
+    return CWMClientRequestRecordingStateTake (state, state->submitStates);
+}
+
+static int
+runCryptoWalletManagerClientRequestTest (BRCryptoAccount account,
+                                         BRCryptoNetwork network,
+                                         BRCryptoAddressScheme scheme,
+                                         const char *storagePath) {
+    printf("Testing BRCryptoClient request cancel, timeout, discard and eviction...\n");
+
+    int success = 1;
+
+    // HACK: Managers set the height; we need to be able to restore it between tests
+    BRCryptoBlockNumber originalNetworkHeight = cryptoNetworkGetHeight (network);
+
+    CWMEventRecordingState state = {0};
+    CWMEventRecordingStateNewDefault (&state);
+
+    CWMClientRequestRecordingState requests;
+    pthread_mutex_init (&requests.lock, NULL);
+    array_new (requests.blockNumberStates, 10);
+    array_new (requests.submitStates, 1);
+
+    BRCryptoListener listener = cryptoListenerCreate (&state,
+                                                     _CWMEventRecordingSystemCallback,
+                                                     _CWMEventRecordingNetworkCallback,
+                                                     _CWMEventRecordingManagerCallback,
+                                                     _CWMEventRecordingWalletCallback,
+                                                     _CWMEventRecordingTransferCallback);
+
+    BRCryptoClient client = (BRCryptoClient) {
+        &requests,
+        _CWMRecordingGetBlockNumberCallback,
+        _CWMNopGetTransactionsCallback,
+        _CWMNopGetTransfersCallback,
+        _CWMRecordingSubmitTransactionCallback,
+        _CWMNopEstimateTransactionFeeCallback
+    };
+
+    BRCryptoSystem system = cryptoSystemCreate (client, listener, account, storagePath, cryptoNetworkIsMainnet(network));
+
+    BRCryptoWalletManager manager = cryptoWalletManagerCreate (cryptoListenerCreateWalletManagerListener (listener, system),
+                                                               client,
+                                                               account,
+                                                               network,
+                                                               CRYPTO_SYNC_MODE_API_ONLY,
+                                                               scheme,
+                                                               storagePath);
+
+    // Timeouts are opt-in
+    success &= (0 == manager->qryManager->requestTimeout);
+
+    // Connecting requests the block number
+    cryptoWalletManagerConnect (manager, NULL);
+    sleep(1);
+
+    BRCryptoClientCallbackState callbackState = CWMClientRequestRecordingStateTakeBlockNumber (&requests);
+    success &= (NULL != callbackState);
+    if (NULL == callbackState) goto done;
+
+    BRCryptoClientRequestId rid = cryptoClientCallbackStateGetRequestId (callbackState);
+    success &= (CRYPTO_TRUE == cryptoClientRequestIsPending (manager, rid));
+
+    // Cancel; the request is no longer pending, and can't be cancelled again
+    success &= (CRYPTO_TRUE  == cryptoClientRequestCancel (manager, rid));
+    success &= (CRYPTO_FALSE == cryptoClientRequestIsPending (manager, rid));
+    success &= (CRYPTO_FALSE == cryptoClientRequestCancel (manager, rid));
+
+    // The cancelled request's announcement is discarded
+    cryptoClientAnnounceBlockNumber (manager, callbackState, CRYPTO_TRUE, originalNetworkHeight + 1000, NULL);
+
+    // As is the announcement of a request never made
+    callbackState = calloc (1, sizeof (struct BRCryptoClientCallbackStateRecord));
+    callbackState->type = CLIENT_CALLBACK_REQUEST_BLOCK_NUMBER;
+    callbackState->rid  = SIZE_MAX - 1;
+    success &= (CRYPTO_FALSE == cryptoClientRequestIsPending (manager, callbackState->rid));
+    cryptoClientAnnounceBlockNumber (manager, callbackState, CRYPTO_TRUE, originalNetworkHeight + 1000, NULL);
+
+    sleep(1);
+    success &= (originalNetworkHeight == cryptoNetworkGetHeight (network));
+
+    // Time out; the next 'tick-tock' after the deadline abandons the request
+    cryptoClientRequestSetTimeout (manager, 1);
+    cryptoClientQRYManagerTickTock (manager->qryManager);
+
+    callbackState = CWMClientRequestRecordingStateTakeBlockNumber (&requests);
+    success &= (NULL != callbackState);
+    if (NULL == callbackState) goto done;
+
+    rid = cryptoClientCallbackStateGetRequestId (callbackState);
+    success &= (CRYPTO_TRUE == cryptoClientRequestIsPending (manager, rid));
+
+    sleep(2);
+    cryptoClientQRYManagerTickTock (manager->qryManager);
+    success &= (CRYPTO_FALSE == cryptoClientRequestIsPending (manager, rid));
+
+    // The timed out request's announcement is discarded
+    cryptoClientAnnounceBlockNumber (manager, callbackState, CRYPTO_TRUE, originalNetworkHeight + 1000, NULL);
+    sleep(1);
+    success &= (originalNetworkHeight == cryptoNetworkGetHeight (network));
+
+    // W/o a timeout, a pending request's announcement is handled
+    cryptoClientRequestSetTimeout (manager, 0);
+    cryptoClientQRYManagerTickTock (manager->qryManager);
+
+    callbackState = CWMClientRequestRecordingStateTakeBlockNumber (&requests);
+    success &= (NULL != callbackState);
+    if (NULL == callbackState) goto done;
+
+    rid = cryptoClientCallbackStateGetRequestId (callbackState);
+    cryptoClientAnnounceBlockNumber (manager, callbackState, CRYPTO_TRUE, originalNetworkHeight + 1000, NULL);
+    success &= (CRYPTO_FALSE == cryptoClientRequestIsPending (manager, rid));
+    sleep(1);
+    success &= (originalNetworkHeight + 1000 == cryptoNetworkGetHeight (network));
+
+    // Submit a transfer
+    BRCryptoWallet wallet = cryptoWalletManagerGetWallet (manager);
+
+    BRCryptoTransferTest *test = &transferTests[0];
+    size_t   testRawSize;
+    uint8_t *testRawBytes = hexDecodeCreate (&testRawSize, test->rawChars, strlen (test->rawChars));
+    BRTransaction *transaction = BRTransactionParse (testRawBytes, testRawSize);
+    free (testRawBytes);
+
+    BRCryptoTransfer transfer = cryptoTransferCreateAsBTC (wallet->listenerTransfer,
+                                                           wallet->unit,
+                                                           wallet->unitForFee,
+                                                           cryptoWalletAsBTC (wallet),
+                                                           transaction, // ownership given
+                                                           cryptoNetworkGetType (network));
+
+    cryptoClientSend (cryptoClientQRYManagerAsSend (manager->qryManager), wallet, transfer);
+
+    callbackState = CWMClientRequestRecordingStateTakeSubmit (&requests);
+    success &= (NULL != callbackState);
+
+    if (NULL != callbackState) {
+        rid = cryptoClientCallbackStateGetRequestId (callbackState);
+
+        // Overfill the requests; the submit is never evicted
+        for (size_t index = 0;
+             index < (1 + CRYPTO_CLIENT_QRY_TICKS_SKIPPED_MAXIMUM) * (CRYPTO_CLIENT_QRY_REQUESTS_MAXIMUM + 10);
+             index++)
+            cryptoClientQRYManagerTickTock (manager->qryManager);
+
+        success &= (CRYPTO_CLIENT_QRY_REQUESTS_MAXIMUM == cryptoClientRequestGetPendingCount (manager));
+        success &= (CRYPTO_TRUE == cryptoClientRequestIsPending (manager, rid));
+
+        // The submit's announcement is handled
+        cryptoClientAnnounceSubmitTransfer (manager, callbackState, NULL, NULL, CRYPTO_TRUE);
+        success &= (CRYPTO_FALSE == cryptoClientRequestIsPending (manager, rid));
+        sleep(1);
+
+        BRCryptoTransferState transferState = cryptoTransferGetState (transfer);
+        success &= (CRYPTO_TRANSFER_STATE_SUBMITTED == cryptoTransferStateGetType (transferState));
+        cryptoTransferStateGive (transferState);
+    }
+
+    cryptoTransferGive (transfer);
+    cryptoWalletGive (wallet);
+
+done:
+    cryptoWalletManagerDisconnect (manager);
+    sleep(1);
+    cryptoWalletManagerStop (manager);
+
+    // Discard any remaining requests; all are cancelled by the disconnect.
+    while (NULL != (callbackState = CWMClientRequestRecordingStateTakeBlockNumber (&requests)))
+        cryptoClientAnnounceBlockNumber (manager, callbackState, CRYPTO_FALSE, 0, NULL);
+
+    cryptoNetworkSetHeight (network, originalNetworkHeight);
+    cryptoWalletManagerGive (manager);
+    CWMEventRecordingStateFree (&state);
+
+    array_free (requests.blockNumberStates);
+    array_free (requests.submitStates);
+    pthread_mutex_destroy (&requests.lock);
+
+    if (!success) printf("%s: failed\n", __func__);
+    return success;
+}
+
+///
+/// Mark: BTC Persistence Tests
+///
+
+// Crib these from BRCryptoWalletManagerPersistBTC.c
+#define persistTestTypeTransactionStatus    "transaction-status"
+#define persistTestTransactionVersion1      (0)
+#define persistTestNetwork                  "persist-test"
+
+static size_t persistTestTransactionWritesCount = 0;
+static BRFileServiceWriter persistTestTransactionWriter = NULL;
+
+// Count the writes of the (immutable) transaction
+static uint8_t *
+persistTestCountingTransactionWriter (BRFileServiceContext context,
+                                      BRFileService fs,
+                                      const void* entity,
+                                      uint32_t *bytesCount) {
+    persistTestTransactionWritesCount += 1;
+    return persistTestTransactionWriter (context, fs, entity, bytesCount);
+}
+
+static int
+persistTestCountEntity (BRFileServiceContext context,
+                        BRFileService fs,
+                        void *entity) {
+    size_t *count = context;
+    *count += 1;
+    free (entity);
+    return 1;
+}
+
+// Copy the BTC specifications; return the index of the transaction's.
+static size_t
+persistTestCopySpecifications (BRFileServiceTypeSpecification *specifications) {
+    size_t transactionIndex = SIZE_MAX;
+    for (size_t index = 0; index < fileServiceSpecificationsCountBTC; index++) {
+        specifications[index] = fileServiceSpecificationsBTC[index];
+        if (0 == strcmp (fileServiceTypeTransactionsBTC, specifications[index].type))
+            transactionIndex = index;
+    }
+    assert (SIZE_MAX != transactionIndex && 2 == specifications[transactionIndex].versionsCount);
+    return transactionIndex;
+}
+
+static BRFileService
+persistTestFileServiceCreate (const char *storagePath,
+                              BRFileServiceTypeSpecification *specifications) {
+    return fileServiceCreateFromTypeSpecifications (storagePath, "btc", persistTestNetwork,
+                                                    NULL, NULL, NULL,
+                                                    fileServiceSpecificationsCountBTC,
+                                                    specifications);
+}
+
+static int
+runCryptoWalletManagerPersistTransactionBTCTest (BRCryptoNetwork network,
+                                                 const char *storagePath) {
+    printf("Testing BTC transaction persistence...\n");
+
+    int success = 1;
+
+    BRCryptoTransferTest *test = &transferTests[0];
+    size_t   testRawSize;
+    uint8_t *testRawBytes = hexDecodeCreate (&testRawSize, test->rawChars, strlen (test->rawChars));
+    BRTransaction *transaction = BRTransactionParse (testRawBytes, testRawSize);
+    free (testRawBytes);
+
+    transaction->blockHeight = test->blockHeight;
+    transaction->timestamp   = test->timestamp;
+
+    // Just enough of a manager for the BTC persistence functions
+    struct BRCryptoWalletManagerRecord managerRecord;
+    memset (&managerRecord, 0, sizeof (managerRecord));
+    managerRecord.type    = cryptoNetworkGetType (network);
+    managerRecord.network = network;
+    managerRecord.path    = (char *) storagePath;
+    BRCryptoWalletManager manager = &managerRecord;
+
+    BRFileServiceTypeSpecification specifications[fileServiceSpecificationsCountBTC];
+    size_t transactionIndex;
+
+    // Save a version 1 transaction, which includes the block height and timestamp
+    transactionIndex = persistTestCopySpecifications (specifications);
+    specifications[transactionIndex].defaultVersion = persistTestTransactionVersion1;
+
+    manager->fileService = persistTestFileServiceCreate (storagePath, specifications);
+    success &= (NULL != manager->fileService);
+    success &= (1 == fileServiceSave (manager->fileService, fileServiceTypeTransactionsBTC, transaction));
+    fileServiceRelease (manager->fileService);
+
+    // Load, updating the transaction to version 2 and saving its status apart
+    transactionIndex = persistTestCopySpecifications (specifications);
+    manager->fileService = persistTestFileServiceCreate (storagePath, specifications);
+
+    BRArrayOf(BRTransaction*) transactions = initialTransactionsLoadBTC (manager);
+    success &= (NULL != transactions && 1 == array_count (transactions));
+    success &= (success &&
+                UInt256Eq (transaction->txHash, transactions[0]->txHash) &&
+                test->blockHeight == transactions[0]->blockHeight &&
+                test->timestamp   == transactions[0]->timestamp);
+    if (NULL != transactions) array_free_all (transactions, BRTransactionFree);
+
+    size_t statusesCount = 0;
+    success &= (1 == fileServiceLoadIterate (manager->fileService, persistTestTypeTransactionStatus, 1,
+                                             &statusesCount, persistTestCountEntity));
+    success &= (1 == statusesCount);
+    fileServiceRelease (manager->fileService);
+
+    // W/o the version 1 handler, the transaction still loads; it was rewritten as version 2
+    transactionIndex = persistTestCopySpecifications (specifications);
+    specifications[transactionIndex].versions[0]   = specifications[transactionIndex].versions[1];
+    specifications[transactionIndex].versionsCount = 1;
+
+    manager->fileService = persistTestFileServiceCreate (storagePath, specifications);
+
+    transactions = initialTransactionsLoadBTC (manager);
+    success &= (NULL != transactions && 1 == array_count (transactions));
+    if (NULL != transactions) array_free_all (transactions, BRTransactionFree);
+
+    // A status update doesn't rewrite the transaction, but is applied on load
+    persistTestTransactionWriter      = specifications[transactionIndex].versions[0].writer;
+    persistTestTransactionWritesCount = 0;
+    specifications[transactionIndex].versions[0].writer = persistTestCountingTransactionWriter;
+    fileServiceRelease (manager->fileService);
+    manager->fileService = persistTestFileServiceCreate (storagePath, specifications);
+
+    transaction->blockHeight = test->blockHeight + 10;
+    transaction->timestamp   = test->timestamp   + 600;
+    fileServiceSaveTransactionStatusBTC (manager, transaction);
+    success &= (0 == persistTestTransactionWritesCount);
+
+    transactions = initialTransactionsLoadBTC (manager);
+    success &= (NULL != transactions && 1 == array_count (transactions));
+    success &= (success &&
+                test->blockHeight + 10  == transactions[0]->blockHeight &&
+                test->timestamp   + 600 == transactions[0]->timestamp);
+    if (NULL != transactions) array_free_all (transactions, BRTransactionFree);
+
+    // Saving the transaction itself writes both
+    fileServiceSaveTransactionBTC (manager, transaction);
+    success &= (1 == persistTestTransactionWritesCount);
+
+    // Removing the transaction removes both
+    fileServiceRemoveTransactionBTC (manager, transaction);
+    transactions = initialTransactionsLoadBTC (manager);
+    success &= (NULL != transactions && 0 == array_count (transactions));
+    if (NULL != transactions) array_free (transactions);
+
+    statusesCount = 0;
+    success &= (1 == fileServiceLoadIterate (manager->fileService, persistTestTypeTransactionStatus, 1,
+                                             &statusesCount, persistTestCountEntity));
+    success &= (0 == statusesCount);
+
+    fileServiceRelease (manager->fileService);
+    fileServiceWipe (storagePath, "btc", persistTestNetwork);
+
+    BRTransactionFree (transaction);
+
+    if (!success) printf("%s: failed\n", __func__);
+    return success;
+}
+
+#define PERSIST_TEST_HEADERS_BASE_HEIGHT   (2 * BLOCK_DIFFICULTY_INTERVAL - 2)
+#define PERSIST_TEST_HEADERS_COUNT         (12)
+
+// Returns a header, linked to `prevBlock`; there is no proof-of-work.
+static BRMerkleBlock *
+persistTestHeaderCreate (UInt256 prevBlock, uint32_t height) {
+    BRMerkleBlock *block = BRMerkleBlockNew ();
+    block->version   = 1;
+    block->prevBlock = prevBlock;
+    block->timestamp = 1500000000 + 600 * height;
+    block->target    = 0x1d00ffff;
+    block->height    = height;
+
+    uint8_t header[80];
+    BRMerkleBlockSerialize (block, header, sizeof (header));
+    BRSHA256_2 (&block->blockHash, header, sizeof (header));
+    return block;
+}
+
+// Load the headers, returning the number loaded or SIZE_MAX if any doesn't match `blocks`.
+static size_t
+persistTestHeadersLoad (BRCryptoWalletManager manager,
+                        BRMerkleBlock **blocks) {
+    BRArrayOf(BRMerkleBlock*) loaded = initialBlocksLoadBTC (manager);
+    if (NULL == loaded) return SIZE_MAX;
+
+    size_t loadedCount = array_count (loaded);
+    for (size_t index = 0; index < array_count (loaded); index++) {
+        uint32_t height = loaded[index]->height;
+        if (height < PERSIST_TEST_HEADERS_BASE_HEIGHT ||
+            height >= PERSIST_TEST_HEADERS_BASE_HEIGHT + PERSIST_TEST_HEADERS_COUNT ||
+            !UInt256Eq (loaded[index]->blockHash, blocks[height - PERSIST_TEST_HEADERS_BASE_HEIGHT]->blockHash))
+            loadedCount = SIZE_MAX;
+    }
+
+    array_free_all (loaded, BRMerkleBlockFree);
+    return loadedCount;
+}
+
+static off_t
+persistTestFileSize (const char *path) {
+    struct stat pathStat;
+    return (0 == stat (path, &pathStat) ? pathStat.st_size : -1);
+}
+
+static int
+runCryptoWalletManagerPersistHeadersBTCTest (BRCryptoNetwork network,
+                                             const char *storagePath) {
+    printf("Testing BTC header store...\n");
+
+    int success = 1;
+
+    // Just enough of a manager for the BTC persistence functions
+    struct BRCryptoWalletManagerRecord managerRecord;
+    memset (&managerRecord, 0, sizeof (managerRecord));
+    managerRecord.type    = cryptoNetworkGetType (network);
+    managerRecord.network = network;
+    managerRecord.path    = (char *) storagePath;
+    BRCryptoWalletManager manager = &managerRecord;
+
+    manager->fileService = persistTestFileServiceCreate (storagePath, fileServiceSpecificationsBTC);
+
+    char path[1024];
+    snprintf (path, sizeof (path), "%s/%s-%s-%s", storagePath,
+              cryptoBlockChainTypeGetCurrencyCode (manager->type),
+              cryptoNetworkGetDesc (network),
+              CRYPTO_FILE_SERVICE_HEADERS_FILENAME);
+    remove (path);
+
+    // A chain of headers, crossing a difficulty transition; saved in descending height order.
+    BRMerkleBlock *blocks[PERSIST_TEST_HEADERS_COUNT];
+    BRMerkleBlock *blocksDescending[PERSIST_TEST_HEADERS_COUNT];
+    for (size_t index = 0; index < PERSIST_TEST_HEADERS_COUNT; index++) {
+        blocks[index] = persistTestHeaderCreate ((0 == index ? UINT256_ZERO : blocks[index - 1]->blockHash),
+                                                 PERSIST_TEST_HEADERS_BASE_HEIGHT + (uint32_t) index);
+        blocksDescending[PERSIST_TEST_HEADERS_COUNT - 1 - index] = blocks[index];
+    }
+
+    off_t fileSize = (off_t) (4 * sizeof (uint32_t) + PERSIST_TEST_HEADERS_COUNT * 80);
+    size_t transitionCount = PERSIST_TEST_HEADERS_COUNT - (2 * BLOCK_DIFFICULTY_INTERVAL - PERSIST_TEST_HEADERS_BASE_HEIGHT);
+
+    // Round trip; only the headers from the last difficulty transition are loaded
+    saveBlocksBTC (manager, 1, blocksDescending, PERSIST_TEST_HEADERS_COUNT);
+    success &= (fileSize == persistTestFileSize (path));
+    success &= (transitionCount == persistTestHeadersLoad (manager, blocks));
+
+    // A partial, trailing record is trimmed
+    uint8_t partial[40] = { 0 };
+    FILE *file = fopen (path, "ab");
+    success &= (NULL != file && sizeof (partial) == fwrite (partial, 1, sizeof (partial), file));
+    if (NULL != file) fclose (file);
+    success &= (fileSize + (off_t) sizeof (partial) == persistTestFileSize (path));
+
+    success &= (transitionCount == persistTestHeadersLoad (manager, blocks));
+    success &= (fileSize == persistTestFileSize (path));
+
+    // A header that doesn't link to its predecessor is dropped, along with those after it
+    size_t corruptIndex = PERSIST_TEST_HEADERS_COUNT - 3;
+    file = fopen (path, "r+b");
+    success &= (NULL != file &&
+                0 == fseek (file, (long) (4 * sizeof (uint32_t) + corruptIndex * 80 + 4), SEEK_SET) &&
+                1 == fwrite ("X", 1, 1, file));
+    if (NULL != file) fclose (file);
+
+    success &= (transitionCount - 3 == persistTestHeadersLoad (manager, blocks));
+    success &= ((off_t) (4 * sizeof (uint32_t) + corruptIndex * 80) == persistTestFileSize (path));
+
+    // Saving again restores the dropped headers
+    saveBlocksBTC (manager, 1, blocksDescending, PERSIST_TEST_HEADERS_COUNT);
+    success &= (fileSize == persistTestFileSize (path));
+    success &= (transitionCount == persistTestHeadersLoad (manager, blocks));
+
+    for (size_t index = 0; index < PERSIST_TEST_HEADERS_COUNT; index++)
+        BRMerkleBlockFree (blocks[index]);
+
+    fileServiceRelease (manager->fileService);
+    fileServiceWipe (storagePath, "btc", persistTestNetwork);
+    remove (path);
+
+    if (!success) printf("%s: failed\n", __func__);
+    return success;
+}
+
 ///
 /// Mark: Entrypoints
 ///
@@ -1564,6 +2343,24 @@ runCryptoTestsWithAccountAndNetwork (BRCryptoAccount account,
     }
 
     if (isBtc) {
+        success = AS_CRYPTO_BOOLEAN(runCryptoWalletManagerPersistTransactionBTCTest (network, storagePath));
+        if (!success) {
+            fprintf(stderr, "***FAILED*** %s:%d: failed\n", __func__, __LINE__);
+            return success;
+        }
+
+        success = AS_CRYPTO_BOOLEAN(runCryptoWalletManagerPersistHeadersBTCTest (network, storagePath));
+        if (!success) {
+            fprintf(stderr, "***FAILED*** %s:%d: failed\n", __func__, __LINE__);
+            return success;
+        }
+
+        success = AS_CRYPTO_BOOLEAN(runCryptoWalletManagerClientRequestTest (account, network, scheme, storagePath));
+        if (!success) {
+            fprintf(stderr, "***FAILED*** %s:%d: failed\n", __func__, __LINE__);
+            return success;
+        }
+
         success = AS_CRYPTO_BOOLEAN(runCryptoWalletManagerLifecycleWithSetModeTest (account,
                                                                                     network,
                                                                                     CRYPTO_SYNC_MODE_P2P_ONLY,
@@ -1618,5 +2415,6 @@ extern void
 runCryptoTests (void) {
     runCryptoAmountTests ();
     runCryptoTransferTests();
+    runCryptoListenerTests();
     return;
 }
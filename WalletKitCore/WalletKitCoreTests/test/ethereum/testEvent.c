@@ -9,10 +9,14 @@
 //  See the CONTRIBUTORS file at the project root for a list of contributors.
 
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 #include <pthread.h>
+#include <stdint.h>
 #include "support/event/BREvent.h"
 #include "support/event/BREventAlarm.h"
+#include "support/event/BREventQueue.h"
+#include "support/BROSCompat.h"
 
 static pthread_cond_t testEventAlarmConditional = PTHREAD_COND_INITIALIZER;
 static pthread_mutex_t testEventAlarmMutex = PTHREAD_MUTEX_INITIALIZER;
@@ -49,7 +53,439 @@ runEventTest (void) {
     alarmClockDestroy(alarmClock);
 }
 
+//
+// Alarm Ordering
+//
+#define TEST_ALARM_COUNT        (100)
+
+static BREventAlarmId testAlarmExpired[TEST_ALARM_COUNT];
+static size_t testAlarmExpiredCount = 0;
+static pthread_mutex_t testAlarmMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void
+testAlarmOrderCallback (BREventAlarmContext context,
+                        struct timespec expiration,
+                        BREventAlarmClock clock) {
+    pthread_mutex_lock (&testAlarmMutex);
+    testAlarmExpired[testAlarmExpiredCount++] = (BREventAlarmId) (uintptr_t) context;
+    pthread_mutex_unlock (&testAlarmMutex);
+}
+
+static void
+runEventAlarmOrderTest (void) {
+    BREventAlarmClock clock = alarmClockCreate ();
+    BREventAlarmId alarms[TEST_ALARM_COUNT];
+
+    // Expirations, in the past, with a scrambled order: index i expires at second (37 * i) % 100
+    for (size_t index = 0; index < TEST_ALARM_COUNT; index++) {
+        struct timespec expiration = { (time_t) (1 + (37 * index) % TEST_ALARM_COUNT), 0 };
+        alarms[index] = alarmClockAddAlarm (clock, (BREventAlarmContext) (uintptr_t) index, testAlarmOrderCallback, expiration);
+        assert (alarmClockHasAlarm (clock, alarms[index]));
+    }
+
+    // Cancel every third alarm, by identifier
+    size_t expectedCount = 0;
+    for (size_t index = 0; index < TEST_ALARM_COUNT; index++)
+        if (0 == index % 3) {
+            alarmClockRemAlarm (clock, alarms[index]);
+            assert (!alarmClockHasAlarm (clock, alarms[index]));
+        }
+        else expectedCount++;
+
+    alarmClockStart (clock);
+    for (int done = 0; !done; ) {
+        pthread_mutex_lock (&testAlarmMutex);
+        done = (testAlarmExpiredCount == expectedCount);
+        pthread_mutex_unlock (&testAlarmMutex);
+        if (!done) nanosleep (&(struct timespec) { 0, 1000000 }, NULL);
+    }
+    alarmClockStop (clock);
+
+    // Expired in expiration order, without the cancelled alarms; one shot alarms are gone.
+    for (size_t index = 0; index < expectedCount; index++) {
+        size_t alarm = testAlarmExpired[index];
+        assert (0 != alarm % 3);
+        assert (!alarmClockHasAlarm (clock, alarms[alarm]));
+        if (index > 0) assert ((37 * testAlarmExpired[index - 1]) % TEST_ALARM_COUNT < (37 * alarm) % TEST_ALARM_COUNT);
+    }
+
+    alarmClockDestroy (clock);
+}
+
+//
+// Alarm Jitter
+//
+#define TEST_ALARM_JITTER_COUNT        (16)
+
+static struct timespec testAlarmJitterFirst[TEST_ALARM_JITTER_COUNT];
+static size_t testAlarmJitterFired[TEST_ALARM_JITTER_COUNT];
+static pthread_mutex_t testAlarmJitterMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void
+testAlarmJitterCallback (BREventAlarmContext context,
+                         struct timespec expiration,
+                         BREventAlarmClock clock) {
+    size_t index = (size_t) (uintptr_t) context;
+    pthread_mutex_lock (&testAlarmJitterMutex);
+    if (0 == testAlarmJitterFired[index]) testAlarmJitterFirst[index] = expiration;
+    testAlarmJitterFired[index] += 1;
+    pthread_mutex_unlock (&testAlarmJitterMutex);
+}
+
+static void
+runEventAlarmJitterTest (void) {
+    BREventAlarmClock clock = alarmClockCreate ();
+    BREventAlarmId alarms[TEST_ALARM_JITTER_COUNT];
+
+    // All with the same period, added together: 50ms +/- 10ms
+    for (size_t index = 0; index < TEST_ALARM_JITTER_COUNT; index++)
+        alarms[index] = alarmClockAddAlarmPeriodicWithJitter (clock,
+                                                              (BREventAlarmContext) (uintptr_t) index,
+                                                              testAlarmJitterCallback,
+                                                              (struct timespec) { 0, 50000000 },
+                                                              (struct timespec) { 0, 10000000 });
+
+    alarmClockStart (clock);
+    for (int done = 0; !done; ) {
+        done = 1;
+        pthread_mutex_lock (&testAlarmJitterMutex);
+        for (size_t index = 0; index < TEST_ALARM_JITTER_COUNT; index++)
+            if (testAlarmJitterFired[index] < 3) done = 0;
+        pthread_mutex_unlock (&testAlarmJitterMutex);
+        if (!done) nanosleep (&(struct timespec) { 0, 1000000 }, NULL);
+    }
+    alarmClockStop (clock);
+
+    // Periodic alarms remain; their first expirations are spread rather than identical.
+    size_t distinct = 0;
+    for (size_t index = 0; index < TEST_ALARM_JITTER_COUNT; index++) {
+        assert (alarmClockHasAlarm (clock, alarms[index]));
+        if (index > 0 &&
+            (testAlarmJitterFirst[index].tv_sec  != testAlarmJitterFirst[0].tv_sec ||
+             testAlarmJitterFirst[index].tv_nsec != testAlarmJitterFirst[0].tv_nsec))
+            distinct++;
+    }
+    assert (distinct > 0);
+
+    alarmClockDestroy (clock);
+}
+
+//
+// Queue Priority
+//
+typedef struct {
+    BREvent base;
+    int value;
+} TestPriorityEvent;
+
+static BREventType testPriorityNormalEventType = {
+    "Test Normal Event",
+    sizeof (TestPriorityEvent),
+    NULL,
+    NULL,
+    EVENT_PRIORITY_NORMAL
+};
+
+static BREventType testPriorityHighEventType = {
+    "Test High Event",
+    sizeof (TestPriorityEvent),
+    NULL,
+    NULL,
+    EVENT_PRIORITY_HIGH
+};
+
+static void
+runEventQueuePriorityTest (void) {
+    BREventQueue queue = eventQueueCreate (sizeof (TestPriorityEvent));
+    TestPriorityEvent event;
+
+    // Normal: 0, 1, 2 at the tail; 3 at the head
+    for (int value = 0; value < 3; value++) {
+        event = (TestPriorityEvent) { { NULL, &testPriorityNormalEventType }, value };
+        eventQueueEnqueueTail (queue, (BREvent *) &event);
+    }
+    event = (TestPriorityEvent) { { NULL, &testPriorityNormalEventType }, 3 };
+    eventQueueEnqueueHead (queue, (BREvent *) &event);
+
+    // High: 10, 11 at the tail
+    for (int value = 10; value < 12; value++) {
+        event = (TestPriorityEvent) { { NULL, &testPriorityHighEventType }, value };
+        eventQueueEnqueueTail (queue, (BREvent *) &event);
+    }
+
+    // High first, then normal - each in FIFO order save for the OOB event.
+    int expected[] = { 10, 11, 3, 0, 1, 2 };
+    for (size_t index = 0; index < sizeof (expected) / sizeof (int); index++) {
+        assert (eventQueueHasPending (queue));
+        assert (EVENT_STATUS_SUCCESS == eventQueueDequeueWait (queue, (BREvent *) &event));
+        assert (expected[index] == event.value);
+    }
+    assert (!eventQueueHasPending (queue));
+    assert (EVENT_STATUS_NONE_PENDING == eventQueueDequeue (queue, (BREvent *) &event));
+
+    eventQueueDestroy (queue);
+}
+
+//
+// Queue Available Limits
+//
+static void *
+testEventQueueAvailableWait (BREventQueue queue) {
+    TestPriorityEvent event;
+    assert (EVENT_STATUS_SUCCESS == eventQueueDequeueWait (queue, (BREvent *) &event));
+    return NULL;
+}
+
+static void
+runEventQueueAvailableTest (void) {
+    BREventQueue queue = eventQueueCreate (sizeof (TestPriorityEvent));
+    TestPriorityEvent event = { { NULL, &testPriorityNormalEventType }, 0 };
+    size_t depth, depthMaximum, available;
+
+    eventQueueSetAvailableLimits (queue, 10, 0);
+
+    for (int value = 0; value < 50; value++)
+        eventQueueEnqueueTail (queue, (BREvent *) &event);
+
+    eventQueueGetStats (queue, &depth, &depthMaximum, &available);
+    assert (50 == depth && 50 == depthMaximum && 0 == available);
+
+    // Dispatched events are retained for reuse, up to the limit
+    while (EVENT_STATUS_SUCCESS == eventQueueDequeue (queue, (BREvent *) &event));
+
+    eventQueueGetStats (queue, &depth, &depthMaximum, &available);
+    assert (0 == depth && 50 == depthMaximum && 10 == available);
+
+    // Trimmed back to the baseline
+    eventQueueTrim (queue);
+    eventQueueGetStats (queue, &depth, &depthMaximum, &available);
+    assert (0 == depth && 1 == available);
+
+    // A waiting queue trims itself once idle
+    eventQueueSetAvailableLimits (queue, 10, 10);
+    for (int value = 0; value < 5; value++)
+        eventQueueEnqueueTail (queue, (BREvent *) &event);
+    while (EVENT_STATUS_SUCCESS == eventQueueDequeue (queue, (BREvent *) &event));
+    eventQueueGetStats (queue, &depth, &depthMaximum, &available);
+    assert (5 == available);
+
+    pthread_t thread;
+    pthread_create (&thread, NULL, (void* (*) (void*)) testEventQueueAvailableWait, queue);
+    nanosleep (&(struct timespec) { 0, 100000000 }, NULL);    // 100 ms, well past idle
+    eventQueueEnqueueTailSignal (queue, (BREvent *) &event);
+    pthread_join (thread, NULL);
+
+    eventQueueGetStats (queue, &depth, &depthMaximum, &available);
+    assert (0 == depth && 1 == available);
+
+    eventQueueDestroy (queue);
+}
+
+//
+// Timeout Late
+//
+typedef struct {
+    BREvent base;
+} TestSlowEvent;
+
+static size_t testTimeoutDispatched = 0;
+
+static void
+testSlowEventDispatcher (BREventHandler handler,
+                         TestSlowEvent *event) {
+    // Many timeout periods
+    nanosleep (&(struct timespec) { 0, 200000000 }, NULL);
+}
+
+static BREventType testSlowEventType = {
+    "Test Slow Event",
+    sizeof (TestSlowEvent),
+    (BREventDispatcher) testSlowEventDispatcher
+};
+
+static const BREventType *testSlowEventTypes[] = {
+    &testSlowEventType
+};
+
+static void
+testTimeoutDispatcher (BREventHandler handler,
+                       BREventTimeout *event) {
+    testTimeoutDispatched += 1;
+}
+
+static void
+runEventTimeoutLateTest (void) {
+    BREventHandler handler = eventHandlerCreate ("Core Test, Timeout", testSlowEventTypes, 1, NULL);
+    eventHandlerSetTimeoutDispatcher (handler, 10, (BREventDispatcher) testTimeoutDispatcher, NULL);
+
+    // The slow event, dispatched first, holds the first timeout past its deadline.
+    TestSlowEvent event = { { NULL, &testSlowEventType } };
+    eventHandlerSignalEvent (handler, (BREvent *) &event);
+
+    eventHandlerStart (handler);
+    nanosleep (&(struct timespec) { 0, 300000000 }, NULL);
+    eventHandlerStop (handler);
+
+    BREventTypeStats typeStats[2];
+    assert (2 == eventHandlerGetTypeStats (handler, typeStats, 2));
+    assert (1 == typeStats[0].dispatch.count);
+    assert (0 == typeStats[0].dropped);
+
+    // A dropped timeout is counted as dropped, not as dispatched
+    assert (0 < typeStats[1].dropped);
+    assert (testTimeoutDispatched == typeStats[1].dispatch.count);
+    assert (testTimeoutDispatched == typeStats[1].latency.count);
+    assert (1 + testTimeoutDispatched == eventHandlerGetStats (handler).dispatch.count);
+
+    eventHandlerResetStats (handler);
+    assert (2 == eventHandlerGetTypeStats (handler, typeStats, 2));
+    assert (0 == typeStats[1].dropped);
+
+    eventHandlerDestroy (handler);
+    alarmClockDestroy (alarmClock);
+}
+
+//
+// Executor
+//
+#define TEST_EXECUTOR_HANDLERS_COUNT    (50)
+#define TEST_EXECUTOR_EVENTS_COUNT      (1000)
+
+typedef struct {
+    BREvent base;
+    size_t index;
+} TestExecutorEvent;
+
+typedef struct {
+    BREventHandler handler;
+    size_t dispatched;      // Count of events dispatched
+    int dispatching;        // Non-zero while dispatching; checks that a handler is serial
+    int outOfOrder;
+} TestExecutorState;
+
+static TestExecutorState testExecutorStates[TEST_EXECUTOR_HANDLERS_COUNT];
+static pthread_mutex_t testExecutorMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void
+testExecutorEventDispatcher (BREventHandler handler,
+                             TestExecutorEvent *event) {
+    TestExecutorState *state = NULL;
+    for (size_t index = 0; index < TEST_EXECUTOR_HANDLERS_COUNT; index++)
+        if (handler == testExecutorStates[index].handler) state = &testExecutorStates[index];
+    assert (NULL != state);
+    assert (eventHandlerIsCurrentThread (handler));
+
+    pthread_mutex_lock (&testExecutorMutex);
+    assert (!state->dispatching);
+    state->dispatching = 1;
+    pthread_mutex_unlock (&testExecutorMutex);
+
+    pthread_yield_brd();
+
+    pthread_mutex_lock (&testExecutorMutex);
+    if (event->index != state->dispatched) state->outOfOrder = 1;
+    state->dispatched += 1;
+    state->dispatching = 0;
+    pthread_mutex_unlock (&testExecutorMutex);
+}
+
+static BREventType testExecutorEventType = {
+    "Test Executor Event",
+    sizeof (TestExecutorEvent),
+    (BREventDispatcher) testExecutorEventDispatcher
+};
+
+static const BREventType *testExecutorEventTypes[] = {
+    &testExecutorEventType
+};
+
+static void
+runEventExecutorTest (void) {
+    BREventExecutor executor = eventExecutorCreate ("Core Test, Executor", 4);
+
+    // Handlers from `eventHandlerCreate()` get the default executor.
+    eventExecutorSetDefault (executor);
+    assert (executor == eventExecutorGetDefault());
+
+    for (size_t index = 0; index < TEST_EXECUTOR_HANDLERS_COUNT; index++)
+        testExecutorStates[index] = (TestExecutorState) {
+            eventHandlerCreate ("Core Test, Handler", testExecutorEventTypes, 1, NULL)
+        };
+
+    eventExecutorSetDefault (NULL);
+
+    // Events signalled before the start are held, then dispatched in order.
+    for (size_t index = 0; index < TEST_EXECUTOR_HANDLERS_COUNT; index++) {
+        BREventHandler handler = testExecutorStates[index].handler;
+        assert (!eventHandlerIsRunning (handler));
+
+        for (size_t event = 0; event < TEST_EXECUTOR_EVENTS_COUNT / 2; event++) {
+            TestExecutorEvent message = { { NULL, &testExecutorEventType }, event };
+            eventHandlerSignalEvent (handler, (BREvent *) &message);
+        }
+    }
+
+    for (size_t index = 0; index < TEST_EXECUTOR_HANDLERS_COUNT; index++) {
+        eventHandlerStart (testExecutorStates[index].handler);
+        assert (eventHandlerIsRunning (testExecutorStates[index].handler));
+    }
+
+    for (size_t event = TEST_EXECUTOR_EVENTS_COUNT / 2; event < TEST_EXECUTOR_EVENTS_COUNT; event++)
+        for (size_t index = 0; index < TEST_EXECUTOR_HANDLERS_COUNT; index++) {
+            TestExecutorEvent message = { { NULL, &testExecutorEventType }, event };
+            eventHandlerSignalEvent (testExecutorStates[index].handler, (BREvent *) &message);
+        }
+
+    // Wait for every event to be dispatched
+    for (int done = 0; !done; ) {
+        done = 1;
+        pthread_mutex_lock (&testExecutorMutex);
+        for (size_t index = 0; index < TEST_EXECUTOR_HANDLERS_COUNT; index++)
+            if (TEST_EXECUTOR_EVENTS_COUNT != testExecutorStates[index].dispatched) done = 0;
+        pthread_mutex_unlock (&testExecutorMutex);
+        if (!done) nanosleep (&(struct timespec) { 0, 1000000 }, NULL);
+    }
+
+    for (size_t index = 0; index < TEST_EXECUTOR_HANDLERS_COUNT; index++) {
+        assert (!testExecutorStates[index].outOfOrder);
+
+        // Every event was counted, against its type; none remain
+        BREventHandlerStats stats = eventHandlerGetStats (testExecutorStates[index].handler);
+        assert (0 == stats.queueDepth);
+        assert (0 <  stats.queueDepthMaximum && stats.queueDepthMaximum <= TEST_EXECUTOR_EVENTS_COUNT);
+        assert (0 <  stats.queueAvailable);
+        assert (TEST_EXECUTOR_EVENTS_COUNT == stats.dispatch.count);
+        assert (TEST_EXECUTOR_EVENTS_COUNT == stats.latency.count);
+
+        BREventTypeStats typeStats[2];
+        assert (2 == eventHandlerGetTypeStats (testExecutorStates[index].handler, typeStats, 2));
+        assert (0 == strcmp (testExecutorEventType.eventName, typeStats[0].eventName));
+        assert (TEST_EXECUTOR_EVENTS_COUNT == typeStats[0].dispatch.count);
+        assert (0 == typeStats[1].dispatch.count);
+
+        uint64_t histogramCount = 0;
+        for (size_t bucket = 0; bucket < EVENT_STATS_HISTOGRAM_BUCKETS; bucket++)
+            histogramCount += typeStats[0].latency.histogram[bucket];
+        assert (TEST_EXECUTOR_EVENTS_COUNT == histogramCount);
+
+        eventHandlerResetStats (testExecutorStates[index].handler);
+        assert (0 == eventHandlerGetStats (testExecutorStates[index].handler).dispatch.count);
+
+        eventHandlerStop (testExecutorStates[index].handler);
+        assert (!eventHandlerIsRunning (testExecutorStates[index].handler));
+        eventHandlerDestroy (testExecutorStates[index].handler);
+    }
+
+    eventExecutorDestroy (executor);
+}
+
 extern void
 runEventTests (void) {
     runEventTest();
+    runEventAlarmOrderTest();
+    runEventAlarmJitterTest();
+    runEventQueuePriorityTest();
+    runEventQueueAvailableTest();
+    runEventTimeoutLateTest();
+    runEventExecutorTest();
 }
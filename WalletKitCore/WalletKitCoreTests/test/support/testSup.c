@@ -20,6 +20,7 @@
 #include "support/BRFileService.h"
 #include "support/BRAssert.h"
 #include "support/BROSCompat.h"
+#include "vendor/sqlite3/sqlite3.h"
 
 /// MARK: - File Service Tests
 
@@ -79,6 +80,11 @@ fileServiceErrorHandler (BRFileServiceContext context,
                     error.u.sdb.code,
                     error.u.sdb.reason);
             break;
+        case FILE_SERVICE_QUARANTINE:
+            printf ("  supFileServiceThread: FileService Error: QUARANTINE (%s): %s\n",
+                    error.u.quarantine.type,
+                    error.u.quarantine.reason);
+            break;
     }
 }
 
@@ -228,6 +234,851 @@ static int runSupFileServiceMultiTests (void) {
     return fileServiceTestDone(path, success);
 }
 
+/// MARK: - File Service Entity Tests
+
+typedef struct {
+    UInt256 hash;
+    uint64_t value;
+} SupEntity;
+
+static size_t
+supEntityHash (const void *entity) {
+    return (size_t) ((const SupEntity *) entity)->hash.u64[0];
+}
+
+static int
+supEntityEq (const void *entity1, const void *entity2) {
+    return UInt256Eq (((const SupEntity *) entity1)->hash, ((const SupEntity *) entity2)->hash);
+}
+
+static SupEntity *
+supEntityCreate (uint64_t value) {
+    SupEntity *entity = calloc (1, sizeof (SupEntity));
+    entity->hash.u64[0] = value;
+    entity->hash.u64[3] = ~value;
+    entity->value = value;
+    return entity;
+}
+
+static UInt256
+supEntityIdentifier (BRFileServiceContext context,
+                     BRFileService fs,
+                     const void *entity) {
+    return ((const SupEntity *) entity)->hash;
+}
+
+static uint8_t *
+supEntityWriter (BRFileServiceContext context,
+                 BRFileService fs,
+                 const void* entity,
+                 uint32_t *bytesCount) {
+    const SupEntity *supEntity = entity;
+
+    *bytesCount = sizeof (UInt256) + sizeof (uint64_t);
+    uint8_t *bytes = malloc (*bytesCount);
+
+    memcpy (bytes, supEntity->hash.u8, sizeof (UInt256));
+    UInt64SetBE (&bytes[sizeof (UInt256)], supEntity->value);
+
+    return bytes;
+}
+
+static void *
+supEntityReader (BRFileServiceContext context,
+                 BRFileService fs,
+                 uint8_t *bytes,
+                 uint32_t bytesCount) {
+    if (bytesCount != sizeof (UInt256) + sizeof (uint64_t)) return NULL;
+
+    SupEntity *entity = calloc (1, sizeof (SupEntity));
+    memcpy (entity->hash.u8, bytes, sizeof (UInt256));
+    entity->value = UInt64GetBE (&bytes[sizeof (UInt256)]);
+
+    return entity;
+}
+
+static BRFileService
+fileServiceSetupEntity (const char *path, const char *currency, const char *network, const char *type) {
+    BRFileService fs = fileServiceCreate(path, currency, network, NULL, fileServiceErrorHandler);
+    if (NULL == fs) return NULL;
+
+    if (1 != fileServiceDefineType (fs, type, 0, NULL,
+                                    supEntityIdentifier,
+                                    supEntityReader,
+                                    supEntityWriter) ||
+        1 != fileServiceDefineCurrentVersion (fs, type, 0)) {
+        fileServiceRelease (fs);
+        return NULL;
+    }
+
+    return fs;
+}
+
+static int
+fileServiceLoadEntities (BRFileService fs, const char *type, size_t expectedCount) {
+    BRSet *entities = BRSetNew (supEntityHash, supEntityEq, 10);
+    int success = fileServiceLoad (fs, entities, type, 1);
+
+    success &= (expectedCount == BRSetCount (entities));
+    FOR_SET (SupEntity*, entity, entities)
+        success &= (entity->hash.u64[0] == entity->value);
+
+    BRSetFreeAll (entities, free);
+    return success;
+}
+
+static int runSupFileServiceEntityTests (void) {
+    printf ("==== SUP:FileServiceEntity\n");
+
+    struct stat dirStat;
+
+    BRFileService fs;
+    char *path = "private";
+    char *currency = "btc", *network = "mainnet";
+    char *type = "foo";
+
+    if (0 == stat  (path, &dirStat)) _rmdir (path);
+    if (0 != mkdir (path, 0700)) return 0;
+
+    //
+    // Create a legacy, hex-encoded 'Entity' table holding one entity; expect it to be migrated.
+    //
+    char dbpath[1024];
+    sprintf (dbpath, "%s/%s-%s-entities.db", path,  currency, network);
+
+    SupEntity *entity = supEntityCreate (1);
+    {
+        sqlite3 *sdb;
+        if (SQLITE_OK != sqlite3_open (dbpath, &sdb)) return fileServiceTestDone (path, 0);
+
+        // The legacy header: {HeaderFormatVersion, Version, EntityBytesCount, EntityBytes}
+        uint32_t entityBytesCount;
+        uint8_t *entityBytes = supEntityWriter (NULL, NULL, entity, &entityBytesCount);
+
+        size_t  bytesCount = 1 + 1 + sizeof (uint32_t) + entityBytesCount;
+        uint8_t bytes[bytesCount];
+        bytes[0] = 0;
+        bytes[1] = 0;
+        UInt32SetBE (&bytes[2], entityBytesCount);
+        memcpy (&bytes[6], entityBytes, entityBytesCount);
+        free (entityBytes);
+
+        char data[2 * bytesCount + 1];
+        for (size_t index = 0; index < bytesCount; index++)
+            sprintf (&data[2 * index], "%02x", bytes[index]);
+
+        char *sql = NULL;
+        asprintf (&sql,
+                  "CREATE TABLE Entity(Type CHAR(64) NOT NULL, Hash CHAR(64) NOT NULL, Data TEXT NOT NULL, PRIMARY KEY (Type, Hash));"
+                  "INSERT INTO Entity (Type, Hash, Data) VALUES ('%s', '%s', '%s');",
+                  type, u256hex (entity->hash), data);
+
+        int status = sqlite3_exec (sdb, sql, NULL, NULL, NULL);
+        free (sql);
+        sqlite3_close (sdb);
+        if (SQLITE_OK != status) return fileServiceTestDone (path, 0);
+    }
+
+    fs = fileServiceSetupEntity (path, currency, network, type);
+    if (NULL == fs) return fileServiceTestDone (path, 0);
+
+    if (!fileServiceLoadEntities (fs, type, 1)) {
+        fileServiceRelease (fs);
+        return fileServiceTestDone (path, 0);
+    }
+
+    //
+    // Save, remove and reload from the 'EntityBlob' table.
+    //
+    int success = 1;
+
+    SupEntity *entities[10];
+    for (size_t index = 0; index < 10; index++) {
+        entities[index] = supEntityCreate (index + 2);
+        success &= fileServiceSave (fs, type, entities[index]);
+    }
+    success &= fileServiceLoadEntities (fs, type, 11);
+
+    success &= fileServiceRemove (fs, type, entity);
+    success &= fileServiceLoadEntities (fs, type, 10);
+
+    fileServiceRelease (fs);
+
+    // Reopen; the legacy table is gone but the entities remain.
+    fs = fileServiceSetupEntity (path, currency, network, type);
+    success &= (NULL != fs && fileServiceLoadEntities (fs, type, 10));
+    if (NULL != fs) fileServiceRelease (fs);
+
+    for (size_t index = 0; index < 10; index++) free (entities[index]);
+    free (entity);
+
+    return fileServiceTestDone (path, success);
+}
+
+typedef struct {
+    size_t count;
+    size_t limit;
+} SupEntityIterateContext;
+
+static int
+supEntityIterateCallback (BRFileServiceContext context,
+                          BRFileService fs,
+                          void *entity) {
+    SupEntityIterateContext *iterateContext = context;
+    iterateContext->count += 1;
+    free (entity);
+    return iterateContext->count < iterateContext->limit;
+}
+
+static int runSupFileServiceSaveManyTests (void) {
+    printf ("==== SUP:FileServiceSaveMany\n");
+
+    struct stat dirStat;
+
+    char *path = "private";
+    char *currency = "btc", *network = "mainnet";
+    char *type = "foo";
+
+    if (0 == stat  (path, &dirStat)) _rmdir (path);
+    if (0 != mkdir (path, 0700)) return 0;
+
+    BRFileService fs = fileServiceSetupEntity (path, currency, network, type);
+    if (NULL == fs) return fileServiceTestDone (path, 0);
+
+    int success = 1;
+
+#define FS_SAVE_MANY_COUNT      (1000)
+    SupEntity *entities[FS_SAVE_MANY_COUNT];
+    for (size_t index = 0; index < FS_SAVE_MANY_COUNT; index++)
+        entities[index] = supEntityCreate (index);
+
+    // Save all in one DB transaction
+    success &= fileServiceSaveMany (fs, type, (const void **) entities, FS_SAVE_MANY_COUNT / 2);
+    success &= fileServiceLoadEntities (fs, type, FS_SAVE_MANY_COUNT / 2);
+
+    // Save the rest within a (nested) transaction scope
+    success &= fileServiceBeginTransaction (fs);
+    success &= fileServiceBeginTransaction (fs);
+    for (size_t index = FS_SAVE_MANY_COUNT / 2; index < FS_SAVE_MANY_COUNT - 1; index++)
+        success &= fileServiceSave (fs, type, entities[index]);
+    success &= fileServiceCommitTransaction (fs);
+    success &= fileServiceSaveMany (fs, type, (const void **) &entities[FS_SAVE_MANY_COUNT - 1], 1);
+    success &= fileServiceCommitTransaction (fs);
+    success &= fileServiceLoadEntities (fs, type, FS_SAVE_MANY_COUNT);
+
+    // Iterate over all, then stop early
+    SupEntityIterateContext iterateContext = { 0, SIZE_MAX };
+    success &= fileServiceLoadIterate (fs, type, 1, &iterateContext, supEntityIterateCallback);
+    success &= (FS_SAVE_MANY_COUNT == iterateContext.count);
+
+    iterateContext = (SupEntityIterateContext) { 0, 10 };
+    success &= fileServiceLoadIterate (fs, type, 1, &iterateContext, supEntityIterateCallback);
+    success &= (10 == iterateContext.count);
+
+    // Within a transaction scope, a failed save rolls back only its own entities.  Force the
+    // third new entity to fail, through another connection's trigger.
+    SupEntity *moreEntities[4];
+    for (size_t index = 0; index < 4; index++)
+        moreEntities[index] = supEntityCreate (FS_SAVE_MANY_COUNT + index);
+
+    char dbpath[1024];
+    sprintf (dbpath, "%s/%s-%s-entities.db", path, currency, network);
+
+    sqlite3 *sdb;
+    success &= (SQLITE_OK == sqlite3_open (dbpath, &sdb));
+    success &= (SQLITE_OK == sqlite3_exec (sdb,
+                                           "CREATE TRIGGER SupFailSave BEFORE INSERT ON EntityBlob "
+                                           "  WHEN (SELECT COUNT(*) FROM EntityBlob) >= 1003 "
+                                           "  BEGIN SELECT RAISE (ABORT, 'forced'); END;",
+                                           NULL, NULL, NULL));
+    sqlite3_close (sdb);
+
+    success &= fileServiceBeginTransaction (fs);
+    success &= fileServiceSave (fs, type, moreEntities[0]);
+    success &= (0 == fileServiceSaveMany (fs, type, (const void **) &moreEntities[1], 3));
+    success &= fileServiceCommitTransaction (fs);
+    success &= fileServiceLoadEntities (fs, type, FS_SAVE_MANY_COUNT + 1);
+
+    fileServiceRelease (fs);
+
+    for (size_t index = 0; index < 4; index++) free (moreEntities[index]);
+    for (size_t index = 0; index < FS_SAVE_MANY_COUNT; index++) free (entities[index]);
+
+    return fileServiceTestDone (path, success);
+}
+
+static int
+supJournalModeCallback (void *context, int count, char **values, char **names) {
+    strlcpy ((char *) context, (NULL == values[0] ? "" : values[0]), 16);
+    return 0;
+}
+
+static int runSupFileServiceConfigurationTests (void) {
+    printf ("==== SUP:FileServiceConfiguration\n");
+
+    struct stat dirStat;
+
+    char *path = "private";
+    char *currency = "btc", *network = "mainnet";
+
+    if (0 == stat  (path, &dirStat)) _rmdir (path);
+    if (0 != mkdir (path, 0700)) return 0;
+
+    BRFileServiceTypeSpecification specifications[] = {
+        { "foo", 0, 1, { { 0, supEntityIdentifier, supEntityReader, supEntityWriter } } }
+    };
+
+    BRFileServiceConfiguration configuration = {
+        FILE_SERVICE_JOURNAL_MODE_WAL,
+        FILE_SERVICE_SYNCHRONOUS_NORMAL,
+        FILE_SERVICE_TEMP_STORE_MEMORY,
+        8192,
+        -4096,
+        1024 * 1024
+    };
+
+    BRFileService fs = fileServiceCreateFromTypeSpecifications (path, currency, network,
+                                                                NULL, fileServiceErrorHandler,
+                                                                &configuration,
+                                                                1, specifications);
+    if (NULL == fs) return fileServiceTestDone (path, 0);
+
+    int success = 1;
+
+    SupEntity *entity = supEntityCreate (1);
+    success &= fileServiceSave (fs, "foo", entity);
+    success &= fileServiceLoadEntities (fs, "foo", 1);
+    free (entity);
+
+    // The journal mode persists in the database; confirm it from another connection.
+    char dbpath[1024];
+    sprintf (dbpath, "%s/%s-%s-entities.db", path,  currency, network);
+
+    char journalMode[16] = { '\0' };
+    sqlite3 *sdb;
+    success &= (SQLITE_OK == sqlite3_open (dbpath, &sdb));
+    success &= (SQLITE_OK == sqlite3_exec (sdb, "PRAGMA journal_mode;", supJournalModeCallback, journalMode, NULL));
+    success &= (0 == strcmp (journalMode, "wal"));
+    sqlite3_close (sdb);
+
+    fileServiceRelease (fs);
+
+    // Wipe removes the database, including any WAL files.
+    success &= (0 == fileServiceWipe (path, currency, network));
+    success &= (0 != stat (dbpath, &dirStat));
+
+    return fileServiceTestDone (path, success);
+}
+
+static int
+supEntityCountCallback (void *context, int count, char **values, char **names) {
+    *((size_t *) context) = (NULL == values[0] ? 0 : (size_t) strtoul (values[0], NULL, 10));
+    return 0;
+}
+
+// Count the saved entities, from another connection; thus only those written.
+static size_t
+supEntityCount (const char *dbpath) {
+    size_t count = SIZE_MAX;
+    sqlite3 *sdb;
+    if (SQLITE_OK == sqlite3_open (dbpath, &sdb))
+        sqlite3_exec (sdb, "SELECT COUNT(*) FROM EntityBlob;", supEntityCountCallback, &count, NULL);
+    sqlite3_close (sdb);
+    return count;
+}
+
+// Corrupt the saved `entity`, from another connection, by flipping its last byte or by
+// truncating it to within the header.
+static int
+supEntityCorrupt (const char *dbpath, const SupEntity *entity, int truncate) {
+    sqlite3 *sdb;
+    sqlite3_stmt *stmt;
+    if (SQLITE_OK != sqlite3_open (dbpath, &sdb)) return 0;
+
+    int success = (SQLITE_OK == sqlite3_prepare_v2 (sdb, "SELECT Data FROM EntityBlob WHERE Hash = ?;", -1, &stmt, NULL));
+    success = success && (SQLITE_OK == sqlite3_bind_blob (stmt, 1, entity->hash.u8, sizeof (UInt256), SQLITE_STATIC));
+    success = success && (SQLITE_ROW == sqlite3_step (stmt));
+
+    size_t  bytesCount = (success ? (size_t) sqlite3_column_bytes (stmt, 0) : 0);
+    uint8_t bytes[bytesCount + 1];
+    if (success) memcpy (bytes, sqlite3_column_blob (stmt, 0), bytesCount);
+    sqlite3_finalize (stmt);
+
+    if (truncate) bytesCount = 3;
+    else bytes[bytesCount - 1] ^= 0xff;
+
+    success = success && (SQLITE_OK == sqlite3_prepare_v2 (sdb, "UPDATE EntityBlob SET Data = ? WHERE Hash = ?;", -1, &stmt, NULL));
+    success = success && (SQLITE_OK == sqlite3_bind_blob (stmt, 1, bytes, (int) bytesCount, SQLITE_STATIC));
+    success = success && (SQLITE_OK == sqlite3_bind_blob (stmt, 2, entity->hash.u8, sizeof (UInt256), SQLITE_STATIC));
+    success = success && (SQLITE_DONE == sqlite3_step (stmt));
+    sqlite3_finalize (stmt);
+
+    sqlite3_close (sdb);
+    return success;
+}
+
+// Replace the saved `entity`, from another connection, with an intact row - its header has no
+// checksum - that the reader can't read.
+static int
+supEntityUnreadable (const char *dbpath, const SupEntity *entity) {
+    sqlite3 *sdb;
+    sqlite3_stmt *stmt;
+    if (SQLITE_OK != sqlite3_open (dbpath, &sdb)) return 0;
+
+    // {HeaderFormatVersion, Version, EntityBytesCount, EntityBytes}
+    uint8_t bytes[] = { 0, 0, 0, 0, 0, 3, 1, 2, 3 };
+
+    int success = (SQLITE_OK == sqlite3_prepare_v2 (sdb, "UPDATE EntityBlob SET Data = ? WHERE Hash = ?;", -1, &stmt, NULL));
+    success = success && (SQLITE_OK == sqlite3_bind_blob (stmt, 1, bytes, (int) sizeof (bytes), SQLITE_STATIC));
+    success = success && (SQLITE_OK == sqlite3_bind_blob (stmt, 2, entity->hash.u8, sizeof (UInt256), SQLITE_STATIC));
+    success = success && (SQLITE_DONE == sqlite3_step (stmt));
+    sqlite3_finalize (stmt);
+
+    sqlite3_close (sdb);
+    return success;
+}
+
+typedef struct {
+    size_t quarantineCount;
+    size_t unreadCount;
+} SupQuarantineErrors;
+
+static void
+supQuarantineErrorHandler (BRFileServiceContext context,
+                           BRFileService fs,
+                           BRFileServiceError error) {
+    SupQuarantineErrors *errors = context;
+
+    if      (FILE_SERVICE_QUARANTINE == error.type) errors->quarantineCount += 1;
+    else if (FILE_SERVICE_ENTITY     == error.type) errors->unreadCount     += 1;
+    else fileServiceErrorHandler (NULL, fs, error);
+}
+
+static int runSupFileServiceParallelLoadTests (void) {
+    printf ("==== SUP:FileServiceParallelLoad\n");
+
+    struct stat dirStat;
+
+    char *path = "private";
+    char *currency = "btc", *network = "mainnet";
+    char *type = "foo";
+
+    if (0 == stat  (path, &dirStat)) _rmdir (path);
+    if (0 != mkdir (path, 0700)) return 0;
+
+    // With a releaser, "foo" entities are decoded in parallel.
+    BRFileServiceTypeSpecification specifications[] = {
+        { "foo", 0, 1, { { 0, supEntityIdentifier, supEntityReader, supEntityWriter } }, free }
+    };
+
+    BRFileServiceConfiguration configuration = {
+        FILE_SERVICE_JOURNAL_MODE_DEFAULT,
+        FILE_SERVICE_SYNCHRONOUS_DEFAULT,
+        FILE_SERVICE_TEMP_STORE_DEFAULT,
+        0,
+        0,
+        0,
+        4
+    };
+
+    BRFileService fs = fileServiceCreateFromTypeSpecifications (path, currency, network,
+                                                                NULL, fileServiceErrorHandler,
+                                                                &configuration,
+                                                                1, specifications);
+    if (NULL == fs) return fileServiceTestDone (path, 0);
+
+    int success = 1;
+
+    // More entities than fit in one load batch.
+#define FS_PARALLEL_LOAD_COUNT      (10000)
+    SupEntity **entities = calloc (FS_PARALLEL_LOAD_COUNT, sizeof (SupEntity*));
+    for (size_t index = 0; index < FS_PARALLEL_LOAD_COUNT; index++)
+        entities[index] = supEntityCreate (index);
+
+    success &= fileServiceSaveMany (fs, type, (const void **) entities, FS_PARALLEL_LOAD_COUNT);
+    success &= fileServiceLoadEntities (fs, type, FS_PARALLEL_LOAD_COUNT);
+
+    // Stop early, within the second batch; the undelivered entities are released.
+    SupEntityIterateContext iterateContext = { 0, FS_PARALLEL_LOAD_COUNT / 2 };
+    success &= fileServiceLoadIterate (fs, type, 1, &iterateContext, supEntityIterateCallback);
+    success &= (FS_PARALLEL_LOAD_COUNT / 2 == iterateContext.count);
+
+    // An entity that can't be read, unlike a corrupted one, is kept
+    char dbpath[1024];
+    sprintf (dbpath, "%s/%s-%s-entities.db", path,  currency, network);
+
+    SupQuarantineErrors errors = { 0, 0 };
+    fileServiceSetErrorHandler (fs, &errors, supQuarantineErrorHandler);
+
+    success &= supEntityUnreadable (dbpath, entities[7]);
+    success &= supEntityCorrupt (dbpath, entities[9], 0);
+    success &= fileServiceLoadEntities (fs, type, FS_PARALLEL_LOAD_COUNT - 2);
+    success &= (1 == errors.unreadCount && 1 == errors.quarantineCount);
+    success &= (FS_PARALLEL_LOAD_COUNT - 1 == supEntityCount (dbpath));
+
+    fileServiceRelease (fs);
+
+    for (size_t index = 0; index < FS_PARALLEL_LOAD_COUNT; index++) free (entities[index]);
+    free (entities);
+
+    return fileServiceTestDone (path, success);
+}
+
+static int runSupFileServiceQuarantineTests (void) {
+    printf ("==== SUP:FileServiceQuarantine\n");
+
+    struct stat dirStat;
+
+    char *path = "private";
+    char *currency = "btc", *network = "mainnet";
+    char *type = "foo";
+
+    if (0 == stat  (path, &dirStat)) _rmdir (path);
+    if (0 != mkdir (path, 0700)) return 0;
+
+    char dbpath[1024];
+    sprintf (dbpath, "%s/%s-%s-entities.db", path,  currency, network);
+
+    BRFileService fs = fileServiceSetupEntity (path, currency, network, type);
+    if (NULL == fs) return fileServiceTestDone (path, 0);
+
+    SupQuarantineErrors errors = { 0, 0 };
+    fileServiceSetErrorHandler (fs, &errors, supQuarantineErrorHandler);
+
+    int success = 1;
+
+    SupEntity *entities[10];
+    for (size_t index = 0; index < 10; index++) {
+        entities[index] = supEntityCreate (index);
+        success &= fileServiceSave (fs, type, entities[index]);
+    }
+
+    // One fails its checksum; one is truncated.  The load continues with the others.
+    success &= supEntityCorrupt (dbpath, entities[3], 0);
+    success &= supEntityCorrupt (dbpath, entities[7], 1);
+
+    success &= fileServiceLoadEntities (fs, type, 8);
+    success &= (2 == errors.quarantineCount);
+    success &= (2 == fileServiceGetQuarantineCount (fs, type));
+
+    // The corrupted entities were moved aside; a reload finds no more.
+    success &= fileServiceLoadEntities (fs, type, 8);
+    success &= (2 == errors.quarantineCount);
+
+    // An intact entity that can't be read is reported and skipped, but never quarantined.
+    success &= supEntityUnreadable (dbpath, entities[5]);
+    success &= fileServiceLoadEntities (fs, type, 7);
+    success &= (1 == errors.unreadCount);
+    success &= (2 == errors.quarantineCount);
+    success &= (8 == supEntityCount (dbpath));
+
+    success &= fileServiceLoadEntities (fs, type, 7);
+    success &= (2 == errors.unreadCount);
+    success &= fileServiceSave (fs, type, entities[5]);
+
+    // Re-fetched entities are saved normally.
+    success &= fileServiceSave (fs, type, entities[3]);
+    success &= fileServiceSave (fs, type, entities[7]);
+    success &= fileServiceLoadEntities (fs, type, 10);
+
+    success &= fileServiceClearQuarantine (fs, type);
+    success &= (0 == fileServiceGetQuarantineCount (fs, type));
+
+    fileServiceRelease (fs);
+
+    for (size_t index = 0; index < 10; index++) free (entities[index]);
+
+    return fileServiceTestDone (path, success);
+}
+
+static int runSupFileServicePoolTests (void) {
+    printf ("==== SUP:FileServicePool\n");
+
+    struct stat dirStat;
+
+    char *path = "private";
+    char *currency = "btc", *network = "mainnet";
+    char *type = "foo";
+
+    if (0 == stat  (path, &dirStat)) _rmdir (path);
+    if (0 != mkdir (path, 0700)) return 0;
+
+    BRFileServiceTypeSpecification specifications[] = {
+        { "foo", 0, 1, { { 0, supEntityIdentifier, supEntityReader, supEntityWriter } }, free }
+    };
+
+    // Two creates share one pool
+    BRFileServicePool pool1 = fileServicePoolCreate (path, NULL);
+    BRFileServicePool pool2 = fileServicePoolCreate (path, NULL);
+    if (NULL == pool1 || pool1 != pool2) return fileServiceTestDone (path, 0);
+    fileServicePoolRelease (pool2);
+
+    BRFileService fs1 = fileServiceCreateFromTypeSpecificationsInPool (pool1, "account1", currency, network,
+                                                                       NULL, fileServiceErrorHandler,
+                                                                       1, specifications);
+    BRFileService fs2 = fileServiceCreateFromTypeSpecificationsInPool (pool1, "account2", currency, network,
+                                                                       NULL, fileServiceErrorHandler,
+                                                                       1, specifications);
+    if (NULL == fs1 || NULL == fs2) return fileServiceTestDone (path, 0);
+
+    int success = 1;
+
+    SupEntity *entities[10];
+    for (size_t index = 0; index < 10; index++)
+        entities[index] = supEntityCreate (index);
+
+    // The same type, and even the same entities, are kept apart by partition
+    success &= fileServiceSaveMany (fs1, type, (const void **) entities, 10);
+    success &= fileServiceSaveMany (fs2, type, (const void **) entities, 4);
+    success &= fileServiceLoadEntities (fs1, type, 10);
+    success &= fileServiceLoadEntities (fs2, type, 4);
+
+    // A purge and a clear only affect their own partition
+    success &= fileServicePurge (fs1);
+    success &= fileServiceClear (fs2, type);
+    success &= fileServiceLoadEntities (fs1, type, 10);
+    success &= fileServiceLoadEntities (fs2, type, 0);
+
+    // Everything is in one database
+    char dbpath[1024];
+    sprintf (dbpath, "%s/pooled-entities.db", path);
+    success &= (0 == stat (dbpath, &dirStat));
+
+    // The pool survives its last create's release while file services remain
+    fileServicePoolRelease (pool1);
+    fileServiceRelease (fs2);
+    success &= fileServiceLoadEntities (fs1, type, 10);
+    fileServiceRelease (fs1);
+
+    // Reopen; the entities persist and a wipe removes only one partition
+    pool1 = fileServicePoolCreate (path, NULL);
+    success &= (NULL != pool1);
+
+    fs2 = fileServiceCreateFromTypeSpecificationsInPool (pool1, "account2", currency, network,
+                                                         NULL, fileServiceErrorHandler,
+                                                         1, specifications);
+    success &= fileServiceSaveMany (fs2, type, (const void **) entities, 4);
+    fileServiceRelease (fs2);
+
+    success &= fileServicePoolWipe (pool1, "account1", currency, network);
+
+    fs1 = fileServiceCreateFromTypeSpecificationsInPool (pool1, "account1", currency, network,
+                                                         NULL, fileServiceErrorHandler,
+                                                         1, specifications);
+    fs2 = fileServiceCreateFromTypeSpecificationsInPool (pool1, "account2", currency, network,
+                                                         NULL, fileServiceErrorHandler,
+                                                         1, specifications);
+    success &= fileServiceLoadEntities (fs1, type, 0);
+    success &= fileServiceLoadEntities (fs2, type, 4);
+
+    fileServiceRelease (fs1);
+    fileServiceRelease (fs2);
+
+    // A partition is bound, never pasted into SQL
+    BRFileService fs3 = fileServiceCreateFromTypeSpecificationsInPool (pool1, "account'3\"", currency, network,
+                                                                       NULL, fileServiceErrorHandler,
+                                                                       1, specifications);
+    success &= fileServiceSaveMany (fs3, type, (const void **) entities, 3);
+    success &= fileServicePurge (fs3);
+    success &= fileServiceLoadEntities (fs3, type, 3);
+    fileServiceRelease (fs3);
+    success &= fileServicePoolWipe (pool1, "account'3\"", currency, network);
+
+    fileServicePoolRelease (pool1);
+
+    for (size_t index = 0; index < 10; index++) free (entities[index]);
+
+    return fileServiceTestDone (path, success);
+}
+
+static int runSupFileServicePoolTransactionTests (void) {
+    printf ("==== SUP:FileServicePoolTransaction\n");
+
+    struct stat dirStat;
+
+    char *path = "private";
+    char *currency = "btc", *network = "mainnet";
+    char *type = "foo";
+
+    if (0 == stat  (path, &dirStat)) _rmdir (path);
+    if (0 != mkdir (path, 0700)) return 0;
+
+    char dbpath[1024];
+    sprintf (dbpath, "%s/pooled-entities.db", path);
+
+    BRFileServiceTypeSpecification specifications[] = {
+        { "foo", 0, 1, { { 0, supEntityIdentifier, supEntityReader, supEntityWriter } }, free }
+    };
+
+    BRFileServicePool pool = fileServicePoolCreate (path, NULL);
+    if (NULL == pool) return fileServiceTestDone (path, 0);
+
+    BRFileService fs1 = fileServiceCreateFromTypeSpecificationsInPool (pool, "account1", currency, network,
+                                                                       NULL, fileServiceErrorHandler,
+                                                                       1, specifications);
+    BRFileService fs2 = fileServiceCreateFromTypeSpecificationsInPool (pool, "account2", currency, network,
+                                                                       NULL, fileServiceErrorHandler,
+                                                                       1, specifications);
+    if (NULL == fs1 || NULL == fs2) return fileServiceTestDone (path, 0);
+
+    int success = 1;
+
+    SupEntity *entities[4];
+    for (size_t index = 0; index < 4; index++)
+        entities[index] = supEntityCreate (index);
+
+    // Each file service balances its own begin; one can't commit the DB transaction of another.
+    success &= fileServiceBeginTransaction (fs1);
+    success &= fileServiceSaveMany (fs1, type, (const void **) entities, 2);
+    success &= (0 == fileServiceCommitTransaction (fs2));
+    success &= (0 == supEntityCount (dbpath));
+
+    // A commit doesn't wait on another file service's open transaction
+    success &= fileServiceBeginTransaction (fs2);
+    success &= fileServiceCommitTransaction (fs1);
+    success &= (2 == supEntityCount (dbpath));
+
+    // ... which remains a transaction, committed by its own outermost commit
+    success &= fileServiceSave (fs2, type, entities[0]);
+    success &= fileServiceBeginTransaction (fs2);
+    success &= fileServiceSave (fs2, type, entities[1]);
+    success &= fileServiceCommitTransaction (fs2);
+    success &= (2 == supEntityCount (dbpath));
+    success &= fileServiceCommitTransaction (fs2);
+    success &= (4 == supEntityCount (dbpath));
+
+    // Release commits a transaction left open
+    success &= fileServiceBeginTransaction (fs1);
+    success &= fileServiceSaveMany (fs1, type, (const void **) &entities[2], 2);
+    fileServiceRelease (fs1);
+    success &= (6 == supEntityCount (dbpath));
+    success &= fileServiceLoadEntities (fs2, type, 2);
+
+    fileServiceRelease (fs2);
+    fileServicePoolRelease (pool);
+
+    for (size_t index = 0; index < 4; index++) free (entities[index]);
+
+    return fileServiceTestDone (path, success);
+}
+
+// The value of the saved `entity`, from another connection; thus as written.
+static uint64_t
+supEntityValue (const char *dbpath, const SupEntity *entity) {
+    uint64_t value = UINT64_MAX;
+    sqlite3 *sdb;
+    sqlite3_stmt *stmt = NULL;
+    if (SQLITE_OK == sqlite3_open (dbpath, &sdb) &&
+        SQLITE_OK == sqlite3_prepare_v2 (sdb, "SELECT Data FROM EntityBlob WHERE Hash = ?;", -1, &stmt, NULL) &&
+        SQLITE_OK == sqlite3_bind_blob (stmt, 1, entity->hash.u8, sizeof (UInt256), SQLITE_STATIC) &&
+        SQLITE_ROW == sqlite3_step (stmt)) {
+        // The value is the last of the entity's bytes
+        const uint8_t *bytes = sqlite3_column_blob (stmt, 0);
+        int bytesCount = sqlite3_column_bytes (stmt, 0);
+        if (bytesCount >= (int) sizeof (uint64_t))
+            value = UInt64GetBE (&bytes[bytesCount - sizeof (uint64_t)]);
+    }
+    if (NULL != stmt) sqlite3_finalize (stmt);
+    sqlite3_close (sdb);
+    return value;
+}
+
+static int runSupFileServiceWriteBehindTests (void) {
+    printf ("==== SUP:FileServiceWriteBehind\n");
+
+    struct stat dirStat;
+
+    char *path = "private";
+    char *currency = "btc", *network = "mainnet";
+    char *type = "foo";
+
+    if (0 == stat  (path, &dirStat)) _rmdir (path);
+    if (0 != mkdir (path, 0700)) return 0;
+
+    char dbpath[1024];
+    sprintf (dbpath, "%s/%s-%s-entities.db", path,  currency, network);
+
+    BRFileServiceTypeSpecification specifications[] = {
+        { "foo", 0, 1, { { 0, supEntityIdentifier, supEntityReader, supEntityWriter } }, free }
+    };
+
+    BRFileServiceConfiguration configuration = {
+        FILE_SERVICE_JOURNAL_MODE_WAL,
+        FILE_SERVICE_SYNCHRONOUS_NORMAL,
+        FILE_SERVICE_TEMP_STORE_DEFAULT,
+        0,
+        0,
+        0,
+        0,
+        1
+    };
+
+    BRFileService fs = fileServiceCreateFromTypeSpecifications (path, currency, network,
+                                                                NULL, fileServiceErrorHandler,
+                                                                &configuration,
+                                                                1, specifications);
+    if (NULL == fs) return fileServiceTestDone (path, 0);
+
+    int success = 1;
+
+#define FS_WRITE_BEHIND_COUNT      (1000)
+    SupEntity *entities[FS_WRITE_BEHIND_COUNT];
+    for (size_t index = 0; index < FS_WRITE_BEHIND_COUNT; index++)
+        entities[index] = supEntityCreate (index);
+
+    // Repeated saves of the same entity coalesce; the last one is written
+    for (size_t index = 0; index < FS_WRITE_BEHIND_COUNT; index++) {
+        success &= fileServiceSave (fs, type, entities[index]);
+        success &= fileServiceSave (fs, type, entities[index]);
+    }
+    entities[0]->value = 1000;
+    success &= fileServiceSave (fs, type, entities[0]);
+
+    fileServiceFlush (fs);
+    success &= (FS_WRITE_BEHIND_COUNT == supEntityCount (dbpath));
+    success &= (1000 == supEntityValue (dbpath, entities[0]));
+    success &= (1    == supEntityValue (dbpath, entities[1]));
+
+    // Of many queued saves of one entity, whether or not the writer is busy, the last is written
+    for (uint64_t value = 1; value <= FS_WRITE_BEHIND_COUNT; value++) {
+        entities[1]->value = value;
+        success &= fileServiceSave (fs, type, entities[1]);
+        success &= fileServiceSaveMany (fs, type, (const void **) &entities[2], 10);
+    }
+    fileServiceFlush (fs);
+    success &= (FS_WRITE_BEHIND_COUNT == supEntityValue (dbpath, entities[1]));
+    entities[1]->value = 1;
+    success &= fileServiceSave (fs, type, entities[1]);
+
+    // A load sees the queued removes and saves
+    entities[0]->value = 0;
+    success &= fileServiceSave (fs, type, entities[0]);
+    for (size_t index = 0; index < FS_WRITE_BEHIND_COUNT / 2; index++)
+        success &= fileServiceRemove (fs, type, entities[index]);
+    success &= fileServiceSaveMany (fs, type, (const void **) entities, 10);
+    success &= fileServiceLoadEntities (fs, type, FS_WRITE_BEHIND_COUNT / 2 + 10);
+
+    // Queued writes, within a transaction, are committed with it
+    success &= fileServiceBeginTransaction (fs);
+    success &= fileServiceSaveMany (fs, type, (const void **) entities, FS_WRITE_BEHIND_COUNT);
+    success &= fileServiceCommitTransaction (fs);
+    success &= (FS_WRITE_BEHIND_COUNT == supEntityCount (dbpath));
+
+    // A replace follows the queued writes
+    success &= fileServiceRemove (fs, type, entities[0]);
+    success &= fileServiceReplace (fs, type, (const void **) entities, 10);
+    success &= fileServiceLoadEntities (fs, type, 10);
+
+    // Release writes any queued saves
+    success &= fileServiceSaveMany (fs, type, (const void **) entities, FS_WRITE_BEHIND_COUNT);
+    fileServiceRelease (fs);
+    success &= (FS_WRITE_BEHIND_COUNT == supEntityCount (dbpath));
+
+    for (size_t index = 0; index < FS_WRITE_BEHIND_COUNT; index++) free (entities[index]);
+
+    return fileServiceTestDone (path, success);
+}
+
 /// MARK: - Assert Tests
 
 #define DEFAULT_WORKERS     (5)
@@ -526,6 +1377,14 @@ int BRRunSupTests (void) {
 
     success &= runSupFileServiceTests();
     success &= runSupFileServiceMultiTests ();
+    success &= runSupFileServiceEntityTests ();
+    success &= runSupFileServiceSaveManyTests ();
+    success &= runSupFileServiceConfigurationTests ();
+    success &= runSupFileServiceParallelLoadTests ();
+    success &= runSupFileServiceQuarantineTests ();
+    success &= runSupFileServicePoolTests ();
+    success &= runSupFileServicePoolTransactionTests ();
+    success &= runSupFileServiceWriteBehindTests ();
     success &= runSupAssertTests();
 
     return success;
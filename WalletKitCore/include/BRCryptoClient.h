@@ -22,6 +22,38 @@ typedef void *BRCryptoClientContext;
 
 typedef struct BRCryptoClientCallbackStateRecord *BRCryptoClientCallbackState;
 
+// MARK: - Request
+
+/// Identifies a request made of the client; unique within a wallet manager.  A request is pending
+/// from when a client function is called until the request is announced, cancelled or timed out.
+/// Once no longer pending, an announcement is discarded - a host that drives requests from its
+/// own event loop can thus check if a result is still wanted, before or while producing it.
+typedef size_t BRCryptoClientRequestId;
+
+extern BRCryptoClientRequestId
+cryptoClientCallbackStateGetRequestId (BRCryptoClientCallbackState callbackState);
+
+extern BRCryptoBoolean
+cryptoClientRequestIsPending (BRCryptoWalletManager cwm,
+                              BRCryptoClientRequestId rid);
+
+/// Cancel a pending request; the wallet manager proceeds as if the request failed.  Submits are
+/// never cancelled.  Returns true if `rid` was pending and is now cancelled.
+extern BRCryptoBoolean
+cryptoClientRequestCancel (BRCryptoWalletManager cwm,
+                           BRCryptoClientRequestId rid);
+
+/// Set the time, in seconds, allowed for subsequent requests to be announced before they are
+/// timed out, as if cancelled.  Zero, the default, disables timeouts.  Submits are never timed out.
+extern void
+cryptoClientRequestSetTimeout (BRCryptoWalletManager cwm,
+                               unsigned int seconds);
+
+/// Return the number of pending requests.  At most 100 requests are pending; beyond that the
+/// oldest, other than a submit, is abandoned.  Submits are never abandoned.
+extern size_t
+cryptoClientRequestGetPendingCount (BRCryptoWalletManager cwm);
+
 // MARK: - Get Block Number
 
 typedef void
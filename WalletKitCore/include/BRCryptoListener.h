@@ -57,6 +57,64 @@ cryptoListenerCreate (BRCryptoListenerContext context,
                       BRCryptoListenerWalletCallback walletCallback,
                       BRCryptoListenerTransferCallback transferCallback);
 
+// MARK: - Listener Batch
+
+typedef enum {
+    CRYPTO_LISTENER_EVENT_SYSTEM,
+    CRYPTO_LISTENER_EVENT_NETWORK,
+    CRYPTO_LISTENER_EVENT_MANAGER,
+    CRYPTO_LISTENER_EVENT_WALLET,
+    CRYPTO_LISTENER_EVENT_TRANSFER,
+} BRCryptoListenerEventType;
+
+/**
+ * A listener event, as delivered in a batch.  The non-NULL objects and the `u` event are owned
+ * by the batch callback exactly as they would be owned by the corresponding per-type callback.
+ */
+typedef struct {
+    BRCryptoListenerEventType type;
+
+    BRCryptoSystem system;              // SYSTEM
+    BRCryptoNetwork network;            // NETWORK
+    BRCryptoWalletManager manager;      // MANAGER, WALLET, TRANSFER
+    BRCryptoWallet wallet;              // WALLET, TRANSFER
+    BRCryptoTransfer transfer;          // TRANSFER
+
+    union {
+        BRCryptoSystemEvent system;
+        BRCryptoNetworkEvent network;
+        BRCryptoWalletManagerEvent manager;
+        BRCryptoWalletEvent wallet;
+        BRCryptoTransferEvent transfer;
+    } u;
+} BRCryptoListenerEvent;
+
+/**
+ * A callback receiving every event pending when the listener's thread runs, in the order
+ * generated.  The `events` memory is owned by the listener and is only valid during the call.
+ */
+typedef void (*BRCryptoListenerBatchCallback) (BRCryptoListenerContext context,
+                                               BRCryptoListenerEvent *events,
+                                               size_t eventsCount);
+
+/**
+ * Deliver events in batches to `batchCallback` rather than one by one to the per-type callbacks.
+ * Pass NULL to restore the per-type callbacks.  Call before the listener is in use.
+ */
+extern void
+cryptoListenerSetBatchCallback (BRCryptoListener listener,
+                                BRCryptoListenerBatchCallback batchCallback);
+
+/**
+ * Collapse redundant pending events before delivery.  When enabled, a pending wallet
+ * BALANCE_UPDATED or TRANSFER_CHANGED event, or a pending transfer CHANGED event, is replaced by
+ * a later event of the same type for the same object; a merged transfer CHANGED event spans
+ * from the earliest `old` state to the latest `new` state.  Disabled by default.
+ */
+extern void
+cryptoListenerSetCoalescing (BRCryptoListener listener,
+                             BRCryptoBoolean coalesce);
+
 
 DECLARE_CRYPTO_GIVE_TAKE (BRCryptoListener, cryptoListener);
 
@@ -23,6 +23,14 @@ extern "C" {
 
 DECLARE_CRYPTO_GIVE_TAKE (BRCryptoSystem, cryptoSystem);
 
+/// Opt-in (or out) of WAL journaling with NORMAL synchronization for the databases of every
+/// BRCryptoSystem created afterwards.  Fewer fsyncs make saves faster, but a power failure or OS
+/// crash may lose the most recent saves (never corrupting the database); those are re-fetched on
+/// the next sync.  By default SQLite's journal and synchronization settings are kept.  Call this
+/// prior to creating any BRCryptoSystem.
+extern void
+cryptoSystemSetWriteAheadLogging (BRCryptoBoolean enabled);
+
 extern BRCryptoSystem
 cryptoSystemCreate (BRCryptoClient client,
                     BRCryptoListener listener,
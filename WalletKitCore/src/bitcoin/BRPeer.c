@@ -44,6 +44,11 @@
 #include <netinet/in.h>	
 #include <arpa/inet.h>
 
+#if defined (__linux__)
+#include <sys/epoll.h>
+#define PEER_REACTOR_SUPPORTED
+#endif
+
 #define HEADER_LENGTH      24
 #define MAX_MSG_LENGTH     0x02000000
 #define MAX_GETDATA_HASHES 50000
@@ -57,6 +62,10 @@
 
 #define PTHREAD_STACK_SIZE  (512 * 1024)
 
+#define PEER_REACTOR_EVENTS_COUNT   64  // socket events handled per epoll_wait()
+#define PEER_REACTOR_TIMEOUT_MS     100 // longest epoll_wait(), so timeouts are checked at least this often
+#define PEER_REACTOR_READS_MAXIMUM  16  // reads per readable event, so one busy peer can't starve the others
+
 // the standard blockchain download protocol works as follows (for SPV mode):
 // - local peer sends getblocks
 // - remote peer reponds with inv containing up to 500 block hashes
@@ -133,6 +142,12 @@ typedef struct {
     void (*volatile mempoolCallback)(void *info, int success);
     pthread_t thread;
     pthread_mutex_t lock;
+    BRPeerReactor *reactor; // when non-NULL, connect via the reactor rather than with a thread of our own
+    struct BRPeerReactorLoopStruct *loop; // the reactor loop driving this peer's socket, while connected
+    int loopConnecting, loopFlags; // socket connect is in progress; socket file status flags to restore
+    uint8_t loopHeader[HEADER_LENGTH], *loopPayload; // partially read message
+    size_t loopHeaderLen, loopPayloadLen, loopPayloadCapacity;
+    double loopMsgTimeout;
 } BRPeerContext;
 
 void BRPeerSendVersionMessage(BRPeer *peer);
@@ -865,14 +880,56 @@ static int _BRPeerAcceptMessage(BRPeer *peer, const uint8_t *msg, size_t msgLen,
     return r;
 }
 
-static int _BRPeerOpenSocket(BRPeer *peer, int domain, double timeout, int *error)
+static int _peerCheckAndGetSocket (BRPeerContext *ctx, int *socket) {
+    int exists;
+
+    pthread_mutex_lock(&ctx->lock);
+    exists = ctx->socket >= 0;
+    if (NULL != socket) *socket = ctx->socket;
+    pthread_mutex_unlock(&ctx->lock);
+
+    return exists;
+}
+
+static int _peerGetSocket (BRPeerContext *ctx) {
+    int socket;
+
+    pthread_mutex_lock(&ctx->lock);
+    socket = ctx->socket;
+    pthread_mutex_unlock(&ctx->lock);
+
+    return socket;
+}
+
+static double _peerGetDisconnectTime (BRPeerContext *ctx) {
+    double value;
+
+    pthread_mutex_lock(&ctx->lock);
+    value = ctx->disconnectTime;
+    pthread_mutex_unlock(&ctx->lock);
+
+    return value;
+}
+
+static double _peerGetMempoolTime (BRPeerContext *ctx) {
+    double value;
+
+    pthread_mutex_lock(&ctx->lock);
+    value = ctx->mempoolTime;
+    pthread_mutex_unlock(&ctx->lock);
+
+    return value;
+}
+
+// creates a socket for peer and starts a non-blocking connect, falling back to IPv4 if needed; returns true if the
+// connect completed or, with inProgress set, is underway; flags are the socket's original file status flags
+static int _BRPeerConnectSocket(BRPeer *peer, int domain, int *inProgress, int *flags, int *error)
 {
     BRPeerContext *ctx = (BRPeerContext *)peer;
     struct sockaddr_storage addr;
     struct timeval tv;
-    fd_set fds;
-    socklen_t addrLen, optLen;
-    int count, arg = 0, err = 0, on = 1, r = 1;
+    socklen_t addrLen;
+    int arg = 0, err = 0, on = 1, r = 1;
     int sock;
 
     pthread_mutex_lock(&ctx->lock);
@@ -897,6 +954,9 @@ static int _BRPeerOpenSocket(BRPeer *peer, int domain, double timeout, int *erro
         if (! r) err = errno;
     }
 
+    *inProgress = 0;
+    *flags = arg;
+
     if (r) {
         memset(&addr, 0, sizeof(addr));
         
@@ -917,75 +977,88 @@ static int _BRPeerOpenSocket(BRPeer *peer, int domain, double timeout, int *erro
         
         if (err == EINPROGRESS) {
             err = 0;
-            optLen = sizeof(err);
-            tv.tv_sec  = (long)  timeout;
-            tv.tv_usec = (long) (timeout*1000000) % 1000000;
-            FD_ZERO(&fds);
-            FD_SET(sock, &fds);
-            count = select(sock + 1, NULL, &fds, NULL, &tv);
-
-            if (count <= 0 || getsockopt(sock, SOL_SOCKET, SO_ERROR, &err, &optLen) < 0 || err) {
-                if (count == 0) err = ETIMEDOUT;
-                if (count < 0 || ! err) err = errno;
-                r = 0;
-            }
+            *inProgress = 1;
         }
         else if (err && domain == PF_INET6 && _BRPeerIsIPv4(peer)) {
-            return _BRPeerOpenSocket(peer, PF_INET, timeout, error); // fallback to IPv4
+            pthread_mutex_lock(&ctx->lock);
+            ctx->socket = -1;
+            pthread_mutex_unlock(&ctx->lock);
+            close(sock);
+            return _BRPeerConnectSocket(peer, PF_INET, inProgress, flags, error); // fallback to IPv4
         }
         else if (err) r = 0;
-
-        if (r) peer_log(peer, "socket connected");
-        fcntl(sock, F_SETFL, arg); // restore socket non-blocking status
     }
 
-    if (! r && err) peer_log(peer, "connect error: %s", strerror(err));
     if (error && err) *error = err;
     return r;
 }
 
-static int _peerCheckAndGetSocket (BRPeerContext *ctx, int *socket) {
-    int exists;
+static int _BRPeerOpenSocket(BRPeer *peer, int domain, double timeout, int *error)
+{
+    BRPeerContext *ctx = (BRPeerContext *)peer;
+    struct timeval tv;
+    fd_set fds;
+    socklen_t optLen;
+    int count, arg = 0, err = 0, inProgress = 0, r;
+    int sock;
 
-    pthread_mutex_lock(&ctx->lock);
-    exists = ctx->socket >= 0;
-    if (NULL != socket) *socket = ctx->socket;
-    pthread_mutex_unlock(&ctx->lock);
+    r = _BRPeerConnectSocket(peer, domain, &inProgress, &arg, &err);
+    sock = _peerGetSocket(ctx);
 
-    return exists;
-}
+    if (r && inProgress) {
+        optLen = sizeof(err);
+        tv.tv_sec  = (long)  timeout;
+        tv.tv_usec = (long) (timeout*1000000) % 1000000;
+        FD_ZERO(&fds);
+        FD_SET(sock, &fds);
+        count = select(sock + 1, NULL, &fds, NULL, &tv);
 
-static int _peerGetSocket (BRPeerContext *ctx) {
-    int socket;
+        if (count <= 0 || getsockopt(sock, SOL_SOCKET, SO_ERROR, &err, &optLen) < 0 || err) {
+            if (count == 0) err = ETIMEDOUT;
+            if (count < 0 || ! err) err = errno;
+            r = 0;
+        }
+    }
 
-    pthread_mutex_lock(&ctx->lock);
-    socket = ctx->socket;
-    pthread_mutex_unlock(&ctx->lock);
+    if (sock >= 0 && arg >= 0) {
+        if (r) peer_log(peer, "socket connected");
+        fcntl(sock, F_SETFL, arg); // restore socket non-blocking status
+    }
 
-    return socket;
+    if (! r && err) peer_log(peer, "connect error: %s", strerror(err));
+    if (error && err) *error = err;
+    return r;
 }
 
-static double _peerGetDisconnectTime (BRPeerContext *ctx) {
-    double value;
+// closes the socket and completes any outstanding requests; the disconnected callback may free peer
+static void _BRPeerDidDisconnect(BRPeer *peer, int error)
+{
+    BRPeerContext *ctx = (BRPeerContext *)peer;
+    int socket;
 
     pthread_mutex_lock(&ctx->lock);
-    value = ctx->disconnectTime;
+    socket = ctx->socket;
+    ctx->socket = -1;
+    ctx->status = BRPeerStatusDisconnected;
     pthread_mutex_unlock(&ctx->lock);
 
-    return value;
-}
-
-static double _peerGetMempoolTime (BRPeerContext *ctx) {
-    double value;
-
-    pthread_mutex_lock(&ctx->lock);
-    value = ctx->mempoolTime;
-    pthread_mutex_unlock(&ctx->lock);
+    if (socket >= 0) close(socket);
+    peer_log(peer, "disconnected");
+    
+    while (array_count(ctx->pongCallback) > 0) {
+        void (*pongCallback)(void *, int) = ctx->pongCallback[0];
+        void *pongInfo = ctx->pongInfo[0];
+        
+        array_rm(ctx->pongCallback, 0);
+        array_rm(ctx->pongInfo, 0);
+        if (pongCallback) pongCallback(pongInfo, 0);
+    }
 
-    return value;
+    if (ctx->mempoolCallback) ctx->mempoolCallback(ctx->mempoolInfo, 0);
+    ctx->mempoolCallback = NULL;
+    if (ctx->disconnected) ctx->disconnected(ctx->info, error);
 }
 
-
 static void *_peerThreadRoutine(void *arg)
 {
     BRPeer *peer = arg;
@@ -1095,32 +1168,496 @@ static void *_peerThreadRoutine(void *arg)
         free(payload);
     }
 
+    _BRPeerDidDisconnect(peer, error);
+    pthread_cleanup_pop(1);
+    return NULL; // detached threads don't need to return a value
+}
+
+static void _dummyThreadCleanup(void *info)
+{
+}
+
+//
+// Peer Reactor
+//
+// A reactor drives the sockets of many peers from a few threads, each running an epoll loop, rather than blocking a
+// thread per peer in read().  Messages are parsed as bytes arrive and handed to _BRPeerAcceptMessage(), so peer
+// callbacks are made on a loop thread.  Sends remain blocking, exactly as from a peer's own thread.
+//
+typedef struct BRPeerReactorLoopStruct {
+    BRPeerReactor *reactor;
+    int epoll;
+    int wakeup[2]; // non-blocking pipe, written to wake the loop when peers are added or disconnected, or on stop
+    BRPeerContext **peers; // peers with a socket on the loop; only used by the loop's thread
+    BRPeerContext **added; // peers to connect on the loop's thread, added by BRPeerConnect()
+    size_t peersCount; // peers plus added, for balancing peers across loops
+    int stopping;
+    pthread_t thread;
+    pthread_mutex_t lock;
+} BRPeerReactorLoop;
+
+struct BRPeerReactorStruct {
+    BRPeerReactorLoop *loops;
+    size_t loopsCount;
+};
+
+static BRPeerReactor *_peerReactorDefault = NULL;
+static pthread_mutex_t _peerReactorDefaultLock = PTHREAD_MUTEX_INITIALIZER;
+
+#if defined (PEER_REACTOR_SUPPORTED)
+
+static double _peerReactorTime(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + (double)tv.tv_usec/1000000;
+}
+
+static void _peerReactorWake(BRPeerReactorLoop *loop)
+{
+    uint8_t byte = 0;
+
+    // a full pipe already guarantees a wakeup
+    if (write(loop->wakeup[1], &byte, sizeof(byte)) < 0 && errno != EAGAIN) perror("peer reactor wakeup");
+}
+
+static void _peerReactorDrain(BRPeerReactorLoop *loop)
+{
+    uint8_t bytes[64];
+
+    while (read(loop->wakeup[0], bytes, sizeof(bytes)) > 0);
+}
+
+// removes peer from the loop and disconnects it, as when a peer's own thread exits; peer may be freed on return
+static void _peerReactorFinish(BRPeerReactorLoop *loop, BRPeerContext *ctx, int error)
+{
+    void (*threadCleanup)(void *info) = ctx->threadCleanup;
+    void *info = ctx->info;
+    int socket;
+
     pthread_mutex_lock(&ctx->lock);
     socket = ctx->socket;
-    ctx->status = BRPeerStatusDisconnected;
+    ctx->loop = NULL;
     pthread_mutex_unlock(&ctx->lock);
 
-    if (socket >= 0) close(socket);
-    peer_log(peer, "disconnected");
-    
-    while (array_count(ctx->pongCallback) > 0) {
-        void (*pongCallback)(void *, int) = ctx->pongCallback[0];
-        void *pongInfo = ctx->pongInfo[0];
-        
-        array_rm(ctx->pongCallback, 0);
-        array_rm(ctx->pongInfo, 0);
-        if (pongCallback) pongCallback(pongInfo, 0);
+    if (socket >= 0) epoll_ctl(loop->epoll, EPOLL_CTL_DEL, socket, NULL);
+
+    for (size_t i = array_count(loop->peers); i > 0; i--) {
+        if (loop->peers[i - 1] != ctx) continue;
+        array_rm(loop->peers, i - 1);
+        break;
     }
 
-    if (ctx->mempoolCallback) ctx->mempoolCallback(ctx->mempoolInfo, 0);
-    ctx->mempoolCallback = NULL;
-    if (ctx->disconnected) ctx->disconnected(ctx->info, error);
-    pthread_cleanup_pop(1);
-    return NULL; // detached threads don't need to return a value
+    pthread_mutex_lock(&loop->lock);
+    loop->peersCount--;
+    pthread_mutex_unlock(&loop->lock);
+
+    free(ctx->loopPayload);
+    ctx->loopPayload = NULL;
+    ctx->loopPayloadCapacity = 0;
+
+    _BRPeerDidDisconnect(&ctx->peer, error);
+    threadCleanup(info);
 }
 
-static void _dummyThreadCleanup(void *info)
+// the socket is connected; restore its blocking sends and start the handshake, as the per-peer thread does
+static int _peerReactorDidOpen(BRPeerReactorLoop *loop, BRPeerContext *ctx, int socket)
+{
+    struct epoll_event event;
+
+    peer_log(&ctx->peer, "socket connected");
+    fcntl(socket, F_SETFL, ctx->loopFlags); // restore socket non-blocking status
+    ctx->loopConnecting = 0;
+
+    event.events = EPOLLIN;
+    event.data.ptr = ctx;
+    if (epoll_ctl(loop->epoll, EPOLL_CTL_MOD, socket, &event) < 0) return errno;
+
+    ctx->startTime = _peerReactorTime();
+    BRPeerSendVersionMessage(&ctx->peer);
+    return 0;
+}
+
+static void _peerReactorStart(BRPeerReactorLoop *loop, BRPeerContext *ctx)
+{
+    struct epoll_event event;
+    int socket, inProgress = 0, error = 0;
+
+    array_add(loop->peers, ctx);
+    ctx->loopHeaderLen = ctx->loopPayloadLen = 0;
+    ctx->loopMsgTimeout = DBL_MAX;
+
+    if (! _BRPeerConnectSocket(&ctx->peer, PF_INET6, &inProgress, &ctx->loopFlags, &error)) {
+        if (error) peer_log(&ctx->peer, "connect error: %s", strerror(error));
+    }
+    else {
+        socket = _peerGetSocket(ctx);
+        ctx->loopConnecting = 1;
+        event.events = (inProgress) ? EPOLLOUT : EPOLLIN;
+        event.data.ptr = ctx;
+
+        if (epoll_ctl(loop->epoll, EPOLL_CTL_ADD, socket, &event) < 0) error = errno;
+        else if (! inProgress) error = _peerReactorDidOpen(loop, ctx, socket);
+        if (! error) return;
+        peer_log(&ctx->peer, "%s", strerror(error));
+    }
+
+    _peerReactorFinish(loop, ctx, error);
+}
+
+static int _peerReactorDidConnect(BRPeerReactorLoop *loop, BRPeerContext *ctx, int socket)
 {
+    socklen_t optLen = sizeof(int);
+    int err = 0;
+
+    if (getsockopt(socket, SOL_SOCKET, SO_ERROR, &err, &optLen) < 0) err = errno;
+
+    if (err) {
+        peer_log(&ctx->peer, "connect error: %s", strerror(err));
+        return err;
+    }
+
+    return _peerReactorDidOpen(loop, ctx, socket);
+}
+
+static int _peerReactorDidReadMessage(BRPeerContext *ctx)
+{
+    BRPeer *peer = &ctx->peer;
+    const char *type = (const char *)(&ctx->loopHeader[4]);
+    uint32_t msgLen = UInt32GetLE(&ctx->loopHeader[16]);
+    uint32_t checksum = UInt32GetLE(&ctx->loopHeader[20]);
+    UInt256 hash;
+    int error = 0;
+
+    BRSHA256_2(&hash, ctx->loopPayload, msgLen);
+
+    if (UInt32GetLE(&hash) != checksum) { // verify checksum
+        peer_log(peer, "error reading %s, invalid checksum %x, expected %x, payload length:%"PRIu32
+                 ", SHA256_2:%s", type, UInt32GetLE(&hash), checksum, msgLen, u256hex(hash));
+        error = EPROTO;
+    }
+    else if (! _BRPeerAcceptMessage(peer, ctx->loopPayload, msgLen, type)) error = EPROTO;
+
+    ctx->loopHeaderLen = ctx->loopPayloadLen = 0;
+    ctx->loopMsgTimeout = DBL_MAX;
+    return error;
+}
+
+static int _peerReactorDidReadHeader(BRPeerContext *ctx, double time)
+{
+    BRPeer *peer = &ctx->peer;
+    const char *type = (const char *)(&ctx->loopHeader[4]);
+    uint32_t msgLen = UInt32GetLE(&ctx->loopHeader[16]);
+
+    if (ctx->loopHeader[15] != 0) { // verify header type field is NULL terminated
+        peer_log(peer, "malformed message header: type not NULL terminated");
+        return EPROTO;
+    }
+
+    if (msgLen > MAX_MSG_LENGTH) { // check message length
+        peer_log(peer, "error reading %s, message length %"PRIu32" is too long", type, msgLen);
+        return EPROTO;
+    }
+
+    if (msgLen > ctx->loopPayloadCapacity) {
+        ctx->loopPayload = realloc(ctx->loopPayload, (ctx->loopPayloadCapacity = msgLen));
+        assert(ctx->loopPayload != NULL);
+    }
+
+    ctx->loopPayloadLen = 0;
+    ctx->loopMsgTimeout = time + MESSAGE_TIMEOUT;
+    return (msgLen == 0) ? _peerReactorDidReadMessage(ctx) : 0;
+}
+
+// reads what is available on the socket, accepting each message once complete; returns an errno.h code on failure
+static int _peerReactorRead(BRPeerContext *ctx, int socket)
+{
+    BRPeer *peer = &ctx->peer;
+    size_t reads = 0, len;
+    uint8_t *buf;
+    ssize_t n;
+    int error = 0;
+
+    while (! error && reads++ < PEER_REACTOR_READS_MAXIMUM) {
+        if (ctx->loopHeaderLen < HEADER_LENGTH) {
+            buf = &ctx->loopHeader[ctx->loopHeaderLen];
+            len = HEADER_LENGTH - ctx->loopHeaderLen;
+        }
+        else {
+            buf = &ctx->loopPayload[ctx->loopPayloadLen];
+            len = UInt32GetLE(&ctx->loopHeader[16]) - ctx->loopPayloadLen;
+        }
+
+        n = recv(socket, buf, len, MSG_DONTWAIT);
+
+        if (n == 0) error = ECONNRESET;
+        else if (n < 0 && (errno == EWOULDBLOCK || errno == EAGAIN || errno == EINTR)) break;
+        else if (n < 0) error = errno;
+        else if (ctx->loopHeaderLen < HEADER_LENGTH) {
+            ctx->loopHeaderLen += (size_t) n;
+
+            while (sizeof(uint32_t) <= ctx->loopHeaderLen && UInt32GetLE(ctx->loopHeader) != ctx->magicNumber) {
+                // consume one byte at a time until we find the magic number
+                memmove(ctx->loopHeader, &ctx->loopHeader[1], --ctx->loopHeaderLen);
+            }
+
+            if (ctx->loopHeaderLen == HEADER_LENGTH) error = _peerReactorDidReadHeader(ctx, _peerReactorTime());
+        }
+        else {
+            ctx->loopPayloadLen += (size_t) n;
+            ctx->loopMsgTimeout = _peerReactorTime() + MESSAGE_TIMEOUT;
+            if (ctx->loopPayloadLen == UInt32GetLE(&ctx->loopHeader[16])) error = _peerReactorDidReadMessage(ctx);
+        }
+
+        if (error && error != EPROTO) peer_log(peer, "%s", strerror(error));
+    }
+
+    return error;
+}
+
+static void _peerReactorService(BRPeerReactorLoop *loop, BRPeerContext *ctx, uint32_t events)
+{
+    int socket = _peerGetSocket(ctx), error = 0;
+
+    if (socket < 0) return;
+    if (ctx->loopConnecting) error = _peerReactorDidConnect(loop, ctx, socket);
+    else if (events & (EPOLLIN | EPOLLERR | EPOLLHUP)) error = _peerReactorRead(ctx, socket);
+    if (error) _peerReactorFinish(loop, ctx, error);
+}
+
+// the checks the per-peer thread makes between reads; returns an errno.h code if peer must disconnect
+static int _peerReactorCheck(BRPeerContext *ctx, double time)
+{
+    BRPeer *peer = &ctx->peer;
+    int error = 0;
+
+    if (BRPeerConnectStatus(peer) == BRPeerStatusDisconnected) error = ECONNRESET; // BRPeerDisconnect() was called
+    else if (time >= _peerGetDisconnectTime(ctx) || time >= ctx->loopMsgTimeout) error = ETIMEDOUT;
+
+    if (error) {
+        peer_log(peer, "%s", strerror(error));
+    }
+    else if (! ctx->loopConnecting && time >= _peerGetMempoolTime(ctx)) {
+        peer_log(peer, "done waiting for mempool response");
+        BRPeerSendPing(peer, ctx->mempoolInfo, ctx->mempoolCallback);
+        ctx->mempoolCallback = NULL;
+
+        pthread_mutex_lock(&ctx->lock);
+        ctx->mempoolTime = DBL_MAX;
+        pthread_mutex_unlock(&ctx->lock);
+    }
+
+    return error;
+}
+
+static void *_peerReactorThreadRoutine(void *arg)
+{
+    BRPeerReactorLoop *loop = arg;
+    struct epoll_event events[PEER_REACTOR_EVENTS_COUNT];
+    BRPeerContext **added;
+    double time, checkTime = 0;
+    int count, woken, stopping = 0;
+
+    pthread_setname_brd(pthread_self(), "Core BTX Reactor");
+    array_new(added, 10);
+
+    while (! stopping) {
+        count = epoll_wait(loop->epoll, events, PEER_REACTOR_EVENTS_COUNT, PEER_REACTOR_TIMEOUT_MS);
+        woken = 0;
+
+        pthread_mutex_lock(&loop->lock);
+        stopping = loop->stopping;
+        array_add_array(added, loop->added, array_count(loop->added));
+        array_clear(loop->added);
+        pthread_mutex_unlock(&loop->lock);
+
+        // once stopping, added peers are never connected; they are disconnected below, along with the others
+        for (size_t i = 0; i < array_count(added); i++) {
+            if (stopping) array_add(loop->peers, added[i]);
+            else _peerReactorStart(loop, added[i]);
+        }
+
+        array_clear(added);
+
+        // each socket appears at most once per epoll_wait(), so a peer finished here has no other events pending
+        for (int i = 0; i < count; i++) {
+            if (events[i].data.ptr == NULL) _peerReactorDrain(loop), woken = 1;
+            else _peerReactorService(loop, events[i].data.ptr, events[i].events);
+        }
+
+        time = _peerReactorTime();
+
+        if (woken || stopping || time >= checkTime) {
+            checkTime = time + PEER_REACTOR_TIMEOUT_MS/1000.0;
+
+            for (size_t i = array_count(loop->peers); i > 0; i--) {
+                BRPeerContext *ctx = loop->peers[i - 1];
+                int error = (stopping) ? ECANCELED : _peerReactorCheck(ctx, time);
+
+                if (error) _peerReactorFinish(loop, ctx, error);
+            }
+        }
+    }
+
+    array_free(added);
+    return NULL;
+}
+
+// adds a connecting peer to the loop with the fewest peers; called with ctx->lock held
+static int _peerReactorAdd(BRPeerReactor *reactor, BRPeerContext *ctx)
+{
+    BRPeerReactorLoop *loop = NULL;
+    size_t peersCount = SIZE_MAX;
+    int r = 0;
+
+    for (size_t i = 0; i < reactor->loopsCount; i++) {
+        pthread_mutex_lock(&reactor->loops[i].lock);
+        if (reactor->loops[i].peersCount < peersCount) {
+            loop = &reactor->loops[i];
+            peersCount = loop->peersCount;
+        }
+        pthread_mutex_unlock(&reactor->loops[i].lock);
+    }
+
+    if (loop) {
+        pthread_mutex_lock(&loop->lock);
+
+        if (! loop->stopping) {
+            array_add(loop->added, ctx);
+            loop->peersCount++;
+            ctx->loop = loop;
+            r = 1;
+        }
+
+        pthread_mutex_unlock(&loop->lock);
+    }
+
+    if (r) _peerReactorWake(loop);
+    return r;
+}
+
+static void _peerReactorLoopRelease(BRPeerReactorLoop *loop)
+{
+    if (loop->epoll >= 0) close(loop->epoll);
+    if (loop->wakeup[0] >= 0) close(loop->wakeup[0]);
+    if (loop->wakeup[1] >= 0) close(loop->wakeup[1]);
+    if (loop->peers) array_free(loop->peers);
+    if (loop->added) array_free(loop->added);
+    pthread_mutex_destroy(&loop->lock);
+}
+
+static int _peerReactorLoopInit(BRPeerReactorLoop *loop, BRPeerReactor *reactor)
+{
+    struct epoll_event event;
+    pthread_attr_t attr;
+    int r = 1;
+
+    loop->reactor = reactor;
+    loop->epoll = epoll_create1(EPOLL_CLOEXEC);
+    loop->wakeup[0] = loop->wakeup[1] = -1;
+    array_new(loop->peers, 10);
+    array_new(loop->added, 10);
+
+    {
+        pthread_mutexattr_t mutexAttr;
+        pthread_mutexattr_init(&mutexAttr);
+        pthread_mutexattr_settype(&mutexAttr, PTHREAD_MUTEX_NORMAL);
+        pthread_mutex_init(&loop->lock, &mutexAttr);
+        pthread_mutexattr_destroy(&mutexAttr);
+    }
+
+    event.events = EPOLLIN;
+    event.data.ptr = NULL; // the wakeup pipe, distinguished from any peer
+
+    if (loop->epoll < 0 || pipe(loop->wakeup) < 0 ||
+        fcntl(loop->wakeup[0], F_SETFL, O_NONBLOCK) < 0 || fcntl(loop->wakeup[1], F_SETFL, O_NONBLOCK) < 0 ||
+        epoll_ctl(loop->epoll, EPOLL_CTL_ADD, loop->wakeup[0], &event) < 0) r = 0;
+
+    if (r && pthread_attr_init(&attr) != 0) r = 0;
+    else if (r) {
+        if (pthread_attr_setstacksize(&attr, PTHREAD_STACK_SIZE) != 0 ||
+            pthread_create(&loop->thread, &attr, _peerReactorThreadRoutine, loop) != 0) r = 0;
+        pthread_attr_destroy(&attr);
+    }
+
+    if (! r) _peerReactorLoopRelease(loop);
+    return r;
+}
+
+#endif // defined (PEER_REACTOR_SUPPORTED)
+
+// returns a newly allocated reactor with threadCount loop threads, or NULL if unsupported on this platform; free it by
+// calling BRPeerReactorFree()
+BRPeerReactor *BRPeerReactorNew(size_t threadCount)
+{
+#if defined (PEER_REACTOR_SUPPORTED)
+    BRPeerReactor *reactor = calloc(1, sizeof(*reactor));
+
+    assert(reactor != NULL);
+    assert(threadCount > 0);
+    reactor->loops = calloc(threadCount, sizeof(*reactor->loops));
+    assert(reactor->loops != NULL);
+
+    while (reactor->loopsCount < threadCount && _peerReactorLoopInit(&reactor->loops[reactor->loopsCount], reactor)) {
+        reactor->loopsCount++;
+    }
+
+    if (reactor->loopsCount < threadCount) {
+        BRPeerReactorFree(reactor);
+        reactor = NULL;
+    }
+
+    return reactor;
+#else
+    return NULL;
+#endif
+}
+
+// stops the reactor's threads, first disconnecting any peers still on them; must not be called from a peer callback
+void BRPeerReactorFree(BRPeerReactor *reactor)
+{
+    assert(reactor != NULL);
+
+    pthread_mutex_lock(&_peerReactorDefaultLock);
+    if (_peerReactorDefault == reactor) _peerReactorDefault = NULL;
+    pthread_mutex_unlock(&_peerReactorDefaultLock);
+
+#if defined (PEER_REACTOR_SUPPORTED)
+    for (size_t i = 0; i < reactor->loopsCount; i++) {
+        BRPeerReactorLoop *loop = &reactor->loops[i];
+
+        pthread_mutex_lock(&loop->lock);
+        loop->stopping = 1;
+        pthread_mutex_unlock(&loop->lock);
+
+        _peerReactorWake(loop);
+        pthread_join(loop->thread, NULL);
+        _peerReactorLoopRelease(loop);
+    }
+#endif
+
+    free(reactor->loops);
+    free(reactor);
+}
+
+// the reactor assigned to each subsequent BRPeerNew() peer; NULL, the default, for a thread per connected peer
+void BRPeerReactorSetDefault(BRPeerReactor *reactor)
+{
+    pthread_mutex_lock(&_peerReactorDefaultLock);
+    _peerReactorDefault = reactor;
+    pthread_mutex_unlock(&_peerReactorDefaultLock);
+}
+
+BRPeerReactor *BRPeerReactorGetDefault(void)
+{
+    BRPeerReactor *reactor;
+
+    pthread_mutex_lock(&_peerReactorDefaultLock);
+    reactor = _peerReactorDefault;
+    pthread_mutex_unlock(&_peerReactorDefaultLock);
+
+    return reactor;
 }
 
 // returns a newly allocated BRPeer struct that must be freed by calling BRPeerFree()
@@ -1142,6 +1679,7 @@ BRPeer *BRPeerNew(uint32_t magicNumber)
     ctx->disconnectTime = DBL_MAX;
     ctx->socket = -1;
     ctx->threadCleanup = _dummyThreadCleanup;
+    ctx->reactor = BRPeerReactorGetDefault();
 
     {
         pthread_mutexattr_t attr;
@@ -1198,6 +1736,17 @@ void BRPeerSetCallbacks(BRPeer *peer, void *info,
     ctx->threadCleanup = (threadCleanup) ? threadCleanup : _dummyThreadCleanup;
 }
 
+// drive peer's socket from reactor, or from a thread of its own if NULL; call only while peer is disconnected
+void BRPeerSetReactor(BRPeer *peer, BRPeerReactor *reactor)
+{
+    BRPeerContext *ctx = (BRPeerContext *)peer;
+
+    pthread_mutex_lock(&ctx->lock);
+    assert(ctx->status == BRPeerStatusDisconnected);
+    ctx->reactor = reactor;
+    pthread_mutex_unlock(&ctx->lock);
+}
+
 // set earliestKeyTime to wallet creation time in order to speed up initial sync
 void BRPeerSetEarliestKeyTime(BRPeer *peer, uint32_t earliestKeyTime)
 {
@@ -1246,7 +1795,16 @@ void BRPeerConnect(BRPeer *peer)
             // No race - set before the thread starts.
             ctx->disconnectTime = tv.tv_sec + (double)tv.tv_usec/1000000 + CONNECT_TIMEOUT;
 
-            if (pthread_attr_init(&attr) != 0) {
+            if (ctx->reactor) {
+#if defined (PEER_REACTOR_SUPPORTED)
+                if (! _peerReactorAdd(ctx->reactor, ctx))
+#endif
+                {
+                    peer_log(peer, "error adding to reactor");
+                    ctx->status = BRPeerStatusDisconnected;
+                }
+            }
+            else if (pthread_attr_init(&attr) != 0) {
                 // error = ENOMEM;
                 peer_log(peer, "error creating thread");
                 ctx->status = BRPeerStatusDisconnected;
@@ -1273,12 +1831,34 @@ void BRPeerDisconnect(BRPeer *peer)
     int socket = -1;
 
     if (_peerCheckAndGetSocket(ctx, &socket)) {
+#if defined (PEER_REACTOR_SUPPORTED)
+        struct BRPeerReactorLoopStruct *loop = NULL;
+#endif
+        int reactor;
+
         pthread_mutex_lock(&ctx->lock);
         ctx->status = BRPeerStatusDisconnected;
+        reactor = (NULL != ctx->reactor);
+
+        // with a reactor, the loop closes the socket once done with it; shut down while it's sure to be open
+        if (reactor) {
+            socket = ctx->socket;
+#if defined (PEER_REACTOR_SUPPORTED)
+            loop = ctx->loop;
+#endif
+            if (socket >= 0 && shutdown(socket, SHUT_RDWR) < 0) peer_log(peer, "%s", strerror(errno));
+        }
+
         pthread_mutex_unlock(&ctx->lock);
 
-        if (shutdown(socket, SHUT_RDWR) < 0) peer_log(peer, "%s", strerror(errno));
-        close(socket);
+#if defined (PEER_REACTOR_SUPPORTED)
+        if (loop) _peerReactorWake(loop);
+#endif
+
+        if (! reactor) {
+            if (shutdown(socket, SHUT_RDWR) < 0) peer_log(peer, "%s", strerror(errno));
+            close(socket);
+        }
     }
 }
 
@@ -1644,6 +2224,7 @@ void BRPeerFree(BRPeer *peer)
     if (ctx->knownTxHashSet) BRSetFree(ctx->knownTxHashSet);
     if (ctx->pongCallback) array_free(ctx->pongCallback);
     if (ctx->pongInfo) array_free(ctx->pongInfo);
+    if (ctx->loopPayload) free(ctx->loopPayload);
     
     pthread_mutex_destroy(&ctx->lock);
     free(ctx);
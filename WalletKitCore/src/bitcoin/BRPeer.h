@@ -108,9 +108,30 @@ typedef struct {
 
 // NOTE: BRPeer functions are not thread-safe
 
+// a reactor drives the sockets of many peers from a few epoll threads, in place of a thread per connected peer; the
+// per-peer callbacks, including threadCleanup() once a peer disconnects, are then made on a reactor thread
+typedef struct BRPeerReactorStruct BRPeerReactor;
+
+// returns a newly allocated reactor with threadCount threads, or NULL if unsupported on this platform (epoll is Linux
+// only); must be freed by calling BRPeerReactorFree()
+BRPeerReactor *BRPeerReactorNew(size_t threadCount);
+
+// disconnects any peers still on the reactor and stops its threads; must not be called from a peer callback
+void BRPeerReactorFree(BRPeerReactor *reactor);
+
+// the reactor for subsequently created peers; NULL, the default, gives each connected peer a thread of its own
+void BRPeerReactorSetDefault(BRPeerReactor *reactor);
+BRPeerReactor *BRPeerReactorGetDefault(void);
+
 // returns a newly allocated BRPeer struct that must be freed by calling BRPeerFree()
 BRPeer *BRPeerNew(uint32_t magicNumber);
 
+// drive peer's socket from reactor, or from a thread of its own if NULL; call only while peer is disconnected
+// NOTE: sends are blocking writes, each bounded by the socket's one second send timeout, so a send from a peer callback
+// that finds the peer's send buffer full stalls the reactor thread, and every peer on it, until the write completes;
+// with many peers per thread, avoid sending large messages (getdata, tx batches) from callbacks to slow peers
+void BRPeerSetReactor(BRPeer *peer, BRPeerReactor *reactor);
+
 // info is a void pointer that will be passed along with each callback call
 // void connected(void *) - called when peer handshake completes successfully
 // void disconnected(void *, int) - called when peer connection is closed, error is an errno.h code
@@ -26,6 +26,7 @@
 #include "support/BRSet.h"
 #include "support/BRAddress.h"
 #include "support/BRArray.h"
+#include "support/BROSCompat.h"
 #include <stdlib.h>
 #include <inttypes.h>
 #include <limits.h>
@@ -51,30 +52,28 @@ inline static uint64_t _txFee(uint64_t feePerKb, size_t size)
     return (fee > standardFee) ? fee : standardFee;
 }
 
-// chain position of first tx output address that appears in chain
-inline static size_t _txChainIndex(const BRTransaction *tx, const UInt160 *chain)
-{
-    const uint8_t *pkh;
-    
-    for (size_t i = array_count(chain); i > 0; i--) {
-        for (size_t j = 0; j < tx->outCount; j++) {
-            pkh = BRScriptPKH(tx->outputs[j].script, tx->outputs[j].scriptLen);
-            if (pkh && _pkhEq(pkh, &chain[i - 1])) return i - 1;
-        }
-    }
-    
-    return (size_t) -1;
-}
+// an unspent output in the wallet's coin selection table
+typedef struct {
+    BRUTXO utxo;
+    uint64_t amount;
+    uint32_t weight; // estimated BIP141 weight of an input spending utxo
+    int64_t value; // effective value: amount less the fee for an input spending utxo at the table's feePerKb
+} _BRWalletCoin;
 
 struct BRWalletStruct {
     uint64_t balance, totalSent, totalReceived, feePerKb, *balanceHist;
     uint32_t blockHeight;
+    int pendingSpends; // true if pending tx have spent outputs that are still in utxos
     BRUTXO *utxos;
+    BRWalletCoinSelection coinSelection;
+    _BRWalletCoin *coins; // utxos by descending effective value at coinsFeePerKb, rebuilt when coinsStale is set
+    uint64_t coinsFeePerKb;
+    int coinsStale; // true if utxos have changed since coins was built
     BRTransaction **transactions;
     BRMasterPubKey masterPubKey;
     BRAddressParams addrParams;
     UInt160 *internalChain, *externalChain;
-    BRSet *allTx, *invalidTx, *pendingTx, *spentOutputs, *usedPKH, *allPKH;
+    BRSet *allTx, *invalidTx, *pendingTx, *spentOutputs, *usedPKH, *allPKH, *txGraph;
     void *callbackInfo;
     void (*balanceChanged)(void *info, uint64_t balance);
     void (*txAdded)(void *info, BRTransaction *tx);
@@ -83,52 +82,262 @@ struct BRWalletStruct {
     pthread_mutex_t lock;
 };
 
-inline static int _BRWalletTxIsAscending(BRWallet *wallet, const BRTransaction *tx1, const BRTransaction *tx2)
+// allPKH holds pointers into internalChain and externalChain, so the set also serves as a pkh -> (chain, index) index;
+// sets chain and index and returns true if pkh was generated by BRWalletUnusedAddrs()
+inline static int _BRWalletPKHPosition(BRWallet *wallet, const void *pkh, uint32_t *chain, uint32_t *index)
 {
-    if (! tx1 || ! tx2) return 0;
-    if (tx1->blockHeight > tx2->blockHeight) return 1;
-    if (tx1->blockHeight < tx2->blockHeight) return 0;
-    
-    for (size_t i = 0; i < tx1->inCount; i++) {
-        if (UInt256Eq(tx1->inputs[i].txHash, tx2->txHash)) return 1;
+    const UInt160 *p = BRSetGet(wallet->allPKH, pkh);
+    uintptr_t internal = (uintptr_t)wallet->internalChain;
+
+    if (! p) return 0;
+
+    if ((uintptr_t)p >= internal && (uintptr_t)p < internal + array_count(wallet->internalChain)*sizeof(*p)) {
+        *chain = SEQUENCE_INTERNAL_CHAIN;
+        *index = (uint32_t)(p - wallet->internalChain);
     }
-    
-    for (size_t i = 0; i < tx2->inCount; i++) {
-        if (UInt256Eq(tx2->inputs[i].txHash, tx1->txHash)) return 0;
+    else {
+        *chain = SEQUENCE_EXTERNAL_CHAIN;
+        *index = (uint32_t)(p - wallet->externalChain);
     }
 
-    for (size_t i = 0; i < tx1->inCount; i++) {
-        if (_BRWalletTxIsAscending(wallet, BRSetGet(wallet->allTx, &(tx1->inputs[i].txHash)), tx2)) return 1;
+    return 1;
+}
+
+// highest chain position of any tx output address that appears in chain, or -1 if none do
+inline static size_t _BRWalletTxChainIndex(BRWallet *wallet, const BRTransaction *tx, uint32_t chain)
+{
+    const uint8_t *pkh;
+    uint32_t c, n;
+    size_t i = (size_t) -1;
+
+    for (size_t j = 0; j < tx->outCount; j++) {
+        pkh = BRScriptPKH(tx->outputs[j].script, tx->outputs[j].scriptLen);
+        if (! pkh || ! _BRWalletPKHPosition(wallet, pkh, &c, &n) || c != chain) continue;
+        if (i == (size_t) -1 || n > i) i = n;
     }
 
-    return 0;
+    return i;
+}
+
+// a node in the wallet's tx dependency graph, for a wallet tx and/or a tx that wallet tx spend outputs of
+typedef struct {
+    UInt256 txHash; // must be first, so that nodes can be hashed and compared as BRTransaction
+    BRTransaction *tx; // wallet tx with txHash, or NULL if not a wallet tx
+    uint32_t depth; // length of the longest chain of wallet tx in the same block that tx spends from
+    BRTransaction **spenders; // wallet tx that spend outputs of txHash
+} _BRWalletTxNode;
+
+static _BRWalletTxNode *_BRWalletTxNodeGet(BRWallet *wallet, UInt256 txHash)
+{
+    _BRWalletTxNode *node = BRSetGet(wallet->txGraph, &txHash);
+
+    if (! node) {
+        node = calloc(1, sizeof(*node));
+        assert(node != NULL);
+        node->txHash = txHash;
+        array_new(node->spenders, 1);
+        BRSetAdd(wallet->txGraph, node);
+    }
+
+    return node;
+}
+
+static void _BRWalletTxNodeRelease(BRWallet *wallet, _BRWalletTxNode *node)
+{
+    if (node->tx || array_count(node->spenders) > 0) return;
+    BRSetRemove(wallet->txGraph, node);
+    array_free(node->spenders);
+    free(node);
+}
+
+inline static uint32_t _BRWalletTxDepth(BRWallet *wallet, const BRTransaction *tx)
+{
+    _BRWalletTxNode *node = BRSetGet(wallet->txGraph, tx);
+
+    return (node && node->tx == tx) ? node->depth : 0;
+}
+
+// depth of tx computed from the wallet tx in the same block that it spends outputs of
+static uint32_t _BRWalletTxParentsDepth(BRWallet *wallet, const BRTransaction *tx)
+{
+    _BRWalletTxNode *parent;
+    uint32_t depth = 0;
+
+    for (size_t i = 0; i < tx->inCount; i++) {
+        parent = BRSetGet(wallet->txGraph, &tx->inputs[i].txHash);
+        if (parent && parent->tx && parent->tx->blockHeight == tx->blockHeight && parent->depth + 1 > depth)
+            depth = parent->depth + 1;
+    }
+
+    return depth;
+}
+
+// adds tx to the dependency graph as a wallet tx, and as a spender of each tx it has inputs from
+static _BRWalletTxNode *_BRWalletTxGraphAdd(BRWallet *wallet, BRTransaction *tx)
+{
+    _BRWalletTxNode *node, *parent;
+
+    for (size_t i = 0; i < tx->inCount; i++) {
+        parent = _BRWalletTxNodeGet(wallet, tx->inputs[i].txHash);
+        if (array_count(parent->spenders) == 0 || parent->spenders[array_count(parent->spenders) - 1] != tx)
+            array_add(parent->spenders, tx);
+    }
+
+    node = _BRWalletTxNodeGet(wallet, tx->txHash);
+    node->tx = tx;
+    node->depth = _BRWalletTxParentsDepth(wallet, tx);
+    return node;
+}
+
+// removes tx from the dependency graph
+static void _BRWalletTxGraphRemove(BRWallet *wallet, BRTransaction *tx)
+{
+    _BRWalletTxNode *node, *parent;
+
+    for (size_t i = 0; i < tx->inCount; i++) {
+        parent = BRSetGet(wallet->txGraph, &tx->inputs[i].txHash);
+        if (! parent) continue;
+
+        for (size_t j = array_count(parent->spenders); j > 0; j--) {
+            if (parent->spenders[j - 1] == tx) array_rm(parent->spenders, j - 1);
+        }
+
+        _BRWalletTxNodeRelease(wallet, parent);
+    }
+
+    node = BRSetGet(wallet->txGraph, tx);
+
+    if (node && node->tx == tx) {
+        node->tx = NULL;
+        node->depth = 0;
+        _BRWalletTxNodeRelease(wallet, node);
+    }
 }
 
-inline static int _BRWalletTxCompare(BRWallet *wallet, const BRTransaction *tx1, const BRTransaction *tx2)
+// orders tx by block height, then after any wallet tx in the same block that they spend outputs of (depth), then by
+// chain position of their outputs
+inline static int _BRWalletTxCompare(BRWallet *wallet, const BRTransaction *tx1, uint32_t depth1,
+                                     const BRTransaction *tx2, uint32_t depth2)
 {
     size_t i = (size_t) -1, j = (size_t) -1;
 
-    if (_BRWalletTxIsAscending(wallet, tx1, tx2)) return 1;
-    if (_BRWalletTxIsAscending(wallet, tx2, tx1)) return -1;
-    if ((i = _txChainIndex(tx1, wallet->internalChain)) != -1) j = _txChainIndex(tx2, wallet->internalChain);
-    if (j == -1 && (i = _txChainIndex(tx1, wallet->externalChain)) != -1) j = _txChainIndex(tx2, wallet->externalChain);
+    if (tx1->blockHeight != tx2->blockHeight) return (tx1->blockHeight > tx2->blockHeight) ? 1 : -1;
+    if (depth1 != depth2) return (depth1 > depth2) ? 1 : -1;
+    if ((i = _BRWalletTxChainIndex(wallet, tx1, SEQUENCE_INTERNAL_CHAIN)) != -1) {
+        j = _BRWalletTxChainIndex(wallet, tx2, SEQUENCE_INTERNAL_CHAIN);
+    }
+
+    if (j == -1 && (i = _BRWalletTxChainIndex(wallet, tx1, SEQUENCE_EXTERNAL_CHAIN)) != -1) {
+        j = _BRWalletTxChainIndex(wallet, tx2, SEQUENCE_EXTERNAL_CHAIN);
+    }
+
     if (i != -1 && j != -1 && i != j) return (i > j) ? 1 : -1;
     return 0;
 }
 
-// inserts tx into wallet->transactions, keeping wallet->transactions sorted by date, oldest first (insertion sort)
-inline static void _BRWalletInsertTx(BRWallet *wallet, BRTransaction *tx)
+// index of tx in wallet->transactions, found by binary search on its block height and depth, or -1 if not found
+static size_t _BRWalletTxIndex(BRWallet *wallet, const BRTransaction *tx, uint32_t depth)
 {
-    size_t i = array_count(wallet->transactions);
-    
-    array_set_count(wallet->transactions, i + 1);
-    
-    while (i > 0 && _BRWalletTxCompare(wallet, wallet->transactions[i - 1], tx) > 0) {
-        wallet->transactions[i] = wallet->transactions[i - 1];
-        i--;
+    size_t lo = 0, hi = array_count(wallet->transactions), mid;
+    const BRTransaction *t;
+
+    while (lo < hi) { // first tx at or after tx's block height and depth
+        mid = lo + (hi - lo)/2;
+        t = wallet->transactions[mid];
+
+        if (t->blockHeight < tx->blockHeight ||
+            (t->blockHeight == tx->blockHeight && _BRWalletTxDepth(wallet, t) < depth)) lo = mid + 1;
+        else hi = mid;
     }
-    
-    wallet->transactions[i] = tx;
+
+    for (; lo < array_count(wallet->transactions); lo++) {
+        t = wallet->transactions[lo];
+        if (t == tx) return lo;
+        if (t->blockHeight != tx->blockHeight || _BRWalletTxDepth(wallet, t) != depth) break;
+    }
+
+    return (size_t) -1;
+}
+
+// inserts the wallet tx for node into wallet->transactions by binary search, then moves any of its spenders in the
+// same block to follow it; returns the lowest index in wallet->transactions that changed
+static size_t _BRWalletPlaceTx(BRWallet *wallet, _BRWalletTxNode *node)
+{
+    BRTransaction *tx = node->tx, *t;
+    _BRWalletTxNode *spender;
+    size_t lo = 0, hi = array_count(wallet->transactions), mid, i, first;
+
+    while (lo < hi) { // after every tx that compares less than or equal to tx
+        mid = lo + (hi - lo)/2;
+        t = wallet->transactions[mid];
+        if (_BRWalletTxCompare(wallet, t, _BRWalletTxDepth(wallet, t), tx, node->depth) > 0) hi = mid;
+        else lo = mid + 1;
+    }
+
+    array_insert(wallet->transactions, lo, tx);
+    first = lo;
+
+    for (size_t j = 0; j < array_count(node->spenders); j++) {
+        t = node->spenders[j];
+        spender = BRSetGet(wallet->txGraph, t);
+        if (t->blockHeight != tx->blockHeight || ! spender || spender->tx != t || spender->depth > node->depth) continue;
+        i = _BRWalletTxIndex(wallet, t, spender->depth);
+        if (i == -1) continue;
+        array_rm(wallet->transactions, i);
+        if (i < first) first = i;
+        spender->depth = node->depth + 1;
+        i = _BRWalletPlaceTx(wallet, spender);
+        if (i < first) first = i;
+    }
+
+    return first;
+}
+
+// inserts tx into wallet->transactions, keeping wallet->transactions sorted by date, oldest first, with every tx
+// following any wallet tx in the same block that it spends outputs of; returns the lowest index that changed
+inline static size_t _BRWalletInsertTx(BRWallet *wallet, BRTransaction *tx)
+{
+    return _BRWalletPlaceTx(wallet, _BRWalletTxGraphAdd(wallet, tx));
+}
+
+static int _BRWalletTxNodeDepthCompare(const void *node1, const void *node2)
+{
+    uint32_t d1 = (*(_BRWalletTxNode * const *)node1)->depth, d2 = (*(_BRWalletTxNode * const *)node2)->depth;
+
+    return (d1 < d2) ? -1 : ((d1 > d2) ? 1 : 0);
+}
+
+// recomputes the depth of wallet->transactions from index i on, and re-sorts them by it; these tx must all be in the
+// same block, and each must already follow any of the others that it spends outputs of
+static void _BRWalletTxReorderFrom(BRWallet *wallet, size_t i)
+{
+    size_t count = array_count(wallet->transactions) - i;
+    _BRWalletTxNode **nodes, *node;
+
+    if (count == 0) return;
+    array_new(nodes, count);
+
+    for (size_t j = i; j < array_count(wallet->transactions); j++) {
+        node = BRSetGet(wallet->txGraph, wallet->transactions[j]);
+        assert(node != NULL && node->tx == wallet->transactions[j]);
+        node->depth = _BRWalletTxParentsDepth(wallet, node->tx);
+        array_add(nodes, node);
+    }
+
+    mergesort_brd(nodes, count, sizeof(*nodes), _BRWalletTxNodeDepthCompare);
+    for (size_t j = 0; j < count; j++) wallet->transactions[i + j] = nodes[j]->tx;
+    array_free(nodes);
+}
+
+// removes tx from wallet->transactions, returning false if it wasn't found
+static int _BRWalletRemoveTx(BRWallet *wallet, BRTransaction *tx)
+{
+    size_t i = _BRWalletTxIndex(wallet, tx, _BRWalletTxDepth(wallet, tx));
+
+    if (i == -1) return 0;
+    array_rm(wallet->transactions, i);
+    _BRWalletTxGraphRemove(wallet, tx);
+    return 1;
 }
 
 // non-threadsafe version of BRWalletContainsTransaction()
@@ -161,100 +370,195 @@ static int _BRWalletContainsTx(BRWallet *wallet, const BRTransaction *tx)
     return r;
 }
 
-static void _BRWalletUpdateBalance(BRWallet *wallet)
+// applies tx, the next transaction in wallet->transactions, to the invalid, pending and spent output sets, the UTXO
+// set and the balance history
+static void _BRWalletApplyTx(BRWallet *wallet, BRTransaction *tx, time_t now)
 {
     int isInvalid, isPending;
-    uint64_t balance = 0, prevBalance = 0;
-    time_t now = time(NULL);
-    size_t i, j;
-    BRTransaction *tx, *t;
+    uint64_t balance = wallet->balance, prevBalance = wallet->balance;
+    size_t j, k;
+    BRTransaction *t;
     const uint8_t *pkh;
-    
+
+    // check if any inputs are invalid or already spent
+    if (tx->blockHeight == TX_UNCONFIRMED) {
+        for (j = 0, isInvalid = 0; ! isInvalid && j < tx->inCount; j++) {
+            if (BRSetContains(wallet->spentOutputs, &tx->inputs[j]) ||
+                BRSetContains(wallet->invalidTx, &tx->inputs[j].txHash)) isInvalid = 1;
+        }
+
+        if (isInvalid) {
+            BRSetAdd(wallet->invalidTx, tx);
+            array_add(wallet->balanceHist, balance);
+            return;
+        }
+    }
+
+    // add inputs to spent output set
+    for (j = 0; j < tx->inCount; j++) {
+        BRSetAdd(wallet->spentOutputs, &tx->inputs[j]);
+    }
+
+    // check if tx is pending
+    if (tx->blockHeight == TX_UNCONFIRMED) {
+        isPending = (BRTransactionVSize(tx) > TX_MAX_SIZE) ? 1 : 0; // check tx size is under TX_MAX_SIZE
+
+        for (j = 0; ! isPending && j < tx->outCount; j++) {
+            if (tx->outputs[j].amount < TX_MIN_OUTPUT_AMOUNT) isPending = 1; // check that no outputs are dust
+        }
+
+        for (j = 0; ! isPending && j < tx->inCount; j++) {
+            if (tx->inputs[j].sequence < UINT32_MAX - 1) isPending = 1; // check for replace-by-fee
+            if (tx->inputs[j].sequence < UINT32_MAX && tx->lockTime < TX_MAX_LOCK_HEIGHT &&
+                tx->lockTime > wallet->blockHeight + 1) isPending = 1; // future lockTime
+            if (tx->inputs[j].sequence < UINT32_MAX && tx->lockTime > now) isPending = 1; // future lockTime
+            if (BRSetContains(wallet->pendingTx, &tx->inputs[j].txHash)) isPending = 1; // check for pending inputs
+            // TODO: XXX handle BIP68 check lock time verify rules
+        }
+
+        if (isPending) {
+            BRSetAdd(wallet->pendingTx, tx);
+            array_add(wallet->balanceHist, balance);
+            if (tx->inCount > 0) wallet->pendingSpends = 1;
+            return;
+        }
+    }
+
+    // remove any UTXOs that are now spent
+    if (wallet->pendingSpends) { // pending tx spent outputs without removing them, so check the entire UTXO set
+        for (k = array_count(wallet->utxos); k > 0; k--) {
+            if (! BRSetContains(wallet->spentOutputs, &wallet->utxos[k - 1])) continue;
+            t = BRSetGet(wallet->allTx, &wallet->utxos[k - 1].hash);
+            balance -= t->outputs[wallet->utxos[k - 1].n].amount;
+            array_rm(wallet->utxos, k - 1);
+        }
+
+        wallet->pendingSpends = 0;
+    }
+    // otherwise no earlier UTXO is in the spent output set, so only tx's own inputs need checking, and only those that
+    // spend an output to a wallet address
+    else for (j = 0; j < tx->inCount; j++) {
+        t = BRSetGet(wallet->allTx, &tx->inputs[j].txHash);
+        if (! t || tx->inputs[j].index >= t->outCount) continue;
+        pkh = BRScriptPKH(t->outputs[tx->inputs[j].index].script, t->outputs[tx->inputs[j].index].scriptLen);
+        if (! pkh || ! BRSetContains(wallet->allPKH, pkh)) continue;
+
+        for (k = array_count(wallet->utxos); k > 0; k--) {
+            if (! BRUTXOEq(&wallet->utxos[k - 1], &tx->inputs[j])) continue;
+            balance -= t->outputs[wallet->utxos[k - 1].n].amount;
+            array_rm(wallet->utxos, k - 1);
+            break;
+        }
+    }
+
+    // add outputs to UTXO set, unless already spent (transaction ordering is not guaranteed)
+    // TODO: don't add outputs below TX_MIN_OUTPUT_AMOUNT
+    // TODO: don't add coin generation outputs < 100 blocks deep
+    // NOTE: balance/UTXOs will then need to be recalculated when last block changes
+    for (j = 0; j < tx->outCount; j++) {
+        pkh = BRScriptPKH(tx->outputs[j].script, tx->outputs[j].scriptLen);
+
+        if (pkh && BRSetContains(wallet->allPKH, pkh)) {
+            BRUTXO o = { tx->txHash, (uint32_t)j };
+
+            BRSetAdd(wallet->usedPKH, (void *)pkh);
+            if (BRSetContains(wallet->spentOutputs, &o)) continue;
+            array_add(wallet->utxos, o);
+            balance += tx->outputs[j].amount;
+        }
+    }
+
+    if (prevBalance < balance) wallet->totalReceived += balance - prevBalance;
+    if (balance < prevBalance) wallet->totalSent += prevBalance - balance;
+    array_add(wallet->balanceHist, balance);
+    wallet->balance = balance;
+    wallet->coinsStale = 1;
+}
+
+// rebuilds balance, UTXOs and the spent output set by replaying every transaction
+static void _BRWalletUpdateBalance(BRWallet *wallet)
+{
+    time_t now = time(NULL);
+
     array_clear(wallet->utxos);
     array_clear(wallet->balanceHist);
     BRSetClear(wallet->spentOutputs);
     BRSetClear(wallet->invalidTx);
     BRSetClear(wallet->pendingTx);
     BRSetClear(wallet->usedPKH);
+    wallet->balance = 0;
+    wallet->pendingSpends = 0;
+    wallet->coinsStale = 1;
     wallet->totalSent = 0;
     wallet->totalReceived = 0;
 
-    for (i = 0; i < array_count(wallet->transactions); i++) {
-        tx = wallet->transactions[i];
+    for (size_t i = 0; i < array_count(wallet->transactions); i++) {
+        _BRWalletApplyTx(wallet, wallet->transactions[i], now);
+    }
 
-        // check if any inputs are invalid or already spent
-        if (tx->blockHeight == TX_UNCONFIRMED) {
-            for (j = 0, isInvalid = 0; ! isInvalid && j < tx->inCount; j++) {
-                if (BRSetContains(wallet->spentOutputs, &tx->inputs[j]) ||
-                    BRSetContains(wallet->invalidTx, &tx->inputs[j].txHash)) isInvalid = 1;
-            }
-        
-            if (isInvalid) {
-                BRSetAdd(wallet->invalidTx, tx);
-                array_add(wallet->balanceHist, balance);
-                continue;
-            }
-        }
+    assert(array_count(wallet->balanceHist) == array_count(wallet->transactions));
+}
+
+// updates balance, UTXOs and the spent output set after tx were inserted into wallet->transactions at index i or later
+// - tx appended after all previously applied ones can't change how those were applied, so they're applied on their own;
+// the exception is when some tx is pending, since a lockTime may have passed since it was applied
+static void _BRWalletUpdateBalanceFrom(BRWallet *wallet, size_t i)
+{
+    if (i == array_count(wallet->balanceHist) && BRSetCount(wallet->pendingTx) == 0) {
+        time_t now = time(NULL);
 
-        // add inputs to spent output set
-        for (j = 0; j < tx->inCount; j++) {
-            BRSetAdd(wallet->spentOutputs, &tx->inputs[j]);
+        for (; i < array_count(wallet->transactions); i++) {
+            _BRWalletApplyTx(wallet, wallet->transactions[i], now);
         }
 
-        // check if tx is pending
-        if (tx->blockHeight == TX_UNCONFIRMED) {
-            isPending = (BRTransactionVSize(tx) > TX_MAX_SIZE) ? 1 : 0; // check tx size is under TX_MAX_SIZE
-            
-            for (j = 0; ! isPending && j < tx->outCount; j++) {
-                if (tx->outputs[j].amount < TX_MIN_OUTPUT_AMOUNT) isPending = 1; // check that no outputs are dust
-            }
+        assert(array_count(wallet->balanceHist) == array_count(wallet->transactions));
+    }
+    else _BRWalletUpdateBalance(wallet);
+}
 
-            for (j = 0; ! isPending && j < tx->inCount; j++) {
-                if (tx->inputs[j].sequence < UINT32_MAX - 1) isPending = 1; // check for replace-by-fee
-                if (tx->inputs[j].sequence < UINT32_MAX && tx->lockTime < TX_MAX_LOCK_HEIGHT &&
-                    tx->lockTime > wallet->blockHeight + 1) isPending = 1; // future lockTime
-                if (tx->inputs[j].sequence < UINT32_MAX && tx->lockTime > now) isPending = 1; // future lockTime
-                if (BRSetContains(wallet->pendingTx, &tx->inputs[j].txHash)) isPending = 1; // check for pending inputs
-                // TODO: XXX handle BIP68 check lock time verify rules
-            }
-            
-            if (isPending) {
-                BRSetAdd(wallet->pendingTx, tx);
-                array_add(wallet->balanceHist, balance);
-                continue;
-            }
-        }
+static int _BRWalletTxBlockHeightCompare(const void *tx1, const void *tx2)
+{
+    uint32_t h1 = (*(BRTransaction * const *)tx1)->blockHeight, h2 = (*(BRTransaction * const *)tx2)->blockHeight;
 
-        // add outputs to UTXO set
-        // TODO: don't add outputs below TX_MIN_OUTPUT_AMOUNT
-        // TODO: don't add coin generation outputs < 100 blocks deep
-        // NOTE: balance/UTXOs will then need to be recalculated when last block changes
-        for (j = 0; j < tx->outCount; j++) {
-            pkh = BRScriptPKH(tx->outputs[j].script, tx->outputs[j].scriptLen);
+    return (h1 < h2) ? -1 : ((h1 > h2) ? 1 : 0);
+}
 
-            if (pkh && BRSetContains(wallet->allPKH, pkh)) {
-                BRSetAdd(wallet->usedPKH, (void *)pkh);
-                array_add(wallet->utxos, ((const BRUTXO) { tx->txHash, (uint32_t)j }));
-                balance += tx->outputs[j].amount;
-            }
-        }
+// appends tx to sorted, after first appending any tx in unsorted that it spends from (depth first)
+static void _BRWalletTxSortVisit(BRSet *unsorted, BRTransaction ***sorted, BRTransaction *tx)
+{
+    BRTransaction *t;
 
-        // transaction ordering is not guaranteed, so check the entire UTXO set against the entire spent output set
-        for (j = array_count(wallet->utxos); j > 0; j--) {
-            if (! BRSetContains(wallet->spentOutputs, &wallet->utxos[j - 1])) continue;
-            t = BRSetGet(wallet->allTx, &wallet->utxos[j - 1].hash);
-            balance -= t->outputs[wallet->utxos[j - 1].n].amount;
-            array_rm(wallet->utxos, j - 1);
-        }
-        
-        if (prevBalance < balance) wallet->totalReceived += balance - prevBalance;
-        if (balance < prevBalance) wallet->totalSent += prevBalance - balance;
-        array_add(wallet->balanceHist, balance);
-        prevBalance = balance;
+    BRSetRemove(unsorted, tx);
+
+    for (size_t i = 0; i < tx->inCount; i++) {
+        t = BRSetGet(unsorted, &tx->inputs[i].txHash);
+        if (t) _BRWalletTxSortVisit(unsorted, sorted, t);
     }
 
-    assert(array_count(wallet->balanceHist) == array_count(wallet->transactions));
-    wallet->balance = balance;
+    array_add(*sorted, tx);
+}
+
+// returns a copy of txs sorted by block height, oldest first, with every tx following any other in txs that it spends
+// from; duplicates are dropped, result must be freed by calling array_free()
+static BRTransaction **_BRWalletTxSort(BRTransaction *txs[], size_t txCount)
+{
+    BRTransaction **byHeight, **sorted;
+    BRSet *unsorted = BRSetNew(BRTransactionHash, BRTransactionEq, txCount);
+
+    array_new(byHeight, txCount);
+    array_add_array(byHeight, txs, txCount);
+    mergesort_brd(byHeight, txCount, sizeof(*byHeight), _BRWalletTxBlockHeightCompare);
+
+    for (size_t i = 0; i < txCount; i++) BRSetAdd(unsorted, byHeight[i]);
+    array_new(sorted, BRSetCount(unsorted));
+
+    for (size_t i = 0; i < txCount; i++) {
+        if (BRSetGet(unsorted, byHeight[i]) == byHeight[i]) _BRWalletTxSortVisit(unsorted, &sorted, byHeight[i]);
+    }
+
+    BRSetFree(unsorted);
+    array_free(byHeight);
+    return sorted;
 }
 
 // allocates and populates a BRWallet struct which must be freed by calling BRWalletFree()
@@ -268,6 +572,8 @@ BRWallet *BRWalletNew(BRAddressParams addrParams, BRTransaction *transactions[],
     wallet = calloc(1, sizeof(*wallet));
     assert(wallet != NULL);
     array_new(wallet->utxos, 100);
+    array_new(wallet->coins, 100);
+    wallet->coinsStale = 1;
     array_new(wallet->transactions, txCount + 100);
     wallet->feePerKb = DEFAULT_FEE_PER_KB;
     wallet->masterPubKey = mpk;
@@ -281,6 +587,7 @@ BRWallet *BRWalletNew(BRAddressParams addrParams, BRTransaction *transactions[],
     wallet->spentOutputs = BRSetNew(BRUTXOHash, BRUTXOEq, txCount + 100);
     wallet->usedPKH = BRSetNew(_pkhHash, _pkhEq, txCount + 100);
     wallet->allPKH = BRSetNew(_pkhHash, _pkhEq, txCount + 100);
+    wallet->txGraph = BRSetNew(BRTransactionHash, BRTransactionEq, txCount + 100);
     pthread_mutex_init(&wallet->lock, NULL);
 
     for (size_t i = 0; transactions && i < txCount; i++) {
@@ -504,6 +811,26 @@ void BRWalletSetFeePerKb(BRWallet *wallet, uint64_t feePerKb)
     pthread_mutex_unlock(&wallet->lock);
 }
 
+// strategy used to choose inputs when creating a transaction
+BRWalletCoinSelection BRWalletGetCoinSelection(BRWallet *wallet)
+{
+    BRWalletCoinSelection coinSelection;
+
+    assert(wallet != NULL);
+    pthread_mutex_lock(&wallet->lock);
+    coinSelection = wallet->coinSelection;
+    pthread_mutex_unlock(&wallet->lock);
+    return coinSelection;
+}
+
+void BRWalletSetCoinSelection(BRWallet *wallet, BRWalletCoinSelection coinSelection)
+{
+    assert(wallet != NULL);
+    pthread_mutex_lock(&wallet->lock);
+    wallet->coinSelection = coinSelection;
+    pthread_mutex_unlock(&wallet->lock);
+}
+
 BRAddressParams BRWalletGetAddressParams (BRWallet *wallet) {
     return wallet->addrParams;
 }
@@ -585,6 +912,25 @@ int BRWalletContainsAddress(BRWallet *wallet, const char *addr)
     return r;
 }
 
+// true if the address was previously generated by BRWalletUnusedAddrs(), in which case its BIP32 chain
+// (SEQUENCE_EXTERNAL_CHAIN or SEQUENCE_INTERNAL_CHAIN) and index are written to chain and index
+int BRWalletAddressChainIndex(BRWallet *wallet, const char *addr, uint32_t *chain, uint32_t *index)
+{
+    int r = 0;
+    uint32_t c = 0, n = 0;
+    UInt160 pkh = UINT160_ZERO;
+
+    assert(wallet != NULL);
+    assert(addr != NULL);
+    pthread_mutex_lock(&wallet->lock);
+    if (addr) BRAddressHash160(&pkh, wallet->addrParams, addr);
+    r = _BRWalletPKHPosition(wallet, &pkh, &c, &n);
+    pthread_mutex_unlock(&wallet->lock);
+    if (r && chain) *chain = c;
+    if (r && index) *index = n;
+    return r;
+}
+
 // true if the address was previously used as an output in any wallet transaction
 int BRWalletAddressIsUsed(BRWallet *wallet, const char *addr)
 {
@@ -629,6 +975,283 @@ BRTransaction *BRWalletCreateTxForOutputs(BRWallet *wallet, const BRTxOutput out
     return BRWalletCreateTxForOutputsWithFeePerKb(wallet, UINT64_MAX, outputs, outCount);
 }
 
+#define TX_INPUT_WEIGHT           (TX_INPUT_SIZE*4 + 1) // estimated P2PKH input weight, including its witness count
+#define TX_WITNESS_INPUT_BASE     (sizeof(UInt256) + sizeof(uint32_t) + 1 + sizeof(uint32_t)) // P2WPKH non-witness size
+#define TX_WITNESS_INPUT_WEIGHT   (TX_WITNESS_INPUT_BASE*4 + TX_INPUT_SIZE - TX_WITNESS_INPUT_BASE + 1) // as VSize
+#define COIN_SELECTION_MAX_TRIES  100000 // branch and bound search limit
+#define COIN_SELECTION_ITERATIONS 1000   // knapsack subset approximation passes
+
+// what coin selection has to fund: amount plus the fee at feePerKb for a transaction of vsize size plus its inputs
+typedef struct {
+    uint64_t feePerKb, amount, minAmount;
+    size_t size; // vsize of the transaction with its outputs and a change output, but no inputs
+    int64_t value; // effective value the inputs need: amount plus the fee for everything but the inputs
+} _BRWalletCoinTarget;
+
+// orders coins by descending effective value
+inline static int _BRWalletCoinValueCompare(const void *coin1, const void *coin2)
+{
+    int64_t value1 = ((const _BRWalletCoin *)coin1)->value, value2 = ((const _BRWalletCoin *)coin2)->value;
+
+    return (value1 == value2) ? 0 : ((value1 < value2) ? 1 : -1);
+}
+
+// rebuilds the coin selection table if utxos have changed since it was built, or it was built for a different feePerKb
+static void _BRWalletUpdateCoins(BRWallet *wallet, uint64_t feePerKb)
+{
+    BRTransaction *tx;
+    const BRTxOutput *output;
+    _BRWalletCoin coin;
+
+    if (! wallet->coinsStale && wallet->coinsFeePerKb == feePerKb) return;
+    array_clear(wallet->coins);
+
+    for (size_t i = 0; i < array_count(wallet->utxos); i++) {
+        tx = BRSetGet(wallet->allTx, &wallet->utxos[i]);
+        if (! tx || wallet->utxos[i].n >= tx->outCount) continue;
+        output = &tx->outputs[wallet->utxos[i].n];
+        coin.utxo = wallet->utxos[i];
+        coin.amount = output->amount;
+        coin.weight = (output->script && output->scriptLen > 0 && output->script[0] == OP_0) ?
+                      TX_WITNESS_INPUT_WEIGHT : TX_INPUT_WEIGHT;
+        coin.value = (int64_t)coin.amount - (int64_t)((coin.weight*feePerKb + 3999)/4000);
+        array_add(wallet->coins, coin);
+    }
+
+    // stable, so coins of equal value stay in wallet transaction order
+    mergesort_brd(wallet->coins, array_count(wallet->coins), sizeof(*wallet->coins), _BRWalletCoinValueCompare);
+    wallet->coinsFeePerKb = feePerKb;
+    wallet->coinsStale = 0;
+}
+
+// fee for a transaction of vsize size plus inputs of total weight inWeight, allowing for the largest input count varint
+// and a segwit marker so that it's never less than the fee of the transaction that is finally built
+inline static uint64_t _coinsFee(uint64_t feePerKb, size_t size, size_t inWeight)
+{
+    return _txFee(feePerKb, size + 3 + (inWeight + 3)/4);
+}
+
+// amount left over after inputs totaling inAmount with weight inWeight fund the target, or -1 if they don't or the
+// transaction would be too large
+static int64_t _BRWalletCoinsExcess(const _BRWalletCoinTarget *target, uint64_t inAmount, size_t inWeight)
+{
+    uint64_t fee = _coinsFee(target->feePerKb, target->size, inWeight);
+
+    if (target->size + 3 + (inWeight + 3)/4 > TX_MAX_SIZE || inAmount < target->amount + fee) return -1;
+    return (int64_t)(inAmount - (target->amount + fee));
+}
+
+// depth first branch and bound search of coins, which must all have positive effective value, for inputs with an
+// effective value within minAmount above the target, so that no change output is needed; adds them to selection
+static int _BRWalletCoinsBranchAndBound(const _BRWalletCoin coins[], size_t count, const _BRWalletCoinTarget *target,
+                                        size_t **selection)
+{
+    int64_t value = 0, lookahead = 0, excess;
+    uint64_t inAmount = 0;
+    size_t i = 0, j, inWeight = 0, tries, *included;
+    int r = 0, backtrack;
+
+    array_new(included, 100);
+    for (j = 0; j < count; j++) lookahead += coins[j].value;
+
+    for (tries = 0; ! r && tries < COIN_SELECTION_MAX_TRIES; tries++) {
+        backtrack = 0;
+
+        if (value + lookahead < target->value || value > target->value + (int64_t)target->minAmount) backtrack = 1;
+        else if (value >= target->value && (excess = _BRWalletCoinsExcess(target, inAmount, inWeight)) >= 0 &&
+                 excess <= (int64_t)target->minAmount) r = 1;
+        else if (i == count) backtrack = 1;
+        else { // include the next coin
+            lookahead -= coins[i].value;
+            value += coins[i].value;
+            inAmount += coins[i].amount;
+            inWeight += coins[i].weight;
+            array_add(included, i);
+            i++;
+        }
+
+        if (backtrack) { // exclude the last included coin instead, undoing the decisions made after it
+            if (array_count(included) == 0) break; // search space exhausted
+            j = included[array_count(included) - 1];
+            array_rm_last(included);
+            while (i > j + 1) lookahead += coins[--i].value;
+            value -= coins[j].value;
+            inAmount -= coins[j].amount;
+            inWeight -= coins[j].weight;
+            i = j + 1;
+        }
+    }
+
+    if (r) array_add_array(*selection, included, array_count(included));
+    array_free(included);
+    return r;
+}
+
+// xorshift32, seeded by the caller so that the same wallet state and target always select the same coins, and repeated
+// fee estimates agree
+inline static uint32_t _coinsRand(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// marks in best the subset of coins, found by random passes, whose total effective value is closest to at least value,
+// and returns that total
+static int64_t _BRWalletCoinsBestSubset(const _BRWalletCoin coins[], size_t count, int64_t total, int64_t value,
+                                        uint8_t best[])
+{
+    uint8_t *included = calloc(count, sizeof(*included));
+    uint32_t state = 0x2545f491;
+    int64_t bestTotal = total, sum;
+    int reached;
+
+    assert(included != NULL);
+    memset(best, 1, count);
+
+    for (size_t n = 0; n < COIN_SELECTION_ITERATIONS && bestTotal != value; n++) {
+        memset(included, 0, count);
+        sum = 0;
+        reached = 0;
+
+        for (int pass = 0; pass < 2 && ! reached; pass++) {
+            for (size_t i = 0; i < count; i++) {
+                if (pass == 0 ? ! (_coinsRand(&state) & 1) : included[i]) continue;
+                sum += coins[i].value;
+                included[i] = 1;
+
+                if (sum >= value) {
+                    reached = 1;
+                    if (sum < bestTotal) bestTotal = sum, memcpy(best, included, count);
+                    sum -= coins[i].value;
+                    included[i] = 0;
+                }
+            }
+        }
+    }
+
+    free(included);
+    return bestTotal;
+}
+
+// index of the first of coins, sorted by descending effective value, with an effective value below value
+static size_t _BRWalletCoinsBelow(const _BRWalletCoin coins[], size_t count, int64_t value)
+{
+    size_t lo = 0, hi = count, mid;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo)/2;
+        if (coins[mid].value >= value) lo = mid + 1;
+        else hi = mid;
+    }
+
+    return lo;
+}
+
+// knapsack selection from coins, which must all have positive effective value: a single coin matching the target, the
+// smallest coin large enough to also leave a minAmount change output, or the best subset of the coins smaller than
+// that; adds the inputs to selection
+static int _BRWalletCoinsKnapsack(const _BRWalletCoin coins[], size_t count, const _BRWalletCoinTarget *target,
+                                  size_t **selection)
+{
+    int64_t changeValue = target->value + (int64_t)target->minAmount, total = 0, bestTotal;
+    uint64_t inAmount = 0;
+    size_t i, large = _BRWalletCoinsBelow(coins, count, changeValue), end, inWeight = 0;
+    uint8_t *best;
+
+    i = _BRWalletCoinsBelow(coins, count, target->value + 1);
+
+    if (i < count && coins[i].value == target->value) {
+        array_add(*selection, i);
+        return (_BRWalletCoinsExcess(target, coins[i].amount, coins[i].weight) >= 0);
+    }
+
+    // only the largest of the smaller coins, up to twice changeValue in total, are candidates, which bounds the work on
+    // wallets with many small outputs and avoids spending them when larger ones will do
+    for (end = large; end < count && total < 2*changeValue; end++) total += coins[end].value;
+
+    if (total < target->value) { // smaller coins can't fund the target, so use the smallest that can
+        if (large > 0) array_add(*selection, large - 1);
+        return (large > 0 && _BRWalletCoinsExcess(target, coins[large - 1].amount, coins[large - 1].weight) >= 0);
+    }
+
+    best = malloc(end - large);
+    assert(best != NULL);
+    bestTotal = _BRWalletCoinsBestSubset(&coins[large], end - large, total, target->value, best);
+
+    if (bestTotal != target->value && total >= changeValue) {
+        bestTotal = _BRWalletCoinsBestSubset(&coins[large], end - large, total, changeValue, best);
+    }
+
+    if (large > 0 && bestTotal != target->value && coins[large - 1].value <= bestTotal) {
+        array_add(*selection, large - 1);
+        inAmount = coins[large - 1].amount;
+        inWeight = coins[large - 1].weight;
+    }
+    else {
+        for (i = large; i < end; i++) {
+            if (! best[i - large]) continue;
+            array_add(*selection, i);
+            inAmount += coins[i].amount;
+            inWeight += coins[i].weight;
+        }
+    }
+
+    free(best);
+    return (_BRWalletCoinsExcess(target, inAmount, inWeight) >= 0);
+}
+
+// adds inputs chosen by the wallet's coin selection strategy to transaction, which has only its outputs, and sets
+// balance to their total and feeAmount to the fee with a change output; returns false, leaving transaction unchanged,
+// for BRWalletCoinSelectionInOrder or if the strategy found no suitable inputs
+static int _BRWalletSelectCoins(BRWallet *wallet, BRTransaction *transaction, uint64_t feePerKb, uint64_t amount,
+                                uint64_t minAmount, uint64_t *balance, uint64_t *feeAmount)
+{
+    _BRWalletCoinTarget target = { feePerKb, amount, minAmount, BRTransactionVSize(transaction) + TX_OUTPUT_SIZE, 0 };
+    BRTransaction *tx;
+    const _BRWalletCoin *coin;
+    size_t i, count, *selection;
+    int r = 0;
+
+    if (wallet->coinSelection == BRWalletCoinSelectionInOrder) return 0;
+    _BRWalletUpdateCoins(wallet, feePerKb);
+    target.value = (int64_t)(amount + _coinsFee(feePerKb, target.size, 0));
+
+    // coins are sorted by descending effective value, so those worth spending at feePerKb come first
+    for (count = 0; count < array_count(wallet->coins) && wallet->coins[count].value > 0; count++);
+    array_new(selection, 100);
+
+    if (wallet->coinSelection == BRWalletCoinSelectionBranchAndBound) {
+        r = _BRWalletCoinsBranchAndBound(wallet->coins, count, &target, &selection);
+    }
+
+    if (! r) {
+        array_clear(selection);
+        r = _BRWalletCoinsKnapsack(wallet->coins, count, &target, &selection);
+    }
+
+    for (i = 0; r && i < array_count(selection); i++) {
+        coin = &wallet->coins[selection[i]];
+        tx = BRSetGet(wallet->allTx, &coin->utxo);
+        BRTransactionAddInput(transaction, tx->txHash, coin->utxo.n, coin->amount, tx->outputs[coin->utxo.n].script,
+                              tx->outputs[coin->utxo.n].scriptLen, NULL, 0, NULL, 0, TXIN_SEQUENCE);
+        *balance += coin->amount;
+    }
+
+    if (r) *feeAmount = _txFee(feePerKb, BRTransactionVSize(transaction) + TX_OUTPUT_SIZE);
+
+    // as with in order selection, increase fee to round off remaining wallet balance to nearest 100 satoshi, but only
+    // if the selected inputs still cover it; without change (always with branch and bound) the excess is all fee anyway
+    if (r && wallet->balance > amount + *feeAmount &&
+        *balance >= amount + *feeAmount + (wallet->balance - (amount + *feeAmount)) % 100) {
+        *feeAmount += (wallet->balance - (amount + *feeAmount)) % 100;
+    }
+
+    array_free(selection);
+    return r;
+}
+
 // returns an unsigned transaction that satisifes the given transaction outputs
 // result must be freed using BRTransactionFree()
 // use feePerKb UINT64_MAX to indicate that the wallet feePerKb should be used
@@ -658,53 +1281,55 @@ BRTransaction *BRWalletCreateTxForOutputsWithFeePerKb(BRWallet *wallet, uint64_t
     // TODO: avoid combining addresses in a single transaction when possible to reduce information leakage
     // TODO: use up UTXOs received from any of the output scripts that this transaction sends funds to, to mitigate an
     //       attacker double spending and requesting a refund
-    for (i = 0; i < array_count(wallet->utxos); i++) {
-        o = &wallet->utxos[i];
-        tx = BRSetGet(wallet->allTx, o);
-        if (! tx || o->n >= tx->outCount) continue;
-        BRTransactionAddInput(transaction, tx->txHash, o->n, tx->outputs[o->n].amount,
-                              tx->outputs[o->n].script, tx->outputs[o->n].scriptLen, NULL, 0, NULL, 0, TXIN_SEQUENCE);
+    if (! _BRWalletSelectCoins(wallet, transaction, feePerKb, amount, minAmount, &balance, &feeAmount)) {
+        for (i = 0; i < array_count(wallet->utxos); i++) {
+            o = &wallet->utxos[i];
+            tx = BRSetGet(wallet->allTx, o);
+            if (! tx || o->n >= tx->outCount) continue;
+            BRTransactionAddInput(transaction, tx->txHash, o->n, tx->outputs[o->n].amount,
+                                  tx->outputs[o->n].script, tx->outputs[o->n].scriptLen, NULL, 0, NULL, 0, TXIN_SEQUENCE);
         
-        if (BRTransactionVSize(transaction) + TX_OUTPUT_SIZE > TX_MAX_SIZE) { // transaction size-in-bytes too large
-            BRTransactionFree(transaction);
-            transaction = NULL;
+            if (BRTransactionVSize(transaction) + TX_OUTPUT_SIZE > TX_MAX_SIZE) { // transaction size-in-bytes too large
+                BRTransactionFree(transaction);
+                transaction = NULL;
         
-            // check for sufficient total funds before building a smaller transaction
-            if (wallet->balance < amount + _txFee(feePerKb, 10 + array_count(wallet->utxos)*TX_INPUT_SIZE +
-                                                  (outCount + 1)*TX_OUTPUT_SIZE + cpfpSize)) break;
-            pthread_mutex_unlock(&wallet->lock);
+                // check for sufficient total funds before building a smaller transaction
+                if (wallet->balance < amount + _txFee(feePerKb, 10 + array_count(wallet->utxos)*TX_INPUT_SIZE +
+                                                      (outCount + 1)*TX_OUTPUT_SIZE + cpfpSize)) break;
+                pthread_mutex_unlock(&wallet->lock);
 
-            if (outputs[outCount - 1].amount > amount + feeAmount + minAmount - balance) {
-                BRTxOutput newOutputs[outCount];
+                if (outputs[outCount - 1].amount > amount + feeAmount + minAmount - balance) {
+                    BRTxOutput newOutputs[outCount];
                 
-                for (j = 0; j < outCount; j++) {
-                    newOutputs[j] = outputs[j];
-                }
+                    for (j = 0; j < outCount; j++) {
+                        newOutputs[j] = outputs[j];
+                    }
                 
-                newOutputs[outCount - 1].amount -= amount + feeAmount - balance; // reduce last output amount
-                transaction = BRWalletCreateTxForOutputsWithFeePerKb(wallet, feePerKb, newOutputs, outCount);
-            }
-            else transaction = BRWalletCreateTxForOutputsWithFeePerKb(wallet, feePerKb, outputs, outCount - 1); // remove last output
+                    newOutputs[outCount - 1].amount -= amount + feeAmount - balance; // reduce last output amount
+                    transaction = BRWalletCreateTxForOutputsWithFeePerKb(wallet, feePerKb, newOutputs, outCount);
+                }
+                else transaction = BRWalletCreateTxForOutputsWithFeePerKb(wallet, feePerKb, outputs, outCount - 1); // remove last output
 
-            balance = amount = feeAmount = 0;
-            pthread_mutex_lock(&wallet->lock);
-            break;
-        }
+                balance = amount = feeAmount = 0;
+                pthread_mutex_lock(&wallet->lock);
+                break;
+            }
         
-        balance += tx->outputs[o->n].amount;
+            balance += tx->outputs[o->n].amount;
         
-//        // size of unconfirmed, non-change inputs for child-pays-for-parent fee
-//        // don't include parent tx with more than 10 inputs or 10 outputs
-//        if (tx->blockHeight == TX_UNCONFIRMED && tx->inCount <= 10 && tx->outCount <= 10 &&
-//            ! _BRWalletTxIsSend(wallet, tx)) cpfpSize += BRTransactionVSize(tx);
+//            // size of unconfirmed, non-change inputs for child-pays-for-parent fee
+//            // don't include parent tx with more than 10 inputs or 10 outputs
+//            if (tx->blockHeight == TX_UNCONFIRMED && tx->inCount <= 10 && tx->outCount <= 10 &&
+//                ! _BRWalletTxIsSend(wallet, tx)) cpfpSize += BRTransactionVSize(tx);
 
-        // fee amount after adding a change output
-        feeAmount = _txFee(feePerKb, BRTransactionVSize(transaction) + TX_OUTPUT_SIZE + cpfpSize);
+            // fee amount after adding a change output
+            feeAmount = _txFee(feePerKb, BRTransactionVSize(transaction) + TX_OUTPUT_SIZE + cpfpSize);
 
-        // increase fee to round off remaining wallet balance to nearest 100 satoshi
-        if (wallet->balance > amount + feeAmount) feeAmount += (wallet->balance - (amount + feeAmount)) % 100;
+            // increase fee to round off remaining wallet balance to nearest 100 satoshi
+            if (wallet->balance > amount + feeAmount) feeAmount += (wallet->balance - (amount + feeAmount)) % 100;
         
-        if (balance == amount + feeAmount || balance >= amount + feeAmount + minAmount) break;
+            if (balance == amount + feeAmount || balance >= amount + feeAmount + minAmount) break;
+        }
     }
     
     pthread_mutex_unlock(&wallet->lock);
@@ -731,7 +1356,7 @@ BRTransaction *BRWalletCreateTxForOutputsWithFeePerKb(BRWallet *wallet, uint64_t
 // returns true if all inputs were signed, or false if there was an error or not all inputs were able to be signed
 int BRWalletSignTransaction(BRWallet *wallet, BRTransaction *tx, uint8_t forkId, const void *seed, size_t seedLen)
 {
-    uint32_t j, internalIdx[tx->inCount], externalIdx[tx->inCount];
+    uint32_t chain, index, internalIdx[tx->inCount], externalIdx[tx->inCount];
     size_t i, internalCount = 0, externalCount = 0;
     int r = 0;
     
@@ -742,13 +1367,9 @@ int BRWalletSignTransaction(BRWallet *wallet, BRTransaction *tx, uint8_t forkId,
     for (i = 0; tx && i < tx->inCount; i++) {
         const uint8_t *pkh = BRScriptPKH(tx->inputs[i].script, tx->inputs[i].scriptLen);
         
-        for (j = (uint32_t)array_count(wallet->internalChain); pkh && j > 0; j--) {
-            if (UInt160Eq(UInt160Get(pkh), wallet->internalChain[j - 1])) internalIdx[internalCount++] = j - 1;
-        }
-
-        for (j = (uint32_t)array_count(wallet->externalChain); pkh && j > 0; j--) {
-            if (UInt160Eq(UInt160Get(pkh), wallet->externalChain[j - 1])) externalIdx[externalCount++] = j - 1;
-        }
+        if (! pkh || ! _BRWalletPKHPosition(wallet, pkh, &chain, &index)) continue;
+        if (chain == SEQUENCE_INTERNAL_CHAIN) internalIdx[internalCount++] = index;
+        if (chain == SEQUENCE_EXTERNAL_CHAIN) externalIdx[externalCount++] = index;
     }
 
     pthread_mutex_unlock(&wallet->lock);
@@ -798,8 +1419,7 @@ int BRWalletRegisterTransaction(BRWallet *wallet, BRTransaction *tx)
                 // TODO: handle tx replacement with input sequence numbers
                 //       (for now, replacements appear invalid until confirmation)
                 BRSetAdd(wallet->allTx, tx);
-                _BRWalletInsertTx(wallet, tx);
-                _BRWalletUpdateBalance(wallet);
+                _BRWalletUpdateBalanceFrom(wallet, _BRWalletInsertTx(wallet, tx));
                 wasAdded = 1;
             }
             else { // keep track of unconfirmed non-wallet tx for invalid tx checks and child-pays-for-parent fees
@@ -825,10 +1445,85 @@ int BRWalletRegisterTransaction(BRWallet *wallet, BRTransaction *tx)
     return r;
 }
 
+// adds the given transactions to the wallet, returning the number that were associated with the wallet and added
+// - transactions are sorted once so that each follows any it spends from, balance is updated once per pass, and
+// callbacks are made once all transactions are registered; transactions that only become associated with the wallet
+// through addresses generated by earlier ones in the same call are picked up in a further pass
+// - on return, each entry of transactions that the wallet took ownership of is set to NULL; the rest (unsigned,
+// confirmed non-wallet, already registered or in-batch duplicate transactions) remain owned by the caller
+size_t BRWalletRegisterTransactions(BRWallet *wallet, BRTransaction *transactions[], size_t txCount)
+{
+    BRTransaction **txs, **added, *tx;
+    size_t i, j, first, addedCount, prevCount;
+
+    assert(wallet != NULL);
+    assert(transactions != NULL || txCount == 0);
+    if (! transactions || txCount == 0) return 0;
+
+    txs = _BRWalletTxSort(transactions, txCount);
+    array_new(added, array_count(txs));
+
+    do {
+        pthread_mutex_lock(&wallet->lock);
+        prevCount = array_count(added);
+        first = array_count(wallet->transactions);
+
+        for (i = 0; i < array_count(txs); i++) {
+            tx = txs[i];
+            if (! tx) continue;
+
+            if (! BRTransactionIsSigned(tx) || BRSetContains(wallet->allTx, tx)) txs[i] = NULL;
+            else if (_BRWalletContainsTx(wallet, tx)) {
+                BRSetAdd(wallet->allTx, tx);
+                j = _BRWalletInsertTx(wallet, tx);
+                if (j < first) first = j;
+                array_add(added, tx);
+                txs[i] = NULL;
+            }
+        }
+
+        addedCount = array_count(added);
+        if (addedCount > prevCount) _BRWalletUpdateBalanceFrom(wallet, first);
+        pthread_mutex_unlock(&wallet->lock);
+
+        if (addedCount > prevCount) {
+            // when a wallet address is used in a transaction, generate a new address to replace it
+            BRWalletUnusedAddrs(wallet, NULL, SEQUENCE_GAP_LIMIT_EXTERNAL, SEQUENCE_EXTERNAL_CHAIN);
+            BRWalletUnusedAddrs(wallet, NULL, SEQUENCE_GAP_LIMIT_INTERNAL, SEQUENCE_INTERNAL_CHAIN);
+        }
+    } while (addedCount > prevCount && addedCount < array_count(txs));
+
+    pthread_mutex_lock(&wallet->lock);
+
+    for (i = 0; i < array_count(txs); i++) { // keep track of unconfirmed non-wallet tx, as in BRWalletRegisterTransaction()
+        tx = txs[i];
+        if (tx && tx->blockHeight == TX_UNCONFIRMED && ! BRSetContains(wallet->allTx, tx)) BRSetAdd(wallet->allTx, tx);
+    }
+
+    for (i = 0; i < txCount; i++) { // mark the transactions now owned by the wallet
+        if (transactions[i] && BRSetGet(wallet->allTx, transactions[i]) == transactions[i]) transactions[i] = NULL;
+    }
+
+    pthread_mutex_unlock(&wallet->lock);
+
+    if (addedCount > 0) {
+        if (wallet->balanceChanged) wallet->balanceChanged(wallet->callbackInfo, wallet->balance);
+
+        for (i = 0; wallet->txAdded && i < addedCount; i++) {
+            wallet->txAdded(wallet->callbackInfo, added[i]);
+        }
+    }
+
+    array_free(added);
+    array_free(txs);
+    return addedCount;
+}
+
 // removes a tx from the wallet, along with any tx that depend on its outputs
 void BRWalletRemoveTransaction(BRWallet *wallet, UInt256 txHash)
 {
     BRTransaction *tx, *t;
+    _BRWalletTxNode *node;
     UInt256 *hashes = NULL;
     int notifyUser = 0, recommendRescan = 0;
 
@@ -839,17 +1534,11 @@ void BRWalletRemoveTransaction(BRWallet *wallet, UInt256 txHash)
 
     if (tx) {
         array_new(hashes, 0);
+        node = BRSetGet(wallet->txGraph, &txHash);
 
-        for (size_t i = array_count(wallet->transactions); i > 0; i--) { // find depedent transactions
-            t = wallet->transactions[i - 1];
-            if (t->blockHeight < tx->blockHeight) break;
-            if (BRTransactionEq(tx, t)) continue;
-            
-            for (size_t j = 0; j < t->inCount; j++) {
-                if (! UInt256Eq(t->inputs[j].txHash, txHash)) continue;
-                array_add(hashes, t->txHash);
-                break;
-            }
+        for (size_t i = 0; node && i < array_count(node->spenders); i++) { // find depedent transactions
+            t = node->spenders[i];
+            if (! BRTransactionEq(tx, t)) array_add(hashes, t->txHash);
         }
         
         if (array_count(hashes) > 0) {
@@ -862,12 +1551,7 @@ void BRWalletRemoveTransaction(BRWallet *wallet, UInt256 txHash)
             BRWalletRemoveTransaction(wallet, txHash);
         }
         else {
-            for (size_t i = array_count(wallet->transactions); i > 0; i--) {
-                if (! BRTransactionEq(wallet->transactions[i - 1], tx)) continue;
-                array_rm(wallet->transactions, i - 1);
-                break;
-            }
-            
+            _BRWalletRemoveTx(wallet, tx);
             _BRWalletUpdateBalance(wallet);
             pthread_mutex_unlock(&wallet->lock);
             
@@ -1062,8 +1746,8 @@ void BRWalletUpdateTransactions(BRWallet *wallet, const UInt256 txHashes[], size
     UInt256 hashesBuf[4096];
     UInt256 *hashes = (txCount <= 4096 ? hashesBuf : calloc (txCount, sizeof (UInt256)));
 
-    int needsUpdate = 0;
-    size_t i, j, k;
+    int needsUpdate = 0, isWalletTx, isRegistered;
+    size_t i, j;
     
     assert(wallet != NULL);
     assert(txHashes != NULL || txCount == 0);
@@ -1073,17 +1757,14 @@ void BRWalletUpdateTransactions(BRWallet *wallet, const UInt256 txHashes[], size
     for (i = 0, j = 0; txHashes && i < txCount; i++) {
         tx = BRSetGet(wallet->allTx, &txHashes[i]);
         if (! tx || (tx->blockHeight == blockHeight && tx->timestamp == timestamp)) continue;
+        
+        isWalletTx = _BRWalletContainsTx(wallet, tx);
+        isRegistered = (isWalletTx && _BRWalletRemoveTx(wallet, tx)); // remove and re-insert tx to keep wallet sorted
         tx->timestamp = timestamp;
         tx->blockHeight = blockHeight;
-        
-        if (_BRWalletContainsTx(wallet, tx)) {
-            for (k = array_count(wallet->transactions); k > 0; k--) { // remove and re-insert tx to keep wallet sorted
-                if (! BRTransactionEq(wallet->transactions[k - 1], tx)) continue;
-                array_rm(wallet->transactions, k - 1);
-                _BRWalletInsertTx(wallet, tx);
-                break;
-            }
-            
+
+        if (isWalletTx) {
+            if (isRegistered) _BRWalletInsertTx(wallet, tx);
             hashes[j++] = txHashes[i];
             if (BRSetContains(wallet->pendingTx, tx) || BRSetContains(wallet->invalidTx, tx)) needsUpdate = 1;
         }
@@ -1119,6 +1800,7 @@ void BRWalletSetTxUnconfirmedAfter(BRWallet *wallet, uint32_t blockHeight)
         hashes[j] = wallet->transactions[i + j]->txHash;
     }
     
+    _BRWalletTxReorderFrom(wallet, i);
     if (count > 0) _BRWalletUpdateBalance(wallet);
     pthread_mutex_unlock(&wallet->lock);
     if (count > 0 && wallet->txUpdated) wallet->txUpdated(wallet->callbackInfo, hashes, count, TX_UNCONFIRMED, 0);
@@ -1321,6 +2003,12 @@ uint64_t BRWalletMaxOutputAmountWithFeePerKb(BRWallet *wallet, uint64_t feePerKb
     return (amount > fee) ? amount - fee : 0;
 }
 
+static void _setApplyFreeTxNode(void *info, void *node)
+{
+    array_free(((_BRWalletTxNode *)node)->spenders);
+    free(node);
+}
+
 static void _setApplyFreeTx(void *info, void *tx)
 {
     BRTransactionFree(tx);
@@ -1338,11 +2026,14 @@ void BRWalletFree(BRWallet *wallet)
     BRSetApply(wallet->allTx, NULL, _setApplyFreeTx);
     BRSetFree(wallet->allTx);
     BRSetFree(wallet->spentOutputs);
+    BRSetApply(wallet->txGraph, NULL, _setApplyFreeTxNode);
+    BRSetFree(wallet->txGraph);
     array_free(wallet->internalChain);
     array_free(wallet->externalChain);
     array_free(wallet->balanceHist);
     array_free(wallet->transactions);
     array_free(wallet->utxos);
+    array_free(wallet->coins);
     pthread_mutex_unlock(&wallet->lock);
     pthread_mutex_destroy(&wallet->lock);
     free(wallet);
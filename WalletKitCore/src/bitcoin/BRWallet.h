@@ -56,6 +56,13 @@ inline static int BRUTXOEq(const void *utxo, const void *otherUtxo)
                                   ((const BRUTXO *)utxo)->n == ((const BRUTXO *)otherUtxo)->n));
 }
 
+// strategies for choosing which unspent outputs fund a transaction created by the wallet
+typedef enum {
+    BRWalletCoinSelectionInOrder = 0,    // spend unspent outputs in wallet transaction order, oldest first
+    BRWalletCoinSelectionBranchAndBound, // search for inputs that need no change output, falling back to knapsack
+    BRWalletCoinSelectionKnapsack        // smallest single output that covers the amount, or best subset of smaller ones
+} BRWalletCoinSelection;
+
 typedef struct BRWalletStruct BRWallet;
 
 // allocates and populates a BRWallet struct that must be freed by calling BRWalletFree()
@@ -101,6 +108,10 @@ size_t BRWalletAllAddrs(BRWallet *wallet, BRAddress addrs[], size_t addrsCount);
 // true if the address was previously generated by BRWalletUnusedAddrs() (even if it's now used)
 int BRWalletContainsAddress(BRWallet *wallet, const char *addr);
 
+// true if the address was previously generated by BRWalletUnusedAddrs(), in which case its BIP32 chain
+// (SEQUENCE_EXTERNAL_CHAIN or SEQUENCE_INTERNAL_CHAIN) and index are written to chain and index, if not NULL
+int BRWalletAddressChainIndex(BRWallet *wallet, const char *addr, uint32_t *chain, uint32_t *index);
+
 // true if the address was previously used as an input or output in any wallet transaction
 int BRWalletAddressIsUsed(BRWallet *wallet, const char *addr);
 
@@ -135,6 +146,10 @@ size_t BRWalletUTXOs(BRWallet *wallet, BRUTXO utxos[], size_t utxosCount);
 uint64_t BRWalletFeePerKb(BRWallet *wallet);
 void BRWalletSetFeePerKb(BRWallet *wallet, uint64_t feePerKb);
 
+// strategy used to choose inputs when creating a transaction, BRWalletCoinSelectionInOrder by default
+BRWalletCoinSelection BRWalletGetCoinSelection(BRWallet *wallet);
+void BRWalletSetCoinSelection(BRWallet *wallet, BRWalletCoinSelection coinSelection);
+
 // returns an unsigned transaction that sends the specified amount from the wallet to the given address
 // result must be freed using BRTransactionFree()
 BRTransaction *BRWalletCreateTransaction(BRWallet *wallet, uint64_t amount, const char *addr);
@@ -165,6 +180,13 @@ int BRWalletContainsTransaction(BRWallet *wallet, const BRTransaction *tx);
 // adds a transaction to the wallet, or returns false if it isn't associated with the wallet
 int BRWalletRegisterTransaction(BRWallet *wallet, BRTransaction *tx);
 
+// adds transactions to the wallet as BRWalletRegisterTransaction() would, but sorting them and updating the balance
+// once for the whole batch; returns the number of transactions that were associated with the wallet and added
+// - on return, each entry of transactions that the wallet took ownership of (wallet transactions and, as for
+// BRWalletRegisterTransaction(), unconfirmed non-wallet ones) is set to NULL; the caller must free those remaining,
+// which include unsigned, confirmed non-wallet and already registered transactions and in-batch duplicates
+size_t BRWalletRegisterTransactions(BRWallet *wallet, BRTransaction *transactions[], size_t txCount);
+
 // removes a tx from the wallet, along with any tx that depend on its outputs
 void BRWalletRemoveTransaction(BRWallet *wallet, UInt256 txHash);
 
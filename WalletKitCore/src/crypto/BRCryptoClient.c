@@ -159,6 +159,15 @@ static void cryptoClientQRYSubmitTransfer      (BRCryptoClientQRYManager qry,
                                                 BRCryptoWallet   wallet,
                                                 BRCryptoTransfer transfer);
 
+static void cryptoClientQRYRequestAdd          (BRCryptoClientQRYManager qry,
+                                                BRCryptoClientRequestId rid,
+                                                BRCryptoClientCallbackType type,
+                                                BRCryptoCookie cookie);
+static bool cryptoClientQRYRequestRemove       (BRCryptoClientQRYManager qry,
+                                                BRCryptoClientRequestId rid);
+static void cryptoClientQRYRequestsExpire      (BRCryptoClientQRYManager qry);
+static void cryptoClientQRYRequestsCancel      (BRCryptoClientQRYManager qry);
+
 extern BRCryptoClientQRYManager
 cryptoClientQRYManagerCreate (BRCryptoClient client,
                               BRCryptoWalletManager manager,
@@ -187,8 +196,16 @@ cryptoClientQRYManagerCreate (BRCryptoClient client,
     qry->sync.success   = false;
     qry->sync.unbounded = CRYPTO_CLIENT_QRY_IS_UNBOUNDED;
 
+    qry->tick.pending = false;
+    qry->tick.rid     = SIZE_MAX;
+    qry->tick.ticksSkipped = 0;
+
     qry->connected = false;
 
+    array_new (qry->requests, 10);
+    qry->requestTimeout = CRYPTO_CLIENT_QRY_REQUEST_TIMEOUT_DEFAULT;
+    pthread_mutex_init_brd (&qry->requestsLock, PTHREAD_MUTEX_NORMAL);
+
     pthread_mutex_init_brd (&qry->lock, PTHREAD_MUTEX_NORMAL);
     return qry;
 }
@@ -201,6 +218,9 @@ cryptoClientQRYManagerRelease (BRCryptoClientQRYManager qry) {
     // Tiny race
     pthread_mutex_destroy (&qry->lock);
 
+    array_free (qry->requests);
+    pthread_mutex_destroy (&qry->requestsLock);
+
     memset (qry, 0, sizeof(*qry));
     free (qry);
 }
@@ -209,6 +229,7 @@ extern void
 cryptoClientQRYManagerConnect (BRCryptoClientQRYManager qry) {
     pthread_mutex_lock (&qry->lock);
     qry->connected = true;
+    qry->tick.pending = false;
     cryptoWalletManagerSetState (qry->manager, cryptoWalletManagerStateInit (CRYPTO_WALLET_MANAGER_STATE_SYNCING));
     pthread_mutex_unlock (&qry->lock);
 
@@ -222,6 +243,9 @@ cryptoClientQRYManagerDisconnect (BRCryptoClientQRYManager qry) {
     cryptoWalletManagerSetState (qry->manager, cryptoWalletManagerStateInit (CRYPTO_WALLET_MANAGER_STATE_CONNECTED));
     qry->connected = false;
     pthread_mutex_unlock (&qry->lock);
+
+    // Results are no longer wanted; the cancellation also ends any in-progress sync.
+    cryptoClientQRYRequestsCancel (qry);
 }
 
 
@@ -309,6 +333,9 @@ cryptoClientQRYManagerUpdateSync (BRCryptoClientQRYManager qry,
 
 extern void
 cryptoClientQRYManagerTickTock (BRCryptoClientQRYManager qry) {
+    // Abandon any requests that the client has failed to announce in time.
+    cryptoClientQRYRequestsExpire (qry);
+
     pthread_mutex_lock (&qry->lock);
 
     // Only continue if connected
@@ -316,6 +343,17 @@ cryptoClientQRYManagerTickTock (BRCryptoClientQRYManager qry) {
         switch (qry->manager->syncMode) {
             case CRYPTO_SYNC_MODE_API_ONLY:
             case CRYPTO_SYNC_MODE_API_WITH_P2P_SEND:
+                // Skip this 'tick-tock' if the prior one's request is still outstanding; the
+                // subsequent sync would be skipped anyway.
+                if (qry->tick.pending && qry->tick.ticksSkipped < CRYPTO_CLIENT_QRY_TICKS_SKIPPED_MAXIMUM) {
+                    qry->tick.ticksSkipped += 1;
+                    break;
+                }
+
+                qry->tick.pending = true;
+                qry->tick.rid     = qry->requestId;
+                qry->tick.ticksSkipped = 0;
+
                 // Alwwys get the current block
                 cryptoClientQRYRequestBlockNumber (qry);
                 break;
@@ -383,6 +421,167 @@ cryptoClientQRYRequestSync (BRCryptoClientQRYManager qry, bool needLock) {
     if (needLock) pthread_mutex_unlock (&qry->lock);
 }
 
+// MARK: - Client Request
+
+static void
+cryptoClientQRYRequestAbandon (BRCryptoClientQRYManager qry,
+                               BRCryptoClientQRYRequest request);
+
+static void
+cryptoClientQRYRequestAdd (BRCryptoClientQRYManager qry,
+                           BRCryptoClientRequestId rid,
+                           BRCryptoClientCallbackType type,
+                           BRCryptoCookie cookie) {
+    BRCryptoClientQRYRequest evicted;
+
+    pthread_mutex_lock (&qry->requestsLock);
+    BRCryptoClientQRYRequest request = {
+        rid,
+        type,
+        (0 == qry->requestTimeout || CLIENT_CALLBACK_SUBMIT_TRANSACTION == type
+         ? 0
+         : time (NULL) + qry->requestTimeout),
+        cookie
+    };
+
+    // Make room, if needed, by evicting the oldest request other than a submit.  A submit is
+    // never evicted, lest its transfer never be SUBMITTED or ERRORED; with only submits pending,
+    // the requests grow.
+    size_t index = array_count (qry->requests);
+    if (array_count (qry->requests) >= CRYPTO_CLIENT_QRY_REQUESTS_MAXIMUM)
+        for (index = 0;
+             index < array_count (qry->requests) && CLIENT_CALLBACK_SUBMIT_TRANSACTION == qry->requests[index].type;
+             index++);
+
+    bool evict = (index < array_count (qry->requests));
+    if (evict) {
+        evicted = qry->requests[index];
+        array_rm (qry->requests, index);
+    }
+
+    array_add (qry->requests, request);
+    pthread_mutex_unlock (&qry->requestsLock);
+
+    if (evict) cryptoClientQRYRequestAbandon (qry, evicted);
+}
+
+static size_t
+cryptoClientQRYRequestFind (BRCryptoClientQRYManager qry,
+                            BRCryptoClientRequestId rid) {
+    for (size_t index = 0; index < array_count (qry->requests); index++)
+        if (rid == qry->requests[index].rid) return index;
+    return SIZE_MAX;
+}
+
+/// Remove `rid`, as announced; return false if `rid` was not pending and should be discarded.
+static bool
+cryptoClientQRYRequestRemove (BRCryptoClientQRYManager qry,
+                              BRCryptoClientRequestId rid) {
+    pthread_mutex_lock (&qry->requestsLock);
+    size_t index = cryptoClientQRYRequestFind (qry, rid);
+    if (SIZE_MAX != index) array_rm (qry->requests, index);
+    pthread_mutex_unlock (&qry->requestsLock);
+
+    return SIZE_MAX != index;
+}
+
+static void
+cryptoClientQRYRequestsExpire (BRCryptoClientQRYManager qry) {
+    BRArrayOf(BRCryptoClientQRYRequest) expired;
+    array_new (expired, 1);
+
+    time_t now = time (NULL);
+
+    pthread_mutex_lock (&qry->requestsLock);
+    for (size_t index = array_count (qry->requests); index > 0; index--)
+        if (0 != qry->requests[index - 1].deadline && now >= qry->requests[index - 1].deadline) {
+            array_add (expired, qry->requests[index - 1]);
+            array_rm  (qry->requests, index - 1);
+        }
+    pthread_mutex_unlock (&qry->requestsLock);
+
+    for (size_t index = 0; index < array_count (expired); index++)
+        cryptoClientQRYRequestAbandon (qry, expired[index]);
+
+    array_free (expired);
+}
+
+static void
+cryptoClientQRYRequestsCancel (BRCryptoClientQRYManager qry) {
+    BRArrayOf(BRCryptoClientQRYRequest) cancelled;
+    array_new (cancelled, 1);
+
+    pthread_mutex_lock (&qry->requestsLock);
+    for (size_t index = array_count (qry->requests); index > 0; index--)
+        if (CLIENT_CALLBACK_SUBMIT_TRANSACTION != qry->requests[index - 1].type) {
+            array_add (cancelled, qry->requests[index - 1]);
+            array_rm  (qry->requests, index - 1);
+        }
+    pthread_mutex_unlock (&qry->requestsLock);
+
+    for (size_t index = 0; index < array_count (cancelled); index++)
+        cryptoClientQRYRequestAbandon (qry, cancelled[index]);
+
+    array_free (cancelled);
+}
+
+extern BRCryptoClientRequestId
+cryptoClientCallbackStateGetRequestId (BRCryptoClientCallbackState callbackState) {
+    return callbackState->rid;
+}
+
+extern BRCryptoBoolean
+cryptoClientRequestIsPending (BRCryptoWalletManager cwm,
+                              BRCryptoClientRequestId rid) {
+    BRCryptoClientQRYManager qry = cwm->qryManager;
+
+    pthread_mutex_lock (&qry->requestsLock);
+    bool pending = (SIZE_MAX != cryptoClientQRYRequestFind (qry, rid));
+    pthread_mutex_unlock (&qry->requestsLock);
+
+    return AS_CRYPTO_BOOLEAN (pending);
+}
+
+extern BRCryptoBoolean
+cryptoClientRequestCancel (BRCryptoWalletManager cwm,
+                           BRCryptoClientRequestId rid) {
+    BRCryptoClientQRYManager qry = cwm->qryManager;
+    BRCryptoClientQRYRequest request;
+
+    pthread_mutex_lock (&qry->requestsLock);
+    size_t index = cryptoClientQRYRequestFind (qry, rid);
+    bool cancel  = (SIZE_MAX != index && CLIENT_CALLBACK_SUBMIT_TRANSACTION != qry->requests[index].type);
+    if (cancel) {
+        request = qry->requests[index];
+        array_rm (qry->requests, index);
+    }
+    pthread_mutex_unlock (&qry->requestsLock);
+
+    if (cancel) cryptoClientQRYRequestAbandon (qry, request);
+    return AS_CRYPTO_BOOLEAN (cancel);
+}
+
+extern void
+cryptoClientRequestSetTimeout (BRCryptoWalletManager cwm,
+                               unsigned int seconds) {
+    BRCryptoClientQRYManager qry = cwm->qryManager;
+
+    pthread_mutex_lock (&qry->requestsLock);
+    qry->requestTimeout = seconds;
+    pthread_mutex_unlock (&qry->requestsLock);
+}
+
+extern size_t
+cryptoClientRequestGetPendingCount (BRCryptoWalletManager cwm) {
+    BRCryptoClientQRYManager qry = cwm->qryManager;
+
+    pthread_mutex_lock (&qry->requestsLock);
+    size_t count = array_count (qry->requests);
+    pthread_mutex_unlock (&qry->requestsLock);
+
+    return count;
+}
+
 // MARK: - Client Callback State
 
 static BRCryptoClientCallbackState
@@ -512,6 +711,12 @@ cryptoClientHandleBlockNumber (OwnershipKept BRCryptoWalletManager cwm,
         });
     }
 
+    // The 'tick-tock' is complete (other than the sync, below)
+    pthread_mutex_lock (&cwm->qryManager->lock);
+    if (cwm->qryManager->tick.pending && callbackState->rid == cwm->qryManager->tick.rid)
+        cwm->qryManager->tick.pending = false;
+    pthread_mutex_unlock (&cwm->qryManager->lock);
+
     cryptoClientCallbackStateRelease (callbackState);
     cryptoMemoryFree(blockHashString);
 
@@ -550,6 +755,12 @@ cryptoClientAnnounceBlockNumber (OwnershipKept BRCryptoWalletManager cwm,
                                BRCryptoBoolean success,
                                BRCryptoBlockNumber blockNumber,
                                const char *blockHashString) {
+    // Discard if no longer wanted
+    if (!cryptoClientQRYRequestRemove (cwm->qryManager, callbackState->rid)) {
+        cryptoClientCallbackStateRelease (callbackState);
+        return;
+    }
+
     BRCryptoClientAnnounceBlockNumberEvent event =
     { { NULL, &handleClientAnnounceBlockNumberEventType },
         cryptoWalletManagerTakeWeak(cwm),
@@ -570,6 +781,8 @@ cryptoClientQRYRequestBlockNumber (BRCryptoClientQRYManager qry) {
     BRCryptoClientCallbackState callbackState = cryptoClientCallbackStateCreate (CLIENT_CALLBACK_REQUEST_BLOCK_NUMBER,
                                                                                  qry->requestId++);
 
+    cryptoClientQRYRequestAdd (qry, callbackState->rid, callbackState->type, NULL);
+
     qry->client.funcGetBlockNumber (qry->client.context,
                                     cryptoWalletManagerTake (cwm),
                                     callbackState);
@@ -615,9 +828,8 @@ cryptoClientHandleTransactions (OwnershipKept BRCryptoWalletManager manager,
             case CRYPTO_TRUE: {
                 size_t bundlesCount = array_count(bundles);
 
-                // Save the transaction bundles immediately
-                for (size_t index = 0; index < bundlesCount; index++)
-                    cryptoWalletManagerSaveTransactionBundle(manager, bundles[index]);
+                // Save the transaction bundles immediately; as one DB transaction
+                cryptoWalletManagerSaveTransactionBundles (manager, bundles, bundlesCount);
 
                 // Sort bundles to have the lowest blocknumber first.  Use of `mergesort` is
                 // appropriate given that the bundles are likely already ordered.  This minimizes
@@ -628,9 +840,8 @@ cryptoClientHandleTransactions (OwnershipKept BRCryptoWalletManager manager,
                 mergesort_brd (bundles, bundlesCount, sizeof (BRCryptoClientTransactionBundle),
                                cryptoClientTransactionBundleCompareForSort);
 
-                // Recover transfers from each bundle
-                for (size_t index = 0; index < bundlesCount; index++)
-                   cryptoWalletManagerRecoverTransfersFromTransactionBundle (manager, bundles[index]);
+                // Recover transfers from the bundles
+                cryptoWalletManagerRecoverTransfersFromTransactionBundles (manager, bundles, bundlesCount);
 
                 // The following assumes `bundles` has produced transfers which may have
                 // impacted the wallet's addresses.  Thus the recovery must be *serial w.r.t. the
@@ -700,6 +911,14 @@ cryptoClientAnnounceTransactions (OwnershipKept BRCryptoWalletManager manager,
                                   BRCryptoBoolean success,
                                   BRCryptoClientTransactionBundle *bundles,  // given elements, not array
                                   size_t bundlesCount) {
+    // Discard if no longer wanted
+    if (!cryptoClientQRYRequestRemove (manager->qryManager, callbackState->rid)) {
+        for (size_t index = 0; index < bundlesCount; index++)
+            cryptoClientTransactionBundleRelease (bundles[index]);
+        cryptoClientCallbackStateRelease (callbackState);
+        return;
+    }
+
     BRArrayOf (BRCryptoClientTransactionBundle) eventBundles;
     array_new (eventBundles, bundlesCount);
     array_add_array (eventBundles, bundles, bundlesCount);
@@ -753,8 +972,8 @@ cryptoClientHandleTransfers (OwnershipKept BRCryptoWalletManager manager,
             case CRYPTO_TRUE: {
                 size_t bundlesCount = array_count(bundles);
 
-                for (size_t index = 0; index < bundlesCount; index++)
-                    cryptoWalletManagerSaveTransferBundle(manager, bundles[index]);
+                // Save the transfer bundles immediately; as one DB transaction
+                cryptoWalletManagerSaveTransferBundles (manager, bundles, bundlesCount);
 
                 // Sort bundles to have the lowest blocknumber first.  Use of `mergesort` is
                 // appropriate given that the bundles are likely already ordered.  This minimizes
@@ -833,6 +1052,14 @@ cryptoClientAnnounceTransfers (OwnershipKept BRCryptoWalletManager manager,
                                BRCryptoBoolean success,
                                OwnershipGiven BRCryptoClientTransferBundle *bundles, // given elements, not array
                                size_t bundlesCount) {
+    // Discard if no longer wanted
+    if (!cryptoClientQRYRequestRemove (manager->qryManager, callbackState->rid)) {
+        for (size_t index = 0; index < bundlesCount; index++)
+            cryptoClientTransferBundleRelease (bundles[index]);
+        cryptoClientCallbackStateRelease (callbackState);
+        return;
+    }
+
     BRArrayOf (BRCryptoClientTransferBundle) eventBundles;
     array_new (eventBundles, bundlesCount);
     array_add_array (eventBundles, bundles, bundlesCount);
@@ -903,6 +1130,8 @@ cryptoClientQRYRequestTransactionsOrTransfers (BRCryptoClientQRYManager qry,
                                                                                              newAddresses,
                                                                                              requestId);
 
+        cryptoClientQRYRequestAdd (qry, requestId, type, NULL);
+
         switch (type) {
             case CLIENT_CALLBACK_REQUEST_TRANSFERS:
                 qry->client.funcGetTransfers (qry->client.context,
@@ -1041,7 +1270,8 @@ BREventType handleClientAnnounceSubmitEventType = {
     "CWM: Handle Client Announce Submit Event",
     sizeof (BRCryptoClientAnnounceSubmitEvent),
     (BREventDispatcher) cryptoClientAnnounceSubmitDispatcher,
-    (BREventDestroyer)  cryptoClientAnnounceSubmitDestroyer
+    (BREventDestroyer)  cryptoClientAnnounceSubmitDestroyer,
+    EVENT_PRIORITY_HIGH
 };
 
 extern void
@@ -1050,6 +1280,12 @@ cryptoClientAnnounceSubmitTransfer (OwnershipKept BRCryptoWalletManager manager,
                                     OwnershipKept const char *identifier,
                                     OwnershipKept const char *hash,
                                     BRCryptoBoolean success) {
+    // Discard if no longer wanted (which, as never cancelled, would be a duplicate announcement)
+    if (!cryptoClientQRYRequestRemove (manager->qryManager, callbackState->rid)) {
+        cryptoClientCallbackStateRelease (callbackState);
+        return;
+    }
+
     BRCryptoClientAnnounceSubmitEvent event =
     { { NULL, &handleClientAnnounceSubmitEventType },
         cryptoWalletManagerTakeWeak(manager),
@@ -1076,6 +1312,8 @@ cryptoClientQRYSubmitTransfer (BRCryptoClientQRYManager qry,
     BRCryptoClientCallbackState callbackState =
     cryptoClientCallbackStateCreateSubmitTransaction (wallet, transfer, qry->requestId++);
 
+    cryptoClientQRYRequestAdd (qry, callbackState->rid, callbackState->type, NULL);
+
     qry->client.funcSubmitTransaction (qry->client.context,
                                        manager,
                                        callbackState,
@@ -1155,7 +1393,8 @@ BREventType handleClientAnnounceEstimateTransactionFeeEventType = {
     "CWM: Handle Client Announce EstimateTransactionFee Event",
     sizeof (BRCryptoClientAnnounceEstimateTransactionFeeEvent),
     (BREventDispatcher) cryptoClientAnnounceEstimateTransactionFeeDispatcher,
-    (BREventDestroyer)  cryptoClientAnnounceEstimateTransactionFeeDestroyer
+    (BREventDestroyer)  cryptoClientAnnounceEstimateTransactionFeeDestroyer,
+    EVENT_PRIORITY_HIGH
 };
 
 extern void
@@ -1166,6 +1405,12 @@ cryptoClientAnnounceEstimateTransactionFee (OwnershipKept BRCryptoWalletManager
                                             size_t attributesCount,
                                             OwnershipKept const char **attributeKeys,
                                             OwnershipKept const char **attributeVals) {
+    // Discard if no longer wanted
+    if (!cryptoClientQRYRequestRemove (manager->qryManager, callbackState->rid)) {
+        cryptoClientCallbackStateRelease (callbackState);
+        return;
+    }
+
     BRArrayOf(char *) keys;
     array_new (keys, attributesCount);
     array_add_array (keys, (char**) attributeKeys, attributesCount);
@@ -1218,6 +1463,8 @@ cryptoClientQRYEstimateTransferFee (BRCryptoClientQRYManager qry,
                                                                                                        initialFeeBasis,
                                                                                                        rid);
 
+    cryptoClientQRYRequestAdd (qry, rid, CLIENT_CALLBACK_ESTIMATE_TRANSACTION_FEE, cookie);
+
     qry->client.funcEstimateTransactionFee (qry->client.context,
                                             cryptoWalletManagerTake(manager),
                                             callbackState,
@@ -1226,6 +1473,85 @@ cryptoClientQRYEstimateTransferFee (BRCryptoClientQRYManager qry,
                                             hashAsHex);
 }
 
+// MARK: - Abandon Request
+
+typedef struct {
+    BREvent base;
+    BRCryptoWalletManager manager;
+    BRCryptoClientQRYRequest request;
+} BRCryptoClientAbandonRequestEvent;
+
+static void
+cryptoClientHandleAbandonRequest (OwnershipKept BRCryptoWalletManager manager,
+                                  BRCryptoClientQRYRequest request) {
+    BRCryptoClientQRYManager qry = manager->qryManager;
+
+    switch (request.type) {
+        case CLIENT_CALLBACK_REQUEST_BLOCK_NUMBER:
+            // Allow the next 'tick-tock' to request the block number
+            pthread_mutex_lock (&qry->lock);
+            if (qry->tick.pending && request.rid == qry->tick.rid)
+                qry->tick.pending = false;
+            pthread_mutex_unlock (&qry->lock);
+            break;
+
+        case CLIENT_CALLBACK_REQUEST_TRANSFERS:
+        case CLIENT_CALLBACK_REQUEST_TRANSACTIONS: {
+            // End the sync, unsuccessfully, so that the next 'tick-tock' can start another.
+            pthread_mutex_lock (&qry->lock);
+            bool matchedRids = (request.rid == qry->sync.rid);
+            pthread_mutex_unlock (&qry->lock);
+
+            if (matchedRids) cryptoClientQRYManagerUpdateSync (qry, true, false, true);
+            break;
+        }
+
+        case CLIENT_CALLBACK_ESTIMATE_TRANSACTION_FEE:
+            cryptoWalletGenerateEvent (manager->wallet,
+                                       cryptoWalletEventCreateFeeBasisEstimated (CRYPTO_ERROR_FAILED,
+                                                                                 request.cookie,
+                                                                                 NULL));
+            break;
+
+        case CLIENT_CALLBACK_SUBMIT_TRANSACTION:
+            assert (false);     // never abandoned
+            break;
+    }
+}
+
+static void
+cryptoClientAbandonRequestDispatcher (BREventHandler ignore,
+                                      BRCryptoClientAbandonRequestEvent *event) {
+    cryptoClientHandleAbandonRequest (event->manager, event->request);
+    cryptoWalletManagerGive (event->manager);
+}
+
+static void
+cryptoClientAbandonRequestDestroyer (BRCryptoClientAbandonRequestEvent *event) {
+    cryptoWalletManagerGive (event->manager);
+}
+
+BREventType handleClientAbandonRequestEventType = {
+    "CWM: Handle Client Abandon Request Event",
+    sizeof (BRCryptoClientAbandonRequestEvent),
+    (BREventDispatcher) cryptoClientAbandonRequestDispatcher,
+    (BREventDestroyer)  cryptoClientAbandonRequestDestroyer
+};
+
+static void
+cryptoClientQRYRequestAbandon (BRCryptoClientQRYManager qry,
+                               BRCryptoClientQRYRequest request) {
+    BRCryptoWalletManager manager = cryptoWalletManagerTakeWeak (qry->manager);
+    if (NULL == manager) return;
+
+    BRCryptoClientAbandonRequestEvent event =
+    { { NULL, &handleClientAbandonRequestEventType },
+        manager,
+        request };
+
+    eventHandlerSignalEvent (manager->handler, (BREvent *) &event);
+}
+
 // MARK: - Transfer Bundle
 
 extern BRCryptoClientTransferBundle
@@ -201,7 +201,7 @@ struct BRCryptoClientCallbackStateRecord {
         } estimateTransactionFee;
         // ...
     } u;
-    size_t rid;
+    BRCryptoClientRequestId rid;
 };
 
 // MARK: - P2P/QRY Type
@@ -334,6 +334,16 @@ typedef enum {
     CRYPTO_CLIENT_REQUEST_USE_TRANSACTIONS,
 } BRCryptoClientQRYByType;
 
+/// A request made of the client and not yet announced.  Once cancelled or timed out a request is
+/// 'abandoned': its eventual announcement is discarded and the QRY manager proceeds as if the
+/// request had failed.
+typedef struct {
+    BRCryptoClientRequestId rid;
+    BRCryptoClientCallbackType type;
+    time_t deadline;                // zero if never timed out
+    BRCryptoCookie cookie;          // for CLIENT_CALLBACK_ESTIMATE_TRANSACTION_FEE
+} BRCryptoClientQRYRequest;
+
 struct BRCryptoClientQRYManagerRecord {
     BRCryptoClient client;
     BRCryptoWalletManager manager;
@@ -349,14 +359,41 @@ struct BRCryptoClientQRYManagerRecord {
         size_t rid;
     } sync;
 
+    // A 'tick-tock' block number request is outstanding; `ticksSkipped` counts the subsequent
+    // 'tick-tocks' skipped while waiting for it.
+    struct {
+        bool pending;
+        size_t rid;
+        unsigned int ticksSkipped;
+    } tick;
+
     bool connected;
     size_t requestId;
 
+    // The pending requests.  These have their own lock because requests are announced on
+    // arbitrary threads and, possibly, from within a client function called with `lock` held.
+    BRArrayOf(BRCryptoClientQRYRequest) requests;
+    unsigned int requestTimeout;    // in seconds; zero if never timed out
+    pthread_mutex_t requestsLock;
+
     pthread_mutex_t lock;
 };
 
 #define CRYPTO_CLIENT_QRY_IS_UNBOUNDED            (true)
 
+// The default time allowed for the client to announce a request; zero, thus timeouts are opt-in
+// with `cryptoClientRequestSetTimeout()`.  Submits are never timed out.
+#define CRYPTO_CLIENT_QRY_REQUEST_TIMEOUT_DEFAULT (0)
+
+// The maximum number of pending requests.  Once reached, the oldest request other than a submit is
+// abandoned to make room for a new one.  Submits are never abandoned; only when all pending
+// requests are submits are there more.  Bounds the requests of a client that never announces.
+#define CRYPTO_CLIENT_QRY_REQUESTS_MAXIMUM        (100)
+
+// The maximum number of consecutive 'tick-tocks' skipped while the block number request from a
+// prior 'tick-tock' is outstanding.  Bounds the wait for a request that is never answered.
+#define CRYPTO_CLIENT_QRY_TICKS_SKIPPED_MAXIMUM   (3)
+
 extern BRCryptoClientQRYManager
 cryptoClientQRYManagerCreate (BRCryptoClient client,
                               BRCryptoWalletManager manager,
@@ -404,13 +441,15 @@ extern BREventType handleClientAnnounceTransactionsEventType;
 extern BREventType handleClientAnnounceTransfersEventType;
 extern BREventType handleClientAnnounceSubmitEventType;
 extern BREventType handleClientAnnounceEstimateTransactionFeeEventType;
+extern BREventType handleClientAbandonRequestEventType;
 
 #define CRYPTO_CLIENT_EVENT_TYPES             \
   &handleClientAnnounceBlockNumberEventType,  \
   &handleClientAnnounceTransactionsEventType, \
   &handleClientAnnounceTransfersEventType,    \
   &handleClientAnnounceSubmitEventType,       \
-  &handleClientAnnounceEstimateTransactionFeeEventType
+  &handleClientAnnounceEstimateTransactionFeeEventType, \
+  &handleClientAbandonRequestEventType
 
 #ifdef __cplusplus
 }
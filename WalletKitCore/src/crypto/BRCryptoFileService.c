@@ -141,7 +141,8 @@ BRFileServiceTypeSpecification cryptoFileServiceSpecifications[] = {
                 cryptoFileServiceTypeTransferV1Reader,
                 cryptoFileServiceTypeTransferV1Writer
             },
-        }
+        },
+        (BRFileServiceReleaser) cryptoClientTransferBundleRelease
     },
 
     {
@@ -155,7 +156,96 @@ BRFileServiceTypeSpecification cryptoFileServiceSpecifications[] = {
                 cryptoFileServiceTypeTransactionV1Reader,
                 cryptoFileServiceTypeTransactionV1Writer
             },
-        }
+        },
+        (BRFileServiceReleaser) cryptoClientTransactionBundleRelease
     }
 };
 size_t cryptoFileServiceSpecificationsCount = (sizeof (cryptoFileServiceSpecifications) / sizeof (BRFileServiceTypeSpecification));
+
+// SQLite's own journal and synchronous settings, as before any configuration.  A host may opt-in
+// to WAL with NORMAL; see `cryptoSystemSetWriteAheadLogging()`.
+BRFileServiceConfiguration cryptoFileServiceConfiguration = {
+    FILE_SERVICE_JOURNAL_MODE_DEFAULT,
+    FILE_SERVICE_SYNCHRONOUS_DEFAULT,
+    FILE_SERVICE_TEMP_STORE_DEFAULT,
+    0,
+    0,
+    0,
+    0,      // decode serially; opt-in to parallel decoding with `loadWorkersCount` > 1
+    0       // write synchronously; opt-in to `writeBehind`
+};
+
+BRCryptoBoolean cryptoFileServicePooled = CRYPTO_FALSE;
+
+// Split `basePath` into the pool's path and the partition (the account).  Returns NULL for a
+// `basePath` w/o a partition.
+static char *
+cryptoFileServicePoolPath (const char *basePath,
+                           const char **partition) {
+    const char *separator = strrchr (basePath, '/');
+    if (NULL == separator || separator == basePath || '\0' == separator[1]) return NULL;
+
+    *partition = &separator[1];
+    return strndup (basePath, (size_t) (separator - basePath));
+}
+
+private_extern BRFileService
+cryptoFileServiceCreate (const char *basePath,
+                         const char *currency,
+                         const char *network,
+                         BRFileServiceContext context,
+                         BRFileServiceErrorHandler handler,
+                         size_t specificationsCount,
+                         BRFileServiceTypeSpecification *specifications) {
+    const char *partition = NULL;
+    char       *poolPath  = (CRYPTO_TRUE == cryptoFileServicePooled
+                             ? cryptoFileServicePoolPath (basePath, &partition)
+                             : NULL);
+
+    if (NULL == poolPath)
+        return fileServiceCreateFromTypeSpecifications (basePath, currency, network,
+                                                        context, handler,
+                                                        &cryptoFileServiceConfiguration,
+                                                        specificationsCount,
+                                                        specifications);
+
+    // The file service holds its own reference to the pool.
+    BRFileServicePool pool = fileServicePoolCreate (poolPath, &cryptoFileServiceConfiguration);
+    free (poolPath);
+    if (NULL == pool) return NULL;
+
+    BRFileService fs = fileServiceCreateFromTypeSpecificationsInPool (pool, partition, currency, network,
+                                                                      context, handler,
+                                                                      specificationsCount,
+                                                                      specifications);
+    fileServicePoolRelease (pool);
+
+    return fs;
+}
+
+private_extern void
+cryptoFileServiceWipe (const char *basePath,
+                       const char *currency,
+                       const char *network) {
+    char headersPath[strlen (basePath) + 1 + strlen (currency) + 1 + strlen (network) + 1 +
+                     strlen (CRYPTO_FILE_SERVICE_HEADERS_FILENAME) + 1];
+    sprintf (headersPath, "%s/%s-%s-%s", basePath, currency, network, CRYPTO_FILE_SERVICE_HEADERS_FILENAME);
+    remove (headersPath);
+
+    const char *partition = NULL;
+    char       *poolPath  = (CRYPTO_TRUE == cryptoFileServicePooled
+                             ? cryptoFileServicePoolPath (basePath, &partition)
+                             : NULL);
+
+    if (NULL == poolPath) {
+        fileServiceWipe (basePath, currency, network);
+        return;
+    }
+
+    BRFileServicePool pool = fileServicePoolCreate (poolPath, &cryptoFileServiceConfiguration);
+    free (poolPath);
+    if (NULL == pool) return;
+
+    fileServicePoolWipe (pool, partition, currency, network);
+    fileServicePoolRelease (pool);
+}
@@ -69,4 +69,42 @@ cryptoFileServiceTypeTransactionV1Writer (BRFileServiceContext context,
 extern BRFileServiceTypeSpecification cryptoFileServiceSpecifications[];
 extern size_t cryptoFileServiceSpecificationsCount;
 
+/// The configuration used for all the crypto file services (system and wallet managers).  Keeps
+/// SQLite's default journal mode and synchronization unless a host opts-in to WAL with NORMAL
+/// with `cryptoSystemSetWriteAheadLogging()`.  Saves are synchronous, thus
+/// `fileServiceSave()` reports the write's result; a host may set `writeBehind` so that saves
+/// from an event handler don't wait on disk I/O.  Entities are decoded serially during a load; a
+/// host on a multi-core device may set `loadWorkersCount`.  A host may modify this prior to
+/// creating any BRCryptoSystem.
+extern BRFileServiceConfiguration cryptoFileServiceConfiguration;
+
+/// If CRYPTO_TRUE, the file services of all accounts sharing a base path (the system and every
+/// wallet manager) share one pooled database, partitioned by account, currency and network.
+/// Otherwise each file service has its own database.  Entities saved in one mode are not seen
+/// in the other.  A host may modify this prior to creating any BRCryptoSystem.
+extern BRCryptoBoolean cryptoFileServicePooled;
+
+/// Create a file service, per `cryptoFileServicePooled`, for `basePath` - an account's path,
+/// as `<base path>/<account file system identifier>`.
+private_extern BRFileService
+cryptoFileServiceCreate (const char *basePath,
+                         const char *currency,
+                         const char *network,
+                         BRFileServiceContext context,
+                         BRFileServiceErrorHandler handler,
+                         size_t specificationsCount,
+                         BRFileServiceTypeSpecification *specifications);
+
+/// The name of a file, kept alongside the file service's data as
+/// `<base path>/<currency>-<network>-<name>`, holding a chain's block headers.  See
+/// `saveBlocksBTC()`
+#define CRYPTO_FILE_SERVICE_HEADERS_FILENAME    "headers.dat"
+
+/// Delete the data of the file service for `basePath`, `currency` and `network`, including any
+/// block headers.
+private_extern void
+cryptoFileServiceWipe (const char *basePath,
+                       const char *currency,
+                       const char *network);
+
 #endif /* BRCryptoFileService_h */
@@ -19,151 +19,270 @@
 
 IMPLEMENT_CRYPTO_GIVE_TAKE (BRCryptoListener, cryptoListener)
 
-// MARK: - Generate Transfer Event
+// MARK: - Listener Event
 
-typedef struct {
-    BREvent base;
-    BRCryptoListener listener;
-    BRCryptoWalletManager manager;
-    BRCryptoWallet wallet;
-    BRCryptoTransfer transfer;
-    BRCryptoTransferEvent event;
-} BRListenerSignalTransferEvent;
+static void
+cryptoListenerEventGive (BRCryptoListenerEvent *event) {
+    switch (event->type) {
+        case CRYPTO_LISTENER_EVENT_WALLET:
+            cryptoWalletEventGive (event->u.wallet);
+            break;
+
+        case CRYPTO_LISTENER_EVENT_TRANSFER:
+            if (CRYPTO_TRANSFER_EVENT_CHANGED == event->u.transfer.type) {
+                cryptoTransferStateGive (event->u.transfer.u.state.old);
+                cryptoTransferStateGive (event->u.transfer.u.state.new);
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    cryptoSystemGive         (event->system);
+    cryptoNetworkGive        (event->network);
+    cryptoWalletManagerGive  (event->manager);
+    cryptoWalletGive         (event->wallet);
+    cryptoTransferGive       (event->transfer);
+}
 
 static void
-cryptoListenerSignalTransferEventDispatcher (BREventHandler ignore,
-                                             BRListenerSignalTransferEvent *event) {
-    event->listener->transferCallback (event->listener->context,
+cryptoListenerEventDeliver (BRCryptoListener listener,
+                            BRCryptoListenerEvent *event) {
+    switch (event->type) {
+        case CRYPTO_LISTENER_EVENT_SYSTEM:
+            listener->systemCallback (listener->context,
+                                      event->system,
+                                      event->u.system);
+            break;
+
+        case CRYPTO_LISTENER_EVENT_NETWORK:
+            listener->networkCallback (listener->context,
+                                       event->network,
+                                       event->u.network);
+            break;
+
+        case CRYPTO_LISTENER_EVENT_MANAGER:
+            listener->managerCallback (listener->context,
                                        event->manager,
-                                       event->wallet,
-                                       event->transfer,
-                                       event->event);
+                                       event->u.manager);
+            break;
+
+        case CRYPTO_LISTENER_EVENT_WALLET:
+            listener->walletCallback (listener->context,
+                                      event->manager,
+                                      event->wallet,
+                                      event->u.wallet);
+            break;
+
+        case CRYPTO_LISTENER_EVENT_TRANSFER:
+            listener->transferCallback (listener->context,
+                                        event->manager,
+                                        event->wallet,
+                                        event->transfer,
+                                        event->u.transfer);
+            break;
+    }
 }
 
-static BREventType handleListenerSignalTransferEventType = {
-    "CWM: Handle Listener Transfer EVent",
-    sizeof (BRListenerSignalTransferEvent),
-    (BREventDispatcher) cryptoListenerSignalTransferEventDispatcher
-};
+static bool
+cryptoListenerEventIsCoalescable (const BRCryptoListenerEvent *event) {
+    switch (event->type) {
+        case CRYPTO_LISTENER_EVENT_WALLET: {
+            BRCryptoWalletEventType type = cryptoWalletEventGetType (event->u.wallet);
+            return (CRYPTO_WALLET_EVENT_BALANCE_UPDATED  == type ||
+                    CRYPTO_WALLET_EVENT_TRANSFER_CHANGED == type);
+        }
+
+        case CRYPTO_LISTENER_EVENT_TRANSFER:
+            return CRYPTO_TRANSFER_EVENT_CHANGED == event->u.transfer.type;
+
+        default:
+            return false;
+    }
+}
 
-extern void
-cryptoListenerGenerateTransferEvent (const BRCryptoTransferListener *listener,
-                                     BRCryptoTransfer transfer,
-                                     BRCryptoTransferEvent event) {
-    if (NULL == listener || NULL == listener->listener) return;
+///
+/// Check if `later` makes `earlier` redundant.  Both must be coalescable.
+///
+static bool
+cryptoListenerEventIsCoalescableWith (const BRCryptoListenerEvent *earlier,
+                                      const BRCryptoListenerEvent *later) {
+    if (earlier->type != later->type || !cryptoListenerEventIsCoalescable (earlier)) return false;
+
+    switch (later->type) {
+        case CRYPTO_LISTENER_EVENT_WALLET: {
+            BRCryptoWalletEventType type = cryptoWalletEventGetType (later->u.wallet);
+
+            if (earlier->wallet != later->wallet ||
+                type != cryptoWalletEventGetType (earlier->u.wallet)) return false;
+
+            if (CRYPTO_WALLET_EVENT_TRANSFER_CHANGED != type) return true;
 
-    BRListenerSignalTransferEvent listenerEvent =
-    { { NULL, &handleListenerSignalTransferEventType},
-        listener->listener,
-        cryptoWalletManagerTakeWeak (listener->manager),
-        cryptoWalletTakeWeak (listener->wallet),
-        cryptoTransferTakeWeak (transfer),
-        event };
+            BRCryptoTransfer earlierTransfer = NULL, laterTransfer = NULL;
+            cryptoWalletEventExtractTransfer (earlier->u.wallet, &earlierTransfer);
+            cryptoWalletEventExtractTransfer (later->u.wallet,   &laterTransfer);
 
-    eventHandlerSignalEvent(listener->listener->handler, (BREvent *) &listenerEvent);
+            bool same = (earlierTransfer == laterTransfer);
+
+            cryptoTransferGive (earlierTransfer);
+            cryptoTransferGive (laterTransfer);
+            return same;
+        }
+
+        case CRYPTO_LISTENER_EVENT_TRANSFER:
+            return earlier->transfer == later->transfer;
+
+        default:
+            return false;
+    }
 }
 
-// MARK: - Generate Wallet Event
+// MARK: - Listener Batch Event
 
 typedef struct {
     BREvent base;
     BRCryptoListener listener;
-    BRCryptoWalletManager manager;
-    BRCryptoWallet wallet;
-    BRCryptoWalletEvent event;
-} BRListenerSignalWalletEvent;
+} BRListenerSignalBatchEvent;
 
 static void
-cryptoListenerSignalWalletEventDispatcher (BREventHandler ignore,
-                                           BRListenerSignalWalletEvent *event) {
-    event->listener->walletCallback (event->listener->context,
-                                     event->manager,
-                                     event->wallet,
-                                     event->event);
+cryptoListenerSignalBatchEventDispatcher (BREventHandler ignore,
+                                          BRListenerSignalBatchEvent *event) {
+    BRCryptoListener listener = event->listener;
+
+    // Take all the pending events; subsequently generated events will signal another batch.
+    pthread_mutex_lock (&listener->pendingLock);
+    BRArrayOf(BRCryptoListenerEvent) events = listener->pending;
+    listener->pending    = listener->delivering;
+    listener->delivering = events;
+    listener->pendingSignalled = false;
+    pthread_mutex_unlock (&listener->pendingLock);
+
+    size_t eventsCount = array_count (events);
+    if (0 == eventsCount) return;
+
+    // Deliver w/o holding `lock`; a callback may set the batch callback.
+    pthread_mutex_lock (&listener->lock);
+    BRCryptoListenerBatchCallback batchCallback = listener->batchCallback;
+    pthread_mutex_unlock (&listener->lock);
+
+    if (NULL != batchCallback)
+        batchCallback (listener->context, events, eventsCount);
+    else
+        for (size_t index = 0; index < eventsCount; index++)
+            cryptoListenerEventDeliver (listener, &events[index]);
+
+    array_clear (events);
 }
 
-static BREventType handleListenerSignalWalletEventType = {
-    "CWM: Handle Listener Wallet Event",
-    sizeof (BRListenerSignalWalletEvent),
-    (BREventDispatcher) cryptoListenerSignalWalletEventDispatcher
+static BREventType handleListenerSignalBatchEventType = {
+    "CWM: Handle Listener Batch Event",
+    sizeof (BRListenerSignalBatchEvent),
+    (BREventDispatcher) cryptoListenerSignalBatchEventDispatcher
 };
 
-extern void
-cryptoListenerGenerateWalletEvent (const BRCryptoWalletListener *listener,
-                                   BRCryptoWallet wallet,
-                                   OwnershipGiven BRCryptoWalletEvent event) {
-    if (NULL == listener || NULL == listener->listener) return;
+///
+/// Signal the batch event, unless already signalled.  Called with `pendingLock` held.
+///
+static void
+cryptoListenerSignalBatchIfNecessary (BRCryptoListener listener) {
+    if (listener->pendingSignalled || 0 == array_count (listener->pending)) return;
+    listener->pendingSignalled = true;
 
-    BRListenerSignalWalletEvent listenerEvent =
-    { { NULL, &handleListenerSignalWalletEventType},
-        listener->listener,
-        cryptoWalletManagerTakeWeak (listener->manager),
-        cryptoWalletTakeWeak (wallet),
-        event };
+    BRListenerSignalBatchEvent listenerEvent =
+    { { NULL, &handleListenerSignalBatchEventType },
+        listener };
 
-    eventHandlerSignalEvent(listener->listener->handler, (BREvent *) &listenerEvent);
+    eventHandlerSignalEvent (listener->handler, (BREvent *) &listenerEvent);
 }
 
-// MARK: - Generate Manager Event
-
-typedef struct {
-    BREvent base;
-    BRCryptoListener listener;
-    BRCryptoWalletManager manager;
-    BRCryptoWalletManagerEvent event;
-} BRListenerSignalManagerEvent;
+///
+/// Remove a pending event made redundant by `event`, if one is found within the coalesce window;
+/// for a transfer CHANGED event `event` assumes the removed event's `old` state.  Called with
+/// `pendingLock` held.
+///
+static void
+cryptoListenerCoalesce (BRCryptoListener listener,
+                        BRCryptoListenerEvent *event) {
+    if (!cryptoListenerEventIsCoalescable (event)) return;
+
+    size_t count = array_count (listener->pending);
+    size_t limit = (count < CRYPTO_LISTENER_COALESCE_WINDOW ? count : CRYPTO_LISTENER_COALESCE_WINDOW);
+
+    for (size_t offset = 1; offset <= limit; offset++) {
+        size_t index = count - offset;
+        BRCryptoListenerEvent *earlier = &listener->pending[index];
+
+        if (cryptoListenerEventIsCoalescableWith (earlier, event)) {
+            if (CRYPTO_LISTENER_EVENT_TRANSFER == event->type) {
+                BRCryptoTransferState old = event->u.transfer.u.state.old;
+                event->u.transfer.u.state.old   = earlier->u.transfer.u.state.old;
+                earlier->u.transfer.u.state.old = old;
+            }
+
+            cryptoListenerEventGive (earlier);
+            array_rm (listener->pending, index);
+            return;
+        }
+    }
+}
 
 static void
-cryptoListenerSignalManagerEventDispatcher (BREventHandler ignore,
-                                            BRListenerSignalManagerEvent *event) {
-    event->listener->managerCallback (event->listener->context,
-                                      event->manager,
-                                      event->event);
+cryptoListenerAnnounce (BRCryptoListener listener,
+                        BRCryptoListenerEvent event) {
+    pthread_mutex_lock (&listener->pendingLock);
+    if (listener->coalesce) cryptoListenerCoalesce (listener, &event);
+    array_add (listener->pending, event);
+    cryptoListenerSignalBatchIfNecessary (listener);
+    pthread_mutex_unlock (&listener->pendingLock);
 }
 
-static BREventType handleListenerSignalManagerEventType = {
-    "CWM: Handle Listener Manager Event",
-    sizeof (BRListenerSignalManagerEvent),
-    (BREventDispatcher) cryptoListenerSignalManagerEventDispatcher
-};
+// MARK: - Generate Transfer Event
 
 extern void
-cryptoListenerGenerateManagerEvent (const BRCryptoWalletManagerListener *listener,
-                                    BRCryptoWalletManager manager,
-                                    BRCryptoWalletManagerEvent event) {
+cryptoListenerGenerateTransferEvent (const BRCryptoTransferListener *listener,
+                                     BRCryptoTransfer transfer,
+                                     BRCryptoTransferEvent event) {
     if (NULL == listener || NULL == listener->listener) return;
 
-    BRListenerSignalManagerEvent listenerEvent =
-    { { NULL, &handleListenerSignalManagerEventType},
-        listener->listener,
-        cryptoWalletManagerTakeWeak (manager),
-        event };
+    cryptoListenerAnnounce (listener->listener, (BRCryptoListenerEvent) {
+        CRYPTO_LISTENER_EVENT_TRANSFER,
+        .manager  = cryptoWalletManagerTakeWeak (listener->manager),
+        .wallet   = cryptoWalletTakeWeak (listener->wallet),
+        .transfer = cryptoTransferTakeWeak (transfer),
+        .u.transfer = event });
+}
+
+// MARK: - Generate Wallet Event
+
+extern void
+cryptoListenerGenerateWalletEvent (const BRCryptoWalletListener *listener,
+                                   BRCryptoWallet wallet,
+                                   OwnershipGiven BRCryptoWalletEvent event) {
+    if (NULL == listener || NULL == listener->listener) return;
 
-    eventHandlerSignalEvent (listener->listener->handler, (BREvent *) &listenerEvent);
+    cryptoListenerAnnounce (listener->listener, (BRCryptoListenerEvent) {
+        CRYPTO_LISTENER_EVENT_WALLET,
+        .manager  = cryptoWalletManagerTakeWeak (listener->manager),
+        .wallet   = cryptoWalletTakeWeak (wallet),
+        .u.wallet = event });
 }
 
-// MARK: - Generate Network Event
+// MARK: - Generate Manager Event
 
-typedef struct {
-    BREvent base;
-    BRCryptoListener listener;
-    BRCryptoNetwork network;
-    BRCryptoNetworkEvent event;
-} BRListenerSignalNetworkEvent;
+extern void
+cryptoListenerGenerateManagerEvent (const BRCryptoWalletManagerListener *listener,
+                                    BRCryptoWalletManager manager,
+                                    BRCryptoWalletManagerEvent event) {
+    if (NULL == listener || NULL == listener->listener) return;
 
-static void
-cryptoListenerSignalNetworkEventDispatcher (BREventHandler ignore,
-                                            BRListenerSignalNetworkEvent *event) {
-    event->listener->networkCallback (event->listener->context,
-                                      event->network,
-                                      event->event);
+    cryptoListenerAnnounce (listener->listener, (BRCryptoListenerEvent) {
+        CRYPTO_LISTENER_EVENT_MANAGER,
+        .manager   = cryptoWalletManagerTakeWeak (manager),
+        .u.manager = event });
 }
 
-static BREventType handleListenerSignalNetworkEventType = {
-    "CWM: Handle Listener Network Event",
-    sizeof (BRListenerSignalNetworkEvent),
-    (BREventDispatcher) cryptoListenerSignalNetworkEventDispatcher
-};
+// MARK: - Generate Network Event
 
 extern void
 cryptoListenerGenerateNetworkEvent (const BRCryptoNetworkListener *listener,
@@ -171,66 +290,35 @@ cryptoListenerGenerateNetworkEvent (const BRCryptoNetworkListener *listener,
                                     BRCryptoNetworkEvent event) {
     if (NULL == listener || NULL == listener->listener) return;
 
-    BRListenerSignalNetworkEvent listenerEvent =
-    { { NULL, &handleListenerSignalNetworkEventType},
-        listener->listener,
-        cryptoNetworkTakeWeak (network),
-        event };
-
-    eventHandlerSignalEvent (listener->listener->handler, (BREvent *) &listenerEvent);
+    cryptoListenerAnnounce (listener->listener, (BRCryptoListenerEvent) {
+        CRYPTO_LISTENER_EVENT_NETWORK,
+        .network   = cryptoNetworkTakeWeak (network),
+        .u.network = event });
 }
 
 // MARK: - Generate System Event
 
-typedef struct {
-    BREvent base;
-    BRCryptoListener listener;
-    BRCryptoSystem system;
-    BRCryptoSystemEvent event;
-} BRListenerSignalSystemEvent;
-
-static void
-cryptoListenerSignalSystemEventDispatcher (BREventHandler ignore,
-                                           BRListenerSignalSystemEvent *event) {
-    event->listener->systemCallback (event->listener->context,
-                                     event->system,
-                                     event->event);
-}
-
-static BREventType handleListenerSignalSystemEventType = {
-    "CWM: Handle Listener System Event",
-    sizeof (BRListenerSignalSystemEvent),
-    (BREventDispatcher) cryptoListenerSignalSystemEventDispatcher
-};
-
 extern void
 cryptoListenerGenerateSystemEvent (BRCryptoListener listener,
                                    BRCryptoSystem system,
                                    BRCryptoSystemEvent event) {
     if (NULL == listener) return;
 
-    BRListenerSignalSystemEvent listenerEvent =
-    { { NULL, &handleListenerSignalSystemEventType},
-        listener,
-        cryptoSystemTakeWeak (system),
-        event };
-
-    eventHandlerSignalEvent (listener->handler, (BREvent *) &listenerEvent);
+    cryptoListenerAnnounce (listener, (BRCryptoListenerEvent) {
+        CRYPTO_LISTENER_EVENT_SYSTEM,
+        .system   = cryptoSystemTakeWeak (system),
+        .u.system = event });
 }
 
 // MARK: - Event Type
 
 static const BREventType *
 cryptoListenerEventTypes[] = {
-    &handleListenerSignalNetworkEventType,
-    &handleListenerSignalTransferEventType,
-    &handleListenerSignalWalletEventType,
-    &handleListenerSignalManagerEventType,
-    &handleListenerSignalSystemEventType
+    &handleListenerSignalBatchEventType
 };
 
 static const unsigned int
-cryptoListenerEventTypesCount = (sizeof (cryptoListenerEventTypes) / sizeof(BREventType*)); //  11
+cryptoListenerEventTypesCount = (sizeof (cryptoListenerEventTypes) / sizeof(BREventType*));
 
 extern BRCryptoListener
 cryptoListenerCreate (BRCryptoListenerContext context,
@@ -252,10 +340,18 @@ cryptoListenerCreate (BRCryptoListenerContext context,
     listener->walletCallback   = walletCallback;
     listener->transferCallback = transferCallback;
 
+    listener->batchCallback = NULL;
+    listener->coalesce      = CRYPTO_FALSE;
+
+    pthread_mutex_init_brd (&listener->pendingLock, PTHREAD_MUTEX_NORMAL);
+    array_new (listener->pending,    10);
+    array_new (listener->delivering, 10);
+    listener->pendingSignalled = false;
+
     listener->handler = eventHandlerCreate ("Core SYS, Listener",
                                             cryptoListenerEventTypes,
                                             cryptoListenerEventTypesCount,
-                                            &listener->lock);
+                                            NULL);
 
     return listener;
 }
@@ -265,18 +361,52 @@ cryptoListenerRelease (BRCryptoListener listener) {
     eventHandlerStop (listener->handler);
     eventHandlerDestroy (listener->handler);
 
+    // Release undelivered events
+    for (size_t index = 0; index < array_count (listener->pending); index++)
+        cryptoListenerEventGive (&listener->pending[index]);
+    array_free (listener->pending);
+    array_free (listener->delivering);
+
+    pthread_mutex_destroy (&listener->pendingLock);
     pthread_mutex_destroy (&listener->lock);
 
     memset (listener, 0, sizeof(*listener));
     free (listener);
 }
 
+extern void
+cryptoListenerSetBatchCallback (BRCryptoListener listener,
+                                BRCryptoListenerBatchCallback batchCallback) {
+    pthread_mutex_lock (&listener->lock);
+    listener->batchCallback = batchCallback;
+    pthread_mutex_unlock (&listener->lock);
+}
+
+extern void
+cryptoListenerSetCoalescing (BRCryptoListener listener,
+                             BRCryptoBoolean coalesce) {
+    pthread_mutex_lock (&listener->pendingLock);
+    listener->coalesce = coalesce;
+    pthread_mutex_unlock (&listener->pendingLock);
+}
+
 extern void
 cryptoListenerStart (BRCryptoListener listener) {
     eventHandlerStart (listener->handler);
+
+    // Events pending from before a stop lost their batch event when the handler was cleared.
+    pthread_mutex_lock (&listener->pendingLock);
+    cryptoListenerSignalBatchIfNecessary (listener);
+    pthread_mutex_unlock (&listener->pendingLock);
 }
 
 extern void
 cryptoListenerStop (BRCryptoListener listener) {
     eventHandlerStop (listener->handler);
+
+    // Stopping clears the handler, including any batch event; keep the pending events for a
+    // subsequent start.
+    pthread_mutex_lock (&listener->pendingLock);
+    listener->pendingSignalled = false;
+    pthread_mutex_unlock (&listener->pendingLock);
 }
@@ -12,6 +12,7 @@
 #define BRCryptoListenerP_h
 
 #include "BRCryptoListener.h"
+#include "support/BRArray.h"
 #include "support/event/BREvent.h"
 
 #include <pthread.h>
@@ -22,6 +23,10 @@ extern "C" {
 
 // MARK: Crypto Listener
 
+/// The number of most-recent pending events searched for an event to coalesce with.  Bounds
+/// the cost of generating an event no matter how far behind the listener's callbacks are.
+#define CRYPTO_LISTENER_COALESCE_WINDOW         (64)
+
 struct BRCryptoListenerRecord {
     BRCryptoRef ref;
     pthread_mutex_t lock;
@@ -34,6 +39,18 @@ struct BRCryptoListenerRecord {
     BRCryptoListenerWalletManagerCallback managerCallback;
     BRCryptoListenerWalletCallback        walletCallback;
     BRCryptoListenerTransferCallback      transferCallback;
+
+    // Protected by `lock`, which is not held while events are delivered
+    BRCryptoListenerBatchCallback         batchCallback;
+    BRCryptoBoolean coalesce;
+
+    // Events generated but not yet delivered, protected by `pendingLock`.  Exactly one 'batch'
+    // event is queued on `handler` whenever `pendingSignalled` holds.  The `delivering` events
+    // are only accessed on the handler's thread.
+    pthread_mutex_t pendingLock;
+    BRArrayOf(BRCryptoListenerEvent) pending;
+    BRArrayOf(BRCryptoListenerEvent) delivering;
+    bool pendingSignalled;
 };
 
 extern void
@@ -13,6 +13,7 @@
 #include "support/BRCrypto.h"
 
 #include "crypto/BRCryptoSystemP.h"
+#include "crypto/BRCryptoFileService.h"
 #include "crypto/BRCryptoNetworkP.h"
 #include "crypto/BRCryptoClientP.h"
 #include "crypto/BRCryptoListenerP.h"
@@ -193,6 +194,12 @@ cryptoSystemFileServiceErrorHandler (BRFileServiceContext context,
                          error.u.sdb.code,
                          error.u.sdb.reason);
             break;
+        case FILE_SERVICE_QUARANTINE:
+            printf ("CRY: System FileService Error: QUARANTINE (%s): %s: %s\n",
+                         error.u.quarantine.type,
+                         u256hex (error.u.quarantine.identifier),
+                         error.u.quarantine.reason);
+            break;
     }
 }
 
@@ -207,11 +214,22 @@ static BRFileServiceTypeSpecification systemFileServiceSpecifications[] = {
             fileServiceTypeCurrencyBundleV1Reader,
             fileServiceTypeCurrencyBundleV1Writer
         }
-    }
+    },
+    (BRFileServiceReleaser) cryptoClientCurrencyBundleRelease
 };
 
 static size_t systemFileServiceSpecificationsCount = (sizeof (systemFileServiceSpecifications) / sizeof (BRFileServiceTypeSpecification));
 
+extern void
+cryptoSystemSetWriteAheadLogging (BRCryptoBoolean enabled) {
+    cryptoFileServiceConfiguration.journalMode = (CRYPTO_TRUE == enabled
+                                                  ? FILE_SERVICE_JOURNAL_MODE_WAL
+                                                  : FILE_SERVICE_JOURNAL_MODE_DEFAULT);
+    cryptoFileServiceConfiguration.synchronous = (CRYPTO_TRUE == enabled
+                                                  ? FILE_SERVICE_SYNCHRONOUS_NORMAL
+                                                  : FILE_SERVICE_SYNCHRONOUS_DEFAULT);
+}
+
 // MARK: - System
 
 IMPLEMENT_CRYPTO_GIVE_TAKE (BRCryptoSystem, cryptoSystem)
@@ -238,11 +256,11 @@ cryptoSystemCreate (BRCryptoClient client,
     free (accountFileSystemIdentifier);
 
     // Create the system-state file service
-    system->fileService = fileServiceCreateFromTypeSpecifications (system->path, "system", "state",
-                                                                   system,
-                                                                   cryptoSystemFileServiceErrorHandler,
-                                                                   systemFileServiceSpecificationsCount,
-                                                                   systemFileServiceSpecifications);
+    system->fileService = cryptoFileServiceCreate (system->path, "system", "state",
+                                                   system,
+                                                   cryptoSystemFileServiceErrorHandler,
+                                                   systemFileServiceSpecificationsCount,
+                                                   systemFileServiceSpecifications);
 
     // Fill in the builtin networks
     size_t networksCount = 0;
@@ -606,10 +624,11 @@ cryptoSystemHandleCurrencyBundles (BRCryptoSystem system,
     for (size_t index = 0; index < networksCount; index++)
         array_new (bundlesForNetworks[index], 10);
 
+    // Save all the bundles, as one DB transaction
+    fileServiceSaveMany (system->fileService, FILE_SERVICE_TYPE_CURRENCY_BUNDLE, (const void **) bundles, array_count(bundles));
+
     size_t networkIndex = 0;
     for (size_t bundleIndex = 0; bundleIndex < array_count(bundles); bundleIndex++) {
-        fileServiceSave (system->fileService, FILE_SERVICE_TYPE_CURRENCY_BUNDLE, bundles[bundleIndex]);
-
         BRCryptoNetwork network = cryptoSystemGetNetworkForUidsWithIndex (system, bundles[bundleIndex]->bid, &networkIndex);
         if (NULL != network)
             array_add (bundlesForNetworks[networkIndex], bundles[bundleIndex]);
@@ -635,6 +654,9 @@ cryptoSystemStop (BRCryptoSystem system) {
     // query
     // client
     cryptoListenerStop(system->listener);
+
+    // Write any queued saves, such as of currency bundles
+    fileServiceFlush (system->fileService);
 }
 
 extern void
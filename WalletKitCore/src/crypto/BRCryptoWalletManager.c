@@ -56,6 +56,12 @@
 #define CWM_MAXIMUM_SAMPLING_PERIOD_IN_MILLISECONDS   (1 * 60 * 1000)    //  1 minute
 #define CWM_MINIMUM_SAMPLING_PERIOD_IN_MILLISECONDS   (    10 * 1000)    // 10 seconds
 
+// With many managers on the same network, and thus with the same sampling period, we don't want
+// every manager's 'tick-tock' to occur at the same time.  Each sampling period is randomly
+// lengthened or shortened by up to 1 / CWM_SAMPLING_JITTER_FACTOR of the period (and the first
+// sample is at a random time within the first period).
+#define CWM_SAMPLING_JITTER_FACTOR      (10)
+
 static unsigned int
 cryptoWalletManagerBoundSamplingPeriod (unsigned int milliseconds) {
     return (milliseconds > CWM_MAXIMUM_SAMPLING_PERIOD_IN_MILLISECONDS
@@ -136,6 +142,16 @@ cryptoWalletManagerReleaseCurrenciesOfInterest (BRCryptoWalletManager cwm,
 #pragma clang diagnostic pop
 #pragma GCC diagnostic pop
 
+// A BRFileServiceLoadCallback appending each loaded bundle to the BRArray in `context`.
+static int
+cryptoWalletManagerLoadBundleIntoArray (BRFileServiceContext context,
+                                        BRFileService fs,
+                                        void *entity) {
+    BRArrayOf(void*) *bundles = context;
+    array_add (*bundles, entity);
+    return 1;
+}
+
 static int
 cryptoClientTransferBundleCompareByBlockheight (const void *tb1, const void *tb2) {
     BRCryptoClientTransferBundle b1 = * (BRCryptoClientTransferBundle *) tb1;
@@ -151,32 +167,30 @@ static void // not locked; called during manager init
 cryptoWalletManagerInitialTransferBundlesLoad (BRCryptoWalletManager manager) {
     assert (NULL == manager->bundleTransfers);
 
-    BRSetOf(BRCryptoClientTransferBundle) bundles = cryptoClientTransferBundleSetCreate (25);
+    BRArrayOf(BRCryptoClientTransferBundle) bundles;
+    array_new (bundles, 25);
 
     if (fileServiceHasType (manager->fileService, CRYPTO_FILE_SERVICE_TYPE_TRANSFER) &&
-        1 != fileServiceLoad (manager->fileService, bundles, CRYPTO_FILE_SERVICE_TYPE_TRANSFER, 1)) {
-        cryptoClientTransferBundleSetRelease (bundles);
+        1 != fileServiceLoadIterate (manager->fileService, CRYPTO_FILE_SERVICE_TYPE_TRANSFER, 1,
+                                     &bundles, cryptoWalletManagerLoadBundleIntoArray)) {
+        array_free_all (bundles, cryptoClientTransferBundleRelease);
         printf ("CRY: %4s: failed to load transfer bundles",
                 cryptoBlockChainTypeGetCurrencyCode (manager->type));
-        cryptoClientTransferBundleSetRelease(bundles);
         return;
     }
-    size_t sortedBundlesCount = BRSetCount(bundles);
+    size_t sortedBundlesCount = array_count (bundles);
 
     printf ("CRY: %4s: loaded %4zu transfer bundles\n",
             cryptoBlockChainTypeGetCurrencyCode (manager->type),
             sortedBundlesCount);
 
-    if (0 != sortedBundlesCount) {
-        array_new (manager->bundleTransfers, sortedBundlesCount);
-        BRSetAll (bundles, (void**) manager->bundleTransfers, sortedBundlesCount);
-        array_set_count (manager->bundleTransfers, sortedBundlesCount);
-
-        qsort (manager->bundleTransfers, sortedBundlesCount, sizeof (BRCryptoClientTransferBundle), cryptoClientTransferBundleCompareByBlockheight);
+    if (0 == sortedBundlesCount) {
+        array_free (bundles);
+        return;
     }
 
-    // Don't release the set's bundles
-    BRSetFree(bundles);
+    qsort (bundles, sortedBundlesCount, sizeof (BRCryptoClientTransferBundle), cryptoClientTransferBundleCompareByBlockheight);
+    manager->bundleTransfers = bundles;
 }
 
 static void // called wtih manager->lock
@@ -206,41 +220,38 @@ static void // not locked; called during manager init
 cryptoWalletManagerInitialTransactionBundlesLoad (BRCryptoWalletManager manager) {
     assert (NULL == manager->bundleTransactions);
 
-    BRSetOf(BRCryptoClientTransactionBundle) bundles = cryptoClientTransactionBundleSetCreate (25);
+    BRArrayOf(BRCryptoClientTransactionBundle) bundles;
+    array_new (bundles, 25);
+
     if (fileServiceHasType (manager->fileService, CRYPTO_FILE_SERVICE_TYPE_TRANSACTION) &&
-        1 != fileServiceLoad (manager->fileService, bundles, CRYPTO_FILE_SERVICE_TYPE_TRANSACTION, 1)) {
-        cryptoClientTransactionBundleSetRelease (bundles);
+        1 != fileServiceLoadIterate (manager->fileService, CRYPTO_FILE_SERVICE_TYPE_TRANSACTION, 1,
+                                     &bundles, cryptoWalletManagerLoadBundleIntoArray)) {
+        array_free_all (bundles, cryptoClientTransactionBundleRelease);
         printf ("CRY: %4s: failed to load transaction bundles",
                 cryptoBlockChainTypeGetCurrencyCode (manager->type));
         return;
     }
-    size_t sortedBundlesCount = BRSetCount(bundles);
+    size_t sortedBundlesCount = array_count (bundles);
 
     printf ("CRY: %4s: loaded %4zu transaction bundles\n",
             cryptoBlockChainTypeGetCurrencyCode (manager->type),
             sortedBundlesCount);
 
-    if (0 != sortedBundlesCount) {
-        BRArrayOf(BRCryptoClientTransactionBundle) sortedBundles;
-        array_new (sortedBundles, sortedBundlesCount);
-        BRSetAll (bundles, (void**) sortedBundles, sortedBundlesCount);
-        array_set_count(sortedBundles, sortedBundlesCount);
-
-        qsort (sortedBundles, sortedBundlesCount, sizeof (BRCryptoClientTransactionBundle), cryptoClientTransactionBundleCompareByBlockheight);
-
-        manager->bundleTransactions = sortedBundles;
+    if (0 == sortedBundlesCount) {
+        array_free (bundles);
+        return;
     }
 
-    // Don't release the set's bundles
-    BRSetFree(bundles);
+    qsort (bundles, sortedBundlesCount, sizeof (BRCryptoClientTransactionBundle), cryptoClientTransactionBundleCompareByBlockheight);
+    manager->bundleTransactions = bundles;
 }
 
 static void // called wtih manager->lock
 cryptoWalletManagerInitialTransactionBundlesRecover (BRCryptoWalletManager manager) {
     if (NULL != manager->bundleTransactions) {
-        for (size_t index = 0; index < array_count(manager->bundleTransactions); index++) {
-            cryptoWalletManagerRecoverTransfersFromTransactionBundle (manager, manager->bundleTransactions[index]);
-        }
+        cryptoWalletManagerRecoverTransfersFromTransactionBundles (manager,
+                                                                   manager->bundleTransactions,
+                                                                   array_count(manager->bundleTransactions));
 
         array_free_all (manager->bundleTransactions, cryptoClientTransactionBundleRelease);
         manager->bundleTransactions = NULL;
@@ -321,11 +332,15 @@ cryptoWalletManagerAllocAndInit (size_t sizeInBytes,
                                            eventTypesCount,
                                            &manager->lock);
 
+    unsigned int samplingPeriod = cryptoWalletManagerBoundSamplingPeriod ((1000 * cryptoNetworkGetConfirmationPeriodInSeconds(network)) / CWM_CONFIRMATION_PERIOD_FACTOR);
+
     eventHandlerSetTimeoutDispatcher (manager->handler,
-                                      cryptoWalletManagerBoundSamplingPeriod ((1000 * cryptoNetworkGetConfirmationPeriodInSeconds(network)) / CWM_CONFIRMATION_PERIOD_FACTOR),
+                                      samplingPeriod,
                                       (BREventDispatcher) cryptoWalletManagerPeriodicDispatcher,
                                       (void*) manager);
 
+    eventHandlerSetTimeoutJitter (manager->handler, samplingPeriod / CWM_SAMPLING_JITTER_FACTOR);
+
     manager->listenerWallet = cryptoListenerCreateWalletListener (&manager->listener, manager);
 
     pthread_mutex_init_brd (&manager->lock, PTHREAD_MUTEX_RECURSIVE);
@@ -427,6 +442,13 @@ cryptoWalletManagerFileServiceErrorHandler (BRFileServiceContext context,
                        error.u.sdb.code,
                        error.u.sdb.reason);
             break;
+        case FILE_SERVICE_QUARANTINE:
+            // Only the one entity is lost; it is re-fetched on the next sync.  No forced sync.
+            _peer_log_x ("CRY: FileService Error: QUARANTINE (%s): %s: %s\n",
+                       error.u.quarantine.type,
+                       u256hex (error.u.quarantine.identifier),
+                       error.u.quarantine.reason);
+            return;
     }
     _peer_log_x ("CRY: FileService Error: FORCED SYNC%s\n", "");
 
@@ -737,6 +759,9 @@ cryptoWalletManagerStop (BRCryptoWalletManager cwm) {
     // Stop the CWM 'Event Handler'
     eventHandlerStop (cwm->handler);
 
+    // Write any saves queued by the handler's events
+    if (NULL != cwm->fileService) fileServiceFlush (cwm->fileService);
+
     // {P2P,QRY} Manager - on disconnect
 }
 
@@ -824,7 +849,7 @@ cryptoWalletManagerWipe (BRCryptoNetwork network,
     const char *networkName  = cryptoNetworkGetDesc(network);
 
     pthread_mutex_lock (&network->lock);
-    fileServiceWipe (path, currencyName, networkName);
+    cryptoFileServiceWipe (path, currencyName, networkName);
     pthread_mutex_unlock (&network->lock);
 }
 
@@ -1204,12 +1229,53 @@ cryptoWalletManagerSaveTransferBundle (BRCryptoWalletManager manager,
         fileServiceSave (manager->fileService, CRYPTO_FILE_SERVICE_TYPE_TRANSFER, bundle);
 }
 
+private_extern void
+cryptoWalletManagerSaveTransactionBundles (BRCryptoWalletManager manager,
+                                           OwnershipKept BRCryptoClientTransactionBundle *bundles,
+                                           size_t bundlesCount) {
+    if (NULL != manager->handlers->saveTransactionBundle) {
+        // The handler saves each bundle; ensure those saves share one DB transaction.
+        fileServiceBeginTransaction (manager->fileService);
+        for (size_t index = 0; index < bundlesCount; index++)
+            manager->handlers->saveTransactionBundle (manager, bundles[index]);
+        fileServiceCommitTransaction (manager->fileService);
+    }
+    else if (fileServiceHasType (manager->fileService, CRYPTO_FILE_SERVICE_TYPE_TRANSACTION))
+        fileServiceSaveMany (manager->fileService, CRYPTO_FILE_SERVICE_TYPE_TRANSACTION, (const void **) bundles, bundlesCount);
+}
+
+private_extern void
+cryptoWalletManagerSaveTransferBundles (BRCryptoWalletManager manager,
+                                        OwnershipKept BRCryptoClientTransferBundle *bundles,
+                                        size_t bundlesCount) {
+    if (NULL != manager->handlers->saveTransferBundle) {
+        // The handler saves each bundle; ensure those saves share one DB transaction.
+        fileServiceBeginTransaction (manager->fileService);
+        for (size_t index = 0; index < bundlesCount; index++)
+            manager->handlers->saveTransferBundle (manager, bundles[index]);
+        fileServiceCommitTransaction (manager->fileService);
+    }
+    else if (fileServiceHasType (manager->fileService, CRYPTO_FILE_SERVICE_TYPE_TRANSFER))
+        fileServiceSaveMany (manager->fileService, CRYPTO_FILE_SERVICE_TYPE_TRANSFER, (const void **) bundles, bundlesCount);
+}
+
 private_extern void
 cryptoWalletManagerRecoverTransfersFromTransactionBundle (BRCryptoWalletManager cwm,
                                                           OwnershipKept BRCryptoClientTransactionBundle bundle) {
     cwm->handlers->recoverTransfersFromTransactionBundle (cwm, bundle);
 }
 
+private_extern void
+cryptoWalletManagerRecoverTransfersFromTransactionBundles (BRCryptoWalletManager cwm,
+                                                           OwnershipKept BRCryptoClientTransactionBundle *bundles,
+                                                           size_t bundlesCount) {
+    if (NULL != cwm->handlers->recoverTransfersFromTransactionBundles)
+        cwm->handlers->recoverTransfersFromTransactionBundles (cwm, bundles, bundlesCount);
+    else
+        for (size_t index = 0; index < bundlesCount; index++)
+            cwm->handlers->recoverTransfersFromTransactionBundle (cwm, bundles[index]);
+}
+
 private_extern void
 cryptoWalletManagerRecoverTransferFromTransferBundle (BRCryptoWalletManager cwm,
                                                       OwnershipKept BRCryptoClientTransferBundle bundle) {
@@ -111,6 +111,13 @@ typedef void
 (*BRCryptoWalletManagerRecoverTransfersFromTransactionBundleHandler) (BRCryptoWalletManager cwm,
                                                                       OwnershipKept BRCryptoClientTransactionBundle bundle);
 
+// Optional; if provided, recover from all of `bundles` at once, in place of one-by-one with
+// the above.
+typedef void
+(*BRCryptoWalletManagerRecoverTransfersFromTransactionBundlesHandler) (BRCryptoWalletManager cwm,
+                                                                       OwnershipKept BRCryptoClientTransactionBundle *bundles,
+                                                                       size_t bundlesCount);
+
 typedef void
 (*BRCryptoWalletManagerRecoverTransferFromTransferBundleHandler) (BRCryptoWalletManager cwm,
                                                                   OwnershipKept BRCryptoClientTransferBundle bundle);
@@ -148,6 +155,7 @@ typedef struct {
     BRCryptoWalletManagerSaveTransactionBundleHandler saveTransactionBundle;
     BRCryptoWalletManagerSaveTransferBundleHandler    saveTransferBundle;
     BRCryptoWalletManagerRecoverTransfersFromTransactionBundleHandler recoverTransfersFromTransactionBundle;
+    BRCryptoWalletManagerRecoverTransfersFromTransactionBundlesHandler recoverTransfersFromTransactionBundles;
     BRCryptoWalletManagerRecoverTransferFromTransferBundleHandler     recoverTransferFromTransferBundle;
     BRCryptoWalletManagerRecoverFeeBasisFromFeeEstimateHandler        recoverFeeBasisFromFeeEstimate;
     BRCryptoWalletManagerWalletSweeperValidateSupportedHandler validateSweeperSupported;
@@ -251,6 +259,18 @@ private_extern void
 cryptoWalletManagerSaveTransferBundle (BRCryptoWalletManager manager,
                                        OwnershipKept BRCryptoClientTransferBundle bundle);
 
+/// Save `bundlesCount` transaction bundles in a single FileService transaction.
+private_extern void
+cryptoWalletManagerSaveTransactionBundles (BRCryptoWalletManager manager,
+                                           OwnershipKept BRCryptoClientTransactionBundle *bundles,
+                                           size_t bundlesCount);
+
+/// Save `bundlesCount` transfer bundles in a single FileService transaction.
+private_extern void
+cryptoWalletManagerSaveTransferBundles (BRCryptoWalletManager manager,
+                                        OwnershipKept BRCryptoClientTransferBundle *bundles,
+                                        size_t bundlesCount);
+
 private_extern BRCryptoWallet
 cryptoWalletManagerCreateWalletInitialized (BRCryptoWalletManager cwm,
                                             BRCryptoCurrency currency,
@@ -261,6 +281,11 @@ private_extern void
 cryptoWalletManagerRecoverTransfersFromTransactionBundle (BRCryptoWalletManager cwm,
                                                           OwnershipKept BRCryptoClientTransactionBundle bundle);
 
+private_extern void
+cryptoWalletManagerRecoverTransfersFromTransactionBundles (BRCryptoWalletManager cwm,
+                                                           OwnershipKept BRCryptoClientTransactionBundle *bundles,
+                                                           size_t bundlesCount);
+
 // Is it possible that the transfers do not have the 'submitted' state?  In some race between
 // the submit call and the included call?  Highly, highly unlikely but possible?
 private_extern void
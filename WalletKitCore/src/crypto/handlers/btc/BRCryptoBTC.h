@@ -257,6 +257,16 @@ extern BRArrayOf(BRTransaction*) initialTransactionsLoadBTC (BRCryptoWalletManag
 extern BRArrayOf(BRPeer)         initialPeersLoadBTC        (BRCryptoWalletManager manager);
 extern BRArrayOf(BRMerkleBlock*) initialBlocksLoadBTC       (BRCryptoWalletManager manager);
 
+// A transaction is saved as two entities: the transaction itself and its status - the block
+// height and timestamp.  On a confirmation, only the status need be saved.
+extern void fileServiceSaveTransactionBTC       (BRCryptoWalletManager manager, const BRTransaction *transaction);
+extern void fileServiceSaveTransactionStatusBTC (BRCryptoWalletManager manager, const BRTransaction *transaction);
+extern void fileServiceRemoveTransactionBTC     (BRCryptoWalletManager manager, const BRTransaction *transaction);
+
+// Blocks are saved as headers, in an append-only header store, and, if they have matched
+// transactions, in full to the file service.
+extern void saveBlocksBTC (BRCryptoWalletManager manager, int replace, BRMerkleBlock **blocks, size_t blocksCount);
+
 #ifdef __cplusplus
 }
 #endif
@@ -201,9 +201,18 @@ cryptoWalletHasAddressBTC (BRCryptoWallet wallet,
     BRCryptoBlockChainType type;
     BRAddress btcAddress = cryptoAddressAsBTC (address, &type);
 
+    // Addresses the wallet never derived are neither used nor the current receive address.
+    uint32_t chain;
+    if (!BRWalletAddressChainIndex (btcWallet, btcAddress.s, &chain, NULL))
+        return false;
+
     if (BRWalletAddressIsUsed (btcWallet, btcAddress.s))
         return true;
 
+    // An unused address can only match the receive address, which is on the external chain.
+    if (SEQUENCE_EXTERNAL_CHAIN != chain)
+        return false;
+
     BRAddress btcLegacyAddress = BRWalletLegacyAddress (btcWallet);
     if (0 == memcmp (btcAddress.s, btcLegacyAddress.s, sizeof (btcAddress.s)))
         return true;
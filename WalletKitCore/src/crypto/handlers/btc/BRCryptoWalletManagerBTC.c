@@ -16,6 +16,7 @@
 #include "crypto/BRCryptoClientP.h"
 #include "crypto/BRCryptoWalletManagerP.h"
 #include "crypto/BRCryptoWalletSweeperP.h"
+#include "crypto/BRCryptoFileService.h"
 
 // BRWallet Callbacks
 
@@ -81,10 +82,10 @@ crytpWalletManagerCreateFileServiceBTC (BRCryptoWalletManager manager,
                                         const char *network,
                                         BRFileServiceContext context,
                                         BRFileServiceErrorHandler handler) {
-    return fileServiceCreateFromTypeSpecifications (basePath, currency, network,
-                                                    context, handler,
-                                                    fileServiceSpecificationsCountBTC,
-                                                    fileServiceSpecificationsBTC);
+    return cryptoFileServiceCreate (basePath, currency, network,
+                                    context, handler,
+                                    fileServiceSpecificationsCountBTC,
+                                    fileServiceSpecificationsBTC);
 }
 
 static const BREventType **
@@ -261,11 +262,40 @@ cryptoWalletManagerSaveTransactionBundleBTC (BRCryptoWalletManager manager,
         transaction->blockHeight = (uint32_t) bundle->blockHeight;
         transaction->timestamp   = (uint32_t) bundle->timestamp;
 
-        fileServiceSave (manager->fileService, fileServiceTypeTransactionsBTC, transaction);
+        fileServiceSaveTransactionBTC (manager, transaction);
         BRTransactionFree(transaction);
     }
 }
 
+// Replace transfers, included at or after `btcBlockHeight`, whose amount has changed since they
+// were created - as happens when later transactions generate new wallet addresses.
+static void
+cryptoWalletManagerReplaceChangedTransfersBTC (BRCryptoWalletManager manager,
+                                               uint32_t btcBlockHeight) {
+    BRWallet *btcWallet = cryptoWalletAsBTC(manager->wallet);
+
+    for (size_t index = 0; index < array_count (manager->wallet->transfers); index++) {
+        BRCryptoTransfer oldTransfer = manager->wallet->transfers[index];
+        BRTransaction *tid = cryptoTransferCoerceBTC(oldTransfer)->tid;
+
+        if (TX_UNCONFIRMED   != tid->blockHeight &&
+            tid->blockHeight >= btcBlockHeight   &&
+            CRYPTO_TRUE == cryptoTransferChangedAmountBTC (oldTransfer, btcWallet)) {
+            cryptoTransferTake (oldTransfer);
+
+            BRCryptoTransfer newTransfer  = cryptoTransferCreateAsBTC (oldTransfer->listener,
+                                                                       oldTransfer->unit,
+                                                                       oldTransfer->unitForFee,
+                                                                       btcWallet,
+                                                                       BRTransactionCopy (tid),
+                                                                       oldTransfer->type);
+
+            cryptoWalletReplaceTransfer (manager->wallet, oldTransfer, newTransfer);
+            cryptoTransferGive (oldTransfer);
+        }
+    }
+}
+
 static void
 cryptoWalletManagerRecoverTransfersFromTransactionBundleBTC (BRCryptoWalletManager manager,
                                                              OwnershipKept BRCryptoClientTransactionBundle bundle) {
@@ -337,28 +367,69 @@ cryptoWalletManagerRecoverTransfersFromTransactionBundleBTC (BRCryptoWalletManag
     // addresses.  Because the order of bundle arrival is not guaranteed to be by block number,
     // it is possible that some other transaction in the wallet now has inputs or outputs that are
     // now in BRWallet.  This changes the amount and fee, possibly.  Find those and replace them.
-    else if (TX_UNCONFIRMED != btcBlockHeight) {
-        for (size_t index = 0; index < array_count (manager->wallet->transfers); index++) {
-            BRCryptoTransfer oldTransfer = manager->wallet->transfers[index];
-            BRTransaction *tid = cryptoTransferCoerceBTC(oldTransfer)->tid;
-
-            if (TX_UNCONFIRMED   != tid->blockHeight &&
-                tid->blockHeight >= btcBlockHeight   &&
-                CRYPTO_TRUE == cryptoTransferChangedAmountBTC (oldTransfer, btcWallet)) {
-                cryptoTransferTake (oldTransfer);
-
-                BRCryptoTransfer newTransfer  = cryptoTransferCreateAsBTC (oldTransfer->listener,
-                                                                           oldTransfer->unit,
-                                                                           oldTransfer->unitForFee,
-                                                                           btcWallet,
-                                                                           BRTransactionCopy (tid),
-                                                                           oldTransfer->type);
-
-                cryptoWalletReplaceTransfer (manager->wallet, oldTransfer, newTransfer);
-                cryptoTransferGive (oldTransfer);
-            }
+    else if (TX_UNCONFIRMED != btcBlockHeight)
+        cryptoWalletManagerReplaceChangedTransfersBTC (manager, btcBlockHeight);
+}
+
+static void
+cryptoWalletManagerRecoverTransfersFromTransactionBundlesBTC (BRCryptoWalletManager manager,
+                                                              OwnershipKept BRCryptoClientTransactionBundle *bundles,
+                                                              size_t bundlesCount) {
+    BRWallet *btcWallet = cryptoWalletAsBTC(manager->wallet);
+
+    BRArrayOf(BRTransaction*) btcTransactions;
+    array_new (btcTransactions, bundlesCount);
+
+    // Bundles for new, signed transactions are registered together; anything else - errors,
+    // unsigned transactions, transactions already in the wallet - is handled one by one.
+    for (size_t index = 0; index < bundlesCount; index++) {
+        BRCryptoClientTransactionBundle bundle = bundles[index];
+        BRTransaction *btcTransaction = (CRYPTO_TRANSFER_STATE_ERRORED == bundle->status
+                                         ? NULL
+                                         : BRTransactionParse (bundle->serialization, bundle->serializationCount));
+
+        if (NULL == btcTransaction ||
+            !BRTransactionIsSigned (btcTransaction) ||
+            NULL != BRWalletTransactionForHash (btcWallet, btcTransaction->txHash)) {
+            if (NULL != btcTransaction) BRTransactionFree (btcTransaction);
+            cryptoWalletManagerRecoverTransfersFromTransactionBundleBTC (manager, bundle);
+            continue;
         }
+
+        // Set the block height and timestamp before registering, so that the wallet sorts and
+        // balances the transaction once, as included, rather than as submitted and then updated.
+        btcTransaction->blockHeight = (BLOCK_HEIGHT_UNBOUND == bundle->blockHeight ? TX_UNCONFIRMED : (uint32_t) bundle->blockHeight);
+        btcTransaction->timestamp   = (uint32_t) bundle->timestamp;
+
+        array_add (btcTransactions, btcTransaction);
     }
+
+    // The wallet NULLs the transactions it takes ownership of; keep them to find the block height.
+    BRArrayOf(BRTransaction*) btcRegisteredTransactions;
+    array_new (btcRegisteredTransactions, array_count (btcTransactions));
+    array_add_array (btcRegisteredTransactions, btcTransactions, array_count (btcTransactions));
+
+    BRWalletRegisterTransactions (btcWallet, btcTransactions, array_count (btcTransactions));
+
+    uint32_t btcBlockHeight = TX_UNCONFIRMED;
+
+    for (size_t index = 0; index < array_count (btcTransactions); index++) {
+        BRTransaction *btcTransaction = btcRegisteredTransactions[index];
+
+        // If our transaction did not make it into the wallet, deallocate it
+        if (NULL != btcTransactions[index])
+            BRTransactionFree (btcTransaction);
+        else if (btcTransaction->blockHeight < btcBlockHeight &&
+                 BRWalletContainsTransaction (btcWallet, btcTransaction))
+            btcBlockHeight = btcTransaction->blockHeight;
+    }
+
+    // As for a single bundle, but once for the lowest block height registered
+    if (TX_UNCONFIRMED != btcBlockHeight)
+        cryptoWalletManagerReplaceChangedTransfersBTC (manager, btcBlockHeight);
+
+    array_free (btcRegisteredTransactions);
+    array_free (btcTransactions);
 }
 
 static void
@@ -455,7 +526,7 @@ static void cryptoWalletManagerBTCTxAdded   (void *info, BRTransaction *tid) {
     printf ("BTC: TxAdded  : %zu (Unresolved Count)\n", array_count (walletBTC->tidsUnresolved));
 
     // Save `tid` to the fileService.
-    fileServiceSave (manager->base.fileService, fileServiceTypeTransactionsBTC, tid);
+    fileServiceSaveTransactionBTC (&manager->base, tid);
 
     // If `tid` is not resolved in `wid`, then add it as unresolved to `wid` and skip out.
     if (!BRWalletTransactionIsResolved (wid, tid)) {
@@ -570,8 +641,8 @@ static void cryptoWalletManagerBTCTxUpdated (void *info,
                 transfer->tid->blockHeight = blockHeight;
                 transfer->tid->timestamp   = timestamp;
 
-                // Save the modified `tid` to the fileService.
-                fileServiceSave (manager->base.fileService, fileServiceTypeTransactionsBTC, transfer->tid);
+                // Save the modified `tid` status to the fileService.
+                fileServiceSaveTransactionStatusBTC (&manager->base, transfer->tid);
             }
 
             // Determine the transfer's state, as best we can.
@@ -632,7 +703,7 @@ static void cryptoWalletManagerBTCTxDeleted (void *info, UInt256 hash, int notif
         else {
             transfer->isDeleted = true;
             cryptoTransferSetState (&transfer->base, cryptoTransferStateInit (CRYPTO_TRANSFER_STATE_DELETED));
-            fileServiceRemove (manager->base.fileService, fileServiceTypeTransactionsBTC, transfer->tid);
+            fileServiceRemoveTransactionBTC (&manager->base, transfer->tid);
         }
 
         pthread_mutex_unlock (&manager->base.lock);
@@ -665,6 +736,7 @@ BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersBTC = {
     cryptoWalletManagerSaveTransactionBundleBTC,
     NULL, // BRCryptoWalletManagerSaveTransactionBundleHandler
     cryptoWalletManagerRecoverTransfersFromTransactionBundleBTC,
+    cryptoWalletManagerRecoverTransfersFromTransactionBundlesBTC,
     cryptoWalletManagerRecoverTransferFromTransferBundleBTC,
     NULL,//BRCryptoWalletManagerRecoverFeeBasisFromFeeEstimateHandler not supported
     cryptoWalletManagerWalletSweeperValidateSupportedBTC,
@@ -685,6 +757,7 @@ BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersBCH = {
     cryptoWalletManagerSaveTransactionBundleBTC,
     NULL, // BRCryptoWalletManagerSaveTransactionBundleHandler
     cryptoWalletManagerRecoverTransfersFromTransactionBundleBTC,
+    cryptoWalletManagerRecoverTransfersFromTransactionBundlesBTC,
     cryptoWalletManagerRecoverTransferFromTransferBundleBTC,
     NULL,//BRCryptoWalletManagerRecoverFeeBasisFromFeeEstimateHandler not supported
     cryptoWalletManagerWalletSweeperValidateSupportedBTC,
@@ -705,6 +778,7 @@ BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersBSV = {
     cryptoWalletManagerSaveTransactionBundleBTC,
     NULL, // BRCryptoWalletManagerSaveTransactionBundleHandler
     cryptoWalletManagerRecoverTransfersFromTransactionBundleBTC,
+    cryptoWalletManagerRecoverTransfersFromTransactionBundlesBTC,
     cryptoWalletManagerRecoverTransferFromTransferBundleBTC,
     NULL,//BRCryptoWalletManagerRecoverFeeBasisFromFeeEstimateHandler not supported
     cryptoWalletManagerWalletSweeperValidateSupportedBTC,
@@ -347,14 +347,7 @@ static void cryptoWalletManagerBTCTxStatusUpdate (void *info) {
 
 static void cryptoWalletManagerBTCSaveBlocks (void *info, int replace, BRMerkleBlock **blocks, size_t count) {
     BRCryptoWalletManagerBTC manager = info;
-
-    if (replace) {
-        fileServiceReplace (manager->base.fileService, fileServiceTypeBlocksBTC, (const void **) blocks, count);
-    }
-    else {
-        for (size_t index = 0; index < count; index++)
-            fileServiceSave (manager->base.fileService, fileServiceTypeBlocksBTC, blocks[index]);
-    }
+    saveBlocksBTC (&manager->base, replace, blocks, count);
 }
 
 static void cryptoWalletManagerBTCSavePeers  (void *info, int replace, const BRPeer *peers, size_t count) {
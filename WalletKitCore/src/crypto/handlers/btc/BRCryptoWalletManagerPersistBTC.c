@@ -8,16 +8,39 @@
 //  See the LICENSE file at the project root for license information.
 //  See the CONTRIBUTORS file at the project root for a list of contributors.
 //
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 #include "BRCryptoBTC.h"
 #include "crypto/BRCryptoFileService.h"
+#include "bitcoin/BRMerkleBlock.h"
+#include "support/BRCrypto.h"
+
+
+/// MARK: - Load Into Array
 
+// A BRFileServiceLoadCallback that appends each loaded entity to a BRArrayOf(void*) provided as
+// `context`.  This avoids an intermediate BRSet (and its rehashing) on load.
+static int
+fileServiceLoadIntoArrayBTC (BRFileServiceContext context,
+                             BRFileService fs,
+                             void *entity) {
+    BRArrayOf(void*) *entities = context;
+    array_add (*entities, entity);
+    return 1;
+}
 
 /// MARK: - Transaction File Service
 
 #define FILE_SERVICE_TYPE_TRANSACTION     "transactions"
 
 enum {
-    FILE_SERVICE_TYPE_TRANSACTION_VERSION_1
+    FILE_SERVICE_TYPE_TRANSACTION_VERSION_1,    // {Transaction, BlockHeight, Timestamp}
+    FILE_SERVICE_TYPE_TRANSACTION_VERSION_2     // {Transaction}; see "transaction status"
 };
 
 static UInt256
@@ -77,27 +100,188 @@ fileServiceTypeTransactionV1Reader (BRFileServiceContext context,
     return transaction;
 }
 
+static uint8_t *
+fileServiceTypeTransactionV2Writer (BRFileServiceContext context,
+                                    BRFileService fs,
+                                    const void* entity,
+                                    uint32_t *bytesCount) {
+    const BRTransaction *transaction = entity;
+
+    size_t txSize = BRTransactionSerialize (transaction, NULL, 0);
+
+    *bytesCount = (uint32_t) txSize;
+
+    uint8_t *bytes = calloc (*bytesCount, 1);
+    BRTransactionSerialize (transaction, bytes, txSize);
+
+    return bytes;
+}
+
+static void *
+fileServiceTypeTransactionV2Reader (BRFileServiceContext context,
+                                    BRFileService fs,
+                                    uint8_t *bytes,
+                                    uint32_t bytesCount) {
+    // The block height and timestamp are those of an unconfirmed transaction until the
+    // transaction's status is applied.
+    return BRTransactionParse (bytes, bytesCount);
+}
+
+/// MARK: - Transaction Status File Service
+
+///
+/// A transaction's mutable state is saved apart from the (immutable) transaction itself; thus
+/// a confirmation update rewrites a few bytes rather than an entire, serialized transaction.  The
+/// status has the transaction's identifier.
+///
+#define FILE_SERVICE_TYPE_TRANSACTION_STATUS    "transaction-status"
+
+enum {
+    FILE_SERVICE_TYPE_TRANSACTION_STATUS_VERSION_1
+};
+
+typedef struct {
+    UInt256 txHash;
+    uint32_t blockHeight;
+    uint32_t timestamp;
+} BRTransactionStatusBTC;
+
+static size_t
+transactionStatusHashBTC (const void *status) {
+    return (size_t) ((const BRTransactionStatusBTC *) status)->txHash.u32[0];
+}
+
+static int
+transactionStatusEqBTC (const void *status1, const void *status2) {
+    return UInt256Eq (((const BRTransactionStatusBTC *) status1)->txHash,
+                      ((const BRTransactionStatusBTC *) status2)->txHash);
+}
+
+static UInt256
+fileServiceTypeTransactionStatusV1Identifier (BRFileServiceContext context,
+                                              BRFileService fs,
+                                              const void *entity) {
+    const BRTransactionStatusBTC *status = entity;
+    return status->txHash;
+}
+
+static uint8_t *
+fileServiceTypeTransactionStatusV1Writer (BRFileServiceContext context,
+                                          BRFileService fs,
+                                          const void* entity,
+                                          uint32_t *bytesCount) {
+    const BRTransactionStatusBTC *status = entity;
+
+    *bytesCount = (uint32_t) (sizeof (UInt256) + sizeof (uint32_t) + sizeof (uint32_t));
+
+    uint8_t *bytes = calloc (*bytesCount, 1);
+
+    memcpy (&bytes[0], status->txHash.u8, sizeof (UInt256));
+    UInt32SetLE (&bytes[sizeof (UInt256)],                    status->blockHeight);
+    UInt32SetLE (&bytes[sizeof (UInt256) + sizeof (uint32_t)], status->timestamp);
+
+    return bytes;
+}
+
+static void *
+fileServiceTypeTransactionStatusV1Reader (BRFileServiceContext context,
+                                          BRFileService fs,
+                                          uint8_t *bytes,
+                                          uint32_t bytesCount) {
+    if (bytesCount != sizeof (UInt256) + sizeof (uint32_t) + sizeof (uint32_t)) return NULL;
+
+    BRTransactionStatusBTC *status = calloc (1, sizeof (BRTransactionStatusBTC));
+
+    memcpy (status->txHash.u8, &bytes[0], sizeof (UInt256));
+    status->blockHeight = UInt32GetLE (&bytes[sizeof (UInt256)]);
+    status->timestamp   = UInt32GetLE (&bytes[sizeof (UInt256) + sizeof (uint32_t)]);
+
+    return status;
+}
+
+static int
+fileServiceLoadStatusIntoSetBTC (BRFileServiceContext context,
+                                 BRFileService fs,
+                                 void *entity) {
+    BRSet *statuses = context;
+    BRTransactionStatusBTC *status = BRSetAdd (statuses, entity);
+    if (NULL != status) free (status);
+    return 1;
+}
+
+// The transaction and its status are saved, and removed, together in one DB transaction.
+extern void
+fileServiceSaveTransactionBTC (BRCryptoWalletManager manager,
+                               const BRTransaction *transaction) {
+    fileServiceBeginTransaction (manager->fileService);
+    fileServiceSave (manager->fileService, FILE_SERVICE_TYPE_TRANSACTION, transaction);
+    fileServiceSaveTransactionStatusBTC (manager, transaction);
+    fileServiceCommitTransaction (manager->fileService);
+}
+
+extern void
+fileServiceSaveTransactionStatusBTC (BRCryptoWalletManager manager,
+                                     const BRTransaction *transaction) {
+    BRTransactionStatusBTC status = {
+        transaction->txHash,
+        transaction->blockHeight,
+        transaction->timestamp
+    };
+    fileServiceSave (manager->fileService, FILE_SERVICE_TYPE_TRANSACTION_STATUS, &status);
+}
+
+extern void
+fileServiceRemoveTransactionBTC (BRCryptoWalletManager manager,
+                                 const BRTransaction *transaction) {
+    fileServiceBeginTransaction (manager->fileService);
+    fileServiceRemove (manager->fileService, FILE_SERVICE_TYPE_TRANSACTION, transaction);
+    fileServiceRemoveByIdentifier (manager->fileService, FILE_SERVICE_TYPE_TRANSACTION_STATUS, transaction->txHash);
+    fileServiceCommitTransaction (manager->fileService);
+}
+
 extern BRArrayOf(BRTransaction*)
 initialTransactionsLoadBTC (BRCryptoWalletManager manager) {
-    BRSetOf(BRTransaction*) transactionSet = BRSetNew(BRTransactionHash, BRTransactionEq, 100);
-    if (1 != fileServiceLoad (manager->fileService, transactionSet, FILE_SERVICE_TYPE_TRANSACTION, 1)) {
-        BRSetFreeAll(transactionSet, (void (*) (void*)) BRTransactionFree);
+    BRArrayOf(BRTransaction*) transactions;
+    array_new (transactions, 100);
+
+    BRSet *statuses = BRSetNew (transactionStatusHashBTC, transactionStatusEqBTC, 100);
+
+    // A version 1 transaction is rewritten, as version 2 and thus w/o its status, during the load;
+    // its status is saved below.  Both are in one DB transaction, lest the status be lost.
+    fileServiceBeginTransaction (manager->fileService);
+
+    if (1 != fileServiceLoadIterate (manager->fileService, FILE_SERVICE_TYPE_TRANSACTION, 1,
+                                     &transactions, fileServiceLoadIntoArrayBTC) ||
+        1 != fileServiceLoadIterate (manager->fileService, FILE_SERVICE_TYPE_TRANSACTION_STATUS, 1,
+                                     statuses, fileServiceLoadStatusIntoSetBTC)) {
+        fileServiceCommitTransaction (manager->fileService);
+        array_free_all (transactions, BRTransactionFree);
+        BRSetFreeAll (statuses, free);
         _peer_log ("BWM: failed to load transactions");
         return NULL;
     }
 
-    size_t transactionsCount = BRSetCount(transactionSet);
+    // Apply each transaction's status.  A transaction w/o a status was loaded from a version 1
+    // entity, which included the status, and is being updated to the current version; thus save
+    // its status now.
+    for (size_t index = 0; index < array_count (transactions); index++) {
+        BRTransaction *transaction = transactions[index];
+        BRTransactionStatusBTC *status = BRSetGet (statuses, &(BRTransactionStatusBTC) { transaction->txHash });
 
-    BRArrayOf(BRTransaction*) transactions;
-    array_new (transactions, transactionsCount);
-    array_set_count(transactions, transactionsCount);
+        if (NULL != status) {
+            transaction->blockHeight = status->blockHeight;
+            transaction->timestamp   = status->timestamp;
+        }
+        else fileServiceSaveTransactionStatusBTC (manager, transaction);
+    }
 
-    BRSetAll(transactionSet, (void**) transactions, transactionsCount);
-    BRSetFree(transactionSet);
+    fileServiceCommitTransaction (manager->fileService);
+
+    BRSetFreeAll (statuses, free);
 
     _peer_log ("BWM: %4s: loaded %4zu transactions\n",
                cryptoBlockChainTypeGetCurrencyCode (manager->type),
-               transactionsCount);
+               array_count (transactions));
     return transactions;
 }
 
@@ -165,28 +349,282 @@ fileServiceTypeBlockV1Reader (BRFileServiceContext context,
     return block;
 }
 
+/// MARK: - Block Header Store
+
+///
+/// The chain's block headers are stored in a file of fixed-size records, indexed by height:
+///     {Magic, Version, RecordSize, BaseHeight} {Header @ BaseHeight} {Header @ BaseHeight + 1} ...
+/// where each header is the 80 byte serialization of a BRMerkleBlock w/o its merkle tree.  The file
+/// is appended to and only truncated, at the first differing header, on a chain reorganization.
+/// On load the file is mmap-ed and only the headers from the last difficulty transition, which
+/// is all BRPeerManager needs, are parsed.  Blocks with matched transactions are saved, in full,
+/// to the file service as well.
+///
+#define HEADER_STORE_MAGIC          (0x53484252)        // "BRHS"
+#define HEADER_STORE_VERSION        (1)
+#define HEADER_STORE_PREFIX_SIZE    (4 * sizeof (uint32_t))
+#define HEADER_STORE_RECORD_SIZE    (80)
+
+static char *
+headerStorePathBTC (BRCryptoWalletManager manager) {
+    const char *currency = cryptoBlockChainTypeGetCurrencyCode (manager->type);
+    const char *network  = cryptoNetworkGetDesc (manager->network);
+
+    char *path = malloc (strlen (manager->path) + 1 + strlen (currency) + 1 + strlen (network) + 1 +
+                         strlen (CRYPTO_FILE_SERVICE_HEADERS_FILENAME) + 1);
+    sprintf (path, "%s/%s-%s-%s", manager->path, currency, network, CRYPTO_FILE_SERVICE_HEADERS_FILENAME);
+    return path;
+}
+
+// Returns the number of complete records in a store of `size` bytes with `prefix`, filling in
+// `baseHeight`; returns SIZE_MAX if `prefix` is not that of a store.
+static size_t
+headerStoreRecordsCount (const uint8_t *prefix, size_t size, uint32_t *baseHeight) {
+    if (size < HEADER_STORE_PREFIX_SIZE ||
+        HEADER_STORE_MAGIC       != UInt32GetLE (&prefix[0 * sizeof (uint32_t)]) ||
+        HEADER_STORE_VERSION     != UInt32GetLE (&prefix[1 * sizeof (uint32_t)]) ||
+        HEADER_STORE_RECORD_SIZE != UInt32GetLE (&prefix[2 * sizeof (uint32_t)]))
+        return SIZE_MAX;
+
+    *baseHeight = UInt32GetLE (&prefix[3 * sizeof (uint32_t)]);
+
+    // A partial, trailing record, as from an interrupted write, is ignored.
+    return (size - HEADER_STORE_PREFIX_SIZE) / HEADER_STORE_RECORD_SIZE;
+}
+
+// Returns the headers from the last difficulty transition, or NULL if there are none.  A store
+// that ends in a partial record, as from an interrupted write, or in headers that don't parse or
+// don't link to their predecessor, as from a torn write, is truncated to its last valid header.
+static BRArrayOf(BRMerkleBlock*)
+headerStoreLoadBTC (const char *path) {
+    int fd = open (path, O_RDWR);
+    if (-1 == fd) return NULL;
+
+    struct stat fdStat;
+    if (0 != fstat (fd, &fdStat) || fdStat.st_size < (off_t) HEADER_STORE_PREFIX_SIZE) {
+        close (fd);
+        return NULL;
+    }
+
+    size_t   size  = (size_t) fdStat.st_size;
+    uint8_t *bytes = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (MAP_FAILED == bytes) { close (fd); return NULL; }
+
+    BRArrayOf(BRMerkleBlock*) blocks = NULL;
+
+    uint32_t baseHeight;
+    size_t   recordsCount = headerStoreRecordsCount (bytes, size, &baseHeight);
+    size_t   validCount   = recordsCount;
+
+    if (SIZE_MAX != recordsCount && 0 != recordsCount) {
+        uint32_t tipHeight = baseHeight + (uint32_t) recordsCount - 1;
+        uint32_t begHeight = tipHeight - tipHeight % BLOCK_DIFFICULTY_INTERVAL;
+        if (begHeight < baseHeight) begHeight = baseHeight;
+
+        // The first header links to the one stored before it, if any.
+        UInt256 prevBlockHash = UINT256_ZERO;
+        if (begHeight > baseHeight)
+            BRSHA256_2 (&prevBlockHash,
+                        &bytes[HEADER_STORE_PREFIX_SIZE + (begHeight - 1 - baseHeight) * HEADER_STORE_RECORD_SIZE],
+                        HEADER_STORE_RECORD_SIZE);
+
+        array_new (blocks, tipHeight - begHeight + 1);
+        for (uint32_t height = begHeight; height <= tipHeight; height++) {
+            const uint8_t *record = &bytes[HEADER_STORE_PREFIX_SIZE + (height - baseHeight) * HEADER_STORE_RECORD_SIZE];
+
+            BRMerkleBlock *block = BRMerkleBlockParse (record, HEADER_STORE_RECORD_SIZE);
+            if (NULL == block ||
+                (height > baseHeight && !UInt256Eq (prevBlockHash, block->prevBlock))) {
+                if (NULL != block) BRMerkleBlockFree (block);
+                validCount = height - baseHeight;
+                break;
+            }
+
+            block->height = height;
+            prevBlockHash = block->blockHash;
+            array_add (blocks, block);
+        }
+
+        if (0 == array_count (blocks)) {
+            array_free (blocks);
+            blocks = NULL;
+        }
+    }
+
+    munmap (bytes, size);
+
+    // Drop an invalid tail so that the next save appends to the last valid header.
+    if (SIZE_MAX != recordsCount &&
+        size != HEADER_STORE_PREFIX_SIZE + validCount * HEADER_STORE_RECORD_SIZE) {
+        int truncated = (0 == ftruncate (fd, (off_t) (HEADER_STORE_PREFIX_SIZE + validCount * HEADER_STORE_RECORD_SIZE)));
+        _peer_log ("BWM: %s header store at %zu of %zu headers\n",
+                   (truncated ? "truncated" : "failed to truncate"), validCount, recordsCount);
+    }
+
+    close (fd);
+    return blocks;
+}
+
+// Save the headers of `blocks`, which are in descending height order, as from BRPeerManager.
+// Headers already stored are not rewritten.  Returns 0 on failure.
+static int
+headerStoreSaveBTC (const char *path, BRMerkleBlock **blocks, size_t blocksCount) {
+    if (0 == blocksCount) return 1;
+
+    uint32_t begHeight = blocks[blocksCount - 1]->height;
+    uint32_t endHeight = blocks[0]->height + 1;
+
+    // Only a contiguous chain of headers can be stored.
+    for (size_t index = 0; index < blocksCount; index++)
+        if (blocks[index]->height != endHeight - 1 - index) return 0;
+
+    uint8_t *records = malloc (blocksCount * HEADER_STORE_RECORD_SIZE);
+    for (size_t index = 0; index < blocksCount; index++) {
+        BRMerkleBlock header = *blocks[blocksCount - 1 - index];
+        header.totalTx = 0;     // just the header
+        BRMerkleBlockSerialize (&header, &records[index * HEADER_STORE_RECORD_SIZE], HEADER_STORE_RECORD_SIZE);
+    }
+
+    int fd = open (path, O_RDWR | O_CREAT, 0600);
+    if (-1 == fd) { free (records); return 0; }
+
+    struct stat fdStat;
+    uint8_t  prefix[HEADER_STORE_PREFIX_SIZE];
+    uint32_t baseHeight   = 0;
+    size_t   recordsCount = SIZE_MAX;
+
+    if (0 == fstat (fd, &fdStat) &&
+        HEADER_STORE_PREFIX_SIZE == pread (fd, prefix, HEADER_STORE_PREFIX_SIZE, 0))
+        recordsCount = headerStoreRecordsCount (prefix, (size_t) fdStat.st_size, &baseHeight);
+
+    // Start over if there is no store, or `blocks` precede it or don't extend it.
+    if (SIZE_MAX == recordsCount || begHeight < baseHeight || begHeight > baseHeight + recordsCount) {
+        baseHeight   = begHeight;
+        recordsCount = 0;
+
+        UInt32SetLE (&prefix[0 * sizeof (uint32_t)], HEADER_STORE_MAGIC);
+        UInt32SetLE (&prefix[1 * sizeof (uint32_t)], HEADER_STORE_VERSION);
+        UInt32SetLE (&prefix[2 * sizeof (uint32_t)], HEADER_STORE_RECORD_SIZE);
+        UInt32SetLE (&prefix[3 * sizeof (uint32_t)], baseHeight);
+
+        if (0 != ftruncate (fd, 0) ||
+            HEADER_STORE_PREFIX_SIZE != pwrite (fd, prefix, HEADER_STORE_PREFIX_SIZE, 0)) {
+            close (fd);
+            free (records);
+            return 0;
+        }
+    }
+
+    // Skip the headers already stored; typically all but the newest one.
+    size_t firstIndex   = begHeight - baseHeight;
+    size_t storedCount  = (recordsCount > firstIndex ? recordsCount - firstIndex : 0);
+    size_t matchedCount = 0;
+
+    if (storedCount > blocksCount) storedCount = blocksCount;
+
+    if (storedCount > 0) {
+        uint8_t *stored = malloc (storedCount * HEADER_STORE_RECORD_SIZE);
+        off_t    offset = (off_t) (HEADER_STORE_PREFIX_SIZE + firstIndex * HEADER_STORE_RECORD_SIZE);
+
+        if ((ssize_t) (storedCount * HEADER_STORE_RECORD_SIZE) == pread (fd, stored, storedCount * HEADER_STORE_RECORD_SIZE, offset))
+            while (matchedCount < storedCount &&
+                   0 == memcmp (&stored[matchedCount * HEADER_STORE_RECORD_SIZE],
+                                &records[matchedCount * HEADER_STORE_RECORD_SIZE],
+                                HEADER_STORE_RECORD_SIZE))
+                matchedCount++;
+
+        free (stored);
+    }
+
+    // Write the remaining headers, replacing any that differ, and drop those beyond `blocks`.
+    size_t writeCount  = blocksCount - matchedCount;
+    off_t  writeOffset = (off_t) (HEADER_STORE_PREFIX_SIZE + (firstIndex + matchedCount) * HEADER_STORE_RECORD_SIZE);
+
+    int success = ((0 == writeCount ||
+                    (ssize_t) (writeCount * HEADER_STORE_RECORD_SIZE) == pwrite (fd,
+                                                                                 &records[matchedCount * HEADER_STORE_RECORD_SIZE],
+                                                                                 writeCount * HEADER_STORE_RECORD_SIZE,
+                                                                                 writeOffset)) &&
+                   0 == ftruncate (fd, writeOffset + (off_t) (writeCount * HEADER_STORE_RECORD_SIZE)));
+
+    close (fd);
+    free (records);
+
+    return success;
+}
+
+extern void
+saveBlocksBTC (BRCryptoWalletManager manager,
+               int replace,
+               BRMerkleBlock **blocks,
+               size_t blocksCount) {
+    char *path = headerStorePathBTC (manager);
+    int stored = headerStoreSaveBTC (path, blocks, blocksCount);
+    free (path);
+
+    // With the headers stored, only blocks with matched transactions are saved in full.
+    BRMerkleBlock **fullBlocks      = blocks;
+    size_t          fullBlocksCount = blocksCount;
+
+    if (stored) {
+        fullBlocks      = calloc (blocksCount, sizeof (BRMerkleBlock*));
+        fullBlocksCount = 0;
+
+        for (size_t index = 0; index < blocksCount; index++)
+            if (BRMerkleBlockTxHashes (blocks[index], NULL, 0) > 0)
+                fullBlocks[fullBlocksCount++] = blocks[index];
+    }
+
+    if (replace)
+        fileServiceReplace (manager->fileService, FILE_SERVICE_TYPE_BLOCK, (const void **) fullBlocks, fullBlocksCount);
+    else if (fullBlocksCount > 0)
+        fileServiceSaveMany (manager->fileService, FILE_SERVICE_TYPE_BLOCK, (const void **) fullBlocks, fullBlocksCount);
+
+    if (fullBlocks != blocks) free (fullBlocks);
+}
+
 extern BRArrayOf(BRMerkleBlock*)
 initialBlocksLoadBTC (BRCryptoWalletManager manager) {
-    BRSetOf(BRMerkleBlock*) blockSet = BRSetNew(BRMerkleBlockHash, BRMerkleBlockEq, 100);
-    if (1 != fileServiceLoad (manager->fileService, blockSet, fileServiceTypeBlocksBTC, 1)) {
-        BRSetFreeAll(blockSet, (void (*) (void*)) BRMerkleBlockFree);
+    BRArrayOf(BRMerkleBlock*) blocks;
+    array_new (blocks, 100);
+
+    if (1 != fileServiceLoadIterate (manager->fileService, fileServiceTypeBlocksBTC, 1,
+                                     &blocks, fileServiceLoadIntoArrayBTC)) {
+        array_free_all (blocks, BRMerkleBlockFree);
         _peer_log ("BWM: %4s: failed to load blocks",
                    cryptoBlockChainTypeGetCurrencyCode (manager->type));
         return NULL;
     }
 
-    size_t blocksCount = BRSetCount(blockSet);
+    char *path = headerStorePathBTC (manager);
+    BRArrayOf(BRMerkleBlock*) headers = headerStoreLoadBTC (path);
+    free (path);
 
-    BRArrayOf(BRMerkleBlock*) blocks;
-    array_new (blocks, blocksCount);
-    array_set_count(blocks, blocksCount);
+    size_t headersCount = (NULL == headers ? 0 : array_count (headers));
 
-    BRSetAll(blockSet, (void**) blocks, blocksCount);
-    BRSetFree(blockSet);
+    // Prefer a full block to its header
+    if (0 != headersCount) {
+        BRSet *blockSet = BRSetNew (BRMerkleBlockHash, BRMerkleBlockEq, headersCount + array_count (blocks));
 
-    _peer_log ("BWM: %4s: loaded %4zu blocks\n",
+        for (size_t index = 0; index < headersCount; index++)
+            BRSetAdd (blockSet, headers[index]);
+
+        for (size_t index = 0; index < array_count (blocks); index++) {
+            BRMerkleBlock *header = BRSetAdd (blockSet, blocks[index]);
+            if (NULL != header) BRMerkleBlockFree (header);
+        }
+
+        array_set_count (blocks, BRSetCount (blockSet));
+        BRSetAll (blockSet, (void **) blocks, array_count (blocks));
+
+        BRSetFree (blockSet);
+        array_free (headers);
+    }
+
+    _peer_log ("BWM: %4s: loaded %4zu blocks (%zu headers)\n",
                cryptoBlockChainTypeGetCurrencyCode (manager->type),
-               blocksCount);
+               array_count (blocks),
+               headersCount);
     return blocks;
 }
 
@@ -268,28 +706,35 @@ fileServiceTypePeerV1Reader (BRFileServiceContext context,
     return peer;
 }
 
+static int
+fileServiceLoadPeerIntoArrayBTC (BRFileServiceContext context,
+                                 BRFileService fs,
+                                 void *entity) {
+    BRArrayOf(BRPeer) *peers = context;
+    BRPeer *peer = entity;
+
+    array_add (*peers, *peer);
+    free (peer);
+    return 1;
+}
+
 extern BRArrayOf(BRPeer)
 initialPeersLoadBTC (BRCryptoWalletManager manager) {
     /// Load peers for the wallet manager.
-    BRSetOf(BRPeer*) peerSet = BRSetNew(BRPeerHash, BRPeerEq, 100);
-    if (1 != fileServiceLoad (manager->fileService, peerSet, fileServiceTypePeersBTC, 1)) {
-        BRSetFreeAll(peerSet, free);
+    BRArrayOf(BRPeer) peers;
+    array_new (peers, 100);
+
+    if (1 != fileServiceLoadIterate (manager->fileService, fileServiceTypePeersBTC, 1,
+                                     &peers, fileServiceLoadPeerIntoArrayBTC)) {
+        array_free (peers);
         _peer_log ("BWM: %4s: failed to load peers",
                    cryptoBlockChainTypeGetCurrencyCode (manager->type));
         return NULL;
     }
 
-    size_t peersCount = BRSetCount(peerSet);
-
-    BRArrayOf(BRPeer) peers;
-    array_new (peers, peersCount);
-
-    FOR_SET (BRPeer*, peer, peerSet) array_add (peers, *peer);
-    BRSetFreeAll(peerSet, free);
-
     _peer_log ("BWM: %4s: loaded %4zu peers\n",
                cryptoBlockChainTypeGetCurrencyCode (manager->type),
-               peersCount);
+               array_count (peers));
     return peers;
 }
 
@@ -304,16 +749,39 @@ initialPeersLoadBTC (BRCryptoWalletManager manager) {
 static BRFileServiceTypeSpecification fileServiceSpecificationsArrayBTC[] = {
     {
         FILE_SERVICE_TYPE_TRANSACTION,
-        FILE_SERVICE_TYPE_TRANSACTION_VERSION_1,
-        1,
+        FILE_SERVICE_TYPE_TRANSACTION_VERSION_2,
+        2,
         {
             {
                 FILE_SERVICE_TYPE_TRANSACTION_VERSION_1,
                 fileServiceTypeTransactionV1Identifier,
                 fileServiceTypeTransactionV1Reader,
                 fileServiceTypeTransactionV1Writer
+            },
+
+            {
+                FILE_SERVICE_TYPE_TRANSACTION_VERSION_2,
+                fileServiceTypeTransactionV1Identifier,
+                fileServiceTypeTransactionV2Reader,
+                fileServiceTypeTransactionV2Writer
             }
-        }
+        },
+        (BRFileServiceReleaser) BRTransactionFree
+    },
+
+    {
+        FILE_SERVICE_TYPE_TRANSACTION_STATUS,
+        FILE_SERVICE_TYPE_TRANSACTION_STATUS_VERSION_1,
+        1,
+        {
+            {
+                FILE_SERVICE_TYPE_TRANSACTION_STATUS_VERSION_1,
+                fileServiceTypeTransactionStatusV1Identifier,
+                fileServiceTypeTransactionStatusV1Reader,
+                fileServiceTypeTransactionStatusV1Writer
+            }
+        },
+        free
     },
 
     {
@@ -327,7 +795,8 @@ static BRFileServiceTypeSpecification fileServiceSpecificationsArrayBTC[] = {
                 fileServiceTypeBlockV1Reader,
                 fileServiceTypeBlockV1Writer
             }
-        }
+        },
+        (BRFileServiceReleaser) BRMerkleBlockFree
     },
 
     {
@@ -341,7 +810,8 @@ static BRFileServiceTypeSpecification fileServiceSpecificationsArrayBTC[] = {
                 fileServiceTypePeerV1Reader,
                 fileServiceTypePeerV1Writer
             }
-        }
+        },
+        free
     }
 };
 
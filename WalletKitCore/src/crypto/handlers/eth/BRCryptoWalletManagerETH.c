@@ -143,10 +143,10 @@ cryptoWalletManagerCreateFileServiceETH (BRCryptoWalletManager manager,
                                          const char *network,
                                          BRFileServiceContext context,
                                          BRFileServiceErrorHandler handler) {
-    return fileServiceCreateFromTypeSpecifications (basePath, currency, network,
-                                                    context, handler,
-                                                    cryptoFileServiceSpecificationsCount,
-                                                    cryptoFileServiceSpecifications);
+    return cryptoFileServiceCreate (basePath, currency, network,
+                                    context, handler,
+                                    cryptoFileServiceSpecificationsCount,
+                                    cryptoFileServiceSpecifications);
 }
 
 static const BREventType **
@@ -1014,6 +1014,7 @@ BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersETH = {
     NULL, // BRCryptoWalletManagerSaveTransactionBundleHandler
     NULL, // BRCryptoWalletManagerSaveTransactionBundleHandler
     cryptoWalletManagerRecoverTransfersFromTransactionBundleETH,
+    NULL, // BRCryptoWalletManagerRecoverTransfersFromTransactionBundlesHandler
     cryptoWalletManagerRecoverTransferFromTransferBundleETH,
     cryptoWalletManagerRecoverFeeBasisFromFeeEstimateETH,
     NULL,//BRCryptoWalletManagerWalletSweeperValidateSupportedHandler not supported
@@ -74,10 +74,10 @@ crytpWalletManagerCreateFileServiceXRP (BRCryptoWalletManager manager,
                                         const char *network,
                                         BRFileServiceContext context,
                                         BRFileServiceErrorHandler handler) {
-    return fileServiceCreateFromTypeSpecifications (basePath, currency, network,
-                                                    context, handler,
-                                                    cryptoFileServiceSpecificationsCount,
-                                                    cryptoFileServiceSpecifications);
+    return cryptoFileServiceCreate (basePath, currency, network,
+                                    context, handler,
+                                    cryptoFileServiceSpecificationsCount,
+                                    cryptoFileServiceSpecifications);
 }
 
 static const BREventType **
@@ -303,6 +303,7 @@ BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersXRP = {
     NULL, // BRCryptoWalletManagerSaveTransactionBundleHandler
     NULL, // BRCryptoWalletManagerSaveTransactionBundleHandler
     cryptoWalletManagerRecoverTransfersFromTransactionBundleXRP,
+    NULL, // BRCryptoWalletManagerRecoverTransfersFromTransactionBundlesHandler
     cryptoWalletManagerRecoverTransferFromTransferBundleXRP,
     NULL,//BRCryptoWalletManagerRecoverFeeBasisFromFeeEstimateHandler not supported
     cryptoWalletManagerWalletSweeperValidateSupportedXRP,
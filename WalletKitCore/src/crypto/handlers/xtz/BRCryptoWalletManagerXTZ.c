@@ -66,10 +66,10 @@ crytpWalletManagerCreateFileServiceXTZ (BRCryptoWalletManager manager,
                                         const char *network,
                                         BRFileServiceContext context,
                                         BRFileServiceErrorHandler handler) {
-    return fileServiceCreateFromTypeSpecifications (basePath, currency, network,
-                                                    context, handler,
-                                                    cryptoFileServiceSpecificationsCount,
-                                                    cryptoFileServiceSpecifications);
+    return cryptoFileServiceCreate (basePath, currency, network,
+                                    context, handler,
+                                    cryptoFileServiceSpecificationsCount,
+                                    cryptoFileServiceSpecifications);
 }
 
 static const BREventType **
@@ -359,6 +359,7 @@ BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersXTZ = {
     NULL, // BRCryptoWalletManagerSaveTransactionBundleHandler
     NULL, // BRCryptoWalletManagerSaveTransactionBundleHandler
     cryptoWalletManagerRecoverTransfersFromTransactionBundleXTZ,
+    NULL, // BRCryptoWalletManagerRecoverTransfersFromTransactionBundlesHandler
     cryptoWalletManagerRecoverTransferFromTransferBundleXTZ,
     cryptoWalletManagerRecoverFeeBasisFromFeeEstimateXTZ,
     cryptoWalletManagerWalletSweeperValidateSupportedXTZ,
@@ -31,7 +31,9 @@ bcsHandleSubmitTransactionDispatcher (BREventHandler ignore,
 static BREventType handleSubmitTransactionEventType = {
     "BCS: Handle Submit Transaction Event",
     sizeof (BREthereumHandleSubmitTransactionEvent),
-    (BREventDispatcher) bcsHandleSubmitTransactionDispatcher
+    (BREventDispatcher) bcsHandleSubmitTransactionDispatcher,
+    NULL,
+    EVENT_PRIORITY_HIGH
 };
 
 extern void
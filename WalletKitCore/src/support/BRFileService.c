@@ -32,7 +32,9 @@
 #include <errno.h>
 #include <pthread.h>
 #include <stdbool.h>
+#include <inttypes.h>
 #include "support/BROSCompat.h"
+#include "support/BRCrypto.h"
 
 #include "../vendor/sqlite3/sqlite3.h"
 typedef int sqlite3_status_code;
@@ -41,48 +43,85 @@ typedef int sqlite3_status_code;
 #define FILE_SERVICE_INITIAL_HANDLER_COUNT    (2)
 
 #define FILE_SERVICE_SDB_FILENAME      "entities.db"
+#define FILE_SERVICE_SDB_POOL_FILENAME "pooled-entities.db"
 
+// The 'EntityBlob' table holds the raw entity bytes (header included) as a BLOB keyed by the
+// raw, 32-byte identifier.  It replaces the original, hex-encoded 'Entity' table; any rows in
+// that table are migrated, once, when the file service is created.  The 'Partition' separates
+// the file services sharing a pool's database; it is empty for a standalone file service.
 #define FILE_SERVICE_SDB_ENTITY_TABLE     \
-"CREATE TABLE IF NOT EXISTS Entity(     \n\
+"CREATE TABLE IF NOT EXISTS EntityBlob( \n\
+  Partition TEXT        NOT NULL,       \n\
   Type      CHAR(64)    NOT NULL,       \n\
-  Hash      CHAR(64)    NOT NULL,       \n\
-  Data      TEXT        NOT NULL,       \n\
-  PRIMARY KEY (Type, Hash));"
+  Hash      BLOB        NOT NULL,       \n\
+  Data      BLOB        NOT NULL,       \n\
+  PRIMARY KEY (Partition, Type, Hash)) WITHOUT ROWID;"
 
 typedef char FileServiceSQL[1024];
 
 #define FILE_SERVICE_SDB_INSERT_ENTITY    \
-"INSERT OR REPLACE INTO Entity (Type, Hash, Data) VALUES (?, ?, ?);"
+"INSERT OR REPLACE INTO EntityBlob (Partition, Type, Hash, Data) VALUES (?, ?, ?, ?);"
 
 #define FILE_SERVICE_SDB_QUERY_ENTITY     \
-"SELECT Data FROM Entity WHERE Type = ? AND Hash = ?;"
+"SELECT Data FROM EntityBlob WHERE Partition = ? AND Type = ? AND Hash = ?;"
 
 #define FILE_SERVICE_SDB_QUERY_ALL_ENTITY     \
-"SELECT Hash, Data FROM Entity WHERE Type = ?;"
+"SELECT Hash, Data FROM EntityBlob WHERE Partition = ? AND Type = ?;"
 
 #define FILE_SERVICE_SDB_UPDATE_ENTITY     \
-"UPDATE Entity SET Data = ? WHERE Type = ? AND Hash = ?;"
+"UPDATE EntityBlob SET Data = ? WHERE Partition = ? AND Type = ? AND Hash = ?;"
 
 #define FILE_SERVICE_SDB_DELETE_ENTITY     \
-"DELETE FROM Entity WHERE Type = ? AND Hash = ?;"
+"DELETE FROM EntityBlob WHERE Partition = ? AND Type = ? AND Hash = ?;"
 
 #define FILE_SERVICE_SDB_DELETE_ALL_TYPE_ENTITY     \
-"DELETE FROM Entity WHERE Type = ?;"
+"DELETE FROM EntityBlob WHERE Partition = ? AND Type = ?;"
 
-#define FILE_SERVICE_SDB_DELETE_ALL_ENTITY     \
-"DELETE FROM Entity;"
+// The 'EntityQuarantine' table holds rows from 'EntityBlob' found to be corrupted during a load;
+// they are held for diagnosis until cleared.
+#define FILE_SERVICE_SDB_QUARANTINE_TABLE     \
+"CREATE TABLE IF NOT EXISTS EntityQuarantine( \n\
+  Partition TEXT        NOT NULL,       \n\
+  Type      CHAR(64)    NOT NULL,       \n\
+  Hash      BLOB        NOT NULL,       \n\
+  Data      BLOB        NOT NULL,       \n\
+  Reason    TEXT        NOT NULL,       \n\
+  PRIMARY KEY (Partition, Type, Hash)) WITHOUT ROWID;"
+
+#define FILE_SERVICE_SDB_INSERT_QUARANTINE    \
+"INSERT OR REPLACE INTO EntityQuarantine (Partition, Type, Hash, Data, Reason) VALUES (?, ?, ?, ?, ?);"
+
+#define FILE_SERVICE_SDB_COUNT_QUARANTINE    \
+"SELECT COUNT(*) FROM EntityQuarantine WHERE Partition = ? AND Type = ?;"
+
+#define FILE_SERVICE_SDB_DELETE_QUARANTINE    \
+"DELETE FROM EntityQuarantine WHERE Partition = ? AND Type = ?;"
+
+#define FILE_SERVICE_SDB_DELETE_PARTITION_ENTITY     \
+"DELETE FROM EntityBlob WHERE Partition = ?;"
+
+#define FILE_SERVICE_SDB_DELETE_PARTITION_QUARANTINE     \
+"DELETE FROM EntityQuarantine WHERE Partition = ?;"
+
+// The legacy, hex-encoded 'Entity' table.  Only used to migrate into 'EntityBlob'
+#define FILE_SERVICE_SDB_LEGACY_ENTITY_TABLE_EXISTS     \
+"SELECT name FROM sqlite_master WHERE type = 'table' AND name = 'Entity';"
+
+#define FILE_SERVICE_SDB_LEGACY_QUERY_ALL_ENTITY     \
+"SELECT Type, Hash, Data FROM Entity;"
+
+#define FILE_SERVICE_SDB_LEGACY_DROP_ENTITY_TABLE     \
+"DROP TABLE Entity;"
 
 #if defined(DEBUG)
 static int needSQLiteCompileOptions = 1;
 #endif
-// HEX Encode/Decode - Cribbed from ethereum/util/BRUtilHex.c
+// HEX Decode - Cribbed from ethereum/util/BRUtilHex.c.  Only needed to migrate the legacy,
+// hex-encoded 'Entity' table.
 
 // Convert a char into uint8_t (decode)
 #define decodeChar(c)           ((uint8_t) _hexu(c))
 
-// Convert a uint8_t into a char (encode)
-#define encodeChar(u)           ((char)    _hexc(u))
-
 static void
 hexDecode (uint8_t *target, size_t targetLen, const char *source, size_t sourceLen) {
     //
@@ -94,17 +133,6 @@ hexDecode (uint8_t *target, size_t targetLen, const char *source, size_t sourceL
     }
 }
 
-static void
-hexEncode (char *target, size_t targetLen, const uint8_t *source, size_t sourceLen) {
-    assert (targetLen == 2 * sourceLen  + 1);
-
-    for (int i = 0; i < sourceLen; i++) {
-        target[2*i + 0] = encodeChar (source[i] >> 4);
-        target[2*i + 1] = encodeChar (source[i]);
-    }
-    target[2*sourceLen] = '\0';
-}
-
 /** Forward Declarations */
 static int
 fileServiceFailedSDB (BRFileService fs,
@@ -120,12 +148,101 @@ static int directoryMake (const char *path) {
     return -1; // otherwise error
 }
 
+#if !defined(NEUTER_FILE_SERVICE)
+///
+/// Migrate the legacy, hex-encoded 'Entity' table, if it exists, into the 'EntityBlob' table.  The
+/// migration is performed in one DB transaction and drops 'Entity' on success; it thus runs once.
+///
+static sqlite3_status_code
+fileServiceMigrateLegacyEntities (sqlite3 *sdb) {
+    sqlite3_status_code status;
+
+    // Determine if the legacy table exists
+    sqlite3_stmt *existsStmt;
+    status = sqlite3_prepare_v2 (sdb, FILE_SERVICE_SDB_LEGACY_ENTITY_TABLE_EXISTS, -1, &existsStmt, NULL);
+    if (SQLITE_OK != status) return status;
+
+    status = sqlite3_step (existsStmt);
+    sqlite3_finalize (existsStmt);
+
+    if (SQLITE_DONE == status) return SQLITE_OK;  // No legacy table; nothing to migrate.
+    if (SQLITE_ROW  != status) return status;
+
+    status = sqlite3_exec (sdb, "BEGIN IMMEDIATE", NULL, NULL, NULL);
+    if (SQLITE_OK != status) return status;
+
+    sqlite3_stmt *selectStmt = NULL;
+    sqlite3_stmt *insertStmt = NULL;
+
+    status = sqlite3_prepare_v2 (sdb, FILE_SERVICE_SDB_LEGACY_QUERY_ALL_ENTITY, -1, &selectStmt, NULL);
+    if (SQLITE_OK == status)
+        status = sqlite3_prepare_v2 (sdb, FILE_SERVICE_SDB_INSERT_ENTITY, -1, &insertStmt, NULL);
+
+    uint8_t *dataBytes      = NULL;
+    size_t   dataBytesCount = 0;
+
+    while (SQLITE_OK == status && SQLITE_ROW == (status = sqlite3_step (selectStmt))) {
+        const char *type = (const char *) sqlite3_column_text (selectStmt, 0);
+        const char *hash = (const char *) sqlite3_column_text (selectStmt, 1);
+        const char *data = (const char *) sqlite3_column_text (selectStmt, 2);
+
+        size_t dataCount = (NULL == data ? 0 : strlen (data));
+        if (NULL == type || NULL == hash || 64 != strlen (hash) || 0 == dataCount || 0 != dataCount % 2) {
+            status = SQLITE_CORRUPT;
+            break;
+        }
+
+        // Decode `hash` and `data` into their raw bytes
+        UInt256 identifier = uint256 (hash);
+
+        if ((dataCount/2) > dataBytesCount) {
+            dataBytesCount = dataCount/2;
+            dataBytes = realloc (dataBytes, dataBytesCount);
+        }
+        hexDecode (dataBytes, dataCount/2, data, dataCount);
+
+        sqlite3_reset (insertStmt);
+        sqlite3_clear_bindings (insertStmt);
+
+        // The legacy table is only ever in a standalone file service's database; no partition.
+        status = sqlite3_bind_text (insertStmt, 1, "", -1, SQLITE_STATIC);
+        if (SQLITE_OK == status)
+            status = sqlite3_bind_text (insertStmt, 2, type, -1, SQLITE_STATIC);
+        if (SQLITE_OK == status)
+            status = sqlite3_bind_blob (insertStmt, 3, identifier.u8, sizeof (UInt256), SQLITE_STATIC);
+        if (SQLITE_OK == status)
+            status = sqlite3_bind_blob (insertStmt, 4, dataBytes, (int) (dataCount/2), SQLITE_STATIC);
+        if (SQLITE_OK == status)
+            status = (SQLITE_DONE == sqlite3_step (insertStmt) ? SQLITE_OK : sqlite3_errcode (sdb));
+    }
+    if (SQLITE_DONE == status) status = SQLITE_OK;
+
+    if (NULL != dataBytes) free (dataBytes);
+    if (NULL != insertStmt) sqlite3_finalize (insertStmt);
+    if (NULL != selectStmt) sqlite3_finalize (selectStmt);
+
+    if (SQLITE_OK == status)
+        status = sqlite3_exec (sdb, FILE_SERVICE_SDB_LEGACY_DROP_ENTITY_TABLE, NULL, NULL, NULL);
+
+    if (SQLITE_OK == status)
+        status = sqlite3_exec (sdb, "COMMIT", NULL, NULL, NULL);
+    else
+        sqlite3_exec (sdb, "ROLLBACK", NULL, NULL, NULL);
+
+    return status;
+}
+#endif
+
 // This must be coercible to/from a uint8_t forever.
 typedef enum {
-    HEADER_FORMAT_1
+    HEADER_FORMAT_1,    // {HeaderFormatVersion, Version, EntityBytesCount, EntityBytes}
+    HEADER_FORMAT_2     // {HeaderFormatVersion, Version, EntityBytesCount, Checksum, EntityBytes}
 } BRFileServiceHeaderFormatVersion;
 
-static BRFileServiceHeaderFormatVersion currentHeaderFormatVersion = HEADER_FORMAT_1;
+static BRFileServiceHeaderFormatVersion currentHeaderFormatVersion = HEADER_FORMAT_2;
+
+// The checksum over EntityBytes.  Cheap, to not slow loads; it detects corruption, not tampering.
+#define fileServiceChecksum(bytes, bytesCount)      BRMurmur3_32 ((bytes), (bytesCount), 0)
 
 ///
 /// The handlers for a particular entity's version
@@ -144,6 +261,7 @@ typedef struct {
 typedef struct {
     char *type;
     BRFileServiceVersion currentVersion;
+    BRFileServiceReleaser releaser;
     BRArrayOf(BRFileServiceEntityHandler) handlers;
 } BRFileServiceEntityType;
 
@@ -177,12 +295,15 @@ fileServiceEntityTypeAddHandler (BRFileServiceEntityType *entityType,
 }
 
 ///
+/// A pool holds the SQLite database - the connection, the prepared statements and the lock that
+/// serializes their use.  A standalone file service owns a private pool; pooled file services,
+/// perhaps hundreds of them, share one - see `fileServicePoolCreate()`.  In a shared pool each
+/// file service's rows are kept apart by the file service's partition, bound as the 'Partition'
+/// of every statement; thus one set of statements serves all.
 ///
-///
-struct BRFileServiceRecord {
-    char *currency;
-    char *network;
+struct BRFileServicePoolRecord {
     char *sdbPath;
+    size_t loadWorkersCount;
 
 #if !defined(NEUTER_FILE_SERVICE)
     sqlite3 *sdb;
@@ -192,25 +313,60 @@ struct BRFileServiceRecord {
     sqlite3_stmt *sdbUpdateStmt;
     sqlite3_stmt *sdbDeleteStmt;
     sqlite3_stmt *sdbDeleteAllTypeStmt;
-    sqlite3_stmt *sdbDeleteAllStmt;
-    bool  sdbClosed;
+    sqlite3_stmt *sdbInsertQuarantineStmt;
+
+    // The file services within a `fileServiceBeginTransaction()`.  The connection has but one DB
+    // transaction; while any file service is within its own, one is kept open.
+    size_t sdbTransactionsCount;
+
+    // If `writeBehind`, saves and removes are queued, coalesced, in `writes` for the `writer`
+    // thread.  The queue has its own lock, thus queuing never waits on the DB.
+    bool writeBehind;
+    pthread_t writer;
+    pthread_mutex_t writesLock;
+    pthread_cond_t writesCond;      // signaled on a queued write, or to quit
+    pthread_cond_t flushedCond;     // broadcast once the writer has written its writes
+    BRSet *writes;
+    bool writing;
+    bool writerQuit;
 #endif
 
+    // The references to this pool, from file services and from `fileServicePoolCreate()`
+    size_t referencesCount;
+    bool shared;
+
+    pthread_mutex_t lock;
+};
+
+///
+///
+///
+struct BRFileServiceRecord {
+    char *currency;
+    char *network;
+
+    // The 'Partition' in the pool, as "<partition>/<currency>-<network>"; empty if standalone
+    char *partition;
+
+    BRFileServicePool pool;
+    bool  sdbClosed;
+
+    // The nesting of `fileServiceBeginTransaction()`, for this file service alone
+    size_t sdbTransactionDepth;
+
     BRArrayOf(BRFileServiceEntityType) entityTypes;
     BRFileServiceContext context;
     BRFileServiceErrorHandler handler;
-
-    pthread_mutex_t lock;
 };
 
-static BRFileService
-fileServiceCreateReturnError (BRFileService fs,
-                              int releaseLock,
-                              BRFileServiceError error) {
-    // Nothing with 'error' at this point; a placeholder for now.
-    if (releaseLock) pthread_mutex_unlock (&fs->lock);
-    fileServiceRelease (fs);
-    return NULL;
+// The 'Partition' of the file service for `partition`, `currency` and `network` in a pool.
+static char *
+fileServiceCreatePartition (const char *partition,
+                            const char *currency,
+                            const char *network) {
+    char *sdbPartition = malloc (strlen (partition) + 1 + strlen (currency) + 1 + strlen (network) + 1);
+    sprintf (sdbPartition, "%s/%s-%s", partition, currency, network);
+    return sdbPartition;
 }
 
 static char *
@@ -224,120 +380,219 @@ fileServiceCreateFilePath (const char *basePath,
     return sdbPath;
 }
 
-extern BRFileService
-fileServiceCreate (const char *basePath,
-                   const char *currency,
-                   const char *network,
-                   BRFileServiceContext context,
-                   BRFileServiceErrorHandler handler) {
-    if (NULL == basePath || 0 == strlen(basePath)) return NULL;
-    if (NULL == currency || 0 == strlen(currency)) return NULL;
-    if (NULL == network  || 0 == strlen(network))  return NULL;
+#if !defined(NEUTER_FILE_SERVICE)
+static const char *
+fileServiceJournalModeGetName (BRFileServiceJournalMode mode) {
+    switch (mode) {
+        case FILE_SERVICE_JOURNAL_MODE_DEFAULT:  return NULL;
+        case FILE_SERVICE_JOURNAL_MODE_DELETE:   return "DELETE";
+        case FILE_SERVICE_JOURNAL_MODE_TRUNCATE: return "TRUNCATE";
+        case FILE_SERVICE_JOURNAL_MODE_WAL:      return "WAL";
+    }
+}
 
-    // Reasonable limits on `network` and `currency` (ensure subsequent stack allocation works).
-    if (strlen(network) > FILENAME_MAX || strlen(currency) > FILENAME_MAX)
-        return NULL;
+static const char *
+fileServiceSynchronousGetName (BRFileServiceSynchronous synchronous) {
+    switch (synchronous) {
+        case FILE_SERVICE_SYNCHRONOUS_DEFAULT: return NULL;
+        case FILE_SERVICE_SYNCHRONOUS_OFF:     return "OFF";
+        case FILE_SERVICE_SYNCHRONOUS_NORMAL:  return "NORMAL";
+        case FILE_SERVICE_SYNCHRONOUS_FULL:    return "FULL";
+    }
+}
+
+static const char *
+fileServiceTempStoreGetName (BRFileServiceTempStore store) {
+    switch (store) {
+        case FILE_SERVICE_TEMP_STORE_DEFAULT: return NULL;
+        case FILE_SERVICE_TEMP_STORE_FILE:    return "FILE";
+        case FILE_SERVICE_TEMP_STORE_MEMORY:  return "MEMORY";
+    }
+}
+
+///
+/// Apply `configuration` to `sdb` as a sequence of PRAGMA statements.  The `page_size` must
+/// precede any table creation (and `journal_mode`) to have an effect on a new database.
+///
+static sqlite3_status_code
+fileServiceApplyConfiguration (sqlite3 *sdb,
+                               const BRFileServiceConfiguration *configuration) {
+    if (NULL == configuration) return SQLITE_OK;
+
+    FileServiceSQL sql;
+    sqlite3_status_code status = SQLITE_OK;
+    const char *name;
+
+    if (SQLITE_OK == status && 0 != configuration->pageSize) {
+        snprintf (sql, sizeof (sql), "PRAGMA page_size = %d;", configuration->pageSize);
+        status = sqlite3_exec (sdb, sql, NULL, NULL, NULL);
+    }
+
+    if (SQLITE_OK == status && NULL != (name = fileServiceJournalModeGetName (configuration->journalMode))) {
+        snprintf (sql, sizeof (sql), "PRAGMA journal_mode = %s;", name);
+        status = sqlite3_exec (sdb, sql, NULL, NULL, NULL);
+    }
+
+    if (SQLITE_OK == status && NULL != (name = fileServiceSynchronousGetName (configuration->synchronous))) {
+        snprintf (sql, sizeof (sql), "PRAGMA synchronous = %s;", name);
+        status = sqlite3_exec (sdb, sql, NULL, NULL, NULL);
+    }
+
+    if (SQLITE_OK == status && NULL != (name = fileServiceTempStoreGetName (configuration->tempStore))) {
+        snprintf (sql, sizeof (sql), "PRAGMA temp_store = %s;", name);
+        status = sqlite3_exec (sdb, sql, NULL, NULL, NULL);
+    }
+
+    if (SQLITE_OK == status && 0 != configuration->cacheSize) {
+        snprintf (sql, sizeof (sql), "PRAGMA cache_size = %d;", configuration->cacheSize);
+        status = sqlite3_exec (sdb, sql, NULL, NULL, NULL);
+    }
+
+    if (SQLITE_OK == status && 0 != configuration->mmapSize) {
+        snprintf (sql, sizeof (sql), "PRAGMA mmap_size = %" PRIi64 ";", configuration->mmapSize);
+        status = sqlite3_exec (sdb, sql, NULL, NULL, NULL);
+    }
+
+    return status;
+}
+#endif
+
+/// MARK: - Pool
+
+#if !defined(NEUTER_FILE_SERVICE)
+/** Forward Declarations */
+static void
+_fileServicePoolWriterStart (BRFileServicePool pool);
+
+static void
+_fileServicePoolWriterStop (BRFileServicePool pool);
+
+static void
+_fileServicePoolFlush (BRFileServicePool pool);
+
+static sqlite3_status_code
+_fileServiceEndTransaction (BRFileService fs);
+
+static void
+_fileServiceFinalizeStmt (sqlite3_stmt **stmt) {
+    if (NULL != stmt && NULL != *stmt) {
+        sqlite3_finalize (*stmt);
+        *stmt = NULL;
+    }
+}
+#endif
+
+// This is callable with a partially allocated pool.
+static void
+_fileServicePoolClose (BRFileServicePool pool) {
+#if !defined(NEUTER_FILE_SERVICE)
+    _fileServiceFinalizeStmt (&pool->sdbInsertStmt);
+    _fileServiceFinalizeStmt (&pool->sdbSelectStmt);
+    _fileServiceFinalizeStmt (&pool->sdbSelectAllStmt);
+    _fileServiceFinalizeStmt (&pool->sdbUpdateStmt);
+    _fileServiceFinalizeStmt (&pool->sdbDeleteStmt);
+    _fileServiceFinalizeStmt (&pool->sdbDeleteAllTypeStmt);
+    _fileServiceFinalizeStmt (&pool->sdbInsertQuarantineStmt);
+
+    if (NULL != pool->sdb) sqlite3_close (pool->sdb);
+    pool->sdb = NULL;
+#endif
+}
+
+static void
+_fileServicePoolFree (BRFileServicePool pool) {
+#if !defined(NEUTER_FILE_SERVICE)
+    _fileServicePoolWriterStop (pool);
+#endif
+    _fileServicePoolClose (pool);
+
+    if (NULL != pool->sdbPath) free (pool->sdbPath);
+
+    pthread_mutex_destroy (&pool->lock);
+    free (pool);
+}
 
+static BRFileServicePool
+_fileServicePoolCreate (const char *basePath,
+                        char *sdbPath,
+                        const BRFileServiceConfiguration *configuration) {
 #if !defined(NEUTER_FILE_SERVICE)
     // Make directory if needed.
-    if (-1 == directoryMake(basePath)) return NULL;
+    if (-1 == directoryMake(basePath)) { free (sdbPath); return NULL; }
 
     // Require `basePath` to be an existing directory.
     DIR *dir = opendir(basePath);
-    if (NULL == dir) return NULL;
+    if (NULL == dir) { free (sdbPath); return NULL; }
     closedir(dir);
 
     // Require SQLite to support 'MULTI_THREADED' or 'SERIALIZED'.  We'll lock our connection.
     // and thus 'MULTI_THREADED' is appropriate.
-    if (0 == sqlite3_threadsafe()) return NULL;
+    if (0 == sqlite3_threadsafe()) { free (sdbPath); return NULL; }
 #endif
 
-    // Create the file service itself
-    BRFileService fs = calloc (1, sizeof (struct BRFileServiceRecord));
-
-    pthread_mutex_init_brd (&fs->lock, PTHREAD_MUTEX_NORMAL);
+    BRFileServicePool pool = calloc (1, sizeof (struct BRFileServicePoolRecord));
 
-    // Set the error handler - early
-    fileServiceSetErrorHandler (fs, context, handler);
+    pthread_mutex_init_brd (&pool->lock, PTHREAD_MUTEX_NORMAL);
 
-    // Save currency and network
-    fs->currency = strdup (currency);
-    fs->network  = strdup (network);
+    // Decode entities in parallel, on load, if configured.
+    pool->loadWorkersCount = (NULL == configuration ? 0 : configuration->loadWorkersCount);
 
     // Locate the SQLITE Database
-     fs->sdbPath = fileServiceCreateFilePath (basePath, currency, network, FILE_SERVICE_SDB_FILENAME);
+    pool->sdbPath = sdbPath;
+
+    pool->referencesCount = 1;
+    pool->shared          = false;
 
 #if !defined(NEUTER_FILE_SERVICE)
-    fs->sdb = NULL;
-    fs->sdbClosed = false;
+    pool->sdb = NULL;
 
     // Create/Open the SQLITE Database
-    sqlite3_status_code status = sqlite3_open(fs->sdbPath, &fs->sdb);
-    if (SQLITE_OK != status) {
-        fileServiceRelease (fs);
-        return NULL;
-    }
+    sqlite3_status_code status = sqlite3_open(pool->sdbPath, &pool->sdb);
+
+    // Configure the SQLITE Database
+    if (SQLITE_OK == status)
+        status = fileServiceApplyConfiguration (pool->sdb, configuration);
 
     // Create the SQLite 'Entity' Table
-    sqlite3_stmt *sdbCreateTableStmt;
-    status = sqlite3_prepare_v2 (fs->sdb, FILE_SERVICE_SDB_ENTITY_TABLE, -1, &sdbCreateTableStmt, NULL);
-    if (SQLITE_OK != status)
-        return fileServiceCreateReturnError (fs, 1, (BRFileServiceError) {
-            FILE_SERVICE_SDB,
-            { .sdb = { status }}
-        });
-
-    if (SQLITE_DONE != sqlite3_step(sdbCreateTableStmt))
-        return fileServiceCreateReturnError (fs, 1, (BRFileServiceError) {
-            FILE_SERVICE_SDB,
-            { .sdb = { status }}
-        });
-    sqlite3_finalize(sdbCreateTableStmt);
+    if (SQLITE_OK == status)
+        status = sqlite3_exec (pool->sdb, FILE_SERVICE_SDB_ENTITY_TABLE, NULL, NULL, NULL);
+
+    // Move any legacy, hex-encoded entities into the 'EntityBlob' table
+    if (SQLITE_OK == status)
+        status = fileServiceMigrateLegacyEntities (pool->sdb);
+
+    // Create the SQLite 'EntityQuarantine' Table
+    if (SQLITE_OK == status)
+        status = sqlite3_exec (pool->sdb, FILE_SERVICE_SDB_QUARANTINE_TABLE, NULL, NULL, NULL);
 
     // Create the SQLITE 'Insert into Entity' Statement
-    status = sqlite3_prepare_v2 (fs->sdb, FILE_SERVICE_SDB_INSERT_ENTITY, -1, &fs->sdbInsertStmt, NULL);
-    if (SQLITE_OK != status)
-        return fileServiceCreateReturnError (fs, 1, (BRFileServiceError) {
-            FILE_SERVICE_SDB,
-            { .sdb = { status }}
-        });
+    if (SQLITE_OK == status)
+        status = sqlite3_prepare_v2 (pool->sdb, FILE_SERVICE_SDB_INSERT_ENTITY, -1, &pool->sdbInsertStmt, NULL);
 
     // Create the SQLITE "Select Entity By Hash' Statement
-    status = sqlite3_prepare_v2 (fs->sdb, FILE_SERVICE_SDB_QUERY_ENTITY, -1, &fs->sdbSelectStmt, NULL);
-    if (SQLITE_OK != status)
-        return fileServiceCreateReturnError (fs, 1, (BRFileServiceError) {
-            FILE_SERVICE_SDB,
-            { .sdb = { status }}
-        });
+    if (SQLITE_OK == status)
+        status = sqlite3_prepare_v2 (pool->sdb, FILE_SERVICE_SDB_QUERY_ENTITY, -1, &pool->sdbSelectStmt, NULL);
 
     // Create the SQLITE "Select Entity ' Statement
-    status = sqlite3_prepare_v2 (fs->sdb, FILE_SERVICE_SDB_QUERY_ALL_ENTITY, -1, &fs->sdbSelectAllStmt, NULL);
-    if (SQLITE_OK != status)
-        return fileServiceCreateReturnError (fs, 1, (BRFileServiceError) {
-            FILE_SERVICE_SDB,
-            { .sdb = { status }}
-        });
+    if (SQLITE_OK == status)
+        status = sqlite3_prepare_v2 (pool->sdb, FILE_SERVICE_SDB_QUERY_ALL_ENTITY, -1, &pool->sdbSelectAllStmt, NULL);
 
-    status = sqlite3_prepare_v2 (fs->sdb, FILE_SERVICE_SDB_UPDATE_ENTITY, -1, &fs->sdbUpdateStmt, NULL);
-    if (SQLITE_OK != status)
-        return fileServiceCreateReturnError (fs, 1, (BRFileServiceError) {
-            FILE_SERVICE_SDB,
-            { .sdb = { status }}
-        });
+    if (SQLITE_OK == status)
+        status = sqlite3_prepare_v2 (pool->sdb, FILE_SERVICE_SDB_UPDATE_ENTITY, -1, &pool->sdbUpdateStmt, NULL);
 
-    status = sqlite3_prepare_v2 (fs->sdb, FILE_SERVICE_SDB_DELETE_ENTITY, -1, &fs->sdbDeleteStmt, NULL);
-    if (SQLITE_OK != status)
-        return fileServiceCreateReturnError (fs, 1, (BRFileServiceError) {
-            FILE_SERVICE_SDB,
-            { .sdb = { status }}
-        });
+    if (SQLITE_OK == status)
+        status = sqlite3_prepare_v2 (pool->sdb, FILE_SERVICE_SDB_DELETE_ENTITY, -1, &pool->sdbDeleteStmt, NULL);
 
-    status = sqlite3_prepare_v2 (fs->sdb, FILE_SERVICE_SDB_DELETE_ALL_TYPE_ENTITY, -1, &fs->sdbDeleteAllTypeStmt, NULL);
-    if (SQLITE_OK != status)
-        return fileServiceCreateReturnError (fs, 1, (BRFileServiceError) {
-            FILE_SERVICE_SDB,
-            { .sdb = { status }}
-        });
+    if (SQLITE_OK == status)
+        status = sqlite3_prepare_v2 (pool->sdb, FILE_SERVICE_SDB_DELETE_ALL_TYPE_ENTITY, -1, &pool->sdbDeleteAllTypeStmt, NULL);
+
+    if (SQLITE_OK == status)
+        status = sqlite3_prepare_v2 (pool->sdb, FILE_SERVICE_SDB_INSERT_QUARANTINE, -1, &pool->sdbInsertQuarantineStmt, NULL);
+
+    if (SQLITE_OK != status) {
+        _fileServicePoolFree (pool);
+        return NULL;
+    }
 
 #  if defined(DEBUG)
     if (needSQLiteCompileOptions) {
@@ -352,59 +607,194 @@ fileServiceCreate (const char *basePath,
         }
     }
 #  endif
+
+    // Queue writes for a dedicated thread, if configured.
+    if (NULL != configuration && configuration->writeBehind)
+        _fileServicePoolWriterStart (pool);
 #endif // !define(NEUTER_FILE_SERVICE)
 
+    return pool;
+}
+
+// The shared pools, by `sdbPath`.  A pool is removed once its last reference is released.
+static pthread_once_t  fileServicePoolsOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t fileServicePoolsLock;
+static BRArrayOf(BRFileServicePool) fileServicePools = NULL;
+
+static void
+_fileServicePoolsInitOnce (void) {
+    array_new (fileServicePools, 1);
+    pthread_mutex_init_brd (&fileServicePoolsLock, PTHREAD_MUTEX_NORMAL);
+}
+
+extern BRFileServicePool
+fileServicePoolCreate (const char *basePath,
+                       const BRFileServiceConfiguration *configuration) {
+    if (NULL == basePath || 0 == strlen(basePath)) return NULL;
+
+    pthread_once (&fileServicePoolsOnce, _fileServicePoolsInitOnce);
+
+    char *sdbPath = malloc (strlen (basePath) + 1 + strlen (FILE_SERVICE_SDB_POOL_FILENAME) + 1);
+    sprintf (sdbPath, "%s/%s", basePath, FILE_SERVICE_SDB_POOL_FILENAME);
+
+    pthread_mutex_lock (&fileServicePoolsLock);
+
+    // Share an existing pool; the `configuration` of the first creator applies.
+    for (size_t index = 0; index < array_count (fileServicePools); index++) {
+        BRFileServicePool pool = fileServicePools[index];
+        if (0 == strcmp (sdbPath, pool->sdbPath)) {
+            pthread_mutex_lock (&pool->lock);
+            pool->referencesCount += 1;
+            pthread_mutex_unlock (&pool->lock);
+
+            pthread_mutex_unlock (&fileServicePoolsLock);
+            free (sdbPath);
+            return pool;
+        }
+    }
+
+    BRFileServicePool pool = _fileServicePoolCreate (basePath, sdbPath, configuration);
+    if (NULL != pool) {
+        pool->shared = true;
+        array_add (fileServicePools, pool);
+    }
+
+    pthread_mutex_unlock (&fileServicePoolsLock);
+    return pool;
+}
+
+extern void
+fileServicePoolRelease (BRFileServicePool pool) {
+    // A shared pool is found by others through `fileServicePools`; hold that lock so that a
+    // pool is not shared while being freed.
+    if (pool->shared) pthread_mutex_lock (&fileServicePoolsLock);
+
+    pthread_mutex_lock (&pool->lock);
+    size_t referencesCount = --pool->referencesCount;
+    pthread_mutex_unlock (&pool->lock);
+
+    if (0 == referencesCount && pool->shared)
+        for (size_t index = 0; index < array_count (fileServicePools); index++)
+            if (pool == fileServicePools[index]) {
+                array_rm (fileServicePools, index);
+                break;
+            }
+
+    if (pool->shared) pthread_mutex_unlock (&fileServicePoolsLock);
+
+    if (0 == referencesCount)
+        _fileServicePoolFree (pool);
+}
+
+/// MARK: - Create
+
+static BRFileService
+_fileServiceCreateInPool (BRFileServicePool pool,
+                          const char *partition,
+                          const char *currency,
+                          const char *network,
+                          BRFileServiceContext context,
+                          BRFileServiceErrorHandler handler) {
+    // Create the file service itself
+    BRFileService fs = calloc (1, sizeof (struct BRFileServiceRecord));
+
+    // Set the error handler - early
+    fileServiceSetErrorHandler (fs, context, handler);
+
+    // Save currency and network
+    fs->currency = strdup (currency);
+    fs->network  = strdup (network);
+
+    fs->partition = (NULL == partition
+                     ? strdup ("")
+                     : fileServiceCreatePartition (partition, currency, network));
+
+    fs->pool      = pool;
+    fs->sdbClosed = false;
+    fs->sdbTransactionDepth = 0;
+
     // Allocate the `entityTypes` array
     array_new (fs->entityTypes, FILE_SERVICE_INITIAL_TYPE_COUNT);
 
     return fs;
 }
 
-static void
-_fileServiceFinalizeStmt (BRFileService fs, sqlite3_stmt **stmt) {
-    if (NULL != stmt && NULL != *stmt) {
-        sqlite3_finalize (*stmt);
-        *stmt = NULL;
-    }
+static BRFileService
+_fileServiceCreate (const char *basePath,
+                    const char *currency,
+                    const char *network,
+                    BRFileServiceContext context,
+                    BRFileServiceErrorHandler handler,
+                    const BRFileServiceConfiguration *configuration) {
+    if (NULL == basePath || 0 == strlen(basePath)) return NULL;
+    if (NULL == currency || 0 == strlen(currency)) return NULL;
+    if (NULL == network  || 0 == strlen(network))  return NULL;
+
+    // Reasonable limits on `network` and `currency` (ensure subsequent stack allocation works).
+    if (strlen(network) > FILENAME_MAX || strlen(currency) > FILENAME_MAX)
+        return NULL;
+
+    // A private pool
+    BRFileServicePool pool = _fileServicePoolCreate (basePath,
+                                                     fileServiceCreateFilePath (basePath, currency, network, FILE_SERVICE_SDB_FILENAME),
+                                                     configuration);
+    if (NULL == pool) return NULL;
+
+    return _fileServiceCreateInPool (pool, NULL, currency, network, context, handler);
 }
 
-static void
-_fileServiceCloseInternal (BRFileService fs) {
-#if !defined(NEUTER_FILE_SERVICE)
-    if (fs->sdbClosed) return;
+extern BRFileService
+fileServiceCreate (const char *basePath,
+                   const char *currency,
+                   const char *network,
+                   BRFileServiceContext context,
+                   BRFileServiceErrorHandler handler) {
+    return _fileServiceCreate (basePath, currency, network, context, handler, NULL);
+}
 
-    fs->sdbClosed = true;
-    _fileServiceFinalizeStmt (fs, &fs->sdbInsertStmt);
-    _fileServiceFinalizeStmt (fs, &fs->sdbSelectStmt);
-    _fileServiceFinalizeStmt (fs, &fs->sdbSelectAllStmt);
-    _fileServiceFinalizeStmt (fs, &fs->sdbUpdateStmt);
-    _fileServiceFinalizeStmt (fs, &fs->sdbDeleteStmt);
-    _fileServiceFinalizeStmt (fs, &fs->sdbDeleteAllTypeStmt);
-    _fileServiceFinalizeStmt (fs, &fs->sdbDeleteAllStmt);
-
-    if (NULL != fs->sdb) sqlite3_close (fs->sdb);
-    fs->sdb = NULL;
-#endif
+extern BRFileService
+fileServiceCreateInPool (BRFileServicePool pool,
+                         const char *partition,
+                         const char *currency,
+                         const char *network,
+                         BRFileServiceContext context,
+                         BRFileServiceErrorHandler handler) {
+    if (NULL == pool) return NULL;
+    if (NULL == partition || 0 == strlen(partition)) return NULL;
+    if (NULL == currency  || 0 == strlen(currency))  return NULL;
+    if (NULL == network   || 0 == strlen(network))   return NULL;
+
+    pthread_mutex_lock (&pool->lock);
+    pool->referencesCount += 1;
+    pthread_mutex_unlock (&pool->lock);
+
+    return _fileServiceCreateInPool (pool, partition, currency, network, context, handler);
 }
 
 extern void
 fileServiceClose (BRFileService fs) {
 #if !defined(NEUTER_FILE_SERVICE)
-    pthread_mutex_lock (&fs->lock);
-    _fileServiceCloseInternal(fs);
-    pthread_mutex_unlock (&fs->lock);
+    _fileServicePoolFlush (fs->pool);
+
+    pthread_mutex_lock (&fs->pool->lock);
+
+    // Commit any DB transaction begun, but not committed, by `fs`.
+    if (!fs->sdbClosed && 0 != fs->sdbTransactionDepth) {
+        fs->sdbTransactionDepth = 0;
+        _fileServiceEndTransaction (fs);
+    }
+
+    fs->sdbClosed = true;
+
+    // A shared pool, and its DB, remains open until released.
+    if (!fs->pool->shared) _fileServicePoolClose (fs->pool);
+    pthread_mutex_unlock (&fs->pool->lock);
 #endif
 }
 
-// This is callable with a partially allocated BRFileService.  So, be
-// careful with fields that might not yet exist.
 extern void
 fileServiceRelease (BRFileService fs) {
-    pthread_mutex_lock (&fs->lock);
-
-#if !defined(NEUTER_FILE_SERVICE)
-    _fileServiceCloseInternal(fs);
-#endif
+    fileServiceClose (fs);
 
     if (NULL != fs->entityTypes) {
         size_t typesCount = array_count(fs->entityTypes);
@@ -413,12 +803,11 @@ fileServiceRelease (BRFileService fs) {
         array_free(fs->entityTypes);
     }
 
-    if (NULL != fs->network)  free (fs->network);
-    if (NULL != fs->currency) free (fs->currency);
-    if (NULL != fs->sdbPath)  free (fs->sdbPath);
+    if (NULL != fs->network)   free (fs->network);
+    if (NULL != fs->currency)  free (fs->currency);
+    if (NULL != fs->partition) free (fs->partition);
 
-    pthread_mutex_unlock (&fs->lock);
-    pthread_mutex_destroy(&fs->lock);
+    fileServicePoolRelease (fs->pool);
 
     free (fs);
 }
@@ -448,6 +837,7 @@ fileServiceAddType (const BRFileService fs,
     BRFileServiceEntityType entityType = {
         strdup (type),
         version,
+        NULL,
         NULL
     };
     array_new (entityType.handlers, FILE_SERVICE_INITIAL_HANDLER_COUNT);
@@ -474,7 +864,7 @@ fileServiceFailedInternal (BRFileService fs,
                            BRFileServiceError error) {
     if (NULL != bufferToFree) free (bufferToFree);
     if (NULL != fileToClose)  fclose (fileToClose);
-    if (releaseLock) pthread_mutex_unlock (&fs->lock);
+    if (releaseLock) pthread_mutex_unlock (&fs->pool->lock);
 
     // Handler invoked w/o the lock.  Avoid a possible recursive use of FS.
     if (NULL != fs->handler)
@@ -550,22 +940,18 @@ fileServiceFailedEntity(BRFileService fs,
 
 /// MARK: - Save
 
-static int
-_fileServiceSave (BRFileService fs,
-                  const char *type,  /* block, peers, transactions, logs, ... */
-                  const void *entity,
-                  int needLock) {     /* BRMerkleBlock*, BRTransaction, BREthereumTransaction, ... */
-
-    BRFileServiceEntityType *entityType = fileServiceLookupType (fs, type);
-    if (NULL == entityType) { fileServiceFailedImpl (fs, 0, NULL, NULL, "missed type"); return 0; };
-
-    BRFileServiceEntityHandler *handler = fileServiceEntityTypeLookupHandler(entityType, entityType->currentVersion);
-    if (NULL == handler) { fileServiceFailedImpl (fs, 0, NULL, NULL, "missed type handler"); return 0; };
-
 #if !defined(NEUTER_FILE_SERVICE)
-    // Get then hex-encode the identifer
-    UInt256 identifier = handler->identifier (handler->context, fs, entity);
-    const char *hash = u256hex(identifier);
+// Serialize `entity` with the header for the currentHeaderFormatVersion.  Returns newly allocated
+// bytes; fills in `identifier` and `bytesCount`.
+static uint8_t *
+_fileServiceEncode (BRFileService fs,
+                    BRFileServiceEntityType *entityType,
+                    BRFileServiceEntityHandler *handler,
+                    const void *entity,
+                    UInt256 *identifier,
+                    size_t *bytesCount) {
+    // Get the identifer; saved as raw bytes
+    *identifier = handler->identifier (handler->context, fs, entity);
 
     // Get the entity bytes
     uint32_t entityBytesCount;
@@ -574,10 +960,10 @@ _fileServiceSave (BRFileService fs,
     // Always, always write the header for the currentHeaderFormatVersion
 
     // Extend the entity bytes with the current header format, which is:
-    //   {HeaderFormatVersion, Current(Type)Version, EntityBytesCount, EntityBytes}
+    //   {HeaderFormatVersion, Current(Type)Version, EntityBytesCount, Checksum, EntityBytes}
     size_t  offset = 0;
-    size_t  bytesCount = 1 + 1 + sizeof(uint32_t) + entityBytesCount;
-    uint8_t *bytes = malloc (bytesCount);
+    *bytesCount = 1 + 1 + sizeof(uint32_t) + sizeof(uint32_t) + entityBytesCount;
+    uint8_t *bytes = malloc (*bytesCount);
 
     bytes[offset] = (uint8_t) currentHeaderFormatVersion;
     offset += 1;
@@ -588,61 +974,352 @@ _fileServiceSave (BRFileService fs,
     UInt32SetBE (&bytes[offset], entityBytesCount);
     offset += sizeof (uint32_t);
 
+    UInt32SetBE (&bytes[offset], fileServiceChecksum (entityBytes, entityBytesCount));
+    offset += sizeof (uint32_t);
+
     memcpy (&bytes[offset], entityBytes, entityBytesCount);
     free (entityBytes);
 
-    // Nex encode bytes
-    size_t dataCount = 2 * bytesCount + 1;
-    char *data = malloc (dataCount);
-    hexEncode (data, dataCount, bytes, bytesCount);
-    free (bytes);
+    return bytes;
+}
 
-    // Fill out the SQL statement
+// Called while locked.  Insert (or replace) the encoded `bytes` as `type` in `partition`.
+static sqlite3_status_code
+_fileServiceInsertBytes (BRFileServicePool pool,
+                         const char *partition,
+                         const char *type,
+                         UInt256 identifier,
+                         const uint8_t *bytes,
+                         size_t bytesCount) {
     sqlite3_status_code status;
 
+    sqlite3_reset (pool->sdbInsertStmt);
+    sqlite3_clear_bindings (pool->sdbInsertStmt);
+
+    status = sqlite3_bind_text (pool->sdbInsertStmt, 1, partition, -1, SQLITE_STATIC);
+    if (SQLITE_OK == status)
+        status = sqlite3_bind_text (pool->sdbInsertStmt, 2, type, -1, SQLITE_STATIC);
+    if (SQLITE_OK == status)
+        status = sqlite3_bind_blob (pool->sdbInsertStmt, 3, identifier.u8, sizeof (UInt256), SQLITE_STATIC);
+    if (SQLITE_OK == status)
+        status = sqlite3_bind_blob (pool->sdbInsertStmt, 4, bytes, (int) bytesCount, SQLITE_STATIC);
+    if (SQLITE_OK == status)
+        status = sqlite3_step (pool->sdbInsertStmt);
+
+    // Ensure the 'implicit DB transaction' is committed.
+    sqlite3_reset (pool->sdbInsertStmt);
+
+    return (SQLITE_DONE == status ? SQLITE_OK : status);
+}
+
+// Called while locked.  Delete the entity `identifier` of `type` in `partition`.
+static sqlite3_status_code
+_fileServiceDeleteIdentifier (BRFileServicePool pool,
+                              const char *partition,
+                              const char *type,
+                              UInt256 identifier) {
+    sqlite3_status_code status;
+
+    sqlite3_reset (pool->sdbDeleteStmt);
+    sqlite3_clear_bindings (pool->sdbDeleteStmt);
+
+    status = sqlite3_bind_text (pool->sdbDeleteStmt, 1, partition, -1, SQLITE_STATIC);
+    if (SQLITE_OK == status)
+        status = sqlite3_bind_text (pool->sdbDeleteStmt, 2, type, -1, SQLITE_STATIC);
+    if (SQLITE_OK == status)
+        status = sqlite3_bind_blob (pool->sdbDeleteStmt, 3, identifier.u8, sizeof (UInt256), SQLITE_STATIC);
+    if (SQLITE_OK == status)
+        status = sqlite3_step (pool->sdbDeleteStmt);
+
+    // Ensure the 'implicit DB transaction' is committed.
+    sqlite3_reset (pool->sdbDeleteStmt);
+
+    return (SQLITE_DONE == status ? SQLITE_OK : status);
+}
+
+// Insert (or replace) the encoded `bytes`, which are freed, as `type`.
+static int
+_fileServiceSaveBytes (BRFileService fs,
+                       const char *type,
+                       UInt256 identifier,
+                       uint8_t *bytes,
+                       size_t bytesCount,
+                       int needLock) {
     if (needLock)
-        pthread_mutex_lock (&fs->lock);
+        pthread_mutex_lock (&fs->pool->lock);
 
     if (fs->sdbClosed)
-        return fileServiceFailedImpl (fs, needLock, NULL, NULL, "closed");
+        return fileServiceFailedImpl (fs, needLock, bytes, NULL, "closed");
 
-    sqlite3_reset (fs->sdbInsertStmt);
-    sqlite3_clear_bindings(fs->sdbInsertStmt);
+    sqlite3_status_code status = _fileServiceInsertBytes (fs->pool, fs->partition, type, identifier, bytes, bytesCount);
+    if (SQLITE_OK != status)
+        return fileServiceFailedSDBWithBufferFree (fs, needLock, bytes, status);
 
-    status = sqlite3_bind_text (fs->sdbInsertStmt, 1, type, -1, SQLITE_STATIC);
-    if (SQLITE_OK != status) {
-        free (data);
-        return fileServiceFailedSDB (fs, needLock, status);
+    if (needLock)
+        pthread_mutex_unlock (&fs->pool->lock);
+
+    free (bytes);
+
+    return 1;
+}
+
+/// MARK: - Write-Behind
+
+///
+/// A queued save of `bytes` or, if `bytes` is NULL, a queued remove.  A pool's queued writes are
+/// coalesced by {partition, type, identifier}; the latest replaces any earlier one.  The
+/// `partition` and `type` are owned by `fs`, which flushes before it is released.
+///
+typedef struct {
+    BRFileService fs;
+    const char *partition;
+    const char *type;
+    UInt256 identifier;
+    uint8_t *bytes;
+    size_t bytesCount;
+    bool closed;
+    sqlite3_status_code status;
+} BRFileServiceWrite;
+
+static size_t
+_fileServiceWriteHash (const void *write) {
+    return (size_t) ((const BRFileServiceWrite *) write)->identifier.u64[0];
+}
+
+static int
+_fileServiceWriteEq (const void *write1, const void *write2) {
+    const BRFileServiceWrite *w1 = write1, *w2 = write2;
+    return (UInt256Eq (w1->identifier, w2->identifier) &&
+            0 == strcmp (w1->type,      w2->type)      &&
+            0 == strcmp (w1->partition, w2->partition));
+}
+
+static BRFileServiceWrite *
+_fileServiceWriteCreate (BRFileService fs,
+                         const char *type,
+                         UInt256 identifier,
+                         uint8_t *bytes,
+                         size_t bytesCount) {
+    BRFileServiceWrite *write = calloc (1, sizeof (BRFileServiceWrite));
+
+    write->fs         = fs;
+    write->partition  = fs->partition;
+    write->type       = type;
+    write->identifier = identifier;
+    write->bytes      = bytes;
+    write->bytesCount = bytesCount;
+
+    return write;
+}
+
+static void
+_fileServiceWriteRelease (BRFileServiceWrite *write) {
+    if (NULL != write->bytes) free (write->bytes);
+    free (write);
+}
+
+// Queue `writesCount` writes; all are written in the same DB transaction.
+static void
+_fileServicePoolQueueWrites (BRFileServicePool pool,
+                             BRFileServiceWrite **writes,
+                             size_t writesCount) {
+    pthread_mutex_lock (&pool->writesLock);
+    for (size_t index = 0; index < writesCount; index++) {
+        BRFileServiceWrite *replaced = BRSetAdd (pool->writes, writes[index]);
+        if (NULL != replaced) _fileServiceWriteRelease (replaced);
     }
+    pthread_cond_signal (&pool->writesCond);
+    pthread_mutex_unlock (&pool->writesLock);
+}
 
-    status = sqlite3_bind_text (fs->sdbInsertStmt, 2, hash, -1, SQLITE_STATIC);
-    if (SQLITE_OK != status) {
-        free (data);
-        return fileServiceFailedSDB (fs, needLock, status);
+// Write `writes` in one DB transaction, or as part of one in progress; then report any failures
+// and release `writes`.
+static void
+_fileServicePoolWrite (BRFileServicePool pool,
+                       BRArrayOf(BRFileServiceWrite*) writes) {
+    size_t writesCount = array_count (writes);
+    sqlite3_status_code status = SQLITE_OK;
+    int began = 0;
+
+    pthread_mutex_lock (&pool->lock);
+
+    if (NULL != pool->sdb) {
+        began = sqlite3_get_autocommit (pool->sdb);
+        if (began) status = sqlite3_exec (pool->sdb, "BEGIN IMMEDIATE", NULL, NULL, NULL);
     }
 
-    status = sqlite3_bind_text (fs->sdbInsertStmt, 3, data, -1, SQLITE_STATIC);
-    if (SQLITE_OK != status) {
-        free (data);
-        return fileServiceFailedSDB (fs, needLock, status);
+    for (size_t index = 0; index < writesCount; index++) {
+        BRFileServiceWrite *write = writes[index];
+
+        if      (write->fs->sdbClosed) write->closed = true;
+        else if (SQLITE_OK != status)  write->status = status;
+        else {
+            write->status = (NULL != write->bytes
+                             ? _fileServiceInsertBytes (pool, write->partition, write->type, write->identifier, write->bytes, write->bytesCount)
+                             : _fileServiceDeleteIdentifier (pool, write->partition, write->type, write->identifier));
+        }
     }
 
-    status = sqlite3_step (fs->sdbInsertStmt);
-    if (SQLITE_DONE != status) {
-        free (data);
-        return fileServiceFailedSDB (fs, needLock, status);
+    if (began && SQLITE_OK == status) {
+        status = sqlite3_exec (pool->sdb, "COMMIT", NULL, NULL, NULL);
+        if (SQLITE_OK != status) {
+            sqlite3_exec (pool->sdb, "ROLLBACK", NULL, NULL, NULL);
+            for (size_t index = 0; index < writesCount; index++)
+                if (!writes[index]->closed) writes[index]->status = status;
+        }
     }
 
-    // Ensure the 'implicit DB transaction' is committed.
-    sqlite3_reset (fs->sdbInsertStmt);
+    pthread_mutex_unlock (&pool->lock);
 
-    if (needLock)
-        pthread_mutex_unlock (&fs->lock);
+    // Report failures w/o the lock; at most one for each file service.
+    BRArrayOf(BRFileService) reported;
+    array_new (reported, 1);
+
+    for (size_t index = 0; index < writesCount; index++) {
+        BRFileServiceWrite *write = writes[index];
+
+        if (write->closed || SQLITE_OK != write->status) {
+            size_t reportedIndex = 0;
+            while (reportedIndex < array_count (reported) && write->fs != reported[reportedIndex])
+                reportedIndex++;
+
+            if (reportedIndex == array_count (reported)) {
+                array_add (reported, write->fs);
+                if (write->closed) fileServiceFailedImpl (write->fs, 0, NULL, NULL, "closed");
+                else               fileServiceFailedSDB  (write->fs, 0, write->status);
+            }
+        }
+
+        _fileServiceWriteRelease (write);
+    }
+
+    array_free (reported);
+}
+
+static void *
+_fileServicePoolWriter (BRFileServicePool pool) {
+    pthread_setname_brd (pthread_self(), "Core File Service Writer");
+
+    BRArrayOf(BRFileServiceWrite*) writes;
+    array_new (writes, 100);
+
+    pthread_mutex_lock (&pool->writesLock);
+    while (1) {
+        while (0 == BRSetCount (pool->writes) && !pool->writerQuit)
+            pthread_cond_wait (&pool->writesCond, &pool->writesLock);
+
+        // On quit, only once all queued writes are written
+        if (0 == BRSetCount (pool->writes)) break;
+
+        // Take all the queued writes
+        array_set_count (writes, BRSetCount (pool->writes));
+        BRSetAll (pool->writes, (void **) writes, array_count (writes));
+        BRSetClear (pool->writes);
+        pool->writing = true;
+        pthread_mutex_unlock (&pool->writesLock);
+
+        _fileServicePoolWrite (pool, writes);
+
+        pthread_mutex_lock (&pool->writesLock);
+        pool->writing = false;
+        pthread_cond_broadcast (&pool->flushedCond);
+    }
+    pthread_mutex_unlock (&pool->writesLock);
+
+    array_free (writes);
+    return NULL;
+}
+
+#define FILE_SERVICE_WRITER_STACK_SIZE     (512 * 1024)
+
+static void
+_fileServicePoolWriterStart (BRFileServicePool pool) {
+    pthread_mutex_init_brd (&pool->writesLock, PTHREAD_MUTEX_NORMAL);
+    pthread_cond_init (&pool->writesCond,  NULL);
+    pthread_cond_init (&pool->flushedCond, NULL);
+
+    pool->writes     = BRSetNew (_fileServiceWriteHash, _fileServiceWriteEq, 100);
+    pool->writing    = false;
+    pool->writerQuit = false;
+
+    pthread_attr_t attr;
+    pthread_attr_init (&attr);
+    pthread_attr_setdetachstate (&attr, PTHREAD_CREATE_JOINABLE);
+    pthread_attr_setstacksize (&attr, FILE_SERVICE_WRITER_STACK_SIZE);
+
+    pool->writeBehind = (0 == pthread_create (&pool->writer, &attr, (ThreadRoutine) _fileServicePoolWriter, pool));
+    pthread_attr_destroy (&attr);
+
+    // If we can't create the writer, writes remain synchronous.
+    if (!pool->writeBehind) {
+        BRSetFree (pool->writes);
+        pool->writes = NULL;
+        pthread_cond_destroy (&pool->flushedCond);
+        pthread_cond_destroy (&pool->writesCond);
+        pthread_mutex_destroy (&pool->writesLock);
+    }
+}
+
+// The writer completes all queued writes before it quits.
+static void
+_fileServicePoolWriterStop (BRFileServicePool pool) {
+    if (!pool->writeBehind) return;
+
+    pthread_mutex_lock (&pool->writesLock);
+    pool->writerQuit = true;
+    pthread_cond_signal (&pool->writesCond);
+    pthread_mutex_unlock (&pool->writesLock);
+
+    pthread_join (pool->writer, NULL);
+    pool->writeBehind = false;
+
+    BRSetFree (pool->writes);
+    pool->writes = NULL;
+    pthread_cond_destroy (&pool->flushedCond);
+    pthread_cond_destroy (&pool->writesCond);
+    pthread_mutex_destroy (&pool->writesLock);
+}
+
+// Called w/o the pool's lock.  On the writer itself, as from an error handler, this is a no-op.
+static void
+_fileServicePoolFlush (BRFileServicePool pool) {
+    if (!pool->writeBehind || pthread_equal (pthread_self(), pool->writer)) return;
 
-    free (data);
+    pthread_mutex_lock (&pool->writesLock);
+    while (0 != BRSetCount (pool->writes) || pool->writing)
+        pthread_cond_wait (&pool->flushedCond, &pool->writesLock);
+    pthread_mutex_unlock (&pool->writesLock);
+}
 #endif // !defined(NEUTER_FILE_SERVICE)
 
+static int
+_fileServiceSave (BRFileService fs,
+                  const char *type,  /* block, peers, transactions, logs, ... */
+                  const void *entity,
+                  int needLock) {     /* BRMerkleBlock*, BRTransaction, BREthereumTransaction, ... */
+
+    BRFileServiceEntityType *entityType = fileServiceLookupType (fs, type);
+    if (NULL == entityType) { fileServiceFailedImpl (fs, 0, NULL, NULL, "missed type"); return 0; };
+
+    BRFileServiceEntityHandler *handler = fileServiceEntityTypeLookupHandler(entityType, entityType->currentVersion);
+    if (NULL == handler) { fileServiceFailedImpl (fs, 0, NULL, NULL, "missed type handler"); return 0; };
+
+#if !defined(NEUTER_FILE_SERVICE)
+    UInt256 identifier;
+    size_t  bytesCount;
+    uint8_t *bytes = _fileServiceEncode (fs, entityType, handler, entity, &identifier, &bytesCount);
+
+    // If not already locked, as in `fileServiceReplace()`, a write-behind save is queued.
+    if (needLock && fs->pool->writeBehind) {
+        BRFileServiceWrite *write = _fileServiceWriteCreate (fs, entityType->type, identifier, bytes, bytesCount);
+        _fileServicePoolQueueWrites (fs->pool, &write, 1);
+        return 1;
+    }
+
+    return _fileServiceSaveBytes (fs, entityType->type, identifier, bytes, bytesCount, needLock);
+#else
     return 1;
+#endif // !defined(NEUTER_FILE_SERVICE)
 }
 
 extern int
@@ -652,134 +1329,773 @@ fileServiceSave (BRFileService fs,
     return _fileServiceSave (fs, type, entity, 1);
 }
 
-/// MARK: - Load
+extern void
+fileServiceFlush (BRFileService fs) {
+#if !defined(NEUTER_FILE_SERVICE)
+    _fileServicePoolFlush (fs->pool);
+#endif
+}
+
+#if !defined(NEUTER_FILE_SERVICE)
+// Called while locked.  Begin a DB transaction or, if one is already in progress, such as from
+// `fileServiceBeginTransaction()`, a savepoint within it; `began` records which.  Either way,
+// the writes until `_fileServiceEndScope()` are all kept or all rolled back.
+static sqlite3_status_code
+_fileServiceBeginScope (BRFileService fs, int *began) {
+    *began = sqlite3_get_autocommit (fs->pool->sdb);
+    return sqlite3_exec (fs->pool->sdb,
+                         (*began ? "BEGIN IMMEDIATE" : "SAVEPOINT FileServiceScope"),
+                         NULL, NULL, NULL);
+}
+
+// Called while locked.  Commit the scope from `_fileServiceBeginScope()` if `status` is
+// SQLITE_OK, otherwise roll it back - but never an enclosing DB transaction.
+static sqlite3_status_code
+_fileServiceEndScope (BRFileService fs, int began, sqlite3_status_code status) {
+    if (SQLITE_OK == status) {
+        status = sqlite3_exec (fs->pool->sdb,
+                               (began ? "COMMIT" : "RELEASE FileServiceScope"),
+                               NULL, NULL, NULL);
+        if (SQLITE_OK == status) return status;
+    }
+
+    if (began)
+        sqlite3_exec (fs->pool->sdb, "ROLLBACK", NULL, NULL, NULL);
+    else {
+        sqlite3_exec (fs->pool->sdb, "ROLLBACK TO FileServiceScope", NULL, NULL, NULL);
+        sqlite3_exec (fs->pool->sdb, "RELEASE FileServiceScope", NULL, NULL, NULL);
+    }
+
+    return status;
+}
+#endif
 
 extern int
-fileServiceLoad (BRFileService fs,
-                 BRSet *results,
-                 const char *type,
-                 int updateVersion) {
+fileServiceSaveMany (BRFileService fs,
+                     const char *type,
+                     const void **entities,
+                     size_t entitiesCount) {
     BRFileServiceEntityType *entityType = fileServiceLookupType (fs, type);
-    if (NULL == entityType) return fileServiceFailedImpl (fs, 0, NULL, NULL, "missed type");
+    if (NULL == entityType)
+        return fileServiceFailedImpl (fs, 0, NULL, NULL, "missed type");
 
-    BRFileServiceEntityHandler *entityHandlerCurrent = fileServiceEntityTypeLookupHandler(entityType, entityType->currentVersion);
-    if (NULL == entityHandlerCurrent) return fileServiceFailedImpl (fs,  0, NULL, NULL, "missed type handler");
+    if (0 == entitiesCount) return 1;
 
 #if !defined(NEUTER_FILE_SERVICE)
     sqlite3_status_code status;
+    int began;
+
+    // Queue all at once, thus written in the same DB transaction.
+    if (fs->pool->writeBehind) {
+        BRFileServiceEntityHandler *handler = fileServiceEntityTypeLookupHandler (entityType, entityType->currentVersion);
+        if (NULL == handler)
+            return fileServiceFailedImpl (fs, 0, NULL, NULL, "missed type handler");
+
+        BRFileServiceWrite **writes = calloc (entitiesCount, sizeof (BRFileServiceWrite*));
+        for (size_t index = 0; index < entitiesCount; index++) {
+            UInt256 identifier;
+            size_t  bytesCount;
+            uint8_t *bytes = _fileServiceEncode (fs, entityType, handler, entities[index], &identifier, &bytesCount);
+
+            writes[index] = _fileServiceWriteCreate (fs, entityType->type, identifier, bytes, bytesCount);
+        }
 
-    pthread_mutex_lock (&fs->lock);
+        _fileServicePoolQueueWrites (fs->pool, writes, entitiesCount);
+        free (writes);
+        return 1;
+    }
+
+    pthread_mutex_lock (&fs->pool->lock);
     if (fs->sdbClosed)
         return fileServiceFailedImpl (fs, 1, NULL, NULL, "closed");
 
-    sqlite3_reset (fs->sdbSelectAllStmt);
-    sqlite3_clear_bindings (fs->sdbSelectAllStmt);
+    status = _fileServiceBeginScope (fs, &began);
+    if (SQLITE_OK != status)
+        return fileServiceFailedSDB (fs, 1, status);
 
-    status = sqlite3_bind_text (fs->sdbSelectAllStmt, 1, type, -1, SQLITE_STATIC);
+    // On a failure, roll back the entities saved so far; an enclosing DB transaction remains.
+    for (size_t index = 0; index < entitiesCount; index++)
+        if (0 == _fileServiceSave (fs, type, entities[index], 0)) {
+            _fileServiceEndScope (fs, began, SQLITE_ABORT);
+            pthread_mutex_unlock (&fs->pool->lock);
+            return 0;
+        }
+
+    status = _fileServiceEndScope (fs, began, SQLITE_OK);
     if (SQLITE_OK != status)
         return fileServiceFailedSDB (fs, 1, status);
 
-    uint8_t  dataBytesBuffer[8196];
-    uint8_t *dataBytes = dataBytesBuffer;
-    size_t   dataBytesCount = 8196;
+    pthread_mutex_unlock (&fs->pool->lock);
+#endif // !defined(NEUTER_FILE_SERVICE)
 
-    // Zero out the dataByte memory to avoid subsequent Clang Static Analysis errors releted
-    // to dereferencing uninitialized memory.  We accept this minimal, extraneous function call.
-    memset(dataBytes, 0, dataBytesCount);
+    return 1;
+}
 
-    while (SQLITE_ROW == sqlite3_step(fs->sdbSelectAllStmt)) {
-        const char *hash = (const char *) sqlite3_column_text (fs->sdbSelectAllStmt, 0);
-        const char *data = (const char *) sqlite3_column_text (fs->sdbSelectAllStmt, 1);
+/// MARK: - Transaction Scope
 
-        if (NULL == hash || NULL == data)
-            return fileServiceFailedImpl (fs, 1, (dataBytes == dataBytesBuffer ? NULL : dataBytes), NULL,
-                                          "missed query `hash` or `data`");
+#if !defined(NEUTER_FILE_SERVICE)
+// Called while locked, once `fs` is no longer within a transaction.  Commit at once, never
+// waiting on another file service; as the DB transaction is the connection's, the writes of any
+// other file service so far commit too and it continues in a new DB transaction.
+static sqlite3_status_code
+_fileServiceEndTransaction (BRFileService fs) {
+    sqlite3_status_code status = SQLITE_OK;
+
+    fs->pool->sdbTransactionsCount -= 1;
+
+    if (!sqlite3_get_autocommit (fs->pool->sdb)) {
+        status = sqlite3_exec (fs->pool->sdb, "COMMIT", NULL, NULL, NULL);
+        if (SQLITE_OK != status)
+            sqlite3_exec (fs->pool->sdb, "ROLLBACK", NULL, NULL, NULL);
+    }
 
-        assert (64 == strlen (hash));
-        
-        // Ensure `dataBytes` is large enough for hex-decoded `data`
-        size_t dataCount = strlen (data);
-        assert (0 == dataCount % 2);  // Surely 'even'
-        if ((dataCount/2) > dataBytesCount) {
-            if (dataBytes != dataBytesBuffer) free (dataBytes);
-            dataBytesCount = dataCount/2;
-            dataBytes = malloc (dataBytesCount);
+    if (0 != fs->pool->sdbTransactionsCount)
+        sqlite3_exec (fs->pool->sdb, "BEGIN IMMEDIATE", NULL, NULL, NULL);
+
+    return status;
+}
+#endif
+
+extern int
+fileServiceBeginTransaction (BRFileService fs) {
+#if !defined(NEUTER_FILE_SERVICE)
+    // Queued writes precede the DB transaction; those queued during it are written within it.
+    _fileServicePoolFlush (fs->pool);
+
+    pthread_mutex_lock (&fs->pool->lock);
+    if (fs->sdbClosed)
+        return fileServiceFailedImpl (fs, 1, NULL, NULL, "closed");
+
+    // Join the connection's DB transaction, beginning one if needed.
+    if (0 == fs->sdbTransactionDepth) {
+        if (sqlite3_get_autocommit (fs->pool->sdb)) {
+            sqlite3_status_code status = sqlite3_exec (fs->pool->sdb, "BEGIN IMMEDIATE", NULL, NULL, NULL);
+            if (SQLITE_OK != status)
+                return fileServiceFailedSDB (fs, 1, status);
         }
+        fs->pool->sdbTransactionsCount += 1;
+    }
+    fs->sdbTransactionDepth += 1;
 
-        // Actually decode `data` into `dataBytes`
-        hexDecode (dataBytes, dataCount/2, data, dataCount);
+    pthread_mutex_unlock (&fs->pool->lock);
+#endif // !defined(NEUTER_FILE_SERVICE)
 
-        size_t offset = 0;
-        BRFileServiceVersion version;
-        uint32_t  entityBytesCount;
-        uint8_t  *entityBytes;
+    return 1;
+}
 
-        BRFileServiceHeaderFormatVersion headerVersion = dataBytes[offset];
-        offset += 1;
+extern int
+fileServiceCommitTransaction (BRFileService fs) {
+#if !defined(NEUTER_FILE_SERVICE)
+    _fileServicePoolFlush (fs->pool);
 
-        switch (headerVersion) {
-            case HEADER_FORMAT_1:
-                version = dataBytes[offset];
-                offset += 1;
+    pthread_mutex_lock (&fs->pool->lock);
+    if (fs->sdbClosed)
+        return fileServiceFailedImpl (fs, 1, NULL, NULL, "closed");
 
-                entityBytesCount = UInt32GetBE (&dataBytes[offset]);
-                offset += sizeof (uint32_t);
+    if (0 == fs->sdbTransactionDepth)
+        return fileServiceFailedImpl (fs, 1, NULL, NULL, "missed begin transaction");
 
-                break;
-        }
+    fs->sdbTransactionDepth -= 1;
+    if (0 == fs->sdbTransactionDepth) {
+        sqlite3_status_code status = _fileServiceEndTransaction (fs);
+        if (SQLITE_OK != status)
+            return fileServiceFailedSDB (fs, 1, status);
+    }
 
-        // Assert entityBytesCount remain in dataBytes
-        if (offset + entityBytesCount > dataBytesCount) {
-            assert (0); // In DEBUG builds.
-            return fileServiceFailedImpl (fs, 1, (dataBytes == dataBytesBuffer ? NULL : dataBytes), NULL,
-                                          "missed bytes count");
-        }
+    pthread_mutex_unlock (&fs->pool->lock);
+#endif // !defined(NEUTER_FILE_SERVICE)
 
-        entityBytes = &dataBytes[offset];
+    return 1;
+}
 
-        switch (headerVersion) {
-            case HEADER_FORMAT_1:
-                // compute then compare checksum
-                break;
+/// MARK: - Load
+
+#if !defined(NEUTER_FILE_SERVICE)
+///
+/// Parse the header of `dataBytes` per the header format in `dataBytes[0]` and, if the format has
+/// one, verify the checksum.  Return NULL on success, otherwise a reason for the failure - the
+/// row is corrupted.
+///
+static const char *
+_fileServiceParseHeader (uint8_t *dataBytes,
+                         size_t dataBytesCount,
+                         BRFileServiceHeaderFormatVersion *headerVersion,
+                         BRFileServiceVersion *version,
+                         uint8_t **entityBytes,
+                         uint32_t *entityBytesCount) {
+    size_t   offset   = 0;
+    uint32_t checksum = 0;
+
+    // The smallest header is {HeaderFormatVersion, Version, EntityBytesCount}
+    if (dataBytesCount < 1 + 1 + sizeof (uint32_t))
+        return "missed header";
+
+    *headerVersion = dataBytes[offset];
+    offset += 1;
+
+    switch (*headerVersion) {
+        case HEADER_FORMAT_1:
+            *version = dataBytes[offset];
+            offset += 1;
+
+            *entityBytesCount = UInt32GetBE (&dataBytes[offset]);
+            offset += sizeof (uint32_t);
+
+            break;
+
+        case HEADER_FORMAT_2:
+            if (dataBytesCount < 1 + 1 + sizeof (uint32_t) + sizeof (uint32_t))
+                return "missed header";
+
+            *version = dataBytes[offset];
+            offset += 1;
+
+            *entityBytesCount = UInt32GetBE (&dataBytes[offset]);
+            offset += sizeof (uint32_t);
+
+            checksum = UInt32GetBE (&dataBytes[offset]);
+            offset += sizeof (uint32_t);
+
+            break;
+
+        default:
+            return "missed header format";
+    }
+
+    // Ensure entityBytesCount remain in dataBytes
+    if (offset + *entityBytesCount > dataBytesCount)
+        return "missed bytes count";
+
+    *entityBytes = &dataBytes[offset];
+
+    switch (*headerVersion) {
+        case HEADER_FORMAT_1:
+            break;
+
+        case HEADER_FORMAT_2:
+            if (checksum != fileServiceChecksum (*entityBytes, *entityBytesCount))
+                return "missed checksum";
+            break;
+    }
+
+    return NULL;
+}
+
+///
+/// A row written once a load's query completes - writing while the query is in progress could
+/// revisit the row.  Either an entity updated to the current version, with `reason` of NULL, or
+/// a corrupted row, with a `reason`, moved from 'EntityBlob' into 'EntityQuarantine'.  A row that
+/// is intact, but that the reader could not read, is only counted; it remains in 'EntityBlob'.
+///
+typedef struct {
+    UInt256 identifier;
+    uint8_t *bytes;
+    size_t bytesCount;
+    const char *reason;
+} BRFileServiceDeferredRow;
+
+typedef struct {
+    BRArrayOf(BRFileServiceDeferredRow) updates;
+    BRArrayOf(BRFileServiceDeferredRow) quarantine;
+    size_t unreadCount;
+} BRFileServiceLoadDeferred;
+
+static void
+_fileServiceLoadDeferredQuarantine (BRFileServiceLoadDeferred *deferred,
+                                    const uint8_t *hash,
+                                    const uint8_t *dataBytes,
+                                    size_t dataBytesCount,
+                                    const char *reason) {
+    BRFileServiceDeferredRow row = { UINT256_ZERO, malloc (dataBytesCount), dataBytesCount, reason };
+    memcpy (row.identifier.u8, hash, sizeof (UInt256));
+    memcpy (row.bytes, dataBytes, dataBytesCount);
+    array_add (deferred->quarantine, row);
+}
+
+static void
+_fileServiceLoadDeferredRelease (BRFileServiceLoadDeferred *deferred) {
+    for (size_t index = 0; index < array_count (deferred->updates); index++)
+        if (NULL != deferred->updates[index].bytes) free (deferred->updates[index].bytes);
+    array_free (deferred->updates);
+
+    for (size_t index = 0; index < array_count (deferred->quarantine); index++)
+        free (deferred->quarantine[index].bytes);
+    array_free (deferred->quarantine);
+}
+
+// Called while locked, after the load's `sdbSelectAllStmt` is reset.  Saves the updates and
+// moves the quarantined rows from 'EntityBlob' into 'EntityQuarantine', in one DB transaction.
+static sqlite3_status_code
+_fileServiceLoadDeferredSave (BRFileService fs,
+                              const char *type,
+                              BRFileServiceLoadDeferred *deferred) {
+    sqlite3_status_code status;
+    int began;
+
+    status = _fileServiceBeginScope (fs, &began);
+    if (SQLITE_OK != status) return status;
+
+    // The update bytes are given to `_fileServiceSaveBytes()`.  This could signal an error; we
+    // won't stop - we couldn't save the entity in the new format but we'll try next time.
+    for (size_t index = 0; SQLITE_OK == status && index < array_count (deferred->updates); index++) {
+        BRFileServiceDeferredRow *row = &deferred->updates[index];
+        _fileServiceSaveBytes (fs, type, row->identifier, row->bytes, row->bytesCount, 0);
+        row->bytes = NULL;
+    }
+
+    for (size_t index = 0; SQLITE_OK == status && index < array_count (deferred->quarantine); index++) {
+        BRFileServiceDeferredRow *row = &deferred->quarantine[index];
+
+        sqlite3_reset (fs->pool->sdbInsertQuarantineStmt);
+        sqlite3_clear_bindings (fs->pool->sdbInsertQuarantineStmt);
+
+        status = sqlite3_bind_text (fs->pool->sdbInsertQuarantineStmt, 1, fs->partition, -1, SQLITE_STATIC);
+        if (SQLITE_OK == status)
+            status = sqlite3_bind_text (fs->pool->sdbInsertQuarantineStmt, 2, type, -1, SQLITE_STATIC);
+        if (SQLITE_OK == status)
+            status = sqlite3_bind_blob (fs->pool->sdbInsertQuarantineStmt, 3, row->identifier.u8, sizeof (UInt256), SQLITE_STATIC);
+        if (SQLITE_OK == status)
+            status = sqlite3_bind_blob (fs->pool->sdbInsertQuarantineStmt, 4, row->bytes, (int) row->bytesCount, SQLITE_STATIC);
+        if (SQLITE_OK == status)
+            status = sqlite3_bind_text (fs->pool->sdbInsertQuarantineStmt, 5, row->reason, -1, SQLITE_STATIC);
+        if (SQLITE_OK == status)
+            status = (SQLITE_DONE == sqlite3_step (fs->pool->sdbInsertQuarantineStmt) ? SQLITE_OK : sqlite3_errcode (fs->pool->sdb));
+        sqlite3_reset (fs->pool->sdbInsertQuarantineStmt);
+
+        if (SQLITE_OK != status) break;
+
+        status = _fileServiceDeleteIdentifier (fs->pool, fs->partition, type, row->identifier);
+    }
+
+    status = _fileServiceEndScope (fs, began, status);
+
+    return status;
+}
+
+// Called while locked.  If the read version is not the current version, update - but only once
+// the query completes.  Encode now, before `callback` takes ownership of `entity`.
+static void
+_fileServiceUpdateVersion (BRFileService fs,
+                           BRFileServiceEntityType *entityType,
+                           BRFileServiceHeaderFormatVersion headerVersion,
+                           BRFileServiceVersion version,
+                           const void *entity,
+                           BRFileServiceLoadDeferred *deferred) {
+    if (version != entityType->currentVersion ||
+        headerVersion != currentHeaderFormatVersion) {
+        BRFileServiceEntityHandler *handler = fileServiceEntityTypeLookupHandler (entityType, entityType->currentVersion);
+
+        BRFileServiceDeferredRow row = { UINT256_ZERO, NULL, 0, NULL };
+        row.bytes = _fileServiceEncode (fs, entityType, handler, entity, &row.identifier, &row.bytesCount);
+        array_add (deferred->updates, row);
+    }
+}
+
+// Called while locked, with `sdbSelectAllStmt` bound.  On failure the lock is released.
+// Corrupted rows are added to `quarantine` and skipped; unread rows are counted and skipped.
+static int
+_fileServiceLoadIterateSerial (BRFileService fs,
+                               BRFileServiceEntityType *entityType,
+                               int updateVersion,
+                               BRFileServiceContext context,
+                               BRFileServiceLoadCallback callback,
+                               BRFileServiceLoadDeferred *deferred) {
+    while (SQLITE_ROW == sqlite3_step(fs->pool->sdbSelectAllStmt)) {
+        // The `dataBytes` are owned by SQLite and are valid until the next step or reset.
+        const uint8_t *hash      = sqlite3_column_blob (fs->pool->sdbSelectAllStmt, 0);
+        size_t         hashCount = (size_t) sqlite3_column_bytes (fs->pool->sdbSelectAllStmt, 0);
+
+        uint8_t *dataBytes      = (uint8_t *) sqlite3_column_blob (fs->pool->sdbSelectAllStmt, 1);
+        size_t   dataBytesCount = (size_t)    sqlite3_column_bytes (fs->pool->sdbSelectAllStmt, 1);
+
+        if (NULL == hash || NULL == dataBytes)
+            return fileServiceFailedImpl (fs, 1, NULL, NULL, "missed query `hash` or `data`");
+
+        assert (sizeof (UInt256) == hashCount); (void) hashCount;
+
+        BRFileServiceHeaderFormatVersion headerVersion;
+        BRFileServiceVersion version;
+        uint32_t  entityBytesCount;
+        uint8_t  *entityBytes;
+
+        const char *reason = _fileServiceParseHeader (dataBytes, dataBytesCount,
+                                                      &headerVersion, &version,
+                                                      &entityBytes, &entityBytesCount);
+        if (NULL != reason) {
+            _fileServiceLoadDeferredQuarantine (deferred, hash, dataBytes, dataBytesCount, reason);
+            continue;
         }
 
         // Look up the entity handler
         BRFileServiceEntityHandler *handler = fileServiceEntityTypeLookupHandler(entityType, version);
         if (NULL == handler)
-            return fileServiceFailedImpl (fs, 1, (dataBytes == dataBytesBuffer ? NULL : dataBytes), NULL,
+            return fileServiceFailedImpl (fs, 1, NULL, NULL,
                                           "missed type handler");
 
-        // Read the entity from buffer and add to results.
+        // Read the entity from buffer.
         void *entity = handler->reader (handler->context, fs, entityBytes, entityBytesCount);
-        if (NULL == entity)
-            return fileServiceFailedEntity (fs, 1, (dataBytes == dataBytesBuffer ? NULL : dataBytes), NULL,
-                                            type, "reader");
-
-        // Update restuls with the newly restored entity
-        void *oldEntity = BRSetAdd (results, entity);
-        assert (NULL == oldEntity);  // DEBUG builds
-        if (NULL != oldEntity)
-            return fileServiceFailedEntity (fs, 1, (dataBytes == dataBytesBuffer ? NULL : dataBytes), NULL,
-                                            type, "duplicate set entry");
-
-        // If the read version is not the current version, update
-        if (updateVersion &&
-            (version != entityType->currentVersion ||
-             headerVersion != currentHeaderFormatVersion))
-            // This could signal an error.  Perhaps we should test the return result and
-            // if `0` skip out here?  We won't - we couldn't save the entity in the new format
-            // but we'll continue and will try next time we load it.
-            _fileServiceSave (fs, type, entity, 0);
+        if (NULL == entity) {
+            deferred->unreadCount += 1;
+            continue;
+        }
+
+        // Update before `callback` takes ownership of `entity`.
+        if (updateVersion)
+            _fileServiceUpdateVersion (fs, entityType, headerVersion, version, entity, deferred);
+
+        // Hand the newly restored entity to `callback`; stop if requested.
+        if (!callback (context, fs, entity))
+            break;
+    }
+
+    return 1;
+}
+
+// The maximum number of rows fetched, and then decoded in parallel, at once.  Bounds the memory
+// holding copies of the rows' bytes.
+#define FILE_SERVICE_LOAD_BATCH_COUNT       (4096)
+
+typedef struct {
+    BRFileServiceEntityHandler *handler;
+    BRFileServiceHeaderFormatVersion headerVersion;
+    BRFileServiceVersion version;
+    UInt256 identifier;
+    uint8_t *dataBytes;
+    size_t dataBytesCount;
+    uint8_t *bytes;         // within `dataBytes`
+    uint32_t bytesCount;
+    void *entity;
+} BRFileServiceLoadRow;
+
+typedef struct {
+    BRFileService fs;
+    BRFileServiceLoadRow *rows;
+    size_t rowsCount;
+    size_t rowsNext;
+    pthread_mutex_t lock;
+} BRFileServiceLoadWork;
+
+static void *
+_fileServiceLoadWorker (BRFileServiceLoadWork *work) {
+    while (1) {
+        pthread_mutex_lock (&work->lock);
+        size_t index = work->rowsNext++;
+        pthread_mutex_unlock (&work->lock);
+
+        if (index >= work->rowsCount) break;
+
+        BRFileServiceLoadRow *row = &work->rows[index];
+        row->entity = row->handler->reader (row->handler->context, work->fs, row->bytes, row->bytesCount);
+    }
+    return NULL;
+}
+
+#define FILE_SERVICE_LOAD_WORKER_STACK_SIZE     (512 * 1024)
+
+// Decode each of `rows` on up to `workersCount` threads, including the calling thread.
+static void
+_fileServiceLoadDecode (BRFileService fs,
+                        BRFileServiceLoadRow *rows,
+                        size_t rowsCount,
+                        size_t workersCount) {
+    BRFileServiceLoadWork work = { fs, rows, rowsCount, 0 };
+    pthread_mutex_init_brd (&work.lock, PTHREAD_MUTEX_NORMAL);
+
+    // Don't bother with threads for fewer rows than workers.
+    size_t threadsCount = (rowsCount < workersCount ? 0 : workersCount - 1);
+    pthread_t threads[threadsCount + 1];
+
+    size_t threadsCreated = 0;
+    for (; threadsCreated < threadsCount; threadsCreated++) {
+        pthread_attr_t attr;
+        pthread_attr_init (&attr);
+        pthread_attr_setdetachstate (&attr, PTHREAD_CREATE_JOINABLE);
+        pthread_attr_setstacksize (&attr, FILE_SERVICE_LOAD_WORKER_STACK_SIZE);
+
+        int failed = pthread_create (&threads[threadsCreated], &attr, (ThreadRoutine) _fileServiceLoadWorker, &work);
+        pthread_attr_destroy (&attr);
+
+        // If we can't create a thread, the remaining workers, at least this thread, suffice.
+        if (0 != failed) break;
+    }
+
+    _fileServiceLoadWorker (&work);
+
+    for (size_t index = 0; index < threadsCreated; index++)
+        pthread_join (threads[index], NULL);
+
+    pthread_mutex_destroy (&work.lock);
+}
+
+// Called while locked, with `sdbSelectAllStmt` bound.  On failure the lock is released.  The
+// rows are fetched serially, decoded in parallel and then delivered in order.  The semantics
+// match `_fileServiceLoadIterateSerial()`: entities preceeding a failure are delivered; others
+// are released.
+static int
+_fileServiceLoadIterateParallel (BRFileService fs,
+                                 BRFileServiceEntityType *entityType,
+                                 int updateVersion,
+                                 BRFileServiceContext context,
+                                 BRFileServiceLoadCallback callback,
+                                 BRFileServiceLoadDeferred *deferred) {
+    BRFileServiceLoadRow *rows = calloc (FILE_SERVICE_LOAD_BATCH_COUNT, sizeof (BRFileServiceLoadRow));
+
+    const char *failedImpl = NULL;
+    int         more       = 1;
+    int         stopped    = 0;
+
+    while (more && !stopped && NULL == failedImpl) {
+        size_t rowsCount = 0;
+
+        // Fetch, serially, up to a batch of rows; copy the bytes as SQLite owns them.
+        while (rowsCount < FILE_SERVICE_LOAD_BATCH_COUNT) {
+            if (SQLITE_ROW != sqlite3_step (fs->pool->sdbSelectAllStmt)) { more = 0; break; }
+
+            const uint8_t *hash      = sqlite3_column_blob (fs->pool->sdbSelectAllStmt, 0);
+            uint8_t *dataBytes       = (uint8_t *) sqlite3_column_blob (fs->pool->sdbSelectAllStmt, 1);
+            size_t   dataBytesCount  = (size_t)    sqlite3_column_bytes (fs->pool->sdbSelectAllStmt, 1);
+
+            if (NULL == hash || NULL == dataBytes) { failedImpl = "missed query `hash` or `data`"; break; }
+
+            BRFileServiceLoadRow row;
+            uint8_t *entityBytes;
+
+            const char *reason = _fileServiceParseHeader (dataBytes, dataBytesCount,
+                                                          &row.headerVersion, &row.version,
+                                                          &entityBytes, &row.bytesCount);
+            if (NULL != reason) {
+                _fileServiceLoadDeferredQuarantine (deferred, hash, dataBytes, dataBytesCount, reason);
+                continue;
+            }
+
+            row.handler = fileServiceEntityTypeLookupHandler (entityType, row.version);
+            if (NULL == row.handler) { failedImpl = "missed type handler"; break; }
+
+            memcpy (row.identifier.u8, hash, sizeof (UInt256));
+            row.dataBytes      = malloc (dataBytesCount);
+            row.dataBytesCount = dataBytesCount;
+            memcpy (row.dataBytes, dataBytes, dataBytesCount);
+            row.bytes  = row.dataBytes + (entityBytes - dataBytes);
+            row.entity = NULL;
+
+            rows[rowsCount++] = row;
+        }
+
+        _fileServiceLoadDecode (fs, rows, rowsCount, fs->pool->loadWorkersCount);
+
+        // Deliver, in order, until stopped; thereafter release.
+        for (size_t index = 0; index < rowsCount; index++) {
+            BRFileServiceLoadRow *row = &rows[index];
+
+            if (NULL == row->entity && !stopped)
+                deferred->unreadCount += 1;
+            free (row->dataBytes);
+
+            if (NULL == row->entity) continue;
+
+            if (stopped) {
+                entityType->releaser (row->entity);
+                continue;
+            }
+
+            if (updateVersion)
+                _fileServiceUpdateVersion (fs, entityType, row->headerVersion, row->version, row->entity, deferred);
+
+            stopped = !callback (context, fs, row->entity);
+        }
+    }
+
+    free (rows);
+
+    if (NULL != failedImpl && !stopped)
+        return fileServiceFailedImpl (fs, 1, NULL, NULL, failedImpl);
+
+    return 1;
+}
+#endif // !defined(NEUTER_FILE_SERVICE)
+
+extern int
+fileServiceLoadIterate (BRFileService fs,
+                        const char *type,
+                        int updateVersion,
+                        BRFileServiceContext context,
+                        BRFileServiceLoadCallback callback) {
+    BRFileServiceEntityType *entityType = fileServiceLookupType (fs, type);
+    if (NULL == entityType) return fileServiceFailedImpl (fs, 0, NULL, NULL, "missed type");
+
+    BRFileServiceEntityHandler *entityHandlerCurrent = fileServiceEntityTypeLookupHandler(entityType, entityType->currentVersion);
+    if (NULL == entityHandlerCurrent) return fileServiceFailedImpl (fs,  0, NULL, NULL, "missed type handler");
+
+#if !defined(NEUTER_FILE_SERVICE)
+    sqlite3_status_code status;
+
+    // Load what was saved
+    _fileServicePoolFlush (fs->pool);
+
+    pthread_mutex_lock (&fs->pool->lock);
+    if (fs->sdbClosed)
+        return fileServiceFailedImpl (fs, 1, NULL, NULL, "closed");
+
+    sqlite3_reset (fs->pool->sdbSelectAllStmt);
+    sqlite3_clear_bindings (fs->pool->sdbSelectAllStmt);
+
+    status = sqlite3_bind_text (fs->pool->sdbSelectAllStmt, 1, fs->partition, -1, SQLITE_STATIC);
+    if (SQLITE_OK == status)
+        status = sqlite3_bind_text (fs->pool->sdbSelectAllStmt, 2, entityType->type, -1, SQLITE_STATIC);
+    if (SQLITE_OK != status)
+        return fileServiceFailedSDB (fs, 1, status);
+
+    BRFileServiceLoadDeferred deferred;
+    array_new (deferred.updates, 1);
+    array_new (deferred.quarantine, 1);
+    deferred.unreadCount = 0;
+
+    // Decode in parallel only if configured and if undelivered entities can be released.
+    int success = (fs->pool->loadWorkersCount > 1 && NULL != entityType->releaser
+                   ? _fileServiceLoadIterateParallel (fs, entityType, updateVersion, context, callback, &deferred)
+                   : _fileServiceLoadIterateSerial   (fs, entityType, updateVersion, context, callback, &deferred));
+    if (!success) {  // lock released
+        _fileServiceLoadDeferredRelease (&deferred);
+        return 0;
     }
 
     // Ensure the 'implicit DB transaction' is committed.
-    sqlite3_reset (fs->sdbSelectAllStmt);
+    sqlite3_reset (fs->pool->sdbSelectAllStmt);
+
+    // Update versions and move corrupted rows aside.  On a failure the rows remain as they were
+    // and will be found on the next load.
+    status = (0 == array_count (deferred.updates) && 0 == array_count (deferred.quarantine)
+              ? SQLITE_OK
+              : _fileServiceLoadDeferredSave (fs, entityType->type, &deferred));
+
+    pthread_mutex_unlock (&fs->pool->lock);
+
+    // Report each quarantined entity, w/o the lock, so that it might be re-fetched.
+    for (size_t index = 0; index < array_count (deferred.quarantine); index++)
+        fileServiceFailedInternal (fs, 0, NULL, NULL,
+                                   (BRFileServiceError) {
+                                       FILE_SERVICE_QUARANTINE,
+                                       { .quarantine = { type,
+                                                         deferred.quarantine[index].identifier,
+                                                         deferred.quarantine[index].reason }}
+                                   });
+
+    // Report each unread entity too; the row is intact, thus kept for a fixed reader.
+    for (size_t index = 0; index < deferred.unreadCount; index++)
+        fileServiceFailedEntity (fs, 0, NULL, NULL, type, "reader");
+
+    _fileServiceLoadDeferredRelease (&deferred);
+
+    if (SQLITE_OK != status)
+        return fileServiceFailedSDB (fs, 0, status);
+#endif // !defined(NEUTER_FILE_SERVICE)
+
+    return 1;
+}
+
+extern size_t
+fileServiceGetQuarantineCount (BRFileService fs,
+                               const char *type) {
+    size_t count = 0;
+
+    BRFileServiceEntityType *entityType = fileServiceLookupType (fs, type);
+    if (NULL == entityType) { fileServiceFailedImpl (fs, 0, NULL, NULL, "missed type"); return 0; }
+
+#if !defined(NEUTER_FILE_SERVICE)
+    sqlite3_status_code status;
+    sqlite3_stmt *stmt = NULL;
+
+    pthread_mutex_lock (&fs->pool->lock);
+    if (fs->sdbClosed) {
+        fileServiceFailedImpl (fs, 1, NULL, NULL, "closed");
+        return 0;
+    }
 
-    pthread_mutex_unlock (&fs->lock);
+    status = sqlite3_prepare_v2 (fs->pool->sdb, FILE_SERVICE_SDB_COUNT_QUARANTINE, -1, &stmt, NULL);
+    if (SQLITE_OK == status)
+        status = sqlite3_bind_text (stmt, 1, fs->partition, -1, SQLITE_STATIC);
+    if (SQLITE_OK == status)
+        status = sqlite3_bind_text (stmt, 2, entityType->type, -1, SQLITE_STATIC);
+    if (SQLITE_OK == status && SQLITE_ROW == sqlite3_step (stmt))
+        count = (size_t) sqlite3_column_int64 (stmt, 0);
+    if (NULL != stmt) sqlite3_finalize (stmt);
 
-    if (dataBytes != dataBytesBuffer) free (dataBytes);
+    if (SQLITE_OK != status) {
+        fileServiceFailedSDB (fs, 1, status);
+        return 0;
+    }
+
+    pthread_mutex_unlock (&fs->pool->lock);
 #endif // !defined(NEUTER_FILE_SERVICE)
 
+    return count;
+}
+
+extern int
+fileServiceClearQuarantine (BRFileService fs,
+                            const char *type) {
+    BRFileServiceEntityType *entityType = fileServiceLookupType (fs, type);
+    if (NULL == entityType)
+        return fileServiceFailedImpl (fs, 0, NULL, NULL, "missed type");
+
+#if !defined(NEUTER_FILE_SERVICE)
+    sqlite3_status_code status;
+    sqlite3_stmt *stmt = NULL;
+
+    pthread_mutex_lock (&fs->pool->lock);
+    if (fs->sdbClosed)
+        return fileServiceFailedImpl (fs, 1, NULL, NULL, "closed");
+
+    status = sqlite3_prepare_v2 (fs->pool->sdb, FILE_SERVICE_SDB_DELETE_QUARANTINE, -1, &stmt, NULL);
+    if (SQLITE_OK == status)
+        status = sqlite3_bind_text (stmt, 1, fs->partition, -1, SQLITE_STATIC);
+    if (SQLITE_OK == status)
+        status = sqlite3_bind_text (stmt, 2, entityType->type, -1, SQLITE_STATIC);
+    if (SQLITE_OK == status)
+        status = (SQLITE_DONE == sqlite3_step (stmt) ? SQLITE_OK : sqlite3_errcode (fs->pool->sdb));
+    if (NULL != stmt) sqlite3_finalize (stmt);
+
+    if (SQLITE_OK != status)
+        return fileServiceFailedSDB (fs, 1, status);
+
+    pthread_mutex_unlock (&fs->pool->lock);
+#endif // !defined(NEUTER_FILE_SERVICE)
+
+    return 1;
+}
+
+typedef struct {
+    BRSet *results;
+    int duplicate;
+} BRFileServiceLoadSetContext;
+
+static int
+fileServiceLoadSetCallback (BRFileServiceContext context,
+                            BRFileService fs,
+                            void *entity) {
+    BRFileServiceLoadSetContext *setContext = context;
+
+    // Update results with the newly restored entity
+    void *oldEntity = BRSetAdd (setContext->results, entity);
+    assert (NULL == oldEntity);  // DEBUG builds
+
+    setContext->duplicate = (NULL != oldEntity);
+    return !setContext->duplicate;
+}
+
+extern int
+fileServiceLoad (BRFileService fs,
+                 BRSet *results,
+                 const char *type,
+                 int updateVersion) {
+    BRFileServiceLoadSetContext setContext = { results, 0 };
+
+    if (!fileServiceLoadIterate (fs, type, updateVersion, &setContext, fileServiceLoadSetCallback))
+        return 0;
+
+    if (setContext.duplicate)
+        return fileServiceFailedEntity (fs, 0, NULL, NULL, type, "duplicate set entry");
+
     return 1;
 }
 
@@ -803,34 +2119,21 @@ fileServiceRemoveByIdentifier (BRFileService fs,
         return fileServiceFailedImpl (fs, 0, NULL, NULL, "missed type");
 
 #if !defined(NEUTER_FILE_SERVICE)
-    // Hex-Encode identifier
-    const char *hash = u256hex(identifier);
-
-    sqlite3_status_code status;
+    if (fs->pool->writeBehind) {
+        BRFileServiceWrite *write = _fileServiceWriteCreate (fs, entityType->type, identifier, NULL, 0);
+        _fileServicePoolQueueWrites (fs->pool, &write, 1);
+        return 1;
+    }
 
-    pthread_mutex_lock (&fs->lock);
+    pthread_mutex_lock (&fs->pool->lock);
     if (fs->sdbClosed)
         return fileServiceFailedImpl (fs, 1, NULL, NULL, "closed");
 
-    sqlite3_reset (fs->sdbDeleteStmt);
-    sqlite3_clear_bindings (fs->sdbDeleteStmt);
-
-    status = sqlite3_bind_text (fs->sdbDeleteStmt, 1, type, -1, SQLITE_STATIC);
+    sqlite3_status_code status = _fileServiceDeleteIdentifier (fs->pool, fs->partition, entityType->type, identifier);
     if (SQLITE_OK != status)
         return fileServiceFailedSDB (fs, 1, status);
 
-    status = sqlite3_bind_text (fs->sdbDeleteStmt, 2, hash, -1, SQLITE_STATIC);
-    if (SQLITE_OK != status)
-        return fileServiceFailedSDB (fs, 1, status);
-
-    status = sqlite3_step (fs->sdbDeleteStmt);
-    if (SQLITE_DONE != status)
-        return fileServiceFailedSDB (fs, 1, status);
-
-    // Ensure the 'implicit DB transaction' is committed.
-    sqlite3_reset (fs->sdbDeleteStmt);
-
-    pthread_mutex_unlock (&fs->lock);
+    pthread_mutex_unlock (&fs->pool->lock);
 #endif // !defined(NEUTER_FILE_SERVICE)
 
     return 1;
@@ -841,29 +2144,29 @@ fileServiceClearForType (BRFileService fs,
                          BRFileServiceEntityType *entityType,
                          int needLock) {
 #if !defined(NEUTER_FILE_SERVICE)
-    const char *type = entityType->type;
-
     sqlite3_status_code status;
 
-    if (needLock) pthread_mutex_lock (&fs->lock);
+    if (needLock) pthread_mutex_lock (&fs->pool->lock);
     if (fs->sdbClosed)
         return fileServiceFailedImpl (fs, needLock, NULL, NULL, "closed");
 
-    sqlite3_reset (fs->sdbDeleteAllTypeStmt);
-    sqlite3_clear_bindings (fs->sdbDeleteAllTypeStmt);
+    sqlite3_reset (fs->pool->sdbDeleteAllTypeStmt);
+    sqlite3_clear_bindings (fs->pool->sdbDeleteAllTypeStmt);
 
-    status = sqlite3_bind_text (fs->sdbDeleteAllTypeStmt, 1, type, -1, SQLITE_STATIC);
+    status = sqlite3_bind_text (fs->pool->sdbDeleteAllTypeStmt, 1, fs->partition, -1, SQLITE_STATIC);
+    if (SQLITE_OK == status)
+        status = sqlite3_bind_text (fs->pool->sdbDeleteAllTypeStmt, 2, entityType->type, -1, SQLITE_STATIC);
     if (SQLITE_OK != status)
         return fileServiceFailedSDB (fs, needLock, status);
 
-    status = sqlite3_step (fs->sdbDeleteAllTypeStmt);
+    status = sqlite3_step (fs->pool->sdbDeleteAllTypeStmt);
     if (SQLITE_DONE != status)
         return fileServiceFailedSDB (fs, needLock, status);
 
     // Ensure the 'implicit DB transaction' is committed.
-    sqlite3_reset (fs->sdbDeleteAllTypeStmt);
+    sqlite3_reset (fs->pool->sdbDeleteAllTypeStmt);
 
-    if (needLock) pthread_mutex_unlock (&fs->lock);
+    if (needLock) pthread_mutex_unlock (&fs->pool->lock);
 #endif // !defined(NEUTER_FILE_SERVICE)
 
     return 1;
@@ -876,11 +2179,19 @@ fileServiceClear (BRFileService fs,
     if (NULL == entityType)
         return fileServiceFailedImpl (fs, 0, NULL, NULL, "missed type");
 
+#if !defined(NEUTER_FILE_SERVICE)
+    _fileServicePoolFlush (fs->pool);
+#endif
+
     return fileServiceClearForType(fs, entityType, 1);
 }
 
 extern int
 fileServiceClearAll (BRFileService fs) {
+#if !defined(NEUTER_FILE_SERVICE)
+    _fileServicePoolFlush (fs->pool);
+#endif
+
     int success = 1;
     size_t typeCount = array_count(fs->entityTypes);
     for (size_t index = 0; index < typeCount; index++)
@@ -889,8 +2200,11 @@ fileServiceClearAll (BRFileService fs) {
 }
 
 static int
-fileServiceReplaceFailed (BRFileService fs, int needUnlock) {
-    if (needUnlock) pthread_mutex_unlock (&fs->lock);
+fileServiceReplaceFailed (BRFileService fs, int needUnlock, int began) {
+#if !defined(NEUTER_FILE_SERVICE)
+    _fileServiceEndScope (fs, began, SQLITE_ABORT);
+#endif
+    if (needUnlock) pthread_mutex_unlock (&fs->pool->lock);
     return 0;
 }
 
@@ -905,27 +2219,31 @@ fileServiceReplace (BRFileService fs,
 
 #if !defined(NEUTER_FILE_SERVICE)
     sqlite3_status_code status;
+    int began;
+
+    // Queued writes precede the replacement, which is itself written synchronously.
+    _fileServicePoolFlush (fs->pool);
 
-    pthread_mutex_lock (&fs->lock);
+    pthread_mutex_lock (&fs->pool->lock);
     if (fs->sdbClosed)
         return fileServiceFailedImpl (fs, 1, NULL, NULL, "closed");
 
-    status = sqlite3_exec (fs->sdb, "BEGIN", NULL, NULL, NULL);
+    status = _fileServiceBeginScope (fs, &began);
     if (SQLITE_OK != status)
         return fileServiceFailedSDB (fs, 1, status);
 
     if (0 == fileServiceClearForType (fs, entityType, 0))
-        return fileServiceReplaceFailed (fs, 1);
+        return fileServiceReplaceFailed (fs, 1, began);
 
     for (size_t index = 0; index < entitiesCount; index++)
         if (0 == _fileServiceSave (fs, type, entities[index], 0))
-            return fileServiceReplaceFailed (fs, 1);
+            return fileServiceReplaceFailed (fs, 1, began);
 
-    status = sqlite3_exec (fs->sdb, "COMMIT", NULL, NULL, NULL);
+    status = _fileServiceEndScope (fs, began, SQLITE_OK);
     if (SQLITE_OK != status)
         return fileServiceFailedSDB (fs, 1, status);
 
-    pthread_mutex_unlock (&fs->lock);
+    pthread_mutex_unlock (&fs->pool->lock);
 #endif // !defined(NEUTER_FILE_SERVICE)
 
     return 1;
@@ -935,33 +2253,17 @@ static char * // called while locked
 fileServicePurgeCreateSQL (BRFileService fs) {
     size_t typeCount = array_count(fs->entityTypes);
 
-    static char *sqlFormatter = "DELETE FROM Entity WHERE Type NOT IN (%s);";
+    // Only this file service's partition, of a pool, is purged.  The partition and each type
+    // is a parameter, bound in order, thus: "... Partition = ? AND Type NOT IN (?,?,?);"
+    static const char *sqlPrefix = "DELETE FROM EntityBlob WHERE Partition = ? AND Type NOT IN (";
+    static const char *sqlSuffix = ");";
 
-    char *sqlArgs;
-    size_t sqlArgsLength = 1;
+    char *sql = malloc (strlen (sqlPrefix) + 2 * typeCount + strlen (sqlSuffix) + 1);
 
-    char *sqlArgPrefix = "\"";
-
-    // Find the args length
-    for (size_t index = 0; index < typeCount; index++) {
-        sqlArgsLength += strlen (sqlArgPrefix);
-        sqlArgsLength += strlen (fs->entityTypes[index].type) + 2; // quotes
-        sqlArgPrefix = "\",\"";
-    }
-    sqlArgsLength += strlen ("\"");
-
-    sqlArgPrefix = "\"";
-
-    sqlArgs = malloc (sqlArgsLength);
-    for (size_t index = 0; index < typeCount; index++) {
-        strcat (sqlArgs, sqlArgPrefix);
-        strcat (sqlArgs, fs->entityTypes[index].type);
-        sqlArgPrefix = "\",\"";
-    }
-    strcat (sqlArgs, "\"");
-
-    char *sql = NULL;
-    asprintf (&sql, sqlFormatter, sqlArgs);
+    strcpy (sql, sqlPrefix);
+    for (size_t index = 0; index < typeCount; index++)
+        strcat (sql, (0 == index ? "?" : ",?"));
+    strcat (sql, sqlSuffix);
 
     return sql;
 }
@@ -970,11 +2272,15 @@ extern int
 fileServicePurge (BRFileService fs) {
     if (NULL == fs) return 0;
 
-    pthread_mutex_lock (&fs->lock);
+#if !defined(NEUTER_FILE_SERVICE)
+    _fileServicePoolFlush (fs->pool);
+#endif
+
+    pthread_mutex_lock (&fs->pool->lock);
 
     size_t typeCount = array_count(fs->entityTypes);
     if (0 == typeCount) {
-        pthread_mutex_unlock (&fs->lock);
+        pthread_mutex_unlock (&fs->pool->lock);
         return 0;
     }
 
@@ -983,24 +2289,26 @@ fileServicePurge (BRFileService fs) {
 
 #if !defined(NEUTER_FILE_SERVICE)
     sqlite3_status_code status;
+    sqlite3_stmt *stmt = NULL;
 
     if (fs->sdbClosed)
         return fileServiceFailedImpl (fs, 1, sql, NULL, "closed");
 
-    status = sqlite3_exec (fs->sdb, "BEGIN", NULL, NULL, NULL);
-    if (SQLITE_OK != status)
-        return fileServiceFailedSDBWithBufferFree (fs, 1, sql, status);
-
-    status = sqlite3_exec(fs->sdb, sql, NULL, NULL, NULL);
-    if (SQLITE_OK != status)
-        return fileServiceFailedSDBWithBufferFree (fs, 1, sql, status);
+    // One statement; thus one 'implicit DB transaction', unless within one already.
+    status = sqlite3_prepare_v2 (fs->pool->sdb, sql, -1, &stmt, NULL);
+    if (SQLITE_OK == status)
+        status = sqlite3_bind_text (stmt, 1, fs->partition, -1, SQLITE_STATIC);
+    for (size_t index = 0; SQLITE_OK == status && index < typeCount; index++)
+        status = sqlite3_bind_text (stmt, (int) (2 + index), fs->entityTypes[index].type, -1, SQLITE_STATIC);
+    if (SQLITE_OK == status)
+        status = (SQLITE_DONE == sqlite3_step (stmt) ? SQLITE_OK : sqlite3_errcode (fs->pool->sdb));
+    if (NULL != stmt) sqlite3_finalize (stmt);
 
-    status = sqlite3_exec (fs->sdb, "COMMIT", NULL, NULL, NULL);
     if (SQLITE_OK != status)
         return fileServiceFailedSDBWithBufferFree (fs, 1, sql, status);
 
 #endif // !defined(NEUTER_FILE_SERVICE)
-    pthread_mutex_unlock (&fs->lock);
+    pthread_mutex_unlock (&fs->pool->lock);
 
     free (sql);
     return 1;
@@ -1018,12 +2326,71 @@ fileServiceWipe (const char *basePath,
 
     // Remove it.
     result  = (0 == remove (sdbPath) ? 0 : errno);
+
+    // Remove any WAL-mode files too; they need not exist.
+    const char *suffixes[] = { "-wal", "-shm" };
+    for (size_t index = 0; index < sizeof (suffixes) / sizeof (suffixes[0]); index++) {
+        char sdbAuxPath[strlen (sdbPath) + strlen (suffixes[index]) + 1];
+        sprintf (sdbAuxPath, "%s%s", sdbPath, suffixes[index]);
+        remove (sdbAuxPath);
+    }
     free (sdbPath);
 #endif
 
     return result;
 }
 
+extern int
+fileServicePoolWipe (BRFileServicePool pool,
+                     const char *partition,
+                     const char *currency,
+                     const char *network) {
+#if !defined(NEUTER_FILE_SERVICE)
+    sqlite3_status_code status;
+
+    // The 'Partition' of the file service; see `_fileServiceCreateInPool()`
+    char *sdbPartition = fileServiceCreatePartition (partition, currency, network);
+
+    const char *sqls[] = {
+        FILE_SERVICE_SDB_DELETE_PARTITION_ENTITY,
+        FILE_SERVICE_SDB_DELETE_PARTITION_QUARANTINE
+    };
+
+    _fileServicePoolFlush (pool);
+
+    pthread_mutex_lock (&pool->lock);
+
+    // Within any DB transaction begun by one of the pool's file services
+    int began = sqlite3_get_autocommit (pool->sdb);
+    status = (began ? sqlite3_exec (pool->sdb, "BEGIN IMMEDIATE", NULL, NULL, NULL) : SQLITE_OK);
+
+    for (size_t index = 0; SQLITE_OK == status && index < sizeof (sqls) / sizeof (sqls[0]); index++) {
+        sqlite3_stmt *stmt = NULL;
+
+        status = sqlite3_prepare_v2 (pool->sdb, sqls[index], -1, &stmt, NULL);
+        if (SQLITE_OK == status)
+            status = sqlite3_bind_text (stmt, 1, sdbPartition, -1, SQLITE_STATIC);
+        if (SQLITE_OK == status)
+            status = (SQLITE_DONE == sqlite3_step (stmt) ? SQLITE_OK : sqlite3_errcode (pool->sdb));
+        if (NULL != stmt) sqlite3_finalize (stmt);
+    }
+
+    if (began) {
+        if (SQLITE_OK == status)
+            status = sqlite3_exec (pool->sdb, "COMMIT", NULL, NULL, NULL);
+        else
+            sqlite3_exec (pool->sdb, "ROLLBACK", NULL, NULL, NULL);
+    }
+
+    pthread_mutex_unlock (&pool->lock);
+
+    free (sdbPartition);
+    return SQLITE_OK == status;
+#else
+    return 1;
+#endif
+}
+
 extern bool
 fileServiceHasType (BRFileService fs,
                     const char *type) {
@@ -1101,22 +2468,26 @@ fileServiceDefineCurrentVersion (BRFileService fs,
     return 1;
 }
 
-extern BRFileService
-fileServiceCreateFromTypeSpecifications(const char *basePath,
-                                        const char *currency,
-                                        const char *network,
-                                        BRFileServiceContext context,
-                                        BRFileServiceErrorHandler handler,
-                                        size_t specificationsCount,
-                                        BRFileServiceTypeSpecification *specfications) {
-    int success = 1;
+extern int
+fileServiceDefineReleaser (BRFileService fs,
+                           const char *type,
+                           BRFileServiceReleaser releaser) {
+    // Find the entityType for `type`
+    BRFileServiceEntityType *entityType = fileServiceLookupType (fs, type);
+    if (NULL == entityType) return fileServiceFailedImpl (fs, 0, NULL, NULL, "missed type");
 
-    BRFileService fileService = fileServiceCreate (basePath,
-                                                   currency,
-                                                   network,
-                                                   context,
-                                                   handler);
-    if (NULL == fileService) return NULL;
+    entityType->releaser = releaser;
+
+    return 1;
+}
+
+// Define all of `specifications`; on failure `fileService` is released and NULL is returned.
+static BRFileService
+fileServiceDefineTypeSpecifications (BRFileService fileService,
+                                     BRFileServiceContext context,
+                                     size_t specificationsCount,
+                                     BRFileServiceTypeSpecification *specfications) {
+    int success = 1;
 
     for (size_t index = 0; index < specificationsCount; index++) {
         BRFileServiceTypeSpecification *specification = &specfications[index];
@@ -1135,8 +2506,53 @@ fileServiceCreateFromTypeSpecifications(const char *basePath,
                                                     specification->type,
                                                     specification->defaultVersion);
         if (!success) break;
+
+        success &= fileServiceDefineReleaser (fileService,
+                                              specification->type,
+                                              specification->releaser);
+        if (!success) break;
     }
 
     if (success) return fileService;
     else { fileServiceRelease (fileService); return NULL; }
 }
+
+extern BRFileService
+fileServiceCreateFromTypeSpecifications(const char *basePath,
+                                        const char *currency,
+                                        const char *network,
+                                        BRFileServiceContext context,
+                                        BRFileServiceErrorHandler handler,
+                                        const BRFileServiceConfiguration *configuration,
+                                        size_t specificationsCount,
+                                        BRFileServiceTypeSpecification *specfications) {
+    BRFileService fileService = _fileServiceCreate (basePath,
+                                                    currency,
+                                                    network,
+                                                    context,
+                                                    handler,
+                                                    configuration);
+    if (NULL == fileService) return NULL;
+
+    return fileServiceDefineTypeSpecifications (fileService, context, specificationsCount, specfications);
+}
+
+extern BRFileService
+fileServiceCreateFromTypeSpecificationsInPool (BRFileServicePool pool,
+                                               const char *partition,
+                                               const char *currency,
+                                               const char *network,
+                                               BRFileServiceContext context,
+                                               BRFileServiceErrorHandler handler,
+                                               size_t specificationsCount,
+                                               BRFileServiceTypeSpecification *specfications) {
+    BRFileService fileService = fileServiceCreateInPool (pool,
+                                                         partition,
+                                                         currency,
+                                                         network,
+                                                         context,
+                                                         handler);
+    if (NULL == fileService) return NULL;
+
+    return fileServiceDefineTypeSpecifications (fileService, context, specificationsCount, specfications);
+}
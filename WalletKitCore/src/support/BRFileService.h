@@ -50,7 +50,8 @@ typedef enum {
     FILE_SERVICE_IMPL,              // generally a fatal condition
     FILE_SERVICE_UNIX,              // something in the file system (fopen, fwrite, ... errorred)
     FILE_SERVICE_SDB,               // something in the sqlite3 database
-    FILE_SERVICE_ENTITY             // entity read/write (parse/serialize) error
+    FILE_SERVICE_ENTITY,            // entity read/write (parse/serialize) error
+    FILE_SERVICE_QUARANTINE         // entity corrupted; moved aside and skipped during a load
 } BRFileServiceErrorType;
 
 typedef struct {
@@ -73,6 +74,12 @@ typedef struct {
             const char *type;
             const char *reason;
         } entity;
+
+        struct {
+            const char *type;
+            UInt256 identifier;
+            const char *reason;
+        } quarantine;
     } u;
 } BRFileServiceError;
 
@@ -81,6 +88,48 @@ typedef void
                               BRFileService fs,
                               BRFileServiceError error);
 
+///
+/// Configuration of the file service's SQLite database, applied when the database is opened.  A
+/// zero value for any field leaves the corresponding SQLite default in place.
+///
+typedef enum {
+    FILE_SERVICE_JOURNAL_MODE_DEFAULT,
+    FILE_SERVICE_JOURNAL_MODE_DELETE,
+    FILE_SERVICE_JOURNAL_MODE_TRUNCATE,
+    FILE_SERVICE_JOURNAL_MODE_WAL           // readers proceed concurrently with a writer
+} BRFileServiceJournalMode;
+
+typedef enum {
+    FILE_SERVICE_SYNCHRONOUS_DEFAULT,
+    FILE_SERVICE_SYNCHRONOUS_OFF,
+    FILE_SERVICE_SYNCHRONOUS_NORMAL,        // with WAL, durable except on an OS crash/power loss
+    FILE_SERVICE_SYNCHRONOUS_FULL
+} BRFileServiceSynchronous;
+
+typedef enum {
+    FILE_SERVICE_TEMP_STORE_DEFAULT,
+    FILE_SERVICE_TEMP_STORE_FILE,
+    FILE_SERVICE_TEMP_STORE_MEMORY
+} BRFileServiceTempStore;
+
+typedef struct {
+    BRFileServiceJournalMode journalMode;
+    BRFileServiceSynchronous synchronous;
+    BRFileServiceTempStore tempStore;
+    int pageSize;           // in bytes; only effective when the database is created
+    int cacheSize;          // in pages if positive; in KiB if negative
+    int64_t mmapSize;       // in bytes
+
+    // If more than one, entities are decoded on this many threads during a load.  Only types
+    // with a `BRFileServiceReleaser` are decoded in parallel.
+    size_t loadWorkersCount;
+
+    // If true, saves and removes return once their entity is serialized; the write itself is
+    // queued to a dedicated writer thread, where repeated saves of an entity are coalesced.  See
+    // `fileServiceFlush()`.
+    int writeBehind;
+} BRFileServiceConfiguration;
+
 /// This *must* be the same fixed size type forever.  It is uint8_t.
 typedef uint8_t BRFileServiceVersion;
 
@@ -92,6 +141,37 @@ fileServiceCreate (const char *basePath,
                    BRFileServiceContext context,
                    BRFileServiceErrorHandler handler);
 
+///
+/// A pool of file services sharing one SQLite database - one file, one connection, one set of
+/// statements and one lock, through which all writes are serialized.  Each file service in the
+/// pool has a `partition`, typically an account identifier, which, together with the file
+/// service's currency and network, keeps its entities apart from all others.
+///
+typedef struct BRFileServicePoolRecord *BRFileServicePool;
+
+/**
+ * Create the pool whose database is in `basePath`.  If the pool already exists, it is shared and
+ * `configuration` is ignored.  Each create must be balanced by `fileServicePoolRelease()`; the
+ * pool is freed once it and all of its file services are released.
+ */
+extern BRFileServicePool
+fileServicePoolCreate (const char *basePath,
+                       const BRFileServiceConfiguration *configuration);
+
+extern void
+fileServicePoolRelease (BRFileServicePool pool);
+
+/**
+ * Create a file service in `pool`.  The file service holds a reference to `pool`.
+ */
+extern BRFileService
+fileServiceCreateInPool (BRFileServicePool pool,
+                         const char *partition,
+                         const char *currency,
+                         const char *network,
+                         BRFileServiceContext context,
+                         BRFileServiceErrorHandler handler);
+
 /**
  * Release fs.  This will close `fs` if it hasn't been already and then free the memory and any
  * other resources associaed with the fs (such as locks).
@@ -115,6 +195,12 @@ fileServiceSetErrorHandler (BRFileService fs,
  * Load all entities of `type` adding each to `results`.  If there is an error then the
  * fileServices' error handler is invoked and 0 is returned
  *
+ * An entity that is corrupted - its header is malformed or it fails its checksum - is moved into
+ * a quarantine table and skipped; the load continues.  The error handler is invoked with a
+ * FILE_SERVICE_QUARANTINE error identifying each such entity, so that it can be re-fetched.  An
+ * intact entity that the reader cannot read is skipped too, but is kept; the error handler is
+ * invoked with a FILE_SERVICE_ENTITY error for each.
+ *
  * @param fs The fileServie
  * @param results A BRSet within which to store the results.  The type stored in the BRSet must
  *     be consistent with type recovered from the file system.
@@ -129,11 +215,95 @@ fileServiceLoad (BRFileService fs,
                  const char *type,   /* blocks, peers, transactions, logs, ... */
                  int updateVersion);
 
+/**
+ * A function type to receive each entity loaded by `fileServiceLoadIterate()`.  You own the
+ * entity.  Return true (1) to continue loading or false (0) to stop.  Invoked while `fs` is
+ * locked; thus, the function must not call back into `fs`.
+ */
+typedef int
+(*BRFileServiceLoadCallback) (BRFileServiceContext context,
+                              BRFileService fs,
+                              void *entity);
+
+/**
+ * Load all entities of `type`, passing each, as it is read, to `callback`.  Unlike
+ * `fileServiceLoad()` no intermediate set of entities is built.  If there is an error then the
+ * fileService's error handler is invoked and 0 is returned; if `callback` stops the load early
+ * that is not an error.  Corrupted entities are quarantined, as for `fileServiceLoad()`.
+ *
+ * @param fs The fileService
+ * @param type The type to restore
+ * @param updateVersion If true (1) update old versions with newer ones.
+ * @param context An arbitrary value passed to `callback`
+ * @param callback The function to receive each entity
+ *
+ * @return true (1) if success, false (0) otherwise;
+ */
+extern int
+fileServiceLoadIterate (BRFileService fs,
+                        const char *type,
+                        int updateVersion,
+                        BRFileServiceContext context,
+                        BRFileServiceLoadCallback callback);
+
+/**
+ * Return the number of quarantined entities of `type`.
+ */
+extern size_t
+fileServiceGetQuarantineCount (BRFileService fs,
+                               const char *type);
+
+/**
+ * Remove all quarantined entities of `type`; typically once they have been re-fetched.
+ */
+extern int
+fileServiceClearQuarantine (BRFileService fs,
+                            const char *type);
+
 extern int  // 1 -> success, 0 -> failure
 fileServiceSave (BRFileService fs,
                  const char *type,  /* block, peers, transactions, logs, ... */
                  const void *entity);     /* BRMerkleBlock*, BRTransaction, BREthereumTransaction, ... */
 
+/**
+ * Save `entitiesCount` entities of `type` in a single DB transaction.  If any entity fails to
+ * save then none are saved.  If called within `fileServiceBeginTransaction()` then the entities
+ * are saved as part of that, enclosing, DB transaction; a failure rolls back these entities
+ * alone and the enclosing DB transaction remains open.  With `writeBehind` the entities are
+ * queued, written together, and a failure is reported to the error handler instead.
+ *
+ * @return true (1) if success, false (0) otherwise
+ */
+extern int
+fileServiceSaveMany (BRFileService fs,
+                     const char *type,
+                     const void **entities,
+                     size_t entitiesCount);
+
+/**
+ * Begin a DB transaction; all subsequent saves, removes, etc are part of the DB transaction until
+ * a balancing `fileServiceCommitTransaction()`.  Calls may be nested; only the outermost commit
+ * actually commits.  Note that the DB transaction is shared by all threads using `fs` and, in a
+ * pool, by all of the pool's file services.  The nesting is tracked per file service; the
+ * outermost commit of one never waits on another's, but commits the other's writes so far too.
+ * A file service released with its DB transaction uncommitted commits it.
+ *
+ * @return true (1) if success, false (0) otherwise
+ */
+extern int
+fileServiceBeginTransaction (BRFileService fs);
+
+extern int
+fileServiceCommitTransaction (BRFileService fs);
+
+/**
+ * Wait until all queued saves and removes - those of every file service sharing `fs`'s database
+ * - are written.  Only the `writeBehind` configuration queues writes; otherwise this returns at
+ * once.  Loads, clears, replaces, purges, transactions and `fileServiceClose()` flush implicitly.
+ */
+extern void
+fileServiceFlush (BRFileService fs);
+
 extern int  // 1 -> success, 0 -> failure
 fileServiceRemove (BRFileService fs,
                    const char *type,
@@ -190,6 +360,13 @@ typedef uint8_t*
                         const void* entity,
                         uint32_t *bytesCount);
 
+/**
+ * A function type to release an entity produced by a reader.  Needed to decode a type in
+ * parallel; entities decoded but not delivered, such as after a load stops early, are released.
+ */
+typedef void
+(*BRFileServiceReleaser) (void *entity);
+
 /// TODO: There is a limitation on `type`.
 
 /**
@@ -220,6 +397,16 @@ fileServiceDefineCurrentVersion (BRFileService fs,
                                  const char *type,
                                  BRFileServiceVersion version);
 
+/**
+ * Define the releaser for `type`, which must already be defined.
+ *
+ * @return true (1) if success, false (0) otherwise
+ */
+extern int
+fileServiceDefineReleaser (BRFileService fs,
+                           const char *type,
+                           BRFileServiceReleaser releaser);
+
 // Version limit can increase with maximum number of version, historically.
 #define FILE_SERVICE_TYPE_SPECIFICATION_NUMBER_OF_VERSION_LIMIT   (5)
 
@@ -233,17 +420,37 @@ typedef struct {
         BRFileServiceReader reader;
         BRFileServiceWriter writer;
     } versions [FILE_SERVICE_TYPE_SPECIFICATION_NUMBER_OF_VERSION_LIMIT];
+    BRFileServiceReleaser releaser;     // optional
 } BRFileServiceTypeSpecification;
 
+/**
+ * Create a file service and define all of its types from `specifications`.
+ *
+ * @param configuration the database configuration.  If NULL, the SQLite defaults are used.
+ */
 extern BRFileService
 fileServiceCreateFromTypeSpecifications(const char *basePath,
                                         const char *currency,
                                         const char *network,
                                         BRFileServiceContext context,
                                         BRFileServiceErrorHandler handler,
+                                        const BRFileServiceConfiguration *configuration,
                                         size_t specificationsCount,
                                         BRFileServiceTypeSpecification *specfications);
 
+/**
+ * Create a file service in `pool` and define all of its types from `specifications`.
+ */
+extern BRFileService
+fileServiceCreateFromTypeSpecificationsInPool (BRFileServicePool pool,
+                                               const char *partition,
+                                               const char *currency,
+                                               const char *network,
+                                               BRFileServiceContext context,
+                                               BRFileServiceErrorHandler handler,
+                                               size_t specificationsCount,
+                                               BRFileServiceTypeSpecification *specfications);
+
 ///
 /// Removes unused entities from the file system data
 ///
@@ -268,6 +475,18 @@ fileServiceWipe (const char *basePath,
                  const char *currency,
                  const char *network);
 
+///
+/// Deletes the data of the file service for `partition`, `currency` and `network` in `pool`.
+/// The file service should not exist.
+///
+/// @return 1 -> success, 0 -> failure
+///
+extern int
+fileServicePoolWipe (BRFileServicePool pool,
+                     const char *partition,
+                     const char *currency,
+                     const char *network);
+
 extern bool
 fileServiceHasType (BRFileService fs,
                     const char *type);
@@ -12,6 +12,8 @@
 #include <errno.h>
 #include <pthread.h>
 #include <assert.h>
+#include <stdbool.h>
+#include <stdatomic.h>
 #include "BREvent.h"
 #include "BREventQueue.h"
 #include "BREventAlarm.h"
@@ -20,10 +22,52 @@
 #define PTHREAD_STACK_SIZE (512 * 1024)
 #define PTHREAD_NAME_SIZE   (33)
 
+/// The maximum number of events an executor worker dispatches for one handler before putting
+/// the handler back at the tail of the ready list (so that a busy handler can't starve others).
+#define EVENT_EXECUTOR_DISPATCH_QUANTUM     (16)
+
 /* Forward Declarations */
 static void *
 eventHandlerThread (BREventHandler handler);
 
+static void
+eventExecutorSchedule (BREventExecutor executor,
+                       BREventHandler handler);
+
+static void
+eventExecutorUnschedule (BREventExecutor executor,
+                         BREventHandler handler);
+
+//
+// Event Executor
+//
+struct BREventExecutorRecord {
+    char name[PTHREAD_NAME_SIZE];
+
+    // The worker threads
+    size_t threadsCount;
+    pthread_t *threads;
+
+    // The handlers with pending events, in FIFO order.  A handler appears at most once and, while
+    // listed or being dispatched, is 'scheduled'; this is what keeps each handler serial.
+    BREventHandler readyHead;
+    BREventHandler readyTail;
+
+    // A lock on internal state, including every handler's `executor*` fields
+    pthread_mutex_t lock;
+
+    // Signalled when a handler is added to the ready list
+    pthread_cond_t readyCond;
+
+    // Signalled when a worker finishes dispatching a handler
+    pthread_cond_t idleCond;
+
+    int threadQuit;
+};
+
+/// The executor assigned to handlers created by `eventHandlerCreate()`; NULL for none.
+static BREventExecutor eventExecutorDefault = NULL;
+
 //
 // Event Handler
 //
@@ -56,11 +100,22 @@ struct BREventHandlerRecord {
     ///
     struct timespec timeout;
 
+    ///
+    /// The timeout jitter; if non-zero the timeout alarm is spread out.  See
+    /// `alarmClockAddAlarmPeriodicWithJitter()`
+    ///
+    struct timespec timeoutJitter;
+
     ///
     /// The timeout alarm id, if one exists
     ///
     BREventAlarmId timeoutAlarmId;
 
+    ///
+    /// True if a timeout event is queued or being dispatched; another is not queued until done.
+    ///
+    atomic_bool timeoutPending;
+
     // The thread handling events.
     pthread_t thread;
 
@@ -69,6 +124,21 @@ struct BREventHandlerRecord {
 
     // A lock for protecting the dispatch call.  Optional but recommended.
     pthread_mutex_t *lockOnDispatch;
+
+    // (Optional) Executor.  If set, `thread` remains PTHREAD_NULL and the handler's events are
+    // dispatched on the executor's worker threads.  The following are protected by the
+    // executor's lock.
+    BREventExecutor executor;
+    BREventHandler executorNext;
+    int executorRunning;
+    int executorScheduled;
+    pthread_t executorThread;   // The worker currently dispatching, if any.
+
+    // Statistics, protected by `statsLock` (not `lock`, which is held while joining `thread`)
+    pthread_mutex_t statsLock;
+    BREventDurationStats latency;
+    BREventDurationStats dispatch;
+    BREventTypeStats *typesStats;   // One per type, then one for the timeout type.
 };
 
 extern BREventHandler
@@ -76,6 +146,15 @@ eventHandlerCreate (const char *name,
                     const BREventType *types[],
                     size_t typesCount,
                     pthread_mutex_t *lockOnDispatch) {
+    return eventHandlerCreateWithExecutor (name, types, typesCount, lockOnDispatch, eventExecutorDefault);
+}
+
+extern BREventHandler
+eventHandlerCreateWithExecutor (const char *name,
+                                const BREventType *types[],
+                                size_t typesCount,
+                                pthread_mutex_t *lockOnDispatch,
+                                BREventExecutor executor) {
     BREventHandler handler = calloc (1, sizeof (struct BREventHandlerRecord));
 
     // Fill in the timeout event.  Leave the dispatcher NULL until the dispatcher is provided.
@@ -99,6 +178,7 @@ eventHandlerCreate (const char *name,
     }
 
     handler->timeoutAlarmId = ALARM_ID_NONE;
+    atomic_init (&handler->timeoutPending, false);
     handler->lockOnDispatch = lockOnDispatch;
 
     // Create the PTHREAD LOCK variable
@@ -106,6 +186,15 @@ eventHandlerCreate (const char *name,
 
     handler->thread = PTHREAD_NULL;
 
+    handler->executor = executor;
+    handler->executorThread = PTHREAD_NULL;
+
+    pthread_mutex_init_brd (&handler->statsLock, PTHREAD_MUTEX_NORMAL);
+    handler->typesStats = calloc (handler->typesCount + 1, sizeof (BREventTypeStats));
+    for (size_t index = 0; index < handler->typesCount; index++)
+        handler->typesStats[index].eventName = handler->types[index]->eventName;
+    handler->typesStats[handler->typesCount].eventName = handler->timeoutEventType.eventName;
+
     handler->scratch = (BREvent*) calloc (1, handler->eventSize);
     handler->queue = eventQueueCreate (handler->eventSize);
 
@@ -125,15 +214,107 @@ eventHandlerSetTimeoutDispatcher (BREventHandler handler,
     pthread_mutex_unlock (&handler->lock);
 }
 
+extern void
+eventHandlerSetTimeoutJitter (BREventHandler handler,
+                              unsigned int jitterInMilliseconds) {
+    pthread_mutex_lock (&handler->lock);
+    handler->timeoutJitter.tv_sec  = jitterInMilliseconds / 1000;
+    handler->timeoutJitter.tv_nsec = 1000000 * (jitterInMilliseconds % 1000);
+    pthread_mutex_unlock (&handler->lock);
+}
+
 static void
 eventHandlerAlarmCallback (BREventHandler handler,
                            struct timespec expiration,
                            BREventAlarmClock clock) {
+    // Skip this timeout if the prior one has not been dispatched; there is no point in queueing
+    // periodic work behind itself.
+    if (atomic_exchange (&handler->timeoutPending, true)) return;
+
     BREventTimeout event =
     { { NULL, &handler->timeoutEventType }, handler->timeoutContext, expiration};
     eventHandlerSignalEventOOB (handler, (BREvent*) &event);
 }
 
+///
+/// Check if the timeout `event` has missed its deadline - the next timeout's expiration.
+///
+static int
+eventHandlerTimeoutIsLate (BREventHandler handler,
+                           BREventTimeout *event) {
+    uint64_t expiration = (1000000 * (uint64_t) event->time.tv_sec  + (uint64_t) event->time.tv_nsec  / 1000);
+    uint64_t period     = (1000000 * (uint64_t) handler->timeout.tv_sec + (uint64_t) handler->timeout.tv_nsec / 1000);
+
+    return 0 != period && eventQueueTime() > expiration + period;
+}
+
+static void
+eventDurationStatsAdd (BREventDurationStats *stats,
+                       uint64_t duration) {
+    size_t bucket = 0;
+    for (uint64_t value = duration; value > 0 && bucket < EVENT_STATS_HISTOGRAM_BUCKETS - 1; value >>= 1)
+        bucket++;
+
+    stats->count += 1;
+    stats->total += duration;
+    if (duration > stats->maximum) stats->maximum = duration;
+    stats->histogram[bucket] += 1;
+}
+
+static void
+eventHandlerStatsAdd (BREventHandler handler,
+                      const BREventType *type,
+                      uint64_t latency,
+                      uint64_t dispatch) {
+    // The type's stats; the timeout type (or an unknown type) is last
+    size_t index = 0;
+    while (index < handler->typesCount && type != handler->types[index]) index++;
+
+    pthread_mutex_lock (&handler->statsLock);
+    eventDurationStatsAdd (&handler->latency,  latency);
+    eventDurationStatsAdd (&handler->dispatch, dispatch);
+    eventDurationStatsAdd (&handler->typesStats[index].latency,  latency);
+    eventDurationStatsAdd (&handler->typesStats[index].dispatch, dispatch);
+    pthread_mutex_unlock (&handler->statsLock);
+}
+
+static void
+eventHandlerStatsAddDropped (BREventHandler handler) {
+    pthread_mutex_lock (&handler->statsLock);
+    handler->typesStats[handler->typesCount].dropped += 1;
+    pthread_mutex_unlock (&handler->statsLock);
+}
+
+static void
+eventHandlerDispatch (BREventHandler handler) {
+    const BREventType *type = handler->scratch->type;
+    uint64_t enqueued = handler->scratch->enqueued;
+    uint64_t start    = eventQueueTime();
+
+    int isTimeout = (type == &handler->timeoutEventType);
+
+    // A timeout event that has missed its deadline is dropped, and not counted as dispatched;
+    // the next one is due.
+    if (isTimeout && eventHandlerTimeoutIsLate (handler, (BREventTimeout *) handler->scratch)) {
+        atomic_store (&handler->timeoutPending, false);
+        eventHandlerStatsAddDropped (handler);
+        return;
+    }
+
+    if (handler->lockOnDispatch) pthread_mutex_lock (handler->lockOnDispatch);
+    type->eventDispatcher (handler, handler->scratch);
+    if (handler->lockOnDispatch) pthread_mutex_unlock (handler->lockOnDispatch);
+
+    if (isTimeout) atomic_store (&handler->timeoutPending, false);
+
+    uint64_t end = eventQueueTime();
+
+    // The clock is not monotonic; avoid negative durations
+    eventHandlerStatsAdd (handler, type,
+                          (start > enqueued ? start - enqueued : 0),
+                          (end   > start    ? end   - start    : 0));
+}
+
 static void *
 eventHandlerThread (BREventHandler handler) {
     pthread_setname_brd (pthread_self(), handler->name);
@@ -145,9 +326,7 @@ eventHandlerThread (BREventHandler handler) {
         switch (eventQueueDequeueWait (handler->queue, handler->scratch)) {
             case EVENT_STATUS_SUCCESS:
                 // We got an event, dispatch
-                if (handler->lockOnDispatch) pthread_mutex_lock (handler->lockOnDispatch);
-                handler->scratch->type->eventDispatcher (handler, handler->scratch);
-                if (handler->lockOnDispatch) pthread_mutex_unlock (handler->lockOnDispatch);
+                eventHandlerDispatch (handler);
 
                 // Yield here so that we don't have a situation where we repeatedly acquire
                 // the `lockOnDispatch`, thereby starving other threads, when there are many
@@ -183,6 +362,8 @@ eventHandlerDestroy (BREventHandler handler) {
     // ... then kill
     assert (PTHREAD_NULL == handler->thread);
     pthread_mutex_destroy(&handler->lock);
+    pthread_mutex_destroy(&handler->statsLock);
+    free (handler->typesStats);
 
     // release memory
     eventQueueDestroy(handler->queue);
@@ -204,17 +385,36 @@ extern void
 eventHandlerStart (BREventHandler handler) {
     alarmClockCreateIfNecessary(1);
     pthread_mutex_lock(&handler->lock);
-    if (PTHREAD_NULL == handler->thread) {
+    if (!eventHandlerIsRunning (handler)) {
         // If we have an timeout event dispatcher, then add an alarm.
         if (NULL != handler->timeoutEventType.eventDispatcher) {
-            handler->timeoutAlarmId = alarmClockAddAlarmPeriodic (alarmClock,
-                                                                  (BREventAlarmContext) handler,
-                                                                  (BREventAlarmCallback) eventHandlerAlarmCallback,
-                                                                  handler->timeout);
+            // Any timeout event was cleared when stopped.
+            atomic_store (&handler->timeoutPending, false);
+
+            handler->timeoutAlarmId = (0 == handler->timeoutJitter.tv_sec && 0 == handler->timeoutJitter.tv_nsec
+                                       ? alarmClockAddAlarmPeriodic (alarmClock,
+                                                                     (BREventAlarmContext) handler,
+                                                                     (BREventAlarmCallback) eventHandlerAlarmCallback,
+                                                                     handler->timeout)
+                                       : alarmClockAddAlarmPeriodicWithJitter (alarmClock,
+                                                                               (BREventAlarmContext) handler,
+                                                                               (BREventAlarmCallback) eventHandlerAlarmCallback,
+                                                                               handler->timeout,
+                                                                               handler->timeoutJitter));
+        }
+
+        if (NULL != handler->executor) {
+            // No thread; just make the handler eligible for the executor's workers.  Events
+            // queued before the start get dispatched immediately.
+            pthread_mutex_lock (&handler->executor->lock);
+            handler->executorRunning = 1;
+            pthread_mutex_unlock (&handler->executor->lock);
+
+            eventExecutorSchedule (handler->executor, handler);
         }
 
         // Spawn the eventHandlerThread
-        {
+        else {
             pthread_attr_t attr;
             pthread_attr_init(&attr);
             pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
@@ -249,7 +449,19 @@ eventHandlerStart (BREventHandler handler) {
 extern void
 eventHandlerStop (BREventHandler handler) {
     pthread_mutex_lock(&handler->lock);
-    if (PTHREAD_NULL != handler->thread) {
+    if (NULL != handler->executor && eventHandlerIsRunning (handler)) {
+        // Remove a timeout alarm, if it exists.
+        if (ALARM_ID_NONE != handler->timeoutAlarmId) {
+            alarmClockRemAlarm (alarmClock, handler->timeoutAlarmId);
+            handler->timeoutAlarmId = ALARM_ID_NONE;
+        }
+
+        // Take the handler off the executor, waiting for an in-progress dispatch to complete.
+        eventExecutorUnschedule (handler->executor, handler);
+        eventHandlerClear (handler);
+    }
+
+    else if (PTHREAD_NULL != handler->thread) {
         // Remove a timeout alarm, if it exists.
         if (ALARM_ID_NONE != handler->timeoutAlarmId) {
             alarmClockRemAlarm (alarmClock, handler->timeoutAlarmId);
@@ -273,6 +485,15 @@ eventHandlerStop (BREventHandler handler) {
 
 extern int
 eventHandlerIsCurrentThread (BREventHandler handler) {
+    if (NULL != handler->executor) {
+        pthread_mutex_lock (&handler->executor->lock);
+        int isCurrent = (!handler->executorRunning ||
+                         (PTHREAD_NULL != handler->executorThread &&
+                          pthread_equal (pthread_self(), handler->executorThread)));
+        pthread_mutex_unlock (&handler->executor->lock);
+        return isCurrent;
+    }
+
     // TODO(fix): This is a hack; fix the ordering such that `handler->thread` is
     //            is properly set by the time `eventHandlerThread()` runs (CORE-564)
     return PTHREAD_NULL == handler->thread || pthread_self() == handler->thread;
@@ -280,20 +501,35 @@ eventHandlerIsCurrentThread (BREventHandler handler) {
 
 extern int
 eventHandlerIsRunning (BREventHandler handler) {
+    if (NULL != handler->executor) {
+        pthread_mutex_lock (&handler->executor->lock);
+        int isRunning = handler->executorRunning;
+        pthread_mutex_unlock (&handler->executor->lock);
+        return isRunning;
+    }
+
     return PTHREAD_NULL != handler->thread;
 }
 
 extern BREventStatus
 eventHandlerSignalEvent (BREventHandler handler,
                          BREvent *event) {
-    eventQueueEnqueueTailSignal (handler->queue, event);
+    if (NULL != handler->executor) {
+        eventQueueEnqueueTail (handler->queue, event);
+        eventExecutorSchedule (handler->executor, handler);
+    }
+    else eventQueueEnqueueTailSignal (handler->queue, event);
     return EVENT_STATUS_SUCCESS;
 }
 
 extern BREventStatus
 eventHandlerSignalEventOOB (BREventHandler handler,
                             BREvent *event) {
-    eventQueueEnqueueHeadSignal (handler->queue, event);
+    if (NULL != handler->executor) {
+        eventQueueEnqueueHead (handler->queue, event);
+        eventExecutorSchedule (handler->executor, handler);
+    }
+    else eventQueueEnqueueHeadSignal (handler->queue, event);
     return EVENT_STATUS_SUCCESS;
 }
 
@@ -301,3 +537,248 @@ extern void
 eventHandlerClear (BREventHandler handler) {
     eventQueueClear(handler->queue);
 }
+
+extern void
+eventHandlerSetAvailableLimits (BREventHandler handler,
+                                size_t availableMaximum,
+                                unsigned int idleTrimMilliseconds) {
+    eventQueueSetAvailableLimits (handler->queue, availableMaximum, idleTrimMilliseconds);
+}
+
+//
+// Statistics
+//
+
+extern BREventHandlerStats
+eventHandlerGetStats (BREventHandler handler) {
+    BREventHandlerStats stats;
+
+    eventQueueGetStats (handler->queue,
+                        &stats.queueDepth,
+                        &stats.queueDepthMaximum,
+                        &stats.queueAvailable);
+
+    pthread_mutex_lock (&handler->statsLock);
+    stats.latency  = handler->latency;
+    stats.dispatch = handler->dispatch;
+    pthread_mutex_unlock (&handler->statsLock);
+
+    return stats;
+}
+
+extern size_t
+eventHandlerGetTypeStats (BREventHandler handler,
+                          BREventTypeStats *stats,
+                          size_t statsCount) {
+    size_t typesCount = handler->typesCount + 1;
+
+    if (NULL != stats) {
+        pthread_mutex_lock (&handler->statsLock);
+        for (size_t index = 0; index < typesCount && index < statsCount; index++)
+            stats[index] = handler->typesStats[index];
+        pthread_mutex_unlock (&handler->statsLock);
+    }
+
+    return typesCount;
+}
+
+extern void
+eventHandlerResetStats (BREventHandler handler) {
+    eventQueueResetStats (handler->queue);
+
+    pthread_mutex_lock (&handler->statsLock);
+    memset (&handler->latency,  0, sizeof (BREventDurationStats));
+    memset (&handler->dispatch, 0, sizeof (BREventDurationStats));
+    for (size_t index = 0; index <= handler->typesCount; index++) {
+        memset (&handler->typesStats[index].latency,  0, sizeof (BREventDurationStats));
+        memset (&handler->typesStats[index].dispatch, 0, sizeof (BREventDurationStats));
+        handler->typesStats[index].dropped = 0;
+    }
+    pthread_mutex_unlock (&handler->statsLock);
+}
+
+//
+// Event Executor
+//
+
+/**
+ * Append `handler` to the executor's ready list if it is running, has pending events and is not
+ * already listed or being dispatched.  Must be called after an event is queued: a worker that is
+ * finishing with `handler` checks for pending events under the executor lock, so either that
+ * worker or this call will see the event.
+ */
+static void
+eventExecutorSchedule (BREventExecutor executor,
+                       BREventHandler handler) {
+    pthread_mutex_lock (&executor->lock);
+    if (handler->executorRunning &&
+        !handler->executorScheduled &&
+        eventQueueHasPending (handler->queue)) {
+        handler->executorScheduled = 1;
+        handler->executorNext      = NULL;
+
+        if (NULL == executor->readyTail) executor->readyHead = handler;
+        else executor->readyTail->executorNext = handler;
+        executor->readyTail = handler;
+
+        pthread_cond_signal (&executor->readyCond);
+    }
+    pthread_mutex_unlock (&executor->lock);
+}
+
+/**
+ * Stop scheduling `handler`.  If the handler is listed, it is removed; if a worker is dispatching
+ * it, wait for the worker to finish.  Must not be called from within the handler's dispatcher.
+ */
+static void
+eventExecutorUnschedule (BREventExecutor executor,
+                         BREventHandler handler) {
+    pthread_mutex_lock (&executor->lock);
+    handler->executorRunning = 0;
+
+    // Wait out any in-progress dispatch; the worker won't reschedule a non-running handler.  If
+    // this is the dispatching worker (stopping from within a dispatcher), there is nothing to wait on.
+    while (PTHREAD_NULL != handler->executorThread &&
+           !pthread_equal (pthread_self(), handler->executorThread))
+        pthread_cond_wait (&executor->idleCond, &executor->lock);
+
+    if (handler->executorScheduled) {
+        BREventHandler prev = NULL;
+        for (BREventHandler this = executor->readyHead; NULL != this; prev = this, this = this->executorNext)
+            if (this == handler) {
+                if (NULL == prev) executor->readyHead = handler->executorNext;
+                else prev->executorNext = handler->executorNext;
+                if (executor->readyTail == handler) executor->readyTail = prev;
+                break;
+            }
+
+        handler->executorNext      = NULL;
+        handler->executorScheduled = 0;
+    }
+    pthread_mutex_unlock (&executor->lock);
+}
+
+static void *
+eventExecutorThread (BREventExecutor executor) {
+    pthread_setname_brd (pthread_self(), executor->name);
+
+    pthread_mutex_lock (&executor->lock);
+    while (!executor->threadQuit) {
+        BREventHandler handler = executor->readyHead;
+
+        if (NULL == handler) {
+            pthread_cond_wait (&executor->readyCond, &executor->lock);
+            continue;
+        }
+
+        // Take the handler; it remains 'scheduled' so no other worker will dispatch it.
+        executor->readyHead = handler->executorNext;
+        if (NULL == executor->readyHead) executor->readyTail = NULL;
+        handler->executorNext   = NULL;
+        handler->executorThread = pthread_self();
+        pthread_mutex_unlock (&executor->lock);
+
+        // Dispatch a bounded number of events, in order.
+        for (size_t index = 0; index < EVENT_EXECUTOR_DISPATCH_QUANTUM; index++) {
+            if (EVENT_STATUS_SUCCESS != eventQueueDequeue (handler->queue, handler->scratch))
+                break;
+            eventHandlerDispatch (handler);
+        }
+
+        // Without a thread waiting on the queue, the queue can't trim itself when idle; do so
+        // here, while the handler can't be stopped.
+        if (!eventQueueHasPending (handler->queue))
+            eventQueueTrim (handler->queue);
+
+        pthread_mutex_lock (&executor->lock);
+        handler->executorThread = PTHREAD_NULL;
+
+        // If more events are pending, go to the back of the line; otherwise rest until signalled.
+        if (handler->executorRunning && eventQueueHasPending (handler->queue)) {
+            if (NULL == executor->readyTail) executor->readyHead = handler;
+            else executor->readyTail->executorNext = handler;
+            executor->readyTail = handler;
+        }
+        else handler->executorScheduled = 0;
+
+        pthread_cond_broadcast (&executor->idleCond);
+
+        // As for `eventHandlerThread()`, don't starve other threads wanting `lockOnDispatch`
+        pthread_mutex_unlock (&executor->lock);
+        pthread_yield_brd();
+        pthread_mutex_lock (&executor->lock);
+    }
+    pthread_mutex_unlock (&executor->lock);
+
+    return NULL;
+}
+
+extern BREventExecutor
+eventExecutorCreate (const char *name,
+                     size_t threadsCount) {
+    assert (threadsCount > 0);
+
+    BREventExecutor executor = calloc (1, sizeof (struct BREventExecutorRecord));
+
+    strlcpy (executor->name, name, PTHREAD_NAME_SIZE);
+    executor->threadsCount = threadsCount;
+    executor->threads      = calloc (threadsCount, sizeof (pthread_t));
+
+    pthread_mutex_init_brd (&executor->lock, PTHREAD_MUTEX_NORMAL);
+
+    // Create the PTHREAD CONDition variables
+    {
+        pthread_condattr_t attr;
+        pthread_condattr_init(&attr);
+        pthread_cond_init(&executor->readyCond, &attr);
+        pthread_cond_init(&executor->idleCond,  &attr);
+        pthread_condattr_destroy(&attr);
+    }
+
+    // Spawn the eventExecutorThreads
+    {
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+        pthread_attr_setstacksize(&attr, PTHREAD_STACK_SIZE);
+
+        for (size_t index = 0; index < threadsCount; index++)
+            pthread_create(&executor->threads[index], &attr, (ThreadRoutine) eventExecutorThread, executor);
+
+        pthread_attr_destroy(&attr);
+    }
+
+    return executor;
+}
+
+extern void
+eventExecutorDestroy (BREventExecutor executor) {
+    pthread_mutex_lock (&executor->lock);
+    assert (NULL == executor->readyHead);
+    executor->threadQuit = 1;
+    pthread_cond_broadcast (&executor->readyCond);
+    pthread_mutex_unlock (&executor->lock);
+
+    for (size_t index = 0; index < executor->threadsCount; index++)
+        pthread_join (executor->threads[index], NULL);
+
+    if (eventExecutorDefault == executor)
+        eventExecutorDefault = NULL;
+
+    pthread_cond_destroy  (&executor->readyCond);
+    pthread_cond_destroy  (&executor->idleCond);
+    pthread_mutex_destroy (&executor->lock);
+
+    free (executor->threads);
+    free (executor);
+}
+
+extern void
+eventExecutorSetDefault (BREventExecutor executor) {
+    eventExecutorDefault = executor;
+}
+
+extern BREventExecutor
+eventExecutorGetDefault (void) {
+    return eventExecutorDefault;
+}
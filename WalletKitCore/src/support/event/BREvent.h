@@ -12,6 +12,7 @@
 #define BR_Event_h
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <time.h>
 #include <pthread.h>
 
@@ -21,6 +22,7 @@ extern "C" {
 
 /* Forward Declarations */
 typedef struct BREventHandlerRecord *BREventHandler;
+typedef struct BREventExecutorRecord *BREventExecutor;
 
 typedef struct BREventTypeRecord BREventType;
 typedef struct BREventRecord BREvent;
@@ -41,16 +43,31 @@ typedef void
 typedef void
 (*BREventDestroyer) (BREvent *event);
 
+/**
+ * An EventPriority orders the dispatching of pending events.  All pending events of a higher
+ * priority are dispatched before any of a lower priority; within one priority events are
+ * dispatched in FIFO order (except for OOB events).  Use EVENT_PRIORITY_HIGH for latency
+ * sensitive events that must not wait behind a backlog of bulk events.
+ */
+typedef enum {
+    EVENT_PRIORITY_NORMAL,      // The default
+    EVENT_PRIORITY_HIGH
+} BREventPriority;
+
+#define EVENT_PRIORITY_COUNT        (1 + EVENT_PRIORITY_HIGH)
+
 /**
  * An EventType defines the types of events that will be handled.  Each individual Event will hold
  * a reference to an EventType; when the Event is handled, the EventType's eventDispathver will
- * be invoked.  The `eventSize` is used by the handler to allocate a cache of events.
+ * be invoked.  The `eventSize` is used by the handler to allocate a cache of events.  The
+ * `eventPriority` is, if unspecified in an initializer, EVENT_PRIORITY_NORMAL.
  */
 struct BREventTypeRecord{
     const char *eventName;
     size_t eventSize;
     BREventDispatcher eventDispatcher;
     BREventDestroyer eventDestroyer;
+    BREventPriority eventPriority;
 };
 
 /**
@@ -59,6 +76,7 @@ struct BREventTypeRecord{
 struct BREventRecord {
     struct BREventRecord *next;
     BREventType *type;
+    uint64_t enqueued;  // Filled by the queue: the enqueue time, in microseconds.
     // Add 'context'
     
     // arguments
@@ -113,6 +131,21 @@ eventHandlerCreate (const char *name,
                     size_t typesCount,
                     pthread_mutex_t *lock);
 
+/**
+ * Create an event handler that, if `executor` is not NULL, does not own a thread but instead
+ * has its events dispatched on the executor's workers.  The handler's events are still
+ * dispatched one at a time and in order; only the dispatching thread can change from one event
+ * to the next.  `eventHandlerCreate()` is this function with the default executor, if any.
+ *
+ * The executor must outlive the handler.
+ */
+extern BREventHandler
+eventHandlerCreateWithExecutor (const char *name,
+                                const BREventType *types[],
+                                size_t typesCount,
+                                pthread_mutex_t *lock,
+                                BREventExecutor executor);
+
 /**
  * Optional specify a periodic TimeoutDispatcher.  The `dispatcher` will run every
  * `timeInMilliseconds` (and will be passed a NULL event).  The event will be delivered OOB (out-of-band)
@@ -124,6 +157,19 @@ eventHandlerSetTimeoutDispatcher (BREventHandler handler,
                                   BREventDispatcher dispatcher,
                                   BREventTimeoutContext context);
 
+/**
+ * Optionally spread out the periodic TimeoutDispatcher: the first timeout occurs at a random
+ * time within one period, and each subsequent one is randomly advanced or delayed by up to
+ * `jitterInMilliseconds`.  Use this when many handlers have the same period, so their timeouts
+ * do not all arrive together.  Set before starting the handler.
+ *
+ * Independent of jitter, a timeout is skipped while the prior timeout event is still queued or
+ * being dispatched, and a timeout event dispatched more than one period late is dropped.
+ */
+extern void
+eventHandlerSetTimeoutJitter (BREventHandler handler,
+                              unsigned int jitterInMilliseconds);
+
 extern void
 eventHandlerDestroy (BREventHandler handler);
 
@@ -175,6 +221,98 @@ eventHandlerSignalEventOOB (BREventHandler handler,
 extern void
 eventHandlerClear (BREventHandler handler);
 
+/**
+ * Bound the handler's retained, unused events.  See `eventQueueSetAvailableLimits()`.
+ */
+extern void
+eventHandlerSetAvailableLimits (BREventHandler handler,
+                                size_t availableMaximum,
+                                unsigned int idleTrimMilliseconds);
+
+//
+// Event Handler Statistics
+//
+
+/// The number of histogram buckets.  Bucket `i` counts durations in [2^(i-1), 2^i) microseconds,
+/// with bucket 0 counting durations under one microsecond and the last bucket everything longer.
+#define EVENT_STATS_HISTOGRAM_BUCKETS       (24)
+
+typedef struct {
+    uint64_t count;
+    uint64_t total;         // microseconds
+    uint64_t maximum;       // microseconds
+    uint64_t histogram[EVENT_STATS_HISTOGRAM_BUCKETS];
+} BREventDurationStats;
+
+typedef struct {
+    const char *eventName;
+    BREventDurationStats latency;   // from enqueue to the start of dispatch
+    BREventDurationStats dispatch;  // of the dispatcher
+    uint64_t dropped;               // not dispatched; a timeout that missed its deadline
+} BREventTypeStats;
+
+typedef struct {
+    size_t queueDepth;              // events pending now
+    size_t queueDepthMaximum;       // events pending, at most, since created or reset
+    size_t queueAvailable;          // events allocated but unused (the free-list)
+
+    BREventDurationStats latency;   // over all types
+    BREventDurationStats dispatch;  // over all types
+} BREventHandlerStats;
+
+/**
+ * Get the handler's statistics, accumulated since creation or the last reset.
+ */
+extern BREventHandlerStats
+eventHandlerGetStats (BREventHandler handler);
+
+/**
+ * Fill `stats` with the statistics for each of the handler's event types, including the
+ * implicit timeout type.  Returns the number of types; if `stats` is NULL or `statsCount` is too
+ * small only `statsCount` entries are filled.
+ */
+extern size_t
+eventHandlerGetTypeStats (BREventHandler handler,
+                          BREventTypeStats *stats,
+                          size_t statsCount);
+
+extern void
+eventHandlerResetStats (BREventHandler handler);
+
+//
+// Event Executor
+//
+// An executor is a fixed-size pool of threads shared by any number of event handlers.  Each
+// handler remains a serial queue: at most one worker dispatches a given handler at a time, and a
+// worker dispatches a bounded number of its events before moving on to the next ready handler.
+// Use an executor when hosting many, mostly idle, handlers; a dispatcher that blocks for long
+// periods will hold one of the workers.
+//
+
+/**
+ * Create an executor with `threadsCount` worker threads, named `name`.
+ */
+extern BREventExecutor
+eventExecutorCreate (const char *name,
+                     size_t threadsCount);
+
+/**
+ * Destroy the executor, joining its workers.  All handlers using the executor must have been
+ * stopped.
+ */
+extern void
+eventExecutorDestroy (BREventExecutor executor);
+
+/**
+ * Set the executor used by subsequent `eventHandlerCreate()` calls; NULL, the initial value,
+ * restores a dedicated thread per handler.  Set this once, before creating handlers.
+ */
+extern void
+eventExecutorSetDefault (BREventExecutor executor);
+
+extern BREventExecutor
+eventExecutorGetDefault (void);
+
 #ifdef __cplusplus
 }
 #endif
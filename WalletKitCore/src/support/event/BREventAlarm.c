@@ -15,6 +15,7 @@
 #include <sys/time.h>
 #include "support/BRAssert.h"
 #include "support/BRArray.h"
+#include "support/BRSet.h"
 #include "support/BROSCompat.h"
 #include "BREvent.h"
 #include "BREventAlarm.h"
@@ -63,6 +64,18 @@ timespecInc (struct timespec *t1, struct timespec *t2) {
     }
 }
 
+static inline int64_t
+timespecToNanoseconds (struct timespec *t) {
+    return 1000000000 * (int64_t) t->tv_sec + (int64_t) t->tv_nsec;
+}
+
+static inline struct timespec
+timespecFromNanoseconds (int64_t nanoseconds) {
+    return (struct timespec) {
+        .tv_sec  = (time_t) (nanoseconds / 1000000000),
+        .tv_nsec = (long)   (nanoseconds % 1000000000) };
+}
+
 static inline int
 timespecCompare (struct timespec *t1, struct timespec *t2) {
     return (t1->tv_sec > t2->tv_sec
@@ -98,8 +111,33 @@ typedef struct {
 
     /// The alarm's period.  For a ONE_SHOT alarm, this is ignored/zeroed.
     struct timespec period;
+
+    /// The alarm's jitter; each period is randomly lengthened or shortened by up to this amount.
+    struct timespec jitter;
+
+    /// The alarm's position in the clock's heap of alarms.
+    size_t index;
 } BREventAlarm;
 
+static size_t
+alarmHashValue (const void *alarm) {
+    return ((const BREventAlarm *) alarm)->identifier;
+}
+
+static int
+alarmHashEqual (const void *alarm1, const void *alarm2) {
+    return ((const BREventAlarm *) alarm1)->identifier == ((const BREventAlarm *) alarm2)->identifier;
+}
+
+///
+/// Order alarms by expiration and then, for equal expirations, by identifier.
+///
+static int
+alarmIsBefore (BREventAlarm *alarm1, BREventAlarm *alarm2) {
+    int compare = timespecCompare (&alarm1->expiration, &alarm2->expiration);
+    return -1 == compare || (0 == compare && alarm1->identifier < alarm2->identifier);
+}
+
 static BREventAlarm
 alarmCreatePeriodic (BREventAlarmContext context,
                      BREventAlarmCallback callback,
@@ -112,7 +150,8 @@ alarmCreatePeriodic (BREventAlarmContext context,
         .context = context,
         .callback = callback,
         .expiration = expiration,
-        .period = period };
+        .period = period,
+        .jitter = { .tv_sec = 0, .tv_nsec = 0 } };
 }
 
 static BREventAlarm
@@ -126,7 +165,8 @@ alarmCreate (BREventAlarmContext context,
         .context = context,
         .callback = callback,
         .expiration = expiration,
-        .period = { .tv_sec = 0, .tv_nsec = 0 } };
+        .period = { .tv_sec = 0, .tv_nsec = 0 },
+        .jitter = { .tv_sec = 0, .tv_nsec = 0 } };
 }
 
 static int
@@ -135,9 +175,13 @@ alarmIsPeriodic (BREventAlarm *alarm) {
 }
 
 static void
-alarmPeriodUpdate (BREventAlarm *alarm) {
+alarmPeriodUpdate (BREventAlarm *alarm, int64_t jitter) {
     timespecInc(&alarm->expiration, &alarm->period);
 
+    // Apply the jitter, in nanoseconds
+    if (0 != jitter)
+        alarm->expiration = timespecFromNanoseconds (timespecToNanoseconds (&alarm->expiration) + jitter);
+
     // ensure that expiration does not occur in the past
     struct timespec now = getTime();
     if (-1 == timespecCompare(&alarm->expiration, &now)) {
@@ -145,6 +189,11 @@ alarmPeriodUpdate (BREventAlarm *alarm) {
     }
 }
 
+static void
+alarmFree (void *ignore, void *alarm) {
+    free (alarm);
+}
+
 static void
 alarmExpire (BREventAlarm *alarm, BREventAlarmClock clock) {
     if (NULL != alarm->callback)
@@ -160,12 +209,18 @@ struct BREventAlarmClock {
     /// Identifier of the next alarm created.
     BREventAlarmId identifier;
 
-    /// An BRArrayOf alarms, sorted by alarm.expiration ascending.
-    BREventAlarm *alarms;
+    /// A BRArrayOf alarms, as a binary min-heap on expiration; alarms[0] expires next.
+    BRArrayOf(BREventAlarm*) alarms;
+
+    /// A BRSetOf alarms, by identifier, for constant time lookup (and removal from `alarms`).
+    BRSet *alarmsById;
 
     /// The time of the next timeout
     struct timespec timeout;
 
+    /// The state of a (xorshift64) pseudo-random generator, for jitter.
+    uint64_t random;
+
     // Thread
     pthread_t thread;
     pthread_cond_t cond;
@@ -189,6 +244,12 @@ alarmClockCreate (void) {
 
     clock->identifier = ALARM_ID_NONE;
     array_new(clock->alarms, 5);
+    clock->alarmsById = BRSetNew (alarmHashValue, alarmHashEqual, 5);
+
+    // Seed with anything that differs from process to process; must not be zero.
+    struct timespec now = getTime();
+    clock->random = (uint64_t) timespecToNanoseconds (&now) ^ (uint64_t) (uintptr_t) clock;
+    if (0 == clock->random) clock->random = 1;
 
     // Create the PTHREAD CONDition variable
     {
@@ -223,23 +284,132 @@ alarmClockDestroy (BREventAlarmClock clock) {
     pthread_mutex_destroy(&clock->lockOnStartStop);
 
     array_free (clock->alarms);
+    BRSetFreeAll (clock->alarmsById, free);
+
     if (clock == alarmClock)
-        free (alarmClock);
         alarmClock = NULL;
+    free (clock);
 }
 
+//
+// Alarm Heap
+//
+
 static void
-alarmClockInsertAlarm (BREventAlarmClock clock,
-                       BREventAlarm alarm) {
+alarmClockHeapSet (BREventAlarmClock clock,
+                   size_t index,
+                   BREventAlarm *alarm) {
+    clock->alarms[index] = alarm;
+    alarm->index = index;
+}
+
+static void
+alarmClockHeapSiftUp (BREventAlarmClock clock,
+                      size_t index) {
+    BREventAlarm *alarm = clock->alarms[index];
+
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (!alarmIsBefore (alarm, clock->alarms[parent])) break;
+
+        alarmClockHeapSet (clock, index, clock->alarms[parent]);
+        index = parent;
+    }
+    alarmClockHeapSet (clock, index, alarm);
+}
+
+static void
+alarmClockHeapSiftDown (BREventAlarmClock clock,
+                        size_t index) {
     size_t count = array_count (clock->alarms);
-    size_t index = count;
+    BREventAlarm *alarm = clock->alarms[index];
+
+    while (1) {
+        size_t child = 2 * index + 1;
+        if (child >= count) break;
+
+        // The earlier of the two children
+        if (child + 1 < count && alarmIsBefore (clock->alarms[child + 1], clock->alarms[child]))
+            child += 1;
+
+        if (!alarmIsBefore (clock->alarms[child], alarm)) break;
 
-    for (; index > 0; index--) {
-        // If alarm.expiration is not less than 'alarm at index-1', then insert alarm at index
-        if (-1 != timespecCompare(&alarm.expiration, &clock->alarms[index - 1].expiration))
-            break;
+        alarmClockHeapSet (clock, index, clock->alarms[child]);
+        index = child;
     }
-    array_insert (clock->alarms, index, alarm);
+    alarmClockHeapSet (clock, index, alarm);
+}
+
+static void
+alarmClockInsertAlarm (BREventAlarmClock clock,
+                       BREventAlarm *alarm) {
+    array_add (clock->alarms, alarm);
+    alarmClockHeapSiftUp (clock, array_count (clock->alarms) - 1);
+}
+
+///
+/// Remove the alarm at `index` from the heap (but not from `alarmsById`), returning it.
+///
+static BREventAlarm *
+alarmClockExtractAlarm (BREventAlarmClock clock,
+                        size_t index) {
+    BREventAlarm *alarm = clock->alarms[index];
+    size_t last = array_count (clock->alarms) - 1;
+
+    if (index != last) {
+        // Move the last alarm into the vacated `index` and restore the heap order around it.
+        alarmClockHeapSet (clock, index, clock->alarms[last]);
+        array_rm_last (clock->alarms);
+
+        if (index > 0 && alarmIsBefore (clock->alarms[index], clock->alarms[(index - 1) / 2]))
+            alarmClockHeapSiftUp (clock, index);
+        else
+            alarmClockHeapSiftDown (clock, index);
+    }
+    else array_rm_last (clock->alarms);
+
+    return alarm;
+}
+
+///
+/// Return a pseudo-random value in [0, bound).  Called with `lock` held.
+///
+static uint64_t
+alarmClockRandom (BREventAlarmClock clock,
+                  uint64_t bound) {
+    uint64_t x = clock->random;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    clock->random = x;
+    return 0 == bound ? 0 : x % bound;
+}
+
+///
+/// Return a pseudo-random jitter, in nanoseconds, within +/- the alarm's jitter.
+///
+static int64_t
+alarmClockJitter (BREventAlarmClock clock,
+                  BREventAlarm *alarm) {
+    int64_t jitter = timespecToNanoseconds (&alarm->jitter);
+    return (0 == jitter ? 0 : (int64_t) alarmClockRandom (clock, (uint64_t) (2 * jitter + 1)) - jitter);
+}
+
+static BREventAlarm *
+alarmClockLookupAlarm (BREventAlarmClock clock,
+                       BREventAlarmId identifier) {
+    BREventAlarm key = { .identifier = identifier };
+    return BRSetGet (clock->alarmsById, &key);
+}
+
+static void
+alarmClockAddAlarmInternal (BREventAlarmClock clock,
+                            BREventAlarm alarm) {
+    BREventAlarm *this = malloc (sizeof (BREventAlarm));
+    *this = alarm;
+
+    BRSetAdd (clock->alarmsById, this);
+    alarmClockInsertAlarm (clock, this);
 }
 
 static void *
@@ -253,31 +423,34 @@ alarmClockThread (BREventAlarmClock clock) {
     while (!clock->threadQuit) {
         // Set the next timeout - based on an existing alarm or 'forever in the future'
         clock->timeout = (array_count(clock->alarms) > 0
-                          ? clock->alarms[0].expiration
+                          ? clock->alarms[0]->expiration
                           : (struct timespec) { .tv_sec = LONG_MAX, .tv_nsec = 0 });
 
         switch (pthread_cond_timedwait (&clock->cond, &clock->lock, &clock->timeout)) {
             case ETIMEDOUT: {
                 // Check if alarm was removed while we slept...
                 if (0 == array_count(clock->alarms) ||
-                    0 != timespecCompare(&clock->alarms[0].expiration, &clock->timeout)) {
+                    0 != timespecCompare(&clock->alarms[0]->expiration, &clock->timeout)) {
                     // ... ignore the timeout, its alarm is for the birds now
                     break;
                 }
 
-                // If we timed-out, then get the alarm that has expired...
-                BREventAlarm alarm = clock->alarms[0];
-                // ... and remove it from the clock's alarms (for now; if periodic, add it back)
-                array_rm (clock->alarms, 0);
+                // If we timed-out, then get the alarm that has expired and remove it from the
+                // clock's alarms (for now; if periodic, add it back)
+                BREventAlarm *alarm = alarmClockExtractAlarm (clock, 0);
 
                 // Expire the alarm - invokes the callback.
-                alarmExpire(&alarm, clock);
+                alarmExpire(alarm, clock);
 
-                // If periodic, update the alarm expiration and reinsert
-                if (alarmIsPeriodic(&alarm)) {
-                    alarmPeriodUpdate(&alarm);
+                // If periodic, update the alarm expiration and reinsert; otherwise, done.
+                if (alarmIsPeriodic(alarm)) {
+                    alarmPeriodUpdate(alarm, alarmClockJitter (clock, alarm));
                     alarmClockInsertAlarm(clock, alarm);
                 }
+                else {
+                    BRSetRemove (clock->alarmsById, alarm);
+                    free (alarm);
+                }
 
                 break;
             }
@@ -336,6 +509,8 @@ alarmClockAssertRecovery (BREventAlarmClock clock) {
     alarmClockStop(clock);
     pthread_mutex_lock(&clock->lockOnStartStop);
     array_clear(clock->alarms);
+    BRSetApply (clock->alarmsById, NULL, alarmFree);
+    BRSetClear (clock->alarmsById);
     pthread_mutex_unlock(&clock->lockOnStartStop);
 }
 
@@ -346,7 +521,37 @@ alarmClockAddAlarmPeriodic (BREventAlarmClock clock,
                             struct timespec period) {
     pthread_mutex_lock(&clock->lock);
     BREventAlarmId identifier = ++clock->identifier;
-    alarmClockInsertAlarm(clock, alarmCreatePeriodic(context, callback, getTime(), period, identifier));
+    alarmClockAddAlarmInternal(clock, alarmCreatePeriodic(context, callback, getTime(), period, identifier));
+    // Having modified `alarms` we need to compute a new 'next expiration'
+    pthread_cond_signal(&clock->cond);
+    pthread_mutex_unlock(&clock->lock);
+    return identifier;
+}
+
+extern BREventAlarmId
+alarmClockAddAlarmPeriodicWithJitter (BREventAlarmClock clock,
+                                      BREventAlarmContext context,
+                                      BREventAlarmCallback callback,
+                                      struct timespec period,
+                                      struct timespec jitter) {
+    // Limit the jitter to half the period; thus the period is at least half the nominal value.
+    int64_t periodNanoseconds = timespecToNanoseconds (&period);
+    if (timespecToNanoseconds (&jitter) > periodNanoseconds / 2)
+        jitter = timespecFromNanoseconds (periodNanoseconds / 2);
+
+    pthread_mutex_lock(&clock->lock);
+    BREventAlarmId identifier = ++clock->identifier;
+
+    // Spread the first expiration uniformly over one period; subsequent expirations follow at
+    // the period, with jitter.
+    struct timespec now = getTime();
+    struct timespec expiration = timespecFromNanoseconds (timespecToNanoseconds (&now) +
+                                                          (int64_t) alarmClockRandom (clock, (uint64_t) periodNanoseconds));
+
+    BREventAlarm alarm = alarmCreatePeriodic(context, callback, expiration, period, identifier);
+    alarm.jitter = jitter;
+
+    alarmClockAddAlarmInternal(clock, alarm);
     // Having modified `alarms` we need to compute a new 'next expiration'
     pthread_cond_signal(&clock->cond);
     pthread_mutex_unlock(&clock->lock);
@@ -360,7 +565,7 @@ alarmClockAddAlarm (BREventAlarmClock clock,
                     struct timespec expiration) {
     pthread_mutex_lock(&clock->lock);
     BREventAlarmId identifier = ++clock->identifier;
-    alarmClockInsertAlarm(clock, alarmCreate(context, callback, expiration, identifier));
+    alarmClockAddAlarmInternal(clock, alarmCreate(context, callback, expiration, identifier));
     // Having modified `alarms` we need to compute a new 'next expiration'
     pthread_cond_signal(&clock->cond);
     pthread_mutex_unlock(&clock->lock);
@@ -371,13 +576,15 @@ extern void
 alarmClockRemAlarm (BREventAlarmClock clock,
                     BREventAlarmId identifier) {
     pthread_mutex_lock(&clock->lock);
-    for (size_t index = 0; index < array_count (clock->alarms); index++)
-        if (identifier == clock->alarms[index].identifier) {
-            array_rm(clock->alarms, index);
-            break;
-        }
-    // Having modified `alarms` we need to compute a new 'next expiration'
-    pthread_cond_signal(&clock->cond);
+    BREventAlarm *alarm = alarmClockLookupAlarm (clock, identifier);
+    if (NULL != alarm) {
+        alarmClockExtractAlarm (clock, alarm->index);
+        BRSetRemove (clock->alarmsById, alarm);
+        free (alarm);
+
+        // Having modified `alarms` we need to compute a new 'next expiration'
+        pthread_cond_signal(&clock->cond);
+    }
     pthread_mutex_unlock(&clock->lock);
 }
 
@@ -387,11 +594,7 @@ alarmClockHasAlarm (BREventAlarmClock clock,
     int hasAlarm = 0;
 
     pthread_mutex_lock(&clock->lock);
-    for (int index = 0; index < array_count (clock->alarms); index++)
-        if (identifier == clock->alarms[index].identifier) {
-            hasAlarm = 1;
-            break;
-        }
+    hasAlarm = NULL != alarmClockLookupAlarm (clock, identifier);
     pthread_mutex_unlock(&clock->lock);
 
     return hasAlarm;
@@ -56,6 +56,19 @@ alarmClockAddAlarmPeriodic (BREventAlarmClock clock,
                             BREventAlarmCallback callback,
                             struct timespec period);
 
+/**
+ * Add a periodic alarm whose first expiration is at a random time within one `period` and
+ * whose subsequent expirations are `period` apart, each lengthened or shortened by a random
+ * amount up to `jitter` (limited to half the period).  With many such alarms, expirations are
+ * spread out rather than arriving together.
+ */
+extern BREventAlarmId
+alarmClockAddAlarmPeriodicWithJitter (BREventAlarmClock clock,
+                                      BREventAlarmContext context,
+                                      BREventAlarmCallback callback,
+                                      struct timespec period,
+                                      struct timespec jitter);
+
 extern BREventAlarmId
 alarmClockAddAlarm  (BREventAlarmClock clock,
                      BREventAlarmContext context,
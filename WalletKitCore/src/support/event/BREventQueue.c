@@ -10,20 +10,38 @@
 //
 
 #include <string.h>
+#include <errno.h>
 #include <pthread.h>
+#include <sys/time.h>
 #include "support/BROSCompat.h"
 
 #include "BREventQueue.h"
 
 #define EVENT_QUEUE_DEFAULT_INITIAL_CAPACITY   (1)
+#define EVENT_QUEUE_DEFAULT_AVAILABLE_MAXIMUM  (100)
+#define EVENT_QUEUE_DEFAULT_IDLE_TRIM_MS       (10 * 1000)
 
 struct BREventQueueRecord {
-    // A linked-list (through event->next) of pending events.
-    BREvent *pending;
+    // A linked-list (through event->next) of pending events, one per priority.
+    BREvent *pending[EVENT_PRIORITY_COUNT];
+
+    // The last pending event, one per priority, for a constant-time enqueue at the tail.
+    BREvent *pendingLast[EVENT_PRIORITY_COUNT];
 
     // A linked-list (through event->next) of available events
     BREvent *available;
 
+    // Counts of pending and available events; the maximum pending.
+    size_t pendingCount;
+    size_t pendingCountMaximum;
+    size_t availableCount;
+
+    // The maximum number of available events retained; others are freed.
+    size_t availableMaximum;
+
+    // The time without pending events after which available events are trimmed; 0 for never.
+    unsigned int idleTrimMilliseconds;
+
     // If not provided with a lock, use this one.
     pthread_mutex_t lock;
 
@@ -41,7 +59,10 @@ extern BREventQueue
 eventQueueCreate (size_t size) {
     BREventQueue queue = calloc (1, sizeof (struct BREventQueueRecord));
 
-    queue->pending = NULL;
+    for (size_t priority = 0; priority < EVENT_PRIORITY_COUNT; priority++) {
+        queue->pending[priority] = NULL;
+        queue->pendingLast[priority] = NULL;
+    }
     queue->available = NULL;
     queue->abort = 0;
     queue->size  = size;
@@ -51,6 +72,10 @@ eventQueueCreate (size_t size) {
         event->next = queue->available;
         queue->available = event;
     }
+    queue->availableCount = EVENT_QUEUE_DEFAULT_INITIAL_CAPACITY;
+
+    queue->availableMaximum     = EVENT_QUEUE_DEFAULT_AVAILABLE_MAXIMUM;
+    queue->idleTrimMilliseconds = EVENT_QUEUE_DEFAULT_IDLE_TRIM_MS;
 
     // Create the PTHREAD CONDition variable
     {
@@ -88,11 +113,16 @@ extern void
 eventQueueClear (BREventQueue queue) {
     pthread_mutex_lock(&queue->lock);
 
-    eventFreeAll(queue->pending, 1);
+    for (size_t priority = 0; priority < EVENT_PRIORITY_COUNT; priority++) {
+        eventFreeAll(queue->pending[priority], 1);
+        queue->pending[priority] = NULL;
+        queue->pendingLast[priority] = NULL;
+    }
     eventFreeAll(queue->available, 0);
 
-    queue->pending = NULL;
     queue->available = NULL;
+    queue->pendingCount = 0;
+    queue->availableCount = 0;
 
     pthread_mutex_unlock(&queue->lock);
 }
@@ -109,6 +139,12 @@ eventQueueDestroy (BREventQueue queue) {
     free (queue);
 }
 
+static size_t
+eventQueuePriority (const BREvent *event) {
+    BREventPriority priority = event->type->eventPriority;
+    return (priority < EVENT_PRIORITY_COUNT ? priority : EVENT_PRIORITY_NORMAL);
+}
+
 static void
 eventQueueEnqueue (BREventQueue queue,
                    const BREvent *event,
@@ -122,25 +158,33 @@ eventQueueEnqueue (BREventQueue queue,
         this = (BREvent*) calloc (1, queue->size);
         this->next = NULL;
     }
+    else queue->availableCount--;
+
     // Make the next event no longer available.
     queue->available = this->next;
 
     // Fill in `this` with event
     memcpy (this, event, event->type->eventSize);
     this->next = NULL;
+    this->enqueued = eventQueueTime();
+
+    queue->pendingCount++;
+    if (queue->pendingCount > queue->pendingCountMaximum)
+        queue->pendingCountMaximum = queue->pendingCount;
+
+    // The pending list for the event's priority
+    size_t priority = eventQueuePriority (event);
 
     // Nothing pending, simply add.
-    if (NULL == queue->pending)
-        queue->pending = this;
+    if (NULL == queue->pending[priority])
+        queue->pending[priority] = queue->pendingLast[priority] = this;
     else if (tail) {
-        // Find the last event
-        BREvent *last = queue->pending;
-        while (NULL != last->next) last = last->next;
-        last->next = this;
+        queue->pendingLast[priority]->next = this;
+        queue->pendingLast[priority] = this;
     }
     else /* (head) */ {
-        this->next = queue->pending;
-        queue->pending = this;
+        this->next = queue->pending[priority];
+        queue->pending[priority] = this;
     }
 
     if (signal) pthread_cond_signal (&queue->cond);
@@ -170,25 +214,50 @@ eventQueueEnqueueHeadSignal (BREventQueue queue,
     eventQueueEnqueue (queue, event, 0, 1);
 }
 
+///
+/// Free available events until at most `count` remain.  Called with `lock` held.
+///
+static void
+_eventQueueTrim (BREventQueue queue,
+                 size_t count) {
+    while (queue->availableCount > count) {
+        BREvent *this = queue->available;
+        queue->available = this->next;
+        queue->availableCount--;
+        free (this);
+    }
+}
+
 static int
 _eventQueueDequeue (BREventQueue queue,
                     BREvent *event) {
-    // Get the next pending event
-    BREvent *this = queue->pending;
+    // Get the next pending event, from the highest priority with one
+    size_t priority = EVENT_PRIORITY_COUNT;
+    while (priority > 0 && NULL == queue->pending[priority - 1]) priority--;
 
     // if there is one, process it
-    if (NULL == this) return 0;
+    if (0 == priority) return 0;
+    priority -= 1;
+
+    BREvent *this = queue->pending[priority];
 
     // Remove `this` from the pending list.
-    queue->pending = this->next;
+    queue->pending[priority] = this->next;
+    if (NULL == queue->pending[priority]) queue->pendingLast[priority] = NULL;
 
     // Fill in the provided event;
     this->next = NULL;
     memcpy (event, this, queue->size);
 
-    // Return `this` to the available list.
-    this->next = queue->available;
-    queue->available = this;
+    queue->pendingCount--;
+
+    // Return `this` to the available list, unless that list is full.
+    if (queue->availableCount < queue->availableMaximum) {
+        this->next = queue->available;
+        queue->available = this;
+        queue->availableCount++;
+    }
+    else free (this);
 
     return 1;
 }
@@ -217,11 +286,32 @@ eventQueueDequeueWait (BREventQueue queue,
     BREventStatus status = EVENT_STATUS_SUCCESS;
 
     pthread_mutex_lock (&queue->lock);
-    while (!queue->abort && !_eventQueueDequeue (queue, event))
-        if (0 != pthread_cond_wait (&queue->cond, &queue->lock)) {
+    while (!queue->abort && !_eventQueueDequeue (queue, event)) {
+        int result;
+
+        // If holding more than the baseline of available events, wait for at most the idle
+        // time and then, if still idle, trim to the baseline.
+        if (0 != queue->idleTrimMilliseconds &&
+            queue->availableCount > EVENT_QUEUE_DEFAULT_INITIAL_CAPACITY) {
+            uint64_t deadline = eventQueueTime() + 1000 * (uint64_t) queue->idleTrimMilliseconds;
+            struct timespec timeout = {
+                .tv_sec  = (time_t) (deadline / 1000000),
+                .tv_nsec = (long)   (1000 * (deadline % 1000000))
+            };
+
+            result = pthread_cond_timedwait (&queue->cond, &queue->lock, &timeout);
+            if (ETIMEDOUT == result) {
+                _eventQueueTrim (queue, EVENT_QUEUE_DEFAULT_INITIAL_CAPACITY);
+                result = 0;
+            }
+        }
+        else result = pthread_cond_wait (&queue->cond, &queue->lock);
+
+        if (0 != result) {
             status = EVENT_STATUS_WAIT_ERROR;
             break; /* from while */
         }
+    }
     if (queue->abort) status = EVENT_STATUS_WAIT_ABORT;
     pthread_mutex_unlock(&queue->lock);
 
@@ -248,7 +338,54 @@ extern int
 eventQueueHasPending (BREventQueue queue) {
     int pending = 0;
     pthread_mutex_lock(&queue->lock);
-    pending = NULL != queue->pending;
+    for (size_t priority = 0; priority < EVENT_PRIORITY_COUNT && !pending; priority++)
+        pending = NULL != queue->pending[priority];
     pthread_mutex_unlock(&queue->lock);
     return pending;
 }
+
+extern void
+eventQueueGetStats (BREventQueue queue,
+                    size_t *depth,
+                    size_t *depthMaximum,
+                    size_t *available) {
+    pthread_mutex_lock(&queue->lock);
+    if (NULL != depth)        *depth        = queue->pendingCount;
+    if (NULL != depthMaximum) *depthMaximum = queue->pendingCountMaximum;
+    if (NULL != available)    *available    = queue->availableCount;
+    pthread_mutex_unlock(&queue->lock);
+}
+
+extern void
+eventQueueSetAvailableLimits (BREventQueue queue,
+                              size_t availableMaximum,
+                              unsigned int idleTrimMilliseconds) {
+    pthread_mutex_lock(&queue->lock);
+    queue->availableMaximum     = availableMaximum;
+    queue->idleTrimMilliseconds = idleTrimMilliseconds;
+    _eventQueueTrim (queue, availableMaximum);
+    // A waiting thread recomputes its timeout
+    pthread_cond_signal (&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+extern void
+eventQueueTrim (BREventQueue queue) {
+    pthread_mutex_lock(&queue->lock);
+    _eventQueueTrim (queue, EVENT_QUEUE_DEFAULT_INITIAL_CAPACITY);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+extern void
+eventQueueResetStats (BREventQueue queue) {
+    pthread_mutex_lock(&queue->lock);
+    queue->pendingCountMaximum = queue->pendingCount;
+    pthread_mutex_unlock(&queue->lock);
+}
+
+extern uint64_t
+eventQueueTime (void) {
+    struct timeval now;
+    gettimeofday (&now, NULL);
+    return 1000000 * (uint64_t) now.tv_sec + (uint64_t) now.tv_usec;
+}
@@ -66,6 +66,42 @@ eventQueueHasPending (BREventQueue queue);
 extern void
 eventQueueClear (BREventQueue queue);
 
+/**
+ * Limit the number of available events - allocated events retained for reuse once dispatched -
+ * to `availableMaximum`.  If `idleTrimMilliseconds` is not zero, a queue waiting in
+ * `eventQueueDequeueWait()` for that long trims its available events back to the baseline.  The
+ * defaults are 100 events and 10 seconds.
+ */
+extern void
+eventQueueSetAvailableLimits (BREventQueue queue,
+                              size_t availableMaximum,
+                              unsigned int idleTrimMilliseconds);
+
+/**
+ * Trim the available events back to the baseline.
+ */
+extern void
+eventQueueTrim (BREventQueue queue);
+
+/**
+ * Get the current number of pending events, the maximum number since created or the last reset,
+ * and the number of unused (aka 'available') events.
+ */
+extern void
+eventQueueGetStats (BREventQueue queue,
+                    size_t *depth,
+                    size_t *depthMaximum,
+                    size_t *available);
+
+extern void
+eventQueueResetStats (BREventQueue queue);
+
+/**
+ * The current time, in microseconds, as used for `BREvent.enqueued`.
+ */
+extern uint64_t
+eventQueueTime (void);
+
 #ifdef __cplusplus
 }
 #endif